@@ -18,6 +18,13 @@
 #include <core/core.h>
 #include <core/platforms.h>
 #include <core/gdb_console.h>
+#include <core/profile.h>
+#include <core/perf.h>
+#include <core/irqstats.h>
+#include <core/sampler.h>
+#include <core/cpuload.h>
+#include <core/async_console.h>
+#include <core/backtrace.h>
 #include <semihost/newlib/newlib_stubs.h>
 #include <semihost/arm/semihost_arm.h>
 #include "debug_cm3.h"
@@ -217,6 +224,7 @@ static void configureDWTandFPB(void)
 {
     enableDWTandITM();
     initDWT();
+    mriCortexMState.dwtMaxMaskBits = calculateDWTMaxMaskBits();
     initFPB();
 }
 
@@ -634,7 +642,9 @@ size_t Platform_GetPacketBufferSize(void)
 static PlatformTrapReason cacheTrapReason(void);
 static uint32_t encounteredStackingException(void);
 static PlatformTrapReason findMatchedWatchpoint(void);
+static int isCycleCountComparator(const DWT_COMP_Type* pComparator);
 static PlatformTrapReason getReasonFromMatchComparator(const DWT_COMP_Type* pComparator);
+static PlatformTrapType convertCortexMTypeToTrapType(uint32_t nativeType);
 static uint32_t hasControlCBeenDetected(void);
 static uint8_t  determineCauseOfDebugEvent(void);
 uint8_t Platform_DetermineCauseOfException(void)
@@ -683,6 +693,12 @@ PlatformTrapReason cacheTrapReason(void)
         /* Stacking faults are more important than breakpoints and lead to an unknown PC anyway. */
         return reason;
     }
+    else if (mriCortexMState.mpuWatchReason.type != MRI_PLATFORM_TRAP_TYPE_UNKNOWN)
+    {
+        /* Single stepped over an access to memory being watched with a MPU region. */
+        reason = mriCortexMState.mpuWatchReason;
+        mriCortexMState.mpuWatchReason.type = MRI_PLATFORM_TRAP_TYPE_UNKNOWN;
+    }
     else if (debugFaultStatus & SCB_DFSR_BKPT)
     {
         /* Was caused by hardware or software breakpoint. If PC points to BKPT then report as software breakpoint. */
@@ -710,36 +726,50 @@ static PlatformTrapReason findMatchedWatchpoint(void)
     uint32_t           comparatorCount;
     uint32_t           i;
 
+    /* MATCHED bits already read (and cleared) while recording a profile sample were cached in dwtMatchedMask. */
     comparatorCount = getDWTComparatorCount();
     for (i = 0 ; i < comparatorCount ; i++)
     {
-        if (pCurrentComparator->FUNCTION & DWT_COMP_FUNCTION_MATCHED)
+        int isMatched = (pCurrentComparator->FUNCTION & DWT_COMP_FUNCTION_MATCHED) ||
+                        (mriCortexMState.dwtMatchedMask & (1 << i));
+        if (isMatched && !isCycleCountComparator(pCurrentComparator))
             reason = getReasonFromMatchComparator(pCurrentComparator);
         pCurrentComparator++;
     }
+    mriCortexMState.dwtMatchedMask = 0;
     return reason;
 }
 
+static int isCycleCountComparator(const DWT_COMP_Type* pComparator)
+{
+    return pComparator == getDWTCycleCountComparator() && isDWTCycleCountComparatorEnabled();
+}
+
 static PlatformTrapReason getReasonFromMatchComparator(const DWT_COMP_Type* pComparator)
 {
     PlatformTrapReason reason;
-    switch (pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK)
+
+    reason.type = convertCortexMTypeToTrapType(pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK);
+    if (isDWTValueComparator(pComparator))
+        reason.address = DWT_COMP_ARRAY[getDWTLinkedAddressIndex(pComparator)].COMP;
+    else
+        reason.address = pComparator->COMP;
+    return reason;
+}
+
+static PlatformTrapType convertCortexMTypeToTrapType(uint32_t nativeType)
+{
+    switch (nativeType)
     {
     case DWT_COMP_FUNCTION_FUNCTION_DATA_READ:
-        reason.type = MRI_PLATFORM_TRAP_TYPE_RWATCH;
-        break;
+        return MRI_PLATFORM_TRAP_TYPE_RWATCH;
     case DWT_COMP_FUNCTION_FUNCTION_DATA_WRITE:
-        reason.type = MRI_PLATFORM_TRAP_TYPE_WATCH;
-        break;
+        return MRI_PLATFORM_TRAP_TYPE_WATCH;
     case DWT_COMP_FUNCTION_FUNCTION_DATA_READWRITE:
-        reason.type = MRI_PLATFORM_TRAP_TYPE_AWATCH;
-        break;
+        return MRI_PLATFORM_TRAP_TYPE_AWATCH;
     default:
-        reason.type = MRI_PLATFORM_TRAP_TYPE_UNKNOWN;
-        break;
+        return MRI_PLATFORM_TRAP_TYPE_UNKNOWN;
     }
-    reason.address = pComparator->COMP;
-    return reason;
 }
 
 static uint32_t hasControlCBeenDetected()
@@ -788,6 +818,7 @@ static void displayHardFaultCauseToGdbConsole(void);
 static void displayMemFaultCauseToGdbConsole(void);
 static void displayBusFaultCauseToGdbConsole(void);
 static void displayUsageFaultCauseToGdbConsole(void);
+static void displayBacktraceToGdbConsole(void);
 void Platform_DisplayFaultCauseToGdbConsole(void)
 {
     switch (mriCortexMState.exceptionNumber)
@@ -811,6 +842,7 @@ void Platform_DisplayFaultCauseToGdbConsole(void)
     default:
         return;
     }
+    displayBacktraceToGdbConsole();
     WriteStringToGdbConsole("\n");
 }
 
@@ -967,13 +999,49 @@ static void displayUsageFaultCauseToGdbConsole(void)
         WriteStringToGdbConsole("\n    Undefined Instruction");
 }
 
+/* The symbols aren't available on the target so only the addresses are shown. gdb's "info symbol ADDRESS" or
+   "list *ADDRESS" will map them back to the source code. */
+static void displayBacktraceToGdbConsole(void)
+{
+    const BacktraceRecord* pRecord = Backtrace_GetFirstRecord();
+    uint32_t               i;
+
+    WriteStringToGdbConsole("\n**Backtrace**");
+    for (i = 0 ; i < pRecord->frameCount ; i++)
+    {
+        WriteStringToGdbConsole("\n  #");
+        WriteDecimalValueToGdbConsole(i);
+        WriteStringToGdbConsole(" ");
+        WriteHexValueToGdbConsole(pRecord->frames[i]);
+    }
+}
+
+
+size_t Platform_GetFaultStatusRegisters(uint32_t* pRegisters, size_t maxRegisters)
+{
+    /* Recorded as CFSR, HFSR, DFSR, MMFAR, and BFAR before the fault status bits were cleared. */
+    uint32_t faultStatusRegisters[5];
+    size_t   i;
+
+    faultStatusRegisters[0] = mriCortexMState.cfsr;
+    faultStatusRegisters[1] = mriCortexMState.hfsr;
+    faultStatusRegisters[2] = mriCortexMState.dfsr;
+    faultStatusRegisters[3] = mriCortexMState.mmfar;
+    faultStatusRegisters[4] = mriCortexMState.bfar;
+    for (i = 0 ; i < maxRegisters && i < sizeof(faultStatusRegisters)/sizeof(faultStatusRegisters[0]) ; i++)
+        pRegisters[i] = faultStatusRegisters[i];
+    return i;
+}
+
 
 static void     clearMemoryFaultFlag(void);
 static int      isExternalInterrupt(uint32_t exceptionNumber);
 static void     setControlCFlag(void);
 static void     setActiveDebugFlag(void);
+static void     disableMPUWatchRegions(void);
 void Platform_EnteringDebugger(void)
 {
+    disableMPUWatchRegions();
     clearMemoryFaultFlag();
     mriCortexMState.originalPC = Platform_GetProgramCounter();
     Platform_DisableSingleStep();
@@ -1008,6 +1076,8 @@ static void checkStack(void);
 static void clearControlCFlag(void);
 static void clearActiveDebugFlag(void);
 static void clearPendedFromFaultFlag(void);
+static void enableMPUWatchRegions(void);
+static void rearmCycleCountComparatorIfNeeded(void);
 void Platform_LeavingDebugger(void)
 {
     checkStack();
@@ -1015,6 +1085,8 @@ void Platform_LeavingDebugger(void)
     clearActiveDebugFlag();
     clearPendedFromFaultFlag();
     clearMonitorPending();
+    enableMPUWatchRegions();
+    rearmCycleCountComparatorIfNeeded();
 }
 
 static void clearControlCFlag(void)
@@ -1032,6 +1104,13 @@ static void clearPendedFromFaultFlag(void)
     mriCortexMFlags &= ~CORTEXM_FLAGS_PEND_FROM_FAULT;
 }
 
+static void rearmCycleCountComparatorIfNeeded(void)
+{
+    /* CYCCNT kept running while halted in the debugger so the comparator has probably been passed already. */
+    if (mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS)
+        armDWTCycleCountComparator(mriCortexMState.cycleMatchInterval);
+}
+
 static void checkStack(void)
 {
     uint32_t* pCurr = (uint32_t*)mriCortexMDebuggerStack;
@@ -1053,6 +1132,12 @@ uint32_t Platform_GetProgramCounter(void)
 }
 
 
+uint32_t Platform_GetStackPointer(void)
+{
+    return Context_Get(&mriCortexMState.context, SP);
+}
+
+
 void Platform_SetProgramCounter(uint32_t newPC)
 {
     Context_Set(&mriCortexMState.context, PC, newPC);
@@ -1192,6 +1277,201 @@ void Platform_SetSemihostCallReturnAndErrnoValues(int returnValue, int errNo)
 }
 
 
+/* Decodes just enough of the Thumb-2 store instructions to know which bytes of memory they can modify. Conditional
+   stores in an IT block are treated as though they will execute since capturing a few extra bytes is harmless. */
+static PlatformMemoryWrite decode16BitStore(uint16_t instruction);
+static PlatformMemoryWrite decode32BitStore(uint16_t firstWord, uint16_t secondWord);
+static PlatformMemoryWrite decodeSingleStore(uint16_t firstWord, uint16_t secondWord);
+static PlatformMemoryWrite memoryWrite(uint32_t address, uint32_t size);
+static uint32_t            getStoreBaseRegister(uint32_t reg);
+static uint32_t            countBits(uint32_t value);
+PlatformMemoryWrite Platform_GetMemoryWriteOfCurrentInstruction(void)
+{
+    uint16_t firstWord = 0;
+    uint16_t secondWord = 0;
+
+    __try
+    {
+        __throwing_func( firstWord = getFirstHalfWordOfCurrentInstruction() );
+        if (isInstruction32Bit(firstWord))
+        {
+            __throwing_func( secondWord = getSecondHalfWordOfCurrentInstruction() );
+        }
+    }
+    __catch
+    {
+        clearExceptionCode();
+        return memoryWrite(0, 0);
+    }
+
+    if (isInstruction32Bit(firstWord))
+        return decode32BitStore(firstWord, secondWord);
+    return decode16BitStore(firstWord);
+}
+
+static PlatformMemoryWrite decode16BitStore(uint16_t instruction)
+{
+    uint32_t rn = (instruction >> 3) & 0x7;
+    uint32_t rm = (instruction >> 6) & 0x7;
+    uint32_t imm5 = (instruction >> 6) & 0x1F;
+    uint32_t registerCount;
+
+    switch (instruction & 0xF800)
+    {
+    case 0x6000:
+        /* STR Rt, [Rn, #imm5*4] */
+        return memoryWrite(getStoreBaseRegister(rn) + (imm5 << 2), 4);
+    case 0x7000:
+        /* STRB Rt, [Rn, #imm5] */
+        return memoryWrite(getStoreBaseRegister(rn) + imm5, 1);
+    case 0x8000:
+        /* STRH Rt, [Rn, #imm5*2] */
+        return memoryWrite(getStoreBaseRegister(rn) + (imm5 << 1), 2);
+    case 0x9000:
+        /* STR Rt, [SP, #imm8*4] */
+        return memoryWrite(getStoreBaseRegister(SP) + ((instruction & 0xFF) << 2), 4);
+    case 0xC000:
+        /* STMIA Rn!, {reglist} */
+        return memoryWrite(getStoreBaseRegister((instruction >> 8) & 0x7), 4 * countBits(instruction & 0xFF));
+    }
+    switch (instruction & 0xFE00)
+    {
+    case 0x5000:
+        /* STR Rt, [Rn, Rm] */
+        return memoryWrite(getStoreBaseRegister(rn) + getStoreBaseRegister(rm), 4);
+    case 0x5200:
+        /* STRH Rt, [Rn, Rm] */
+        return memoryWrite(getStoreBaseRegister(rn) + getStoreBaseRegister(rm), 2);
+    case 0x5400:
+        /* STRB Rt, [Rn, Rm] */
+        return memoryWrite(getStoreBaseRegister(rn) + getStoreBaseRegister(rm), 1);
+    case 0xB400:
+        /* PUSH {reglist, LR} */
+        registerCount = countBits(instruction & 0x1FF);
+        return memoryWrite(getStoreBaseRegister(SP) - 4 * registerCount, 4 * registerCount);
+    }
+    return memoryWrite(0, 0);
+}
+
+static PlatformMemoryWrite decode32BitStore(uint16_t firstWord, uint16_t secondWord)
+{
+    uint32_t rn = firstWord & 0xF;
+    uint32_t base = getStoreBaseRegister(rn);
+    uint32_t imm8 = secondWord & 0xFF;
+    uint32_t registerCount;
+
+    if ((firstWord & 0xFFD0) == 0xE880)
+    {
+        /* STMIA.W Rn{!}, {reglist} */
+        return memoryWrite(base, 4 * countBits(secondWord & 0x5FFF));
+    }
+    if ((firstWord & 0xFFD0) == 0xE900)
+    {
+        /* STMDB Rn{!}, {reglist} and PUSH.W {reglist} */
+        registerCount = countBits(secondWord & 0x5FFF);
+        return memoryWrite(base - 4 * registerCount, 4 * registerCount);
+    }
+    if ((firstWord & 0xFFF0) == 0xE840)
+    {
+        /* STREX Rd, Rt, [Rn, #imm8*4] */
+        return memoryWrite(base + (imm8 << 2), 4);
+    }
+    if ((firstWord & 0xFFF0) == 0xE8C0 && (secondWord & 0x00E0) == 0x0040)
+    {
+        /* STREXB and STREXH Rd, Rt, [Rn] */
+        return memoryWrite(base, (secondWord & 0x0010) ? 2 : 1);
+    }
+    if ((firstWord & 0xFE50) == 0xE840 && (firstWord & 0x0120) != 0)
+    {
+        /* STRD Rt, Rt2, [Rn{, #+/-imm8*4}]{!} and STRD Rt, Rt2, [Rn], #+/-imm8*4 */
+        if (firstWord & 0x0100)
+            base = (firstWord & 0x0080) ? base + (imm8 << 2) : base - (imm8 << 2);
+        return memoryWrite(base, 8);
+    }
+    if ((firstWord & 0xFF10) == 0xF800)
+        return decodeSingleStore(firstWord, secondWord);
+    if ((secondWord & 0x0E00) == 0x0A00 && (firstWord & 0xFF30) == 0xED00)
+    {
+        /* VSTR Sd/Dd, [Rn, #+/-imm8*4] */
+        base = (firstWord & 0x0080) ? base + (imm8 << 2) : base - (imm8 << 2);
+        return memoryWrite(base, (secondWord & 0x0100) ? 8 : 4);
+    }
+    if ((secondWord & 0x0E00) == 0x0A00 && (firstWord & 0xFE10) == 0xEC00)
+    {
+        switch (firstWord & 0x01A0)
+        {
+        case 0x0080:
+        case 0x00A0:
+            /* VSTMIA Rn{!}, {list} */
+            return memoryWrite(base, imm8 << 2);
+        case 0x0120:
+            /* VSTMDB Rn!, {list} and VPUSH {list} */
+            return memoryWrite(base - (imm8 << 2), imm8 << 2);
+        }
+    }
+    return memoryWrite(0, 0);
+}
+
+static PlatformMemoryWrite decodeSingleStore(uint16_t firstWord, uint16_t secondWord)
+{
+    static const uint8_t sizes[] = { 1, 2, 4, 0 };
+    uint32_t             op1 = (firstWord >> 5) & 0x7;
+    uint32_t             size = sizes[op1 & 0x3];
+    uint32_t             base = getStoreBaseRegister(firstWord & 0xF);
+    uint32_t             imm8 = secondWord & 0xFF;
+    uint32_t             offsetAddress;
+
+    if (size == 0)
+        return memoryWrite(0, 0);
+    if (op1 & 0x4)
+    {
+        /* STR{B,H}.W Rt, [Rn, #imm12] */
+        return memoryWrite(base + (secondWord & 0xFFF), size);
+    }
+    if ((secondWord & 0x0FC0) == 0x0000)
+    {
+        /* STR{B,H}.W Rt, [Rn, Rm{, LSL #imm2}] */
+        return memoryWrite(base + (getStoreBaseRegister(secondWord & 0xF) << ((secondWord >> 4) & 0x3)), size);
+    }
+    if (secondWord & 0x0800)
+    {
+        /* STR{B,H}{T} Rt, [Rn, #+/-imm8]{!} and STR{B,H} Rt, [Rn], #+/-imm8 */
+        offsetAddress = (secondWord & 0x0200) ? base + imm8 : base - imm8;
+        return memoryWrite((secondWord & 0x0400) ? offsetAddress : base, size);
+    }
+    return memoryWrite(0, 0);
+}
+
+static PlatformMemoryWrite memoryWrite(uint32_t address, uint32_t size)
+{
+    PlatformMemoryWrite write;
+
+    write.address = address;
+    write.size = size;
+    return write;
+}
+
+static uint32_t getStoreBaseRegister(uint32_t reg)
+{
+    /* The PC reads as the word aligned address of the current instruction + 4 when used as a base register. */
+    if (reg == PC)
+        return (Platform_GetProgramCounter() + 4) & ~3;
+    return Context_Get(&mriCortexMState.context, reg);
+}
+
+static uint32_t countBits(uint32_t value)
+{
+    uint32_t count = 0;
+
+    while (value)
+    {
+        value &= value - 1;
+        count++;
+    }
+    return count;
+}
+
+
 int Platform_WasMemoryFaultEncountered(void)
 {
     int wasFaultEncountered;
@@ -1310,16 +1590,21 @@ void Platform_ClearHardwareBreakpoint(uint32_t address)
 
 
 static uint32_t convertWatchpointTypeToCortexMType(PlatformWatchpointType type);
+static int      enableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type);
 void Platform_SetHardwareWatchpoint(uint32_t address, uint32_t size, PlatformWatchpointType type)
 {
-    uint32_t       nativeType = convertWatchpointTypeToCortexMType(type);
-    DWT_COMP_Type* pComparator;
+    uint32_t nativeType = convertWatchpointTypeToCortexMType(type);
 
-    if (!isValidDWTComparatorSetting(address, size, nativeType))
+    if (!isValidDWTComparatorRange(address, size, nativeType))
         __throw(invalidArgumentException);
 
-    pComparator = enableDWTWatchpoint(address, size, nativeType);
-    if (!pComparator)
+    /* Ranges which aren't naturally aligned powers of 2 are split across multiple comparators. This fails without
+       setting any of them if there aren't enough free comparators left so that gdb can fall back cleanly. */
+    if (enableDWTWatchpointRange(address, size, nativeType, mriCortexMState.dwtMaxMaskBits,
+                                 mriCortexMState.dwtUseCounts))
+        return;
+    /* Ranges too large for the remaining comparators can still be watched with a MPU region. */
+    if (!enableMPUWatchpoint(address, size, nativeType))
         __throw(exceededHardwareResourcesException);
 }
 
@@ -1339,16 +1624,595 @@ static uint32_t convertWatchpointTypeToCortexMType(PlatformWatchpointType type)
 }
 
 
+static int disableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type);
 void Platform_ClearHardwareWatchpoint(uint32_t address, uint32_t size, PlatformWatchpointType type)
 {
     uint32_t nativeType = convertWatchpointTypeToCortexMType(type);
 
-    if (!isValidDWTComparatorSetting(address, size, nativeType))
+    if (!isValidDWTComparatorRange(address, size, nativeType))
         __throw(invalidArgumentException);
 
-    disableDWTWatchpoint(address, size, nativeType);
+    if (!disableMPUWatchpoint(address, size, nativeType))
+        disableDWTWatchpointRange(address, size, nativeType, mriCortexMState.dwtMaxMaskBits,
+                                  mriCortexMState.dwtUseCounts);
+}
+
+
+void Platform_SetHardwareValueWatchpoint(uint32_t address, uint32_t size, uint32_t value, PlatformWatchpointType type)
+{
+    uint32_t       nativeType = convertWatchpointTypeToCortexMType(type);
+    DWT_COMP_Type* pComparator;
+
+    if (!isValidDWTValueComparatorSetting(address, size, nativeType))
+        __throw(invalidArgumentException);
+
+    pComparator = enableDWTValueWatchpoint(address, size, value, nativeType);
+    if (!pComparator)
+        __throw(exceededHardwareResourcesException);
+}
+
+
+void Platform_ClearHardwareValueWatchpoint(uint32_t address, uint32_t size, uint32_t value, PlatformWatchpointType type)
+{
+    uint32_t nativeType = convertWatchpointTypeToCortexMType(type);
+
+    if (!isValidDWTValueComparatorSetting(address, size, nativeType))
+        __throw(invalidArgumentException);
+
+    disableDWTValueWatchpoint(address, size, value, nativeType);
+}
+
+
+/* The PC is sampled every sampleInterval CPU cycles by matching DWT comparator 0 against the cycle counter. Each match
+   generates a DebugMon exception which records the stacked PC and re-arms the comparator. Cores without a cycle
+   counter, or where comparator 0 is already being used for a watchpoint, the performance counters or variable
+   sampling, can't be profiled. */
+void Platform_StartProfiling(uint32_t sampleInterval)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS) || !enableDWTCycleCountComparator(sampleInterval))
+        __throw(exceededHardwareResourcesException);
+    mriCortexMState.cycleMatchInterval = sampleInterval;
+    mriCortexMFlags |= CORTEXM_FLAGS_PROFILING;
+}
+
+
+void Platform_StopProfiling(void)
+{
+    mriCortexMFlags &= ~CORTEXM_FLAGS_PROFILING;
+    disableDWTCycleCountComparator();
+}
+
+
+uint32_t Platform_GetCpuClockFrequency(void)
+{
+    return SystemCoreClock;
+}
+
+
+void Platform_EnableCycleCounter(void)
+{
+    if (!enableDWTCycleCounter())
+        __throw(exceededHardwareResourcesException);
+}
+
+
+uint32_t Platform_GetCycleCounter(void)
+{
+    return DWT->CYCCNT;
+}
+
+
+/* The DWT's 8-bit performance counters wrap far too quickly to only be read when gdb stops the program. Comparator 0
+   is matched against the cycle counter to force a DebugMon exception every sampleInterval cycles. Each entry into
+   mriCortexMExceptionHandler() adds the counters to the 32-bit totals kept by the core and each exit clears them
+   again so that the cycles spent in the debug monitor itself aren't counted. Profiling uses the same comparator so
+   the two can't run at the same time. */
+void Platform_StartPerfCounters(uint32_t sampleInterval)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS) || !enableDWTPerfCounters())
+        __throw(exceededHardwareResourcesException);
+    if (!enableDWTCycleCountComparator(sampleInterval))
+    {
+        disableDWTPerfCounters();
+        __throw(exceededHardwareResourcesException);
+    }
+    mriCortexMState.cycleMatchInterval = sampleInterval;
+    mriCortexMFlags |= CORTEXM_FLAGS_PERF_COUNTERS;
+}
+
+
+void Platform_StopPerfCounters(void)
+{
+    mriCortexMFlags &= ~CORTEXM_FLAGS_PERF_COUNTERS;
+    disableDWTPerfCounters();
+    disableDWTCycleCountComparator();
+}
+
+
+/* Variables are sampled every sampleInterval CPU cycles from the same comparator 0 match on the cycle counter as is
+   used by the profiler. */
+void Platform_StartSampling(uint32_t sampleInterval)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS) || !enableDWTCycleCountComparator(sampleInterval))
+        __throw(exceededHardwareResourcesException);
+    mriCortexMState.cycleMatchInterval = sampleInterval;
+    mriCortexMFlags |= CORTEXM_FLAGS_SAMPLING;
+}
+
+
+void Platform_StopSampling(void)
+{
+    mriCortexMFlags &= ~CORTEXM_FLAGS_SAMPLING;
+    disableDWTCycleCountComparator();
+}
+
+
+/* The running thread is sampled every sampleInterval CPU cycles from the same comparator 0 match on the cycle counter
+   as is used by the profiler. */
+void Platform_StartCpuLoadSampling(uint32_t sampleInterval)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS) || !enableDWTCycleCountComparator(sampleInterval))
+        __throw(exceededHardwareResourcesException);
+    mriCortexMState.cycleMatchInterval = sampleInterval;
+    mriCortexMFlags |= CORTEXM_FLAGS_CPULOAD;
+}
+
+
+void Platform_StopCpuLoadSampling(void)
+{
+    mriCortexMFlags &= ~CORTEXM_FLAGS_CPULOAD;
+    disableDWTCycleCountComparator();
+}
+
+
+/* "monitor irqstats" redirects the selected IRQs through irqShim() by relocating the vector table into the RAM
+   provided by the program through mriSetIrqVectorTable(). The relocated table starts out as a copy of the original so
+   that all of the other vectors, including the ones used by MRI itself, are left untouched. VTOR is pointed back at
+   the original table once the last IRQ has been unhooked. This state is kept outside of mriCortexMState since the
+   program is free to provide the table before calling mriInit(). */
+typedef struct
+{
+    volatile uint32_t*          pTable;
+    const volatile uint32_t*    pOriginalTable;
+    uint32_t                    vectorCount;
+    uint32_t                    hookCount;
+} CortexMIrqShim;
+
+static CortexMIrqShim g_irqShim;
+
+static int isVectorTableAligned(const void* pTable, size_t tableSize);
+void mriSetIrqVectorTable(void* pTable, size_t tableSize)
+{
+    IrqStats_Reset();
+    g_irqShim.pTable = NULL;
+    g_irqShim.vectorCount = 0;
+
+    if (pTable == NULL || !isVectorTableAligned(pTable, tableSize))
+        return;
+    g_irqShim.pTable = (volatile uint32_t*)pTable;
+    g_irqShim.vectorCount = tableSize / sizeof(uint32_t);
+}
+
+static int isVectorTableAligned(const void* pTable, size_t tableSize)
+{
+    /* VTOR requires the table to be aligned to its size rounded up to the next power of 2 with a minimum of 128. */
+    size_t alignment = 128;
+
+    while (alignment < tableSize)
+        alignment <<= 1;
+    return ((uintptr_t)pTable & (alignment - 1)) == 0;
+}
+
+
+static void relocateVectorTable(void);
+static void irqShim(void);
+void Platform_HookIrq(uint32_t irq)
+{
+    const uint32_t nvicBaseVectorOffset = 16;
+    uint32_t       vector = irq + nvicBaseVectorOffset;
+
+    if (g_irqShim.pTable == NULL)
+        __throw(notFoundException);
+    if (vector >= g_irqShim.vectorCount)
+        __throw(invalidArgumentException);
+
+    if (g_irqShim.hookCount == 0)
+        relocateVectorTable();
+    g_irqShim.pTable[vector] = (uint32_t)irqShim;
+    g_irqShim.hookCount++;
+    __DSB();
+}
+
+static void relocateVectorTable(void)
+{
+    const volatile uint32_t* pOriginalTable = (const volatile uint32_t*)SCB->VTOR;
+    uint32_t                 i;
+
+    for (i = 0 ; i < g_irqShim.vectorCount ; i++)
+        g_irqShim.pTable[i] = pOriginalTable[i];
+    g_irqShim.pOriginalTable = pOriginalTable;
+    __DSB();
+    SCB->VTOR = (uint32_t)g_irqShim.pTable;
+    __DSB();
+    __ISB();
+}
+
+/* Exception entry on Cortex-M follows the AAPCS so the original handler can be called like any other function and
+   the EXC_RETURN value in LR is preserved by the compiler generated prologue and epilogue. */
+static void irqShim(void)
+{
+    const uint32_t nvicBaseVectorOffset = 16;
+    uint32_t       vector = __get_IPSR() & 0x1FF;
+    uint32_t       irq = vector - nvicBaseVectorOffset;
+
+    IrqStats_Enter(irq);
+    ((void (*)(void))g_irqShim.pOriginalTable[vector])();
+    IrqStats_Exit(irq);
+}
+
+
+void Platform_UnhookIrq(uint32_t irq)
+{
+    const uint32_t nvicBaseVectorOffset = 16;
+    uint32_t       vector = irq + nvicBaseVectorOffset;
+
+    if (g_irqShim.hookCount == 0 || vector >= g_irqShim.vectorCount)
+        return;
+
+    g_irqShim.pTable[vector] = g_irqShim.pOriginalTable[vector];
+    if (--g_irqShim.hookCount == 0)
+        SCB->VTOR = (uint32_t)g_irqShim.pOriginalTable;
+    __DSB();
+    __ISB();
+}
+
+
+int Platform_IsIrqPending(uint32_t irq)
+{
+    return (NVIC->ISPR[irq >> 5] >> (irq & 0x1F)) & 1;
+}
+
+
+/* Watchpoints which need more DWT comparators than are free fall back to using the highest numbered MPU regions. The
+   region makes the watched memory read-only for write watchpoints or inaccessible for read/access watchpoints. The
+   resulting MemManage fault is intercepted by mriPendFaultToDebugMon() which opens up the regions and single steps
+   over the faulting access. Once that step completes, mriCortexMExceptionHandler() either reports the watchpoint to
+   GDB or silently resumes if the access was to a part of the region outside of the watched range. The regions are
+   only enabled while the program is running so that they don't interfere with GDB's own memory accesses.
+
+   NOTE: The region can't contain MRI's own state and any code running at a priority too high to debug will crash if
+         it touches the region.
+*/
+#if defined (__MPU_PRESENT) && (__MPU_PRESENT == 1U)
+
+static CortexMMPUWatchpoint* findMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type);
+static CortexMMPUWatchpoint* findFreeMPUWatchpoint(void);
+static int                   isMPUWatchpointFree(const CortexMMPUWatchpoint* pWatchpoint);
+static uint32_t              getMPUWatchpointRegionNumber(const CortexMMPUWatchpoint* pWatchpoint);
+static int                   doesMPUWatchpointOverlapDebugger(const CortexMMPUWatchpoint* pWatchpoint);
+static int                   doesMPUWatchpointOverlapRange(const CortexMMPUWatchpoint* pWatchpoint,
+                                                           const volatile void* pStart, size_t size);
+static int enableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type)
+{
+    CortexMMPUWatchpoint  watchpoint;
+    CortexMMPUWatchpoint* pFreeWatchpoint;
+
+    if (findMPUWatchpoint(address, size, type))
+        return 1;
+    pFreeWatchpoint = findFreeMPUWatchpoint();
+    if (!pFreeWatchpoint)
+        return 0;
+
+    watchpoint.address = address;
+    watchpoint.size = size;
+    watchpoint.type = type;
+    watchpoint.regionSizeBits = calculateMPURegionSizeBits(address, size);
+    watchpoint.regionAddress = calculateMPURegionBaseAddress(address, watchpoint.regionSizeBits);
+    watchpoint.regionAttributeAndSize = buildMPUWatchRegionAttributeAndSize(address, size, watchpoint.regionSizeBits,
+                                                                            type == DWT_COMP_FUNCTION_FUNCTION_DATA_WRITE);
+    if (doesMPUWatchpointOverlapDebugger(&watchpoint))
+        return 0;
+
+    /* The region itself is enabled by enableMPUWatchRegions() when the debugger resumes execution. */
+    *pFreeWatchpoint = watchpoint;
+    return 1;
+}
+
+static CortexMMPUWatchpoint* findMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type)
+{
+    CortexMMPUWatchpoint* pWatchpoint = mriCortexMState.mpuWatchpoints;
+    size_t                i;
+
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++, pWatchpoint++)
+    {
+        if (pWatchpoint->size != 0 &&
+            pWatchpoint->address == address && pWatchpoint->size == size && pWatchpoint->type == type)
+        {
+            return pWatchpoint;
+        }
+    }
+    return NULL;
+}
+
+static CortexMMPUWatchpoint* findFreeMPUWatchpoint(void)
+{
+    CortexMMPUWatchpoint* pWatchpoint = mriCortexMState.mpuWatchpoints;
+    size_t                i;
+
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++, pWatchpoint++)
+    {
+        if (isMPUWatchpointFree(pWatchpoint))
+            return pWatchpoint;
+    }
+    return NULL;
+}
+
+static int isMPUWatchpointFree(const CortexMMPUWatchpoint* pWatchpoint)
+{
+    uint32_t index = pWatchpoint - mriCortexMState.mpuWatchpoints;
+
+    if (pWatchpoint->size != 0 || index >= getMPUDataRegionCount())
+        return 0;
+
+    /* Don't steal a region which is already in use by the application. */
+    prepareToAccessMPURegion(getMPUWatchpointRegionNumber(pWatchpoint));
+    return (getMPURegionAttributeAndSize() & MPU_RASR_ENABLE) == 0;
+}
+
+static uint32_t getMPUWatchpointRegionNumber(const CortexMMPUWatchpoint* pWatchpoint)
+{
+    /* Use the highest numbered regions since they take priority over any lower numbered regions used by the
+       application. */
+    return getHighestMPUDataRegionIndex() - (pWatchpoint - mriCortexMState.mpuWatchpoints);
+}
+
+static int doesMPUWatchpointOverlapDebugger(const CortexMMPUWatchpoint* pWatchpoint)
+{
+    /* The fault and DebugMon handlers must be able to access MRI's state while the region is still enabled. */
+    return doesMPUWatchpointOverlapRange(pWatchpoint, &mriCortexMState, sizeof(mriCortexMState)) ||
+           doesMPUWatchpointOverlapRange(pWatchpoint, &mriCortexMFlags, sizeof(mriCortexMFlags)) ||
+           doesMPUWatchpointOverlapRange(pWatchpoint, mriCortexMDebuggerStack, sizeof(mriCortexMDebuggerStack));
+}
+
+static int doesMPUWatchpointOverlapRange(const CortexMMPUWatchpoint* pWatchpoint,
+                                         const volatile void* pStart, size_t size)
+{
+    uint32_t start = (uint32_t)pStart;
+    uint32_t last = start + (size - 1);
+    uint32_t regionLast = calculateMPURegionLastAddress(pWatchpoint->regionAddress, pWatchpoint->regionSizeBits);
+
+    return start <= regionLast && last >= pWatchpoint->regionAddress;
+}
+
+
+static int disableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type)
+{
+    CortexMMPUWatchpoint* pWatchpoint = findMPUWatchpoint(address, size, type);
+
+    if (!pWatchpoint)
+        return 0;
+
+    /* Regions are already disabled while in the debugger so just need to free up the entry. The MPU will be returned
+       to its original state by enableMPUWatchRegions() if this was the last one. */
+    mri_memset(pWatchpoint, 0, sizeof(*pWatchpoint));
+    return 1;
+}
+
+
+static void setMPUWatchRegionsEnabled(int enable);
+static void clearMPUWatchStepFlag(void);
+static void disableMPUWatchRegions(void)
+{
+    setMPUWatchRegionsEnabled(0);
+    clearMPUWatchStepFlag();
+}
+
+static void setMPUWatchRegionsEnabled(int enable)
+{
+    CortexMMPUWatchpoint* pWatchpoint = mriCortexMState.mpuWatchpoints;
+    size_t                i;
+
+    if ((mriCortexMFlags & CORTEXM_FLAGS_MPU_WATCH_ACTIVE) == 0)
+        return;
+
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++, pWatchpoint++)
+    {
+        if (pWatchpoint->size == 0)
+            continue;
+        prepareToAccessMPURegion(getMPUWatchpointRegionNumber(pWatchpoint));
+        setMPURegionAddress(pWatchpoint->regionAddress);
+        setMPURegionAttributeAndSize(enable ? pWatchpoint->regionAttributeAndSize : 0);
+    }
+    __DSB();
+    __ISB();
+}
+
+static void clearMPUWatchStepFlag(void)
+{
+    mriCortexMFlags &= ~CORTEXM_FLAGS_MPU_WATCH_STEP;
+}
+
+
+static int  hasMPUWatchpoints(void);
+static void activateMPUForWatchpoints(void);
+static void restoreOriginalMPUState(void);
+static void enableMPUWatchRegions(void)
+{
+    if (!hasMPUWatchpoints())
+    {
+        restoreOriginalMPUState();
+        return;
+    }
+
+    activateMPUForWatchpoints();
+    setMPUWatchRegionsEnabled(1);
+}
+
+static int hasMPUWatchpoints(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++)
+    {
+        if (mriCortexMState.mpuWatchpoints[i].size != 0)
+            return 1;
+    }
+    return 0;
+}
+
+static void activateMPUForWatchpoints(void)
+{
+    if (mriCortexMFlags & CORTEXM_FLAGS_MPU_WATCH_ACTIVE)
+        return;
+
+    /* Keep the default memory map for everything outside of the watch regions and route the faults to MemManage
+       rather than escalating them to HardFault. */
+    mriCortexMState.mpuOriginalControl = getMPUControlValue();
+    mriCortexMState.mpuOriginalShcsr = SCB->SHCSR & SCB_SHCSR_MEMFAULTENA_Msk;
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    setMPUControlValue(mriCortexMState.mpuOriginalControl | MPU_CTRL_PRIVDEFENA | MPU_CTRL_ENABLE);
+    mriCortexMFlags |= CORTEXM_FLAGS_MPU_WATCH_ACTIVE;
+}
+
+static void restoreOriginalMPUState(void)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_MPU_WATCH_ACTIVE) == 0)
+        return;
+
+    setMPUControlValue(mriCortexMState.mpuOriginalControl);
+    SCB->SHCSR = (SCB->SHCSR & ~SCB_SHCSR_MEMFAULTENA_Msk) | mriCortexMState.mpuOriginalShcsr;
+    mriCortexMFlags &= ~CORTEXM_FLAGS_MPU_WATCH_ACTIVE;
+}
+
+
+static int                   isMPUWatchRegionFault(uint32_t faultAddress);
+static PlatformTrapReason    determineMPUWatchReason(uint32_t faultAddress);
+static void                  raisePriorityForMPUWatchStep(void);
+static int stepOverMPUWatchRegionFault(void)
+{
+    static const uint32_t dataAccessFaultBits = SCB_CFSR_DACCVIOL_Msk | SCB_CFSR_MMARVALID_Msk;
+    uint32_t              faultAddress = SCB->MMFAR;
+
+    if ((SCB->CFSR & dataAccessFaultBits) != dataAccessFaultBits || !isMPUWatchRegionFault(faultAddress))
+        return 0;
+
+    /* Open up the regions so that the faulting access can complete when single stepped. A DebugMon exception will
+       follow once the step is done and completeMPUWatchStep() decides whether to report it to GDB. */
+    setMPUWatchRegionsEnabled(0);
+    SCB->CFSR = dataAccessFaultBits;
+    SCB->HFSR = SCB->HFSR & SCB_HFSR_FORCED_Msk;
+    mriCortexMState.mpuWatchReason = determineMPUWatchReason(faultAddress);
+    raisePriorityForMPUWatchStep();
+    mriCortexMFlags |= CORTEXM_FLAGS_MPU_WATCH_STEP;
+    enableSingleStep();
+    return 1;
+}
+
+static int isMPUWatchRegionFault(uint32_t faultAddress)
+{
+    CortexMMPUWatchpoint* pWatchpoint = mriCortexMState.mpuWatchpoints;
+    size_t                i;
+
+    if ((mriCortexMFlags & CORTEXM_FLAGS_MPU_WATCH_ACTIVE) == 0)
+        return 0;
+
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++, pWatchpoint++)
+    {
+        if (pWatchpoint->size != 0 &&
+            isAddressInMPURegion(faultAddress, pWatchpoint->regionAddress, pWatchpoint->regionSizeBits,
+                                 (pWatchpoint->regionAttributeAndSize & MPU_RASR_SRD_MASK) >> MPU_RASR_SRD_SHIFT))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static PlatformTrapReason determineMPUWatchReason(uint32_t faultAddress)
+{
+    PlatformTrapReason    reason = { MRI_PLATFORM_TRAP_TYPE_UNKNOWN, 0x00000000 };
+    CortexMMPUWatchpoint* pWatchpoint = mriCortexMState.mpuWatchpoints;
+    size_t                i;
+
+    /* Accesses to the parts of the region outside of the watched range are left as MRI_PLATFORM_TRAP_TYPE_UNKNOWN. */
+    for (i = 0 ; i < CORTEXM_MPU_WATCHPOINT_COUNT ; i++, pWatchpoint++)
+    {
+        if (pWatchpoint->size != 0 &&
+            faultAddress >= pWatchpoint->address && faultAddress <= pWatchpoint->address + (pWatchpoint->size - 1))
+        {
+            reason.type = convertCortexMTypeToTrapType(pWatchpoint->type);
+            reason.address = faultAddress;
+            break;
+        }
+    }
+    return reason;
+}
+
+static void raisePriorityForMPUWatchStep(void)
+{
+    /* Don't let lower priority interrupts run before the faulting instruction is stepped. */
+    uint32_t basepri = __get_BASEPRI();
+    uint32_t stepBasepri = calculateBasePriorityForThisCPU(mriCortexMGetPriority(DebugMonitor_IRQn) + 1);
+
+    mriCortexMState.mpuWatchBasepri = basepri;
+    if (stepBasepri != 0 && (basepri == 0 || basepri > stepBasepri))
+        __set_BASEPRI(stepBasepri);
+}
+
+
+static int completeMPUWatchStep(void)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_MPU_WATCH_STEP) == 0)
+        return 0;
+
+    clearMPUWatchStepFlag();
+    __set_BASEPRI(mriCortexMState.mpuWatchBasepri);
+    if (mriCortexMState.mpuWatchReason.type != MRI_PLATFORM_TRAP_TYPE_UNKNOWN || Platform_IsSingleStepping())
+    {
+        /* Let the debugger report the watchpoint (or the user's single step). The regions will be enabled again by
+           Platform_LeavingDebugger(). */
+        return 0;
+    }
+
+    /* The access was to a part of the region outside of the watched range so just close the regions again and resume. */
+    disableSingleStep();
+    SCB->DFSR = SCB_DFSR_HALTED;
+    setMPUWatchRegionsEnabled(1);
+    return 1;
+}
+
+#else
+
+static int enableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type)
+{
+    return 0;
+}
+
+static int disableMPUWatchpoint(uint32_t address, uint32_t size, uint32_t type)
+{
+    return 0;
+}
+
+static void disableMPUWatchRegions(void)
+{
+}
+
+static void enableMPUWatchRegions(void)
+{
+}
+
+static int stepOverMPUWatchRegionFault(void)
+{
+    return 0;
+}
+
+static int completeMPUWatchStep(void)
+{
+    return 0;
 }
 
+#endif /* defined (__MPU_PRESENT) && (__MPU_PRESENT == 1U) */
+
 size_t Platform_GetTargetXmlSize(void)
 {
     return sizeof(g_targetXml) - 1;
@@ -1608,6 +2472,7 @@ static void recordAndClearFaultStatusBits(uint32_t exceptionNumber);
 static void disableInterruptMaskingIfNecessary(void);
 static void treatDebugEventHardFaultAsDebugMonInterrupt(void);
 static void setPendedFromFaultBit(void);
+static int  stepOverMPUWatchRegionFault(void);
 int mriPendFaultToDebugMon(uint32_t psp, uint32_t msp, uint32_t excReturn)
 {
     /* This handler will be called from the fault handlers (Hard Fault, etc.)
@@ -1623,6 +2488,12 @@ int mriPendFaultToDebugMon(uint32_t psp, uint32_t msp, uint32_t excReturn)
     uint32_t exceptionNumber = pExceptionStack->xpsr & 0xFF;
     if (isExceptionPriorityLowEnoughToDebug(exceptionNumber))
     {
+        if (stepOverMPUWatchRegionFault())
+        {
+            /* Returns 0 to just return and let the access to the MPU watch region be single stepped. */
+            return 0;
+        }
+
         /* Pend DebugMon interrupt to debug the fault.
 
            Returns 0 to let asm routine know that it can now just return to let the pended DebugMon run.
@@ -1756,11 +2627,49 @@ __attribute__((weak)) void Platform_HandleFaultFromHighPriorityCode(void)
 
 
 
+static void accumulatePerfCountersIfNeeded(void);
+static void handleException(IntegerRegisters* pIntegerRegs, uint32_t* pFloatingRegs);
+static void restartPerfCountersIfNeeded(void);
+void mriCortexMExceptionHandler(IntegerRegisters* pIntegerRegs, uint32_t* pFloatingRegs)
+{
+    accumulatePerfCountersIfNeeded();
+    handleException(pIntegerRegs, pFloatingRegs);
+    restartPerfCountersIfNeeded();
+}
+
+static void accumulatePerfCountersIfNeeded(void)
+{
+    PerfCounters sample;
+
+    if ((mriCortexMFlags & CORTEXM_FLAGS_PERF_COUNTERS) == 0)
+        return;
+
+    sample.cycles = DWT->CYCCNT - mriCortexMState.perfClearedCycles;
+    sample.cpi = DWT->CPICNT & MRI_PERF_COUNTER_MAX;
+    sample.exception = DWT->EXCCNT & MRI_PERF_COUNTER_MAX;
+    sample.sleep = DWT->SLEEPCNT & MRI_PERF_COUNTER_MAX;
+    sample.lsu = DWT->LSUCNT & MRI_PERF_COUNTER_MAX;
+    sample.fold = DWT->FOLDCNT & MRI_PERF_COUNTER_MAX;
+    Perf_Accumulate(&sample);
+}
+
+static void restartPerfCountersIfNeeded(void)
+{
+    if ((mriCortexMFlags & CORTEXM_FLAGS_PERF_COUNTERS) == 0)
+        return;
+
+    clearDWTPerfCounters();
+    mriCortexMState.perfClearedCycles = DWT->CYCCNT;
+    armDWTCycleCountComparator(mriCortexMState.cycleMatchInterval);
+}
+
 static ExceptionStack* getExceptionStack(uint32_t excReturn, uint32_t psp, uint32_t msp);
 static int wasPendedFromFault(void);
 static int prepareThreadContext(ExceptionStack* pExceptionStack, IntegerRegisters* pIntegerRegs, uint32_t* pFloatingRegs);
 static void allocateFakeFloatRegAndCallMriDebugException(void);
-void mriCortexMExceptionHandler(IntegerRegisters* pIntegerRegs, uint32_t* pFloatingRegs)
+static int  completeMPUWatchStep(void);
+static int  handleCycleCountComparatorMatch(const ExceptionStack* pExceptionStack);
+static void handleException(IntegerRegisters* pIntegerRegs, uint32_t* pFloatingRegs)
 {
     uint32_t excReturn = pIntegerRegs->excReturn;
     uint32_t msp = pIntegerRegs->msp;
@@ -1773,9 +2682,20 @@ void mriCortexMExceptionHandler(IntegerRegisters* pIntegerRegs, uint32_t* pFloat
     if (!wasPendedFromFault())
     {
         uint32_t exceptionNumber = getCurrentlyExecutingExceptionNumber();
-        if (isExternalInterrupt(exceptionNumber) && !Platform_CommHasReceiveData())
+        if (isExternalInterrupt(exceptionNumber) && !AsyncConsole_ProcessCommInterrupt())
         {
-            /* Just return if communication channel had a pending interrupt when last debug session completed. */
+            /* Just return if the communication channel interrupt was only for background console output or was left
+               pending when the last debug session completed. */
+            return;
+        }
+        if (!isExternalInterrupt(exceptionNumber) && completeMPUWatchStep())
+        {
+            /* Just return if the single stepped access to a MPU watch region was outside of the watched range. */
+            return;
+        }
+        if (!isExternalInterrupt(exceptionNumber) && handleCycleCountComparatorMatch(pExceptionStack))
+        {
+            /* Just return if the DebugMon exception was only for taking a profile, perf counter, variable or CPU load sample. */
             return;
         }
 
@@ -1833,6 +2753,60 @@ void mriCortexMExceptionHandler(IntegerRegisters* pIntegerRegs, uint32_t* pFloat
     }
 }
 
+static void takeVariableSample(void);
+static void cacheOtherMatchedDWTComparators(void);
+static int handleCycleCountComparatorMatch(const ExceptionStack* pExceptionStack)
+{
+    uint32_t dfsr = SCB->DFSR;
+
+    if ((mriCortexMFlags & CORTEXM_FLAGS_CYCLE_MATCH_USERS) == 0 ||
+        (dfsr & SCB_DFSR_DWTTRAP) == 0 ||
+        (getDWTCycleCountComparator()->FUNCTION & DWT_COMP_FUNCTION_MATCHED) == 0)
+    {
+        return 0;
+    }
+
+    /* The performance counters were already accumulated on the way into mriCortexMExceptionHandler(). */
+    if (mriCortexMFlags & CORTEXM_FLAGS_PROFILING)
+        Profile_RecordSample(pExceptionStack->pc);
+    if (mriCortexMFlags & CORTEXM_FLAGS_SAMPLING)
+        takeVariableSample();
+    if (mriCortexMFlags & CORTEXM_FLAGS_CPULOAD)
+        CpuLoad_RecordSample((pExceptionStack->xpsr & 0xFF) != 0);
+    armDWTCycleCountComparator(mriCortexMState.cycleMatchInterval);
+
+    /* Reading the other comparators clears their MATCHED bits so remember them for findMatchedWatchpoint(). */
+    cacheOtherMatchedDWTComparators();
+    if (mriCortexMState.dwtMatchedMask != 0 || (dfsr & ~SCB_DFSR_DWTTRAP) != 0)
+        return 0;
+
+    SCB->DFSR = SCB_DFSR_DWTTRAP;
+    return 1;
+}
+
+static void takeVariableSample(void)
+{
+    /* Faults on reads of the sampled variables are only caught by mriFaultHandler while the debugger is active. */
+    clearMemoryFaultFlag();
+    setActiveDebugFlag();
+    Sampler_ProcessTick();
+    clearActiveDebugFlag();
+}
+
+static void cacheOtherMatchedDWTComparators(void)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY + 1;
+    uint32_t       comparatorCount = getDWTComparatorCount();
+    uint32_t       i;
+
+    for (i = 1 ; i < comparatorCount ; i++)
+    {
+        if (pCurrentComparator->FUNCTION & DWT_COMP_FUNCTION_MATCHED)
+            mriCortexMState.dwtMatchedMask |= 1 << i;
+        pCurrentComparator++;
+    }
+}
+
 static int wasPendedFromFault(void)
 {
     return mriCortexMFlags & CORTEXM_FLAGS_PEND_FROM_FAULT;
@@ -39,18 +39,29 @@
 #define CORTEXM_FLAGS_CTRL_C                (1 << 5)
 #define CORTEXM_FLAGS_NO_DEBUG_STACK        (1 << 6)
 #define CORTEXM_FLAGS_PEND_FROM_FAULT       (1 << 7)
+#define CORTEXM_FLAGS_MPU_WATCH_ACTIVE      (1 << 8)
+#define CORTEXM_FLAGS_MPU_WATCH_STEP        (1 << 9)
+#define CORTEXM_FLAGS_PROFILING             (1 << 10)
+#define CORTEXM_FLAGS_PERF_COUNTERS         (1 << 11)
+#define CORTEXM_FLAGS_SAMPLING              (1 << 12)
+#define CORTEXM_FLAGS_CPULOAD               (1 << 13)
+
+/* Features which share DWT comparator 0 to generate a DebugMon exception every so many CPU cycles. */
+#define CORTEXM_FLAGS_CYCLE_MATCH_USERS     (CORTEXM_FLAGS_PROFILING | CORTEXM_FLAGS_PERF_COUNTERS | \
+                                             CORTEXM_FLAGS_SAMPLING | CORTEXM_FLAGS_CPULOAD)
 
 /* Special memory area used by the debugger for its stack so that it doesn't interfere with the task's
    stack contents.
 
    The stack sizes below are based on actual test runs on LPC1768 (non-FPU) and LPC4330 (FPU) based boards with a
-   roughly 25% reservation for future growth.
+   roughly 25% reservation for future growth. Another 16 entries were added for the deeper calls made by the stack
+   unwinder.
 */
 #define CORTEXM_DEBUGGER_STACK_FILL            0xDEADBEEF
 #if MRI_DEVICE_HAS_FPU
-    #define CORTEXM_DEBUGGER_STACK_SIZE        113
+    #define CORTEXM_DEBUGGER_STACK_SIZE        129
 #else
-    #define CORTEXM_DEBUGGER_STACK_SIZE        58
+    #define CORTEXM_DEBUGGER_STACK_SIZE        74
 #endif
 
 
@@ -91,10 +102,38 @@
     #define CONTEXT_SIZE    (17 + SPECIAL_REGISTER_COUNT)
 #endif
 
-/* NOTE: The largest buffer is required for receiving the 'G' command which receives the contents of the registers from
+/* NOTE: The buffer must be large enough for receiving the 'G' command which receives the contents of the registers from
    the debugger as two hex digits per byte.  Also need a character for the 'G' command itself and another 4 for the '$',
-   '#', and 2-byte checksum. */
-#define CORTEXM_PACKET_BUFFER_SIZE  (1 + 2 * sizeof(uint32_t) * CONTEXT_SIZE + 4)
+   '#', and 2-byte checksum. Without the FPU registers, the qSupported response advertising every optional feature is
+   larger still. */
+#define CORTEXM_G_PACKET_BUFFER_SIZE    (1 + 2 * sizeof(uint32_t) * CONTEXT_SIZE + 4)
+#define CORTEXM_MIN_PACKET_BUFFER_SIZE  (CORTEXM_G_PACKET_BUFFER_SIZE > MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE ? \
+                                         CORTEXM_G_PACKET_BUFFER_SIZE : MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE)
+
+/* gdb sizes its memory transfers, including those for semihost reads and writes, to the packet size so programs which
+   move a lot of data through mriHostWrite()/mriHostRead() can define MRI_PACKET_BUFFER_SIZE to trade RAM for fewer
+   round trips. Values smaller than CORTEXM_MIN_PACKET_BUFFER_SIZE are ignored. */
+#ifndef MRI_PACKET_BUFFER_SIZE
+    #define MRI_PACKET_BUFFER_SIZE  0
+#endif
+#define CORTEXM_PACKET_BUFFER_SIZE  (MRI_PACKET_BUFFER_SIZE > CORTEXM_MIN_PACKET_BUFFER_SIZE ? \
+                                     MRI_PACKET_BUFFER_SIZE : CORTEXM_MIN_PACKET_BUFFER_SIZE)
+
+/* The DWT's NUMCOMP field is 4 bits wide so there can be at most 15 comparators. */
+#define CORTEXM_DWT_COMPARATOR_MAX      15
+
+/* Maximum number of watchpoints which can fall back to using MPU regions once the DWT comparators are exhausted. */
+#define CORTEXM_MPU_WATCHPOINT_COUNT    2
+
+typedef struct
+{
+    uint32_t    address;
+    uint32_t    size;
+    uint32_t    type;
+    uint32_t    regionAddress;
+    uint32_t    regionAttributeAndSize;
+    uint32_t    regionSizeBits;
+} CortexMMPUWatchpoint;
 
 typedef struct
 {
@@ -112,6 +151,16 @@ typedef struct
     uint32_t            basepri;
     uint32_t            primask;
     uint32_t            priorityBitShift;
+    uint32_t            dwtMaxMaskBits;
+    uint8_t             dwtUseCounts[CORTEXM_DWT_COMPARATOR_MAX];
+    CortexMMPUWatchpoint mpuWatchpoints[CORTEXM_MPU_WATCHPOINT_COUNT];
+    PlatformTrapReason  mpuWatchReason;
+    uint32_t            mpuWatchBasepri;
+    uint32_t            mpuOriginalControl;
+    uint32_t            mpuOriginalShcsr;
+    uint32_t            cycleMatchInterval;
+    uint32_t            perfClearedCycles;
+    uint32_t            dwtMatchedMask;
     int                 maxStackUsed;
     char                packetBuffer[CORTEXM_PACKET_BUFFER_SIZE];
 } CortexMState;
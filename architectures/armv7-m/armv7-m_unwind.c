@@ -0,0 +1,405 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Stack unwinder for Cortex-M which walks the ARM EHABI unwind tables (.ARM.exidx and .ARM.extab) on the target. */
+#include <core/platforms.h>
+#include <core/context.h>
+#include "armv7-m.h"
+
+
+/* Bounds of the .ARM.exidx section as defined by the standard GNU linker scripts. They are weak so that programs
+   linked without them, or built without unwind tables, still link and just get shorter backtraces. */
+extern const uint32_t __exidx_start[] __attribute__((weak));
+extern const uint32_t __exidx_end[] __attribute__((weak));
+
+#define EXIDX_CANTUNWIND        1
+#define EXC_RETURN_MASK         0xFFFFFF00
+#define EXC_RETURN_PSP_BIT      (1 << 2)
+#define EXC_RETURN_BASIC_BIT    (1 << 4)
+#define XPSR_STACK_ALIGN_BIT    (1 << 9)
+
+typedef struct
+{
+    uint32_t registers[16];
+    uint32_t psp;
+} UnwindState;
+
+/* Unwind instructions are packed a byte at a time into words, starting with the most significant byte. */
+typedef struct
+{
+    const uint32_t* pNextWord;
+    uint32_t        wordsLeft;
+    uint32_t        currentWord;
+    int             bytesLeft;
+} InstructionReader;
+
+/* Kept off of the stack since the unwinder runs on MRI's small debugger stack. */
+static UnwindState g_unwindState;
+
+
+/* Fills pFrames with the program counter followed by the return address of each caller found on the stack. Unwinding
+   stops at the first function marked as not unwindable, at the first one that has no unwind table entry (other than
+   the top frame, which uses LR instead so that leaf functions written in assembly language still show their caller),
+   or when the stack can't be read. Returns the number of frames filled in. */
+static void initState(UnwindState* pState, MriContext* pContext);
+static int  unwindFrame(UnwindState* pState, int isTopFrame);
+size_t Platform_UnwindStack(MriContext* pContext, uint32_t* pFrames, size_t maxFrames)
+{
+    UnwindState* pState = &g_unwindState;
+    size_t       frameCount = 0;
+
+    initState(pState, pContext);
+    while (frameCount < maxFrames)
+    {
+        pFrames[frameCount] = pState->registers[PC];
+        frameCount++;
+        if (!unwindFrame(pState, frameCount == 1))
+            break;
+    }
+    return frameCount;
+}
+
+static void initState(UnwindState* pState, MriContext* pContext)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(pState->registers)/sizeof(pState->registers[0]) ; i++)
+        pState->registers[i] = Context_Get(pContext, i);
+    /* RTOS thread contexts might only contain the core registers. */
+    pState->psp = Context_Count(pContext) > PSP ? Context_Get(pContext, PSP) : 0;
+}
+
+static const uint32_t* findIndexEntry(uint32_t address);
+static int             initInstructionReader(InstructionReader* pReader, const uint32_t* pEntry);
+static int             executeInstructions(UnwindState* pState, InstructionReader* pReader);
+static int             isExceptionReturn(uint32_t address);
+static int             unwindExceptionFrame(UnwindState* pState, uint32_t excReturn);
+static int unwindFrame(UnwindState* pState, int isTopFrame)
+{
+    const uint32_t*   pEntry = findIndexEntry(pState->registers[PC]);
+    InstructionReader reader;
+    uint32_t          prevPC = pState->registers[PC];
+    uint32_t          prevSP = pState->registers[SP];
+
+    if (pEntry)
+    {
+        if (!initInstructionReader(&reader, pEntry) || !executeInstructions(pState, &reader))
+            return 0;
+    }
+    else
+    {
+        if (!isTopFrame)
+            return 0;
+        pState->registers[PC] = pState->registers[LR];
+    }
+
+    if (isExceptionReturn(pState->registers[PC]))
+    {
+        /* The interrupted code might have been running on the other stack so skip the stack direction check. */
+        if (!unwindExceptionFrame(pState, pState->registers[PC]))
+            return 0;
+        prevSP = 0;
+    }
+    pState->registers[PC] &= ~1;
+
+    /* The stack only grows down so a caller's frame can't be below that of the function it called. */
+    if (pState->registers[PC] == 0 || pState->registers[SP] < prevSP)
+        return 0;
+    if (pState->registers[PC] == prevPC && pState->registers[SP] == prevSP)
+        return 0;
+    return 1;
+}
+
+static uint32_t prel31ToAddress(const uint32_t* pWord);
+static const uint32_t* findIndexEntry(uint32_t address)
+{
+    const uint32_t* pFirst = __exidx_start;
+    const uint32_t* pEnd = __exidx_end;
+    size_t          entryCount;
+    size_t          low = 0;
+    size_t          high;
+
+    if (pFirst == NULL || pEnd == NULL || pEnd <= pFirst)
+        return NULL;
+    entryCount = (pEnd - pFirst) / 2;
+
+    /* Each entry is a pair of words, the first giving the address of the function which it covers. Entries are sorted
+       by this address so search for the last one which starts at or before the desired address. */
+    if (address < prel31ToAddress(&pFirst[0]))
+        return NULL;
+    high = entryCount;
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (prel31ToAddress(&pFirst[middle * 2]) <= address)
+            low = middle;
+        else
+            high = middle;
+    }
+    return &pFirst[low * 2];
+}
+
+static uint32_t prel31ToAddress(const uint32_t* pWord)
+{
+    int32_t offset = (int32_t)(*pWord << 1) >> 1;
+
+    return (uint32_t)pWord + offset;
+}
+
+static int initInstructionReader(InstructionReader* pReader, const uint32_t* pEntry)
+{
+    uint32_t        data = pEntry[1];
+    const uint32_t* pTable;
+
+    if (data == EXIDX_CANTUNWIND)
+        return 0;
+
+    /* The three unwind instructions of the compact Su16 format are stored inline in the index entry itself. */
+    if (data & 0x80000000)
+    {
+        if ((data & 0x0F000000) != 0)
+            return 0;
+        pReader->currentWord = data;
+        pReader->bytesLeft = 3;
+        pReader->pNextWord = NULL;
+        pReader->wordsLeft = 0;
+        return 1;
+    }
+
+    pTable = (const uint32_t*)prel31ToAddress(&pEntry[1]);
+    if (pTable[0] & 0x80000000)
+    {
+        /* Compact model in .ARM.extab: Su16 has 3 instructions, Lu16 and Lu32 have 2 plus a count of extra words. */
+        uint32_t personality = (pTable[0] >> 24) & 0x0F;
+
+        pReader->currentWord = pTable[0];
+        pReader->pNextWord = &pTable[1];
+        if (personality == 0)
+        {
+            pReader->bytesLeft = 3;
+            pReader->wordsLeft = 0;
+        }
+        else if (personality == 1 || personality == 2)
+        {
+            pReader->bytesLeft = 2;
+            pReader->wordsLeft = (pTable[0] >> 16) & 0xFF;
+        }
+        else
+        {
+            return 0;
+        }
+        return 1;
+    }
+
+    /* Generic model, as used by GCC for C++ functions with exception handlers. The personality routine's address is
+       followed by the unwind instructions in the same layout as the Lu16 compact model but with 3 in the first word. */
+    pReader->currentWord = pTable[1];
+    pReader->bytesLeft = 3;
+    pReader->pNextWord = &pTable[2];
+    pReader->wordsLeft = pTable[1] >> 24;
+    return 1;
+}
+
+static int nextInstructionByte(InstructionReader* pReader, uint8_t* pByte);
+static int popRegisters(UnwindState* pState, uint32_t registerMask);
+static int executeInstructions(UnwindState* pState, InstructionReader* pReader)
+{
+    uint32_t* pSP = &pState->registers[SP];
+    int       wasPCPopped = 0;
+
+    for (;;)
+    {
+        uint8_t instruction;
+        uint8_t operand;
+
+        /* Running out of instructions is the same as an explicit finish. */
+        if (!nextInstructionByte(pReader, &instruction))
+            instruction = 0xB0;
+
+        if ((instruction & 0xC0) == 0x00)
+        {
+            *pSP += ((instruction & 0x3F) << 2) + 4;
+        }
+        else if ((instruction & 0xC0) == 0x40)
+        {
+            *pSP -= ((instruction & 0x3F) << 2) + 4;
+        }
+        else if ((instruction & 0xF0) == 0x80)
+        {
+            uint32_t registerMask;
+
+            if (!nextInstructionByte(pReader, &operand))
+                return 0;
+            registerMask = (((instruction & 0x0F) << 8) | operand) << 4;
+            /* A mask of 0 means that the function refuses to be unwound. */
+            if (registerMask == 0 || !popRegisters(pState, registerMask))
+                return 0;
+            if (registerMask & (1 << PC))
+                wasPCPopped = 1;
+        }
+        else if ((instruction & 0xF0) == 0x90)
+        {
+            uint32_t registerIndex = instruction & 0x0F;
+
+            if (registerIndex == SP || registerIndex == PC)
+                return 0;
+            *pSP = pState->registers[registerIndex];
+        }
+        else if ((instruction & 0xF0) == 0xA0)
+        {
+            uint32_t registerMask = ((1 << ((instruction & 0x07) + 1)) - 1) << 4;
+
+            if (instruction & 0x08)
+                registerMask |= 1 << LR;
+            if (!popRegisters(pState, registerMask))
+                return 0;
+        }
+        else if (instruction == 0xB0)
+        {
+            break;
+        }
+        else if (instruction == 0xB1)
+        {
+            if (!nextInstructionByte(pReader, &operand) || operand == 0 || (operand & 0xF0) != 0)
+                return 0;
+            if (!popRegisters(pState, operand))
+                return 0;
+        }
+        else if (instruction == 0xB2)
+        {
+            uint32_t value = 0;
+            uint32_t shift = 0;
+
+            do
+            {
+                if (!nextInstructionByte(pReader, &operand) || shift > 28)
+                    return 0;
+                value |= (uint32_t)(operand & 0x7F) << shift;
+                shift += 7;
+            } while (operand & 0x80);
+            *pSP += 0x204 + (value << 2);
+        }
+        else if (instruction == 0xB3)
+        {
+            /* FSTMFDX saved VFP registers have an extra pad word. */
+            if (!nextInstructionByte(pReader, &operand))
+                return 0;
+            *pSP += ((operand & 0x0F) + 1) * 8 + 4;
+        }
+        else if ((instruction & 0xF8) == 0xB8)
+        {
+            *pSP += ((instruction & 0x07) + 1) * 8 + 4;
+        }
+        else if (instruction == 0xC8 || instruction == 0xC9)
+        {
+            if (!nextInstructionByte(pReader, &operand))
+                return 0;
+            *pSP += ((operand & 0x0F) + 1) * 8;
+        }
+        else if ((instruction & 0xF8) == 0xD0)
+        {
+            *pSP += ((instruction & 0x07) + 1) * 8;
+        }
+        else
+        {
+            /* Spare encodings and the iWMMXt instructions which can't be found on a Cortex-M. */
+            return 0;
+        }
+    }
+
+    if (!wasPCPopped)
+        pState->registers[PC] = pState->registers[LR];
+    return 1;
+}
+
+static int nextInstructionByte(InstructionReader* pReader, uint8_t* pByte)
+{
+    if (pReader->bytesLeft == 0)
+    {
+        if (pReader->wordsLeft == 0)
+            return 0;
+        pReader->currentWord = *pReader->pNextWord++;
+        pReader->wordsLeft--;
+        pReader->bytesLeft = 4;
+    }
+    pReader->bytesLeft--;
+    *pByte = pReader->currentWord >> (pReader->bytesLeft * 8);
+    return 1;
+}
+
+static int readStackWord(uint32_t address, uint32_t* pValue);
+static int popRegisters(UnwindState* pState, uint32_t registerMask)
+{
+    uint32_t address = pState->registers[SP];
+    uint32_t newSP = 0;
+    int      i;
+
+    for (i = 0 ; i < 16 ; i++)
+    {
+        uint32_t value;
+
+        if ((registerMask & (1 << i)) == 0)
+            continue;
+        if (!readStackWord(address, &value))
+            return 0;
+        if (i == SP)
+            newSP = value;
+        else
+            pState->registers[i] = value;
+        address += sizeof(uint32_t);
+    }
+    pState->registers[SP] = (registerMask & (1 << SP)) ? newSP : address;
+    return 1;
+}
+
+/* The stack is likely to be corrupt after a fault so every read from it is checked. */
+static int readStackWord(uint32_t address, uint32_t* pValue)
+{
+    if (address & 3)
+        return 0;
+    *pValue = Platform_MemRead32(address);
+    return !Platform_WasMemoryFaultEncountered();
+}
+
+static int isExceptionReturn(uint32_t address)
+{
+    return (address & EXC_RETURN_MASK) == EXC_RETURN_MASK;
+}
+
+/* Continues from a handler into the code that it interrupted by using the exception frame which the processor
+   stacked on entry: R0-R3, R12, LR, PC, and xPSR, followed by the FPU registers if EXC_RETURN indicates that they were
+   stacked too. */
+static int unwindExceptionFrame(UnwindState* pState, uint32_t excReturn)
+{
+    static const int stackedRegisters[] = { R0, R1, R2, R3, 12, LR, PC };
+    uint32_t         frameAddress = (excReturn & EXC_RETURN_PSP_BIT) ? pState->psp : pState->registers[SP];
+    uint32_t         frameSize = (excReturn & EXC_RETURN_BASIC_BIT) ? 8 * sizeof(uint32_t) : 26 * sizeof(uint32_t);
+    uint32_t         xpsr;
+    size_t           i;
+
+    if (frameAddress == 0)
+        return 0;
+    for (i = 0 ; i < sizeof(stackedRegisters)/sizeof(stackedRegisters[0]) ; i++)
+    {
+        if (!readStackWord(frameAddress + i * sizeof(uint32_t), &pState->registers[stackedRegisters[i]]))
+            return 0;
+    }
+    if (!readStackWord(frameAddress + 7 * sizeof(uint32_t), &xpsr))
+        return 0;
+    if (xpsr & XPSR_STACK_ALIGN_BIT)
+        frameSize += sizeof(uint32_t);
+    pState->registers[SP] = frameAddress + frameSize;
+    return 1;
+}
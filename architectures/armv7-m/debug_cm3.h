@@ -274,9 +274,46 @@ static __INLINE DWT_COMP_Type* findDWTComparator(uint32_t watchpointAddress,
     return NULL;
 }
 
+static __INLINE uint32_t getDWTComparatorIndex(const DWT_COMP_Type* pComparator)
+{
+    return pComparator - DWT_COMP_ARRAY;
+}
+
+static __INLINE uint32_t getDWTLinkedAddressIndex(const DWT_COMP_Type* pComparator)
+{
+    return (pComparator->FUNCTION & DWT_COMP_FUNCTION_DATAVADDR0) >> 12;
+}
+
+static __INLINE int isDWTValueComparator(const DWT_COMP_Type* pComparator)
+{
+    return (pComparator->FUNCTION & DWT_COMP_FUNCTION_DATAVMATCH) &&
+           (pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK) != DWT_COMP_FUNCTION_FUNCTION_DISABLED;
+}
+
+static __INLINE int isDWTComparatorLinkedToValueComparator(const DWT_COMP_Type* pComparator)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY;
+    uint32_t       comparatorCount;
+    uint32_t       i;
+
+    comparatorCount = getDWTComparatorCount();
+    for (i = 0 ; i < comparatorCount ; i++)
+    {
+        if (isDWTValueComparator(pCurrentComparator) &&
+            getDWTLinkedAddressIndex(pCurrentComparator) == getDWTComparatorIndex(pComparator))
+        {
+            return 1;
+        }
+        pCurrentComparator++;
+    }
+    return 0;
+}
+
 static __INLINE int isDWTComparatorFree(DWT_COMP_Type* pComparator)
 {
-    return (pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK) == DWT_COMP_FUNCTION_FUNCTION_DISABLED;
+    /* The address comparator linked to a data value comparator is left disabled but is still in use. */
+    return (pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK) == DWT_COMP_FUNCTION_FUNCTION_DISABLED &&
+           !isDWTComparatorLinkedToValueComparator(pComparator);
 }
 
 static __INLINE DWT_COMP_Type* findFreeDWTComparator(void)
@@ -408,6 +445,407 @@ static __INLINE DWT_COMP_Type* disableDWTWatchpoint(uint32_t watchpointAddress,
 }
 
 
+/* Watchpoints over ranges which aren't a naturally aligned power of 2 in size are split into the fewest naturally
+   aligned power of 2 sized regions which exactly cover the range, with one DWT comparator used for each region. The
+   split depends on the largest mask supported by the comparators which is determined once at init with
+   calculateDWTMaxMaskBits(). Overlapping ranges can share a region's comparator so pUseCounts tracks how many ranges
+   use each comparator and it is only cleared once the last of them is removed. */
+static __INLINE uint32_t calculateDWTMaxMaskBits(void)
+{
+    DWT_COMP_Type* pComparator = DWT_COMP_ARRAY;
+    uint32_t       maxMaskBits;
+
+    if (getDWTComparatorCount() == 0)
+        return 0;
+
+    /* Unsupported upper bits of MASK read back as zero. Only called when all comparators are free. */
+    pComparator->MASK = 31;
+    maxMaskBits = pComparator->MASK;
+    pComparator->MASK = 0;
+
+    return maxMaskBits;
+}
+
+static __INLINE int isValidDWTComparatorRange(uint32_t watchpointAddress,
+                                              uint32_t watchpointSize,
+                                              uint32_t watchpointType)
+{
+    return watchpointSize != 0 &&
+           watchpointAddress + (watchpointSize - 1) >= watchpointAddress &&
+           isValidDWTComparatorType(watchpointType);
+}
+
+static __INLINE uint32_t calculateDWTRegionSize(uint32_t address, uint32_t sizeLeft, uint32_t maxMaskBits)
+{
+    uint32_t regionSize = (uint32_t)1 << maxMaskBits;
+
+    while (regionSize > sizeLeft || !isAddressAlignedToSize(address, regionSize))
+        regionSize >>= 1;
+
+    return regionSize;
+}
+
+static __INLINE uint32_t countFreeDWTComparators(void)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY;
+    uint32_t       comparatorCount;
+    uint32_t       freeCount = 0;
+    uint32_t       i;
+
+    comparatorCount = getDWTComparatorCount();
+    for (i = 0 ; i < comparatorCount ; i++)
+    {
+        if (isDWTComparatorFree(pCurrentComparator))
+            freeCount++;
+        pCurrentComparator++;
+    }
+
+    return freeCount;
+}
+
+static __INLINE uint32_t countMissingDWTRegions(uint32_t watchpointAddress,
+                                                uint32_t watchpointSize,
+                                                uint32_t watchpointType,
+                                                uint32_t maxMaskBits)
+{
+    uint32_t missingCount = 0;
+
+    while (watchpointSize > 0)
+    {
+        uint32_t regionSize = calculateDWTRegionSize(watchpointAddress, watchpointSize, maxMaskBits);
+
+        if (!findDWTComparator(watchpointAddress, regionSize, watchpointType))
+            missingCount++;
+        watchpointAddress += regionSize;
+        watchpointSize -= regionSize;
+    }
+
+    return missingCount;
+}
+
+static __INLINE int enableDWTWatchpointRange(uint32_t watchpointAddress,
+                                             uint32_t watchpointSize,
+                                             uint32_t watchpointType,
+                                             uint32_t maxMaskBits,
+                                             uint8_t* pUseCounts)
+{
+    /* Make sure that there are enough free comparators for the whole range before touching any of them. */
+    if (countMissingDWTRegions(watchpointAddress, watchpointSize, watchpointType, maxMaskBits) >
+        countFreeDWTComparators())
+    {
+        return 0;
+    }
+
+    while (watchpointSize > 0)
+    {
+        uint32_t regionSize = calculateDWTRegionSize(watchpointAddress, watchpointSize, maxMaskBits);
+
+        DWT_COMP_Type* pComparator;
+
+        pComparator = enableDWTWatchpoint(watchpointAddress, regionSize, watchpointType);
+        if (!pComparator)
+            return 0;
+        pUseCounts[getDWTComparatorIndex(pComparator)]++;
+        watchpointAddress += regionSize;
+        watchpointSize -= regionSize;
+    }
+
+    return 1;
+}
+
+static __INLINE void disableDWTWatchpointRange(uint32_t watchpointAddress,
+                                               uint32_t watchpointSize,
+                                               uint32_t watchpointType,
+                                               uint32_t maxMaskBits,
+                                               uint8_t* pUseCounts)
+{
+    while (watchpointSize > 0)
+    {
+        uint32_t       regionSize = calculateDWTRegionSize(watchpointAddress, watchpointSize, maxMaskBits);
+        DWT_COMP_Type* pComparator;
+
+        pComparator = findDWTComparator(watchpointAddress, regionSize, watchpointType);
+        if (pComparator)
+        {
+            uint32_t index = getDWTComparatorIndex(pComparator);
+
+            if (pUseCounts[index] > 0)
+                pUseCounts[index]--;
+            if (pUseCounts[index] == 0)
+                clearDWTComparator(pComparator);
+        }
+        watchpointAddress += regionSize;
+        watchpointSize -= regionSize;
+    }
+}
+
+
+/* Data value watchpoints use a pair of comparators. The value comparator holds the value to be matched and links
+   to a disabled address comparator which holds the address to be monitored. Only some comparators (typically
+   just comparator 1 on the Cortex-M3/M4) support data value matching. */
+static __INLINE int isValidDWTValueComparatorSetting(uint32_t watchpointAddress,
+                                                     uint32_t watchpointSize,
+                                                     uint32_t watchpointType)
+{
+    return (watchpointSize == 1 || watchpointSize == 2 || watchpointSize == 4) &&
+           isValidDWTComparatorAddress(watchpointAddress, watchpointSize) &&
+           isValidDWTComparatorType(watchpointType);
+}
+
+static __INLINE uint32_t calculateDWTValueSizeBits(uint32_t watchpointSize)
+{
+    switch (watchpointSize)
+    {
+    case 1:
+        return DWT_COMP_FUNCTION_DATAVSIZE_BYTE;
+    case 2:
+        return DWT_COMP_FUNCTION_DATAVSIZE_HALFWORD;
+    default:
+        return DWT_COMP_FUNCTION_DATAVSIZE_WORD;
+    }
+}
+
+static __INLINE uint32_t replicateDWTValue(uint32_t value, uint32_t watchpointSize)
+{
+    /* Byte and halfword values must be replicated across the whole comparator. */
+    switch (watchpointSize)
+    {
+    case 1:
+        value &= 0xFF;
+        return value | (value << 8) | (value << 16) | (value << 24);
+    case 2:
+        value &= 0xFFFF;
+        return value | (value << 16);
+    default:
+        return value;
+    }
+}
+
+static __INLINE uint32_t buildDWTValueFunction(uint32_t addressIndex, uint32_t watchpointSize, uint32_t watchpointType)
+{
+    return (addressIndex << 16) | (addressIndex << 12) |
+           calculateDWTValueSizeBits(watchpointSize) |
+           DWT_COMP_FUNCTION_DATAVMATCH |
+           watchpointType;
+}
+
+static __INLINE DWT_COMP_Type* findDWTValueComparator(uint32_t watchpointAddress,
+                                                      uint32_t watchpointSize,
+                                                      uint32_t watchpointValue,
+                                                      uint32_t watchpointType)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY;
+    uint32_t       comparatorCount;
+    uint32_t       i;
+
+    comparatorCount = getDWTComparatorCount();
+    for (i = 0 ; i < comparatorCount ; i++)
+    {
+        if (isDWTValueComparator(pCurrentComparator))
+        {
+            uint32_t       addressIndex = getDWTLinkedAddressIndex(pCurrentComparator);
+            DWT_COMP_Type* pAddressComparator = &DWT_COMP_ARRAY[addressIndex];
+
+            if (maskOffDWTFunctionBits(pCurrentComparator->FUNCTION) ==
+                    buildDWTValueFunction(addressIndex, watchpointSize, watchpointType) &&
+                pCurrentComparator->COMP == replicateDWTValue(watchpointValue, watchpointSize) &&
+                pAddressComparator->COMP == watchpointAddress)
+            {
+                return pCurrentComparator;
+            }
+        }
+        pCurrentComparator++;
+    }
+
+    return NULL;
+}
+
+static __INLINE int doesDWTComparatorSupportValueMatch(DWT_COMP_Type* pComparator)
+{
+    int supported;
+
+    /* DATAVMATCH is read-only as zero on comparators which don't support data value matching. */
+    pComparator->FUNCTION = DWT_COMP_FUNCTION_DATAVMATCH;
+    supported = (pComparator->FUNCTION & DWT_COMP_FUNCTION_DATAVMATCH) != 0;
+    pComparator->FUNCTION = DWT_COMP_FUNCTION_FUNCTION_DISABLED;
+
+    return supported;
+}
+
+static __INLINE DWT_COMP_Type* findFreeDWTValueComparator(void)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY;
+    uint32_t       comparatorCount;
+    uint32_t       i;
+
+    comparatorCount = getDWTComparatorCount();
+    for (i = 0 ; i < comparatorCount ; i++)
+    {
+        if (isDWTComparatorFree(pCurrentComparator) && doesDWTComparatorSupportValueMatch(pCurrentComparator))
+            return pCurrentComparator;
+        pCurrentComparator++;
+    }
+
+    return NULL;
+}
+
+static __INLINE DWT_COMP_Type* findFreeDWTComparatorExcept(DWT_COMP_Type* pExclude)
+{
+    DWT_COMP_Type* pCurrentComparator = DWT_COMP_ARRAY;
+    uint32_t       comparatorCount;
+    uint32_t       i;
+
+    comparatorCount = getDWTComparatorCount();
+    for (i = 0 ; i < comparatorCount ; i++)
+    {
+        if (pCurrentComparator != pExclude && isDWTComparatorFree(pCurrentComparator))
+            return pCurrentComparator;
+        pCurrentComparator++;
+    }
+
+    return NULL;
+}
+
+static __INLINE DWT_COMP_Type* enableDWTValueWatchpoint(uint32_t watchpointAddress,
+                                                        uint32_t watchpointSize,
+                                                        uint32_t watchpointValue,
+                                                        uint32_t watchpointType)
+{
+    DWT_COMP_Type* pValueComparator;
+    DWT_COMP_Type* pAddressComparator;
+
+    pValueComparator = findDWTValueComparator(watchpointAddress, watchpointSize, watchpointValue, watchpointType);
+    if (pValueComparator)
+        return pValueComparator;
+
+    pValueComparator = findFreeDWTValueComparator();
+    if (!pValueComparator)
+        return NULL;
+    pAddressComparator = findFreeDWTComparatorExcept(pValueComparator);
+    if (!pAddressComparator)
+        return NULL;
+
+    pAddressComparator->COMP = watchpointAddress;
+    pAddressComparator->MASK = 0;
+    pAddressComparator->FUNCTION = DWT_COMP_FUNCTION_FUNCTION_DISABLED;
+    pValueComparator->COMP = replicateDWTValue(watchpointValue, watchpointSize);
+    pValueComparator->MASK = 0;
+    pValueComparator->FUNCTION = buildDWTValueFunction(getDWTComparatorIndex(pAddressComparator),
+                                                       watchpointSize,
+                                                       watchpointType);
+
+    return pValueComparator;
+}
+
+static __INLINE DWT_COMP_Type* disableDWTValueWatchpoint(uint32_t watchpointAddress,
+                                                         uint32_t watchpointSize,
+                                                         uint32_t watchpointValue,
+                                                         uint32_t watchpointType)
+{
+    DWT_COMP_Type* pValueComparator;
+    DWT_COMP_Type* pAddressComparator;
+
+    pValueComparator = findDWTValueComparator(watchpointAddress, watchpointSize, watchpointValue, watchpointType);
+    if (!pValueComparator)
+        return NULL;
+
+    pAddressComparator = &DWT_COMP_ARRAY[getDWTLinkedAddressIndex(pValueComparator)];
+    clearDWTComparator(pValueComparator);
+    pValueComparator->FUNCTION &= ~(DWT_COMP_FUNCTION_DATAVADDR1 |
+                                    DWT_COMP_FUNCTION_DATAVADDR0 |
+                                    DWT_COMP_FUNCTION_DATAVSIZE_MASK);
+    clearDWTComparator(pAddressComparator);
+    return pValueComparator;
+}
+
+/* Only DWT comparator 0 supports matching against the cycle counter. */
+static __INLINE DWT_COMP_Type* getDWTCycleCountComparator(void)
+{
+    return DWT_COMP_ARRAY;
+}
+
+static __INLINE int isDWTCycleCounterPresent(void)
+{
+    return getDWTComparatorCount() > 0 && (DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk) == 0;
+}
+
+static __INLINE int enableDWTCycleCounter(void)
+{
+    if (!isDWTCycleCounterPresent())
+        return 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    return 1;
+}
+
+static __INLINE int isDWTCycleCountComparatorEnabled(void)
+{
+    DWT_COMP_Type* pComparator = getDWTCycleCountComparator();
+
+    return (pComparator->FUNCTION & DWT_COMP_FUNCTION_CYCMATCH) &&
+           (pComparator->FUNCTION & DWT_COMP_FUNCTION_FUNCTION_MASK) != DWT_COMP_FUNCTION_FUNCTION_DISABLED;
+}
+
+static __INLINE void armDWTCycleCountComparator(uint32_t cycles)
+{
+    getDWTCycleCountComparator()->COMP = DWT->CYCCNT + cycles;
+}
+
+static __INLINE int enableDWTCycleCountComparator(uint32_t cycles)
+{
+    DWT_COMP_Type* pComparator = getDWTCycleCountComparator();
+
+    if (!isDWTCycleCounterPresent())
+        return 0;
+    if (!isDWTCycleCountComparatorEnabled() && !isDWTComparatorFree(pComparator))
+        return 0;
+
+    enableDWTCycleCounter();
+    armDWTCycleCountComparator(cycles);
+    pComparator->MASK = 0;
+    /* With CYCMATCH set, the instruction watchpoint function generates a debug event when CYCCNT matches COMP. */
+    pComparator->FUNCTION = DWT_COMP_FUNCTION_CYCMATCH | DWT_COMP_FUNCTION_FUNCTION_INSTRUCTION;
+    return 1;
+}
+
+static __INLINE void disableDWTCycleCountComparator(void)
+{
+    if (isDWTCycleCountComparatorEnabled())
+        clearDWTComparator(getDWTCycleCountComparator());
+}
+
+/* The CPI, exception overhead, sleep, LSU and folded instruction counters are each only 8-bits wide. */
+#define DWT_CTRL_PERF_COUNTERS_Msk  (DWT_CTRL_CPIEVTENA_Msk | DWT_CTRL_EXCEVTENA_Msk | DWT_CTRL_SLEEPEVTENA_Msk | \
+                                     DWT_CTRL_LSUEVTENA_Msk | DWT_CTRL_FOLDEVTENA_Msk)
+
+static __INLINE int isDWTPerfCounterPresent(void)
+{
+    return (DWT->CTRL & DWT_CTRL_NOPRFCNT_Msk) == 0;
+}
+
+static __INLINE void clearDWTPerfCounters(void)
+{
+    DWT->CPICNT = 0;
+    DWT->EXCCNT = 0;
+    DWT->SLEEPCNT = 0;
+    DWT->LSUCNT = 0;
+    DWT->FOLDCNT = 0;
+}
+
+static __INLINE int enableDWTPerfCounters(void)
+{
+    if (!isDWTPerfCounterPresent() || !enableDWTCycleCounter())
+        return 0;
+    DWT->CTRL |= DWT_CTRL_PERF_COUNTERS_Msk;
+    clearDWTPerfCounters();
+    return 1;
+}
+
+static __INLINE void disableDWTPerfCounters(void)
+{
+    DWT->CTRL &= ~DWT_CTRL_PERF_COUNTERS_Msk;
+}
+
+
 /* FlashPatch Control Register Bits. */
 /* Flash Patch breakpoint architecture revision. 0 for revision 1 and 1 for revision 2. */
 #define FP_CTRL_REV_SHIFT           28
@@ -851,6 +1289,112 @@ static __INLINE uint32_t getMPURegionAttributeAndSize(void)
     return MPU->RASR;
 }
 
+
+/* MPU regions are used for watchpoints which need more DWT comparators than are free. The watched range is covered by
+   the smallest naturally aligned power of 2 sized region which contains it (32 bytes minimum) and the 1/8th
+   subregions which don't overlap the watched range are disabled once the region is 256 bytes or larger. */
+#define MPU_RASR_AP_NONE            (0 << MPU_RASR_AP_SHIFT)
+#define MPU_RASR_AP_READ_ONLY       (6 << MPU_RASR_AP_SHIFT)
+#define MPU_RASR_TEX_1              (1 << MPU_RASR_TEX_SHIFT)
+#define MPU_REGION_MIN_SIZE_BITS    5
+#define MPU_SUBREGION_MIN_SIZE_BITS 8
+#define MPU_SUBREGION_COUNT         8
+
+static __INLINE uint32_t calculateMPURegionSizeBits(uint32_t address, uint32_t size)
+{
+    uint32_t lastAddress = address + (size - 1);
+    uint32_t sizeBits;
+
+    for (sizeBits = MPU_REGION_MIN_SIZE_BITS ; sizeBits < 32 ; sizeBits++)
+    {
+        if ((address >> sizeBits) == (lastAddress >> sizeBits))
+            break;
+    }
+    return sizeBits;
+}
+
+static __INLINE uint32_t calculateMPURegionBaseAddress(uint32_t address, uint32_t sizeBits)
+{
+    if (sizeBits >= 32)
+        return 0;
+    return address & ~(((uint32_t)1 << sizeBits) - 1);
+}
+
+static __INLINE uint32_t calculateMPURegionLastAddress(uint32_t baseAddress, uint32_t sizeBits)
+{
+    if (sizeBits >= 32)
+        return 0xFFFFFFFF;
+    return baseAddress + (((uint32_t)1 << sizeBits) - 1);
+}
+
+static __INLINE uint32_t calculateMPUSubregionDisableBits(uint32_t address, uint32_t size, uint32_t sizeBits)
+{
+    uint32_t baseAddress = calculateMPURegionBaseAddress(address, sizeBits);
+    uint32_t subregionSizeBits = sizeBits - 3;
+    uint32_t firstSubregion;
+    uint32_t lastSubregion;
+    uint32_t disableBits = 0;
+    uint32_t i;
+
+    if (sizeBits < MPU_SUBREGION_MIN_SIZE_BITS)
+        return 0;
+
+    firstSubregion = (address - baseAddress) >> subregionSizeBits;
+    lastSubregion = (address + (size - 1) - baseAddress) >> subregionSizeBits;
+    for (i = 0 ; i < MPU_SUBREGION_COUNT ; i++)
+    {
+        if (i < firstSubregion || i > lastSubregion)
+            disableBits |= 1 << i;
+    }
+    return disableBits;
+}
+
+static __INLINE int isAddressInMPURegion(uint32_t address,
+                                         uint32_t baseAddress,
+                                         uint32_t sizeBits,
+                                         uint32_t subregionDisableBits)
+{
+    uint32_t offset = address - baseAddress;
+
+    if (address < baseAddress || address > calculateMPURegionLastAddress(baseAddress, sizeBits))
+        return 0;
+    if (sizeBits < MPU_SUBREGION_MIN_SIZE_BITS)
+        return 1;
+    return (subregionDisableBits & (1 << (offset >> (sizeBits - 3)))) == 0;
+}
+
+static __INLINE uint32_t calculateMPUDefaultMemoryAttributes(uint32_t address)
+{
+    /* Match the attributes used by the default memory map for this address so that the watch region only changes the
+       access permissions. */
+    if (address < 0x20000000)
+        return MPU_RASR_C;
+    else if (address < 0x40000000)
+        return MPU_RASR_TEX_1 | MPU_RASR_C | MPU_RASR_B;
+    else if (address < 0x60000000)
+        return MPU_RASR_S | MPU_RASR_B;
+    else if (address < 0x80000000)
+        return MPU_RASR_TEX_1 | MPU_RASR_C | MPU_RASR_B;
+    else if (address < 0xA0000000)
+        return MPU_RASR_C;
+    else
+        return MPU_RASR_S | MPU_RASR_B;
+}
+
+static __INLINE uint32_t buildMPUWatchRegionAttributeAndSize(uint32_t address,
+                                                             uint32_t size,
+                                                             uint32_t sizeBits,
+                                                             int      isWriteOnly)
+{
+    uint32_t baseAddress = calculateMPURegionBaseAddress(address, sizeBits);
+
+    return calculateMPUDefaultMemoryAttributes(baseAddress) |
+           (isWriteOnly ? MPU_RASR_AP_READ_ONLY : MPU_RASR_AP_NONE) |
+           (calculateMPUSubregionDisableBits(address, size, sizeBits) << MPU_RASR_SRD_SHIFT) |
+           ((sizeBits - 1) << MPU_RASR_SIZE_SHIFT) |
+           MPU_RASR_ENABLE;
+}
+
 #endif
 
 static __INLINE uint32_t getCurrentlyExecutingExceptionNumber(void)
@@ -0,0 +1,790 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Interpreter for the gdb agent expression bytecode attached to breakpoints (used by dprintf-style agent). */
+#include <core/libc.h>
+#include <core/buffer.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/agent.h>
+
+
+/* Maximum depth of the evaluation stack. A printf call needs room for its arguments plus 2 more entries. */
+#ifndef MRI_AGENT_STACK_SIZE
+    #define MRI_AGENT_STACK_SIZE    16
+#endif
+/* Maximum number of characters that a printf %s conversion will fetch from target memory. */
+#ifndef MRI_AGENT_MAX_STRING
+    #define MRI_AGENT_MAX_STRING    256
+#endif
+
+/* Agent expression opcodes from gdb's ax.def. Floating point, trace, and trace state variable opcodes aren't
+   supported since breakpoint commands only need to compute integer values and print them. */
+#define AGENT_OP_ADD            0x02
+#define AGENT_OP_SUB            0x03
+#define AGENT_OP_MUL            0x04
+#define AGENT_OP_DIV_SIGNED     0x05
+#define AGENT_OP_DIV_UNSIGNED   0x06
+#define AGENT_OP_REM_SIGNED     0x07
+#define AGENT_OP_REM_UNSIGNED   0x08
+#define AGENT_OP_LSH            0x09
+#define AGENT_OP_RSH_SIGNED     0x0a
+#define AGENT_OP_RSH_UNSIGNED   0x0b
+#define AGENT_OP_LOG_NOT        0x0e
+#define AGENT_OP_BIT_AND        0x0f
+#define AGENT_OP_BIT_OR         0x10
+#define AGENT_OP_BIT_XOR        0x11
+#define AGENT_OP_BIT_NOT        0x12
+#define AGENT_OP_EQUAL          0x13
+#define AGENT_OP_LESS_SIGNED    0x14
+#define AGENT_OP_LESS_UNSIGNED  0x15
+#define AGENT_OP_EXT            0x16
+#define AGENT_OP_REF8           0x17
+#define AGENT_OP_REF16          0x18
+#define AGENT_OP_REF32          0x19
+#define AGENT_OP_REF64          0x1a
+#define AGENT_OP_IF_GOTO        0x20
+#define AGENT_OP_GOTO           0x21
+#define AGENT_OP_CONST8         0x22
+#define AGENT_OP_CONST16        0x23
+#define AGENT_OP_CONST32        0x24
+#define AGENT_OP_CONST64        0x25
+#define AGENT_OP_REG            0x26
+#define AGENT_OP_END            0x27
+#define AGENT_OP_DUP            0x28
+#define AGENT_OP_POP            0x29
+#define AGENT_OP_ZERO_EXT       0x2a
+#define AGENT_OP_SWAP           0x2b
+#define AGENT_OP_PICK           0x32
+#define AGENT_OP_ROT            0x33
+#define AGENT_OP_PRINTF         0x34
+
+typedef struct
+{
+    uint64_t        stack[MRI_AGENT_STACK_SIZE];
+    const uint8_t*  pStart;
+    const uint8_t*  pCurr;
+    const uint8_t*  pEnd;
+    size_t          depth;
+} AgentState;
+
+static AgentState g_agent;
+
+
+static int  isAtEnd(void);
+static void executeOpcode(uint8_t opcode);
+/* Runs a single agent expression.
+
+   Throws invalidArgumentException if the bytecode is malformed or uses an unsupported opcode, memFaultException if
+   a memory reference faults, and bufferOverrunException if the evaluation stack overflows. */
+void Agent_RunExpression(const uint8_t* pBytecode, size_t length)
+{
+    g_agent.pStart = pBytecode;
+    g_agent.pCurr = pBytecode;
+    g_agent.pEnd = pBytecode + length;
+    g_agent.depth = 0;
+
+    while (!isAtEnd())
+    {
+        __try
+            executeOpcode(*g_agent.pCurr++);
+        __catch
+            __rethrow;
+    }
+}
+
+static int isAtEnd(void)
+{
+    return g_agent.pCurr >= g_agent.pEnd || *g_agent.pCurr == AGENT_OP_END;
+}
+
+
+static uint64_t fetchImmediate(size_t size);
+static uint64_t pop(void);
+static void     push(uint64_t value);
+static uint64_t peek(size_t depth);
+static void     executeBinaryOpcode(uint8_t opcode);
+static void     executeMemoryReference(size_t size);
+static void     executeGoto(int isConditional);
+static void     executeRegister(void);
+static void     executeRotate(void);
+static void     executePrintf(void);
+static uint64_t signExtend(uint64_t value, uint32_t bitCount);
+static uint64_t zeroExtend(uint64_t value, uint32_t bitCount);
+static void executeOpcode(uint8_t opcode)
+{
+    uint64_t value;
+
+    __try
+    {
+        switch (opcode)
+        {
+        case AGENT_OP_ADD:
+        case AGENT_OP_SUB:
+        case AGENT_OP_MUL:
+        case AGENT_OP_DIV_SIGNED:
+        case AGENT_OP_DIV_UNSIGNED:
+        case AGENT_OP_REM_SIGNED:
+        case AGENT_OP_REM_UNSIGNED:
+        case AGENT_OP_LSH:
+        case AGENT_OP_RSH_SIGNED:
+        case AGENT_OP_RSH_UNSIGNED:
+        case AGENT_OP_BIT_AND:
+        case AGENT_OP_BIT_OR:
+        case AGENT_OP_BIT_XOR:
+        case AGENT_OP_EQUAL:
+        case AGENT_OP_LESS_SIGNED:
+        case AGENT_OP_LESS_UNSIGNED:
+            __throwing_func( executeBinaryOpcode(opcode) );
+            break;
+        case AGENT_OP_LOG_NOT:
+            __throwing_func( value = pop() );
+            __throwing_func( push(!value) );
+            break;
+        case AGENT_OP_BIT_NOT:
+            __throwing_func( value = pop() );
+            __throwing_func( push(~value) );
+            break;
+        case AGENT_OP_EXT:
+        case AGENT_OP_ZERO_EXT:
+        {
+            uint32_t bitCount;
+
+            __throwing_func( bitCount = fetchImmediate(1) );
+            __throwing_func( value = pop() );
+            value = (opcode == AGENT_OP_EXT) ? signExtend(value, bitCount) : zeroExtend(value, bitCount);
+            __throwing_func( push(value) );
+            break;
+        }
+        case AGENT_OP_REF8:
+            __throwing_func( executeMemoryReference(sizeof(uint8_t)) );
+            break;
+        case AGENT_OP_REF16:
+            __throwing_func( executeMemoryReference(sizeof(uint16_t)) );
+            break;
+        case AGENT_OP_REF32:
+            __throwing_func( executeMemoryReference(sizeof(uint32_t)) );
+            break;
+        case AGENT_OP_REF64:
+            __throwing_func( executeMemoryReference(sizeof(uint64_t)) );
+            break;
+        case AGENT_OP_IF_GOTO:
+            __throwing_func( executeGoto(1) );
+            break;
+        case AGENT_OP_GOTO:
+            __throwing_func( executeGoto(0) );
+            break;
+        case AGENT_OP_CONST8:
+            __throwing_func( value = fetchImmediate(1) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_CONST16:
+            __throwing_func( value = fetchImmediate(2) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_CONST32:
+            __throwing_func( value = fetchImmediate(4) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_CONST64:
+            __throwing_func( value = fetchImmediate(8) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_REG:
+            __throwing_func( executeRegister() );
+            break;
+        case AGENT_OP_DUP:
+            __throwing_func( value = peek(0) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_POP:
+            __throwing_func( pop() );
+            break;
+        case AGENT_OP_SWAP:
+        {
+            uint64_t next;
+
+            __throwing_func( value = pop() );
+            __throwing_func( next = pop() );
+            push(value);
+            push(next);
+            break;
+        }
+        case AGENT_OP_PICK:
+            __throwing_func( value = fetchImmediate(1) );
+            __throwing_func( value = peek(value) );
+            __throwing_func( push(value) );
+            break;
+        case AGENT_OP_ROT:
+            __throwing_func( executeRotate() );
+            break;
+        case AGENT_OP_PRINTF:
+            __throwing_func( executePrintf() );
+            break;
+        default:
+            __throw(invalidArgumentException);
+        }
+    }
+    __catch
+    {
+        __rethrow;
+    }
+}
+
+static uint64_t fetchImmediate(size_t size)
+{
+    uint64_t value = 0;
+
+    /* Immediate operands are stored in big endian order. */
+    if ((size_t)(g_agent.pEnd - g_agent.pCurr) < size)
+        __throw_and_return(invalidArgumentException, 0);
+    while (size--)
+        value = (value << 8) | *g_agent.pCurr++;
+    return value;
+}
+
+static uint64_t pop(void)
+{
+    if (g_agent.depth == 0)
+        __throw_and_return(invalidArgumentException, 0);
+    return g_agent.stack[--g_agent.depth];
+}
+
+static void push(uint64_t value)
+{
+    if (g_agent.depth >= MRI_AGENT_STACK_SIZE)
+        __throw(bufferOverrunException);
+    g_agent.stack[g_agent.depth++] = value;
+}
+
+static uint64_t peek(size_t depth)
+{
+    if (depth >= g_agent.depth)
+        __throw_and_return(invalidArgumentException, 0);
+    return g_agent.stack[g_agent.depth - 1 - depth];
+}
+
+static void executeBinaryOpcode(uint8_t opcode)
+{
+    uint64_t a;
+    uint64_t b;
+    uint64_t result = 0;
+
+    __try
+    {
+        __throwing_func( b = pop() );
+        __throwing_func( a = pop() );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+
+    switch (opcode)
+    {
+    case AGENT_OP_ADD:
+        result = a + b;
+        break;
+    case AGENT_OP_SUB:
+        result = a - b;
+        break;
+    case AGENT_OP_MUL:
+        result = a * b;
+        break;
+    case AGENT_OP_DIV_SIGNED:
+    case AGENT_OP_DIV_UNSIGNED:
+    case AGENT_OP_REM_SIGNED:
+    case AGENT_OP_REM_UNSIGNED:
+        if (b == 0)
+            __throw(invalidValueException);
+        if (opcode == AGENT_OP_DIV_SIGNED)
+            result = (int64_t)a / (int64_t)b;
+        else if (opcode == AGENT_OP_DIV_UNSIGNED)
+            result = a / b;
+        else if (opcode == AGENT_OP_REM_SIGNED)
+            result = (int64_t)a % (int64_t)b;
+        else
+            result = a % b;
+        break;
+    case AGENT_OP_LSH:
+        result = (b < 64) ? a << b : 0;
+        break;
+    case AGENT_OP_RSH_SIGNED:
+        result = (int64_t)a >> ((b < 64) ? b : 63);
+        break;
+    case AGENT_OP_RSH_UNSIGNED:
+        result = (b < 64) ? a >> b : 0;
+        break;
+    case AGENT_OP_BIT_AND:
+        result = a & b;
+        break;
+    case AGENT_OP_BIT_OR:
+        result = a | b;
+        break;
+    case AGENT_OP_BIT_XOR:
+        result = a ^ b;
+        break;
+    case AGENT_OP_EQUAL:
+        result = (a == b);
+        break;
+    case AGENT_OP_LESS_SIGNED:
+        result = ((int64_t)a < (int64_t)b);
+        break;
+    case AGENT_OP_LESS_UNSIGNED:
+        result = (a < b);
+        break;
+    }
+    push(result);
+}
+
+static void executeMemoryReference(size_t size)
+{
+    uint64_t  value = 0;
+    uintmri_t address;
+
+    __try
+        address = pop();
+    __catch
+        __rethrow;
+
+    switch (size)
+    {
+    case sizeof(uint8_t):
+        value = Platform_MemRead8(address);
+        break;
+    case sizeof(uint16_t):
+        value = Platform_MemRead16(address);
+        break;
+    case sizeof(uint32_t):
+        value = Platform_MemRead32(address);
+        break;
+    case sizeof(uint64_t):
+        value = Platform_MemRead64(address);
+        break;
+    }
+    if (Platform_WasMemoryFaultEncountered())
+        __throw(memFaultException);
+    push(value);
+}
+
+static void executeGoto(int isConditional)
+{
+    uint64_t offset;
+    uint64_t condition = 1;
+
+    __try
+    {
+        __throwing_func( offset = fetchImmediate(2) );
+        if (isConditional)
+        {
+            __throwing_func( condition = pop() );
+        }
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    if (offset >= (uint64_t)(g_agent.pEnd - g_agent.pStart))
+        __throw(invalidArgumentException);
+    if (condition)
+        g_agent.pCurr = g_agent.pStart + offset;
+}
+
+static void executeRegister(void)
+{
+    uint64_t  registerIndex;
+    uintmri_t value;
+
+    /* The register number is the remote protocol number which matches the ordering of the 'g' packet. */
+    __try
+    {
+        __throwing_func( registerIndex = fetchImmediate(2) );
+        __throwing_func( value = Context_Get(GetContext(), registerIndex) );
+        __throwing_func( push(value) );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+}
+
+static void executeRotate(void)
+{
+    uint64_t top;
+
+    if (g_agent.depth < 3)
+        __throw(invalidArgumentException);
+
+    /* a b c => c a b */
+    top = g_agent.stack[g_agent.depth - 1];
+    g_agent.stack[g_agent.depth - 1] = g_agent.stack[g_agent.depth - 2];
+    g_agent.stack[g_agent.depth - 2] = g_agent.stack[g_agent.depth - 3];
+    g_agent.stack[g_agent.depth - 3] = top;
+}
+
+static uint64_t signExtend(uint64_t value, uint32_t bitCount)
+{
+    uint32_t shift;
+
+    if (bitCount == 0 || bitCount >= 64)
+        return value;
+    shift = 64 - bitCount;
+    return (uint64_t)((int64_t)(value << shift) >> shift);
+}
+
+static uint64_t zeroExtend(uint64_t value, uint32_t bitCount)
+{
+    if (bitCount >= 64)
+        return value;
+    return value & (((uint64_t)1 << bitCount) - 1);
+}
+
+
+/* Flags used in FormatSpec::flags */
+#define FORMAT_FLAG_LEFT_JUSTIFY    (1 << 0)
+#define FORMAT_FLAG_PLUS_SIGN       (1 << 1)
+#define FORMAT_FLAG_SPACE_SIGN      (1 << 2)
+#define FORMAT_FLAG_ALTERNATE       (1 << 3)
+#define FORMAT_FLAG_ZERO_PAD        (1 << 4)
+
+typedef struct
+{
+    uint32_t flags;
+    int32_t  width;
+    int32_t  precision;
+    uint32_t argSize;
+    char     conversion;
+} FormatSpec;
+
+static void        beginConsoleOutput(void);
+static void        endConsoleOutput(void);
+static const char* parseFormatSpec(const char* pFormat, FormatSpec* pSpec);
+static void        outputChar(char c);
+static void        outputConversion(const FormatSpec* pSpec, uint64_t arg);
+/* Handle the printf opcode which gdb generates for dprintf-style agent.
+
+    Opcode Format: 0x34 NN LLLL format...
+    Where NN is the number of arguments on the stack.
+          LLLL is the length of the NUL terminated format string which follows.
+    On entry the top of the stack contains the function and channel (unused on the target), followed by NN
+    arguments with the first argument nearest the top.
+
+    The formatted text is sent to gdb in an 'O' packet so that it shows up on the gdb console.
+*/
+static void executePrintf(void)
+{
+    const char* pFormat;
+    uint64_t    argCount;
+    uint64_t    formatLength;
+    size_t      argIndex = 0;
+
+    __try
+    {
+        __throwing_func( argCount = fetchImmediate(1) );
+        __throwing_func( formatLength = fetchImmediate(2) );
+        __throwing_func( pop() );
+        __throwing_func( pop() );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    pFormat = (const char*)g_agent.pCurr;
+    if (formatLength == 0 || formatLength > (uint64_t)(g_agent.pEnd - g_agent.pCurr) || pFormat[formatLength - 1] != '\0')
+        __throw(invalidArgumentException);
+    if (argCount > g_agent.depth)
+        __throw(invalidArgumentException);
+    g_agent.pCurr += formatLength;
+
+    beginConsoleOutput();
+    while (*pFormat)
+    {
+        FormatSpec spec;
+
+        if (*pFormat != '%')
+        {
+            outputChar(*pFormat++);
+            continue;
+        }
+        pFormat = parseFormatSpec(pFormat + 1, &spec);
+        if (spec.conversion == '%')
+        {
+            outputChar('%');
+            continue;
+        }
+        if (argIndex >= argCount)
+            __throw(invalidArgumentException);
+        __try
+            outputConversion(&spec, g_agent.stack[g_agent.depth - 1 - argIndex++]);
+        __catch
+            __rethrow;
+    }
+    endConsoleOutput();
+    g_agent.depth -= argCount;
+}
+
+static void beginConsoleOutput(void)
+{
+    Buffer_WriteChar(GetInitializedBuffer(), 'O');
+}
+
+static void endConsoleOutput(void)
+{
+    if (Buffer_GetLength(GetBuffer()) > 1)
+        SendPacketToGdb();
+}
+
+static void outputChar(char c)
+{
+    Buffer* pBuffer = GetBuffer();
+
+    /* Long output is split across multiple 'O' packets. */
+    if (Buffer_BytesLeft(pBuffer) < 2)
+    {
+        endConsoleOutput();
+        beginConsoleOutput();
+    }
+    Buffer_WriteByteAsHex(pBuffer, c);
+}
+
+static const char* parseFormatSpec(const char* pFormat, FormatSpec* pSpec)
+{
+    mri_memset(pSpec, 0, sizeof(*pSpec));
+    pSpec->precision = -1;
+    pSpec->argSize = sizeof(int);
+
+    for (;;)
+    {
+        if (*pFormat == '-')
+            pSpec->flags |= FORMAT_FLAG_LEFT_JUSTIFY;
+        else if (*pFormat == '+')
+            pSpec->flags |= FORMAT_FLAG_PLUS_SIGN;
+        else if (*pFormat == ' ')
+            pSpec->flags |= FORMAT_FLAG_SPACE_SIGN;
+        else if (*pFormat == '#')
+            pSpec->flags |= FORMAT_FLAG_ALTERNATE;
+        else if (*pFormat == '0')
+            pSpec->flags |= FORMAT_FLAG_ZERO_PAD;
+        else
+            break;
+        pFormat++;
+    }
+    while (*pFormat >= '0' && *pFormat <= '9')
+        pSpec->width = pSpec->width * 10 + (*pFormat++ - '0');
+    if (*pFormat == '.')
+    {
+        pFormat++;
+        pSpec->precision = 0;
+        while (*pFormat >= '0' && *pFormat <= '9')
+            pSpec->precision = pSpec->precision * 10 + (*pFormat++ - '0');
+    }
+
+    switch (*pFormat)
+    {
+    case 'h':
+        pSpec->argSize = sizeof(short);
+        if (*++pFormat == 'h')
+        {
+            pSpec->argSize = sizeof(char);
+            pFormat++;
+        }
+        break;
+    case 'l':
+        pSpec->argSize = sizeof(long);
+        if (*++pFormat == 'l')
+        {
+            pSpec->argSize = sizeof(long long);
+            pFormat++;
+        }
+        break;
+    case 'j':
+    case 'L':
+        pSpec->argSize = sizeof(uint64_t);
+        pFormat++;
+        break;
+    case 'z':
+    case 't':
+        pSpec->argSize = sizeof(size_t);
+        pFormat++;
+        break;
+    }
+
+    pSpec->conversion = *pFormat;
+    if (*pFormat)
+        pFormat++;
+    return pFormat;
+}
+
+static void outputInteger(const FormatSpec* pSpec, uint64_t arg);
+static void outputString(const FormatSpec* pSpec, uintmri_t address);
+static void outputPadding(char padChar, int32_t count);
+static void outputConversion(const FormatSpec* pSpec, uint64_t arg)
+{
+    switch (pSpec->conversion)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'p':
+        outputInteger(pSpec, arg);
+        break;
+    case 'c':
+        if ((pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY) == 0)
+            outputPadding(' ', pSpec->width - 1);
+        outputChar((char)arg);
+        if (pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY)
+            outputPadding(' ', pSpec->width - 1);
+        break;
+    case 's':
+        outputString(pSpec, (uintmri_t)arg);
+        break;
+    default:
+        /* Floating point conversions aren't supported. */
+        __throw(invalidArgumentException);
+    }
+}
+
+static void outputInteger(const FormatSpec* pSpec, uint64_t arg)
+{
+    static const char lowerDigits[] = "0123456789abcdef";
+    static const char upperDigits[] = "0123456789ABCDEF";
+    const char*       pDigits = lowerDigits;
+    const char*       pPrefix = "";
+    char              digits[24];
+    char              sign = '\0';
+    uint32_t          base = 10;
+    uint32_t          argSize = pSpec->argSize;
+    int32_t           digitCount = 0;
+    int32_t           precision = pSpec->precision;
+    int32_t           zeroCount;
+    int32_t           padCount;
+
+    switch (pSpec->conversion)
+    {
+    case 'd':
+    case 'i':
+        arg = signExtend(arg, argSize * 8);
+        if ((int64_t)arg < 0)
+        {
+            sign = '-';
+            arg = -arg;
+        }
+        else if (pSpec->flags & FORMAT_FLAG_PLUS_SIGN)
+        {
+            sign = '+';
+        }
+        else if (pSpec->flags & FORMAT_FLAG_SPACE_SIGN)
+        {
+            sign = ' ';
+        }
+        break;
+    case 'o':
+        base = 8;
+        arg = zeroExtend(arg, argSize * 8);
+        break;
+    case 'x':
+    case 'X':
+        base = 16;
+        if (pSpec->conversion == 'X')
+            pDigits = upperDigits;
+        arg = zeroExtend(arg, argSize * 8);
+        if ((pSpec->flags & FORMAT_FLAG_ALTERNATE) && arg != 0)
+            pPrefix = (pSpec->conversion == 'X') ? "0X" : "0x";
+        break;
+    case 'p':
+        base = 16;
+        arg = zeroExtend(arg, sizeof(uintmri_t) * 8);
+        pPrefix = "0x";
+        break;
+    default:
+        arg = zeroExtend(arg, argSize * 8);
+        break;
+    }
+
+    while (arg != 0)
+    {
+        digits[digitCount++] = pDigits[arg % base];
+        arg /= base;
+    }
+    if (precision < 0)
+        precision = 1;
+    if (base == 8 && (pSpec->flags & FORMAT_FLAG_ALTERNATE) && precision <= digitCount)
+        precision = digitCount + 1;
+    zeroCount = (precision > digitCount) ? precision - digitCount : 0;
+    padCount = pSpec->width - (sign ? 1 : 0) - (int32_t)mri_strlen(pPrefix) - zeroCount - digitCount;
+    if ((pSpec->flags & FORMAT_FLAG_ZERO_PAD) && pSpec->precision < 0 &&
+        (pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY) == 0 && padCount > 0)
+    {
+        zeroCount += padCount;
+        padCount = 0;
+    }
+
+    if ((pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY) == 0)
+        outputPadding(' ', padCount);
+    if (sign)
+        outputChar(sign);
+    while (*pPrefix)
+        outputChar(*pPrefix++);
+    outputPadding('0', zeroCount);
+    while (digitCount > 0)
+        outputChar(digits[--digitCount]);
+    if (pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY)
+        outputPadding(' ', padCount);
+}
+
+static int32_t fetchStringLength(uintmri_t address, int32_t maximumLength);
+static void outputString(const FormatSpec* pSpec, uintmri_t address)
+{
+    static const char nullString[] = "(null)";
+    int32_t           maximumLength = MRI_AGENT_MAX_STRING;
+    int32_t           length;
+    int32_t           i;
+
+    if (pSpec->precision >= 0 && pSpec->precision < maximumLength)
+        maximumLength = pSpec->precision;
+    if (address == 0)
+        length = (int32_t)sizeof(nullString) - 1 < maximumLength ? (int32_t)sizeof(nullString) - 1 : maximumLength;
+    else
+        length = fetchStringLength(address, maximumLength);
+
+    if ((pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY) == 0)
+        outputPadding(' ', pSpec->width - length);
+    for (i = 0 ; i < length ; i++)
+        outputChar(address == 0 ? nullString[i] : (char)Platform_MemRead8(address + i));
+    if (pSpec->flags & FORMAT_FLAG_LEFT_JUSTIFY)
+        outputPadding(' ', pSpec->width - length);
+}
+
+static int32_t fetchStringLength(uintmri_t address, int32_t maximumLength)
+{
+    int32_t length;
+
+    /* The string is truncated at the first byte which can't be read. */
+    for (length = 0 ; length < maximumLength ; length++)
+    {
+        uint8_t c = Platform_MemRead8(address + length);
+        if (Platform_WasMemoryFaultEncountered() || c == '\0')
+            break;
+    }
+    return length;
+}
+
+static void outputPadding(char padChar, int32_t count)
+{
+    while (count-- > 0)
+        outputChar(padChar);
+}
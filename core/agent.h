@@ -0,0 +1,29 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Interpreter for the gdb agent expression bytecode attached to breakpoints (used by dprintf-style agent). */
+#ifndef AGENT_H_
+#define AGENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Real name of functions are in mri namespace. */
+__throws void mriAgent_RunExpression(const uint8_t* pBytecode, size_t length);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Agent_RunExpression     mriAgent_RunExpression
+
+#endif /* AGENT_H_ */
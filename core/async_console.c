@@ -0,0 +1,282 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Ring buffer of program console output which is sent to gdb from the comm channel interrupt while the program runs. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/hex_convert.h>
+#include <core/platforms.h>
+#include <core/gdb_console.h>
+#include <core/mri.h>
+#include <core/async_console.h>
+
+
+typedef struct
+{
+    char*    pBuffer;
+    uint32_t bufferSize;
+    uint32_t readIndex;
+    uint32_t count;
+    uint32_t packetDataSize;
+    uint32_t packetIndex;
+    uint32_t state;
+    uint32_t lineLength;
+    uint8_t  checksum;
+    char     line[MRI_ASYNC_CONSOLE_PACKET_SIZE];
+} AsyncConsoleState;
+
+static AsyncConsoleState g_console;
+
+/* AsyncConsoleState::state values. */
+#define ASYNC_CONSOLE_IDLE              0
+#define ASYNC_CONSOLE_SENDING           1
+#define ASYNC_CONSOLE_WAITING_FOR_ACK   2
+
+
+void mriSetConsoleBuffer(void* pBuffer, size_t bufferSize)
+{
+    AsyncConsole_Reset();
+    g_console.pBuffer = (char*)pBuffer;
+    g_console.bufferSize = pBuffer ? bufferSize : 0;
+}
+
+
+void AsyncConsole_Reset(void)
+{
+    g_console.readIndex = 0;
+    g_console.count = 0;
+    g_console.packetDataSize = 0;
+    g_console.packetIndex = 0;
+    g_console.state = ASYNC_CONSOLE_IDLE;
+    g_console.lineLength = 0;
+}
+
+
+/* Called from the semihost handler to queue up output written to stdout by the program. Returns 0 without queueing
+   anything if there isn't enough free space so that the caller can fall back to sending it before resuming. */
+int AsyncConsole_Write(const char* pData, size_t length)
+{
+    uint32_t writeIndex;
+
+    if (g_console.pBuffer == NULL || length > g_console.bufferSize - g_console.count)
+        return 0;
+
+    writeIndex = (g_console.readIndex + g_console.count) % g_console.bufferSize;
+    while (length-- > 0)
+    {
+        g_console.pBuffer[writeIndex] = *pData++;
+        writeIndex = (writeIndex + 1) % g_console.bufferSize;
+        g_console.count++;
+    }
+    return 1;
+}
+
+
+/* Called each time that the comm channel interrupts while the program is running. gdb's acknowledgements of the 'O'
+   packets are consumed here and as many characters of the current packet as the transmitter can accept are sent.
+   Returns non-zero if gdb sent anything else, like CTRL+C, so that the debugger should be entered. */
+static int  processPacketResponse(int charFromGdb);
+static void startPacketIfNeeded(void);
+static void sendPacketChar(void);
+int AsyncConsole_ProcessCommInterrupt(void)
+{
+    while (Platform_CommHasReceiveData())
+    {
+        if (g_console.state != ASYNC_CONSOLE_WAITING_FOR_ACK)
+            return 1;
+        if (!processPacketResponse(Platform_CommReceiveChar()))
+            return 1;
+    }
+
+    startPacketIfNeeded();
+    while (g_console.state == ASYNC_CONSOLE_SENDING && Platform_CommIsTransmitReady())
+        sendPacketChar();
+    Platform_CommSetTransmitInterrupt(g_console.state == ASYNC_CONSOLE_SENDING);
+
+    return 0;
+}
+
+static void consumePacketData(void);
+static int processPacketResponse(int charFromGdb)
+{
+    switch (charFromGdb)
+    {
+    case '+':
+        consumePacketData();
+        return 1;
+    case '-':
+        g_console.packetIndex = 0;
+        g_console.state = ASYNC_CONSOLE_SENDING;
+        return 1;
+    default:
+        /* Anything else, like CTRL+C, is left for the debugger and the acknowledgement is still expected after it. */
+        return 0;
+    }
+}
+
+static void consumePacketData(void)
+{
+    g_console.readIndex = (g_console.readIndex + g_console.packetDataSize) % g_console.bufferSize;
+    g_console.count -= g_console.packetDataSize;
+    g_console.packetDataSize = 0;
+    g_console.state = ASYNC_CONSOLE_IDLE;
+}
+
+static char getPacketDataHexChar(uint32_t hexIndex);
+static void startPacketIfNeeded(void)
+{
+    uint32_t i;
+
+    if (g_console.state != ASYNC_CONSOLE_IDLE || g_console.count == 0)
+        return;
+
+    g_console.packetDataSize = g_console.count;
+    if (g_console.packetDataSize > MRI_ASYNC_CONSOLE_PACKET_SIZE)
+        g_console.packetDataSize = MRI_ASYNC_CONSOLE_PACKET_SIZE;
+    g_console.checksum = 'O';
+    for (i = 0 ; i < 2 * g_console.packetDataSize ; i++)
+        g_console.checksum += getPacketDataHexChar(i);
+    g_console.packetIndex = 0;
+    g_console.state = ASYNC_CONSOLE_SENDING;
+}
+
+static char getPacketDataHexChar(uint32_t hexIndex)
+{
+    uint8_t byte = g_console.pBuffer[(g_console.readIndex + hexIndex / 2) % g_console.bufferSize];
+
+    if (hexIndex & 1)
+        return NibbleToHexChar[EXTRACT_LO_NIBBLE(byte)];
+    return NibbleToHexChar[EXTRACT_HI_NIBBLE(byte)];
+}
+
+/* The packet is generated a character at a time: $O<hex data>#<checksum> */
+static char getPacketChar(uint32_t packetIndex);
+static void sendPacketChar(void)
+{
+    uint32_t packetLength = 2 * g_console.packetDataSize + 5;
+
+    Platform_CommSendChar(getPacketChar(g_console.packetIndex++));
+    if (g_console.packetIndex >= packetLength)
+        g_console.state = ASYNC_CONSOLE_WAITING_FOR_ACK;
+}
+
+static char getPacketChar(uint32_t packetIndex)
+{
+    uint32_t hexLength = 2 * g_console.packetDataSize;
+
+    if (packetIndex == 0)
+        return '$';
+    if (packetIndex == 1)
+        return 'O';
+    if (packetIndex < 2 + hexLength)
+        return getPacketDataHexChar(packetIndex - 2);
+    if (packetIndex == 2 + hexLength)
+        return '#';
+    if (packetIndex == 3 + hexLength)
+        return NibbleToHexChar[EXTRACT_HI_NIBBLE(g_console.checksum)];
+    return NibbleToHexChar[EXTRACT_LO_NIBBLE(g_console.checksum)];
+}
+
+
+/* Called before the debugger sends its own packet to gdb. A packet which was only partially sent from the interrupt
+   is completed and its acknowledgement received so that the two don't get interleaved. */
+void AsyncConsole_FinishPacket(void)
+{
+    static const int controlC = 0x03;
+
+    while (g_console.state != ASYNC_CONSOLE_IDLE)
+    {
+        int charFromGdb;
+
+        if (g_console.state == ASYNC_CONSOLE_SENDING)
+        {
+            sendPacketChar();
+            continue;
+        }
+
+        charFromGdb = Platform_CommReceiveChar();
+        if (charFromGdb == controlC)
+            ControlCEncountered();
+        processPacketResponse(charFromGdb);
+    }
+    Platform_CommSetTransmitInterrupt(0);
+}
+
+
+/* Called before a stop is reported to gdb, and when the program's output doesn't fit in the ring buffer, to send
+   everything that is still queued up. */
+void AsyncConsole_Flush(void)
+{
+    AsyncConsole_FlushLine();
+    AsyncConsole_FinishPacket();
+    while (g_console.count > 0)
+    {
+        uint32_t length = g_console.count;
+        size_t   charsWritten;
+
+        if (length > g_console.bufferSize - g_console.readIndex)
+            length = g_console.bufferSize - g_console.readIndex;
+        charsWritten = WriteSizedStringToGdbConsole(g_console.pBuffer + g_console.readIndex, length);
+        if (charsWritten == 0)
+            break;
+        g_console.readIndex = (g_console.readIndex + charsWritten) % g_console.bufferSize;
+        g_console.count -= charsWritten;
+    }
+}
+
+
+/* Called as the debugger returns to the program so that the interrupt can start sending any queued output. */
+void AsyncConsole_Resume(void)
+{
+    if (g_console.count > 0)
+        Platform_CommSetTransmitInterrupt(1);
+}
+
+
+/* Called for console output which the program sends a character or short string at a time. It is queued in the ring
+   buffer if the program provided one. Otherwise it is collected into a line and sent to gdb in a single packet once
+   a newline arrives, the line fills up, or the debugger is about to send something else. */
+static void appendToLine(char c);
+void AsyncConsole_WriteBuffered(const char* pData, size_t length)
+{
+    if (g_console.pBuffer)
+    {
+        if (AsyncConsole_Write(pData, length))
+            return;
+        AsyncConsole_Flush();
+        if (!AsyncConsole_Write(pData, length))
+            WriteSizedStringToGdbConsole(pData, length);
+        return;
+    }
+
+    while (length-- > 0 && !WasControlCEncountered())
+        appendToLine(*pData++);
+}
+
+static void appendToLine(char c)
+{
+    g_console.line[g_console.lineLength++] = c;
+    if (c == '\n' || g_console.lineLength >= sizeof(g_console.line))
+        AsyncConsole_FlushLine();
+}
+
+
+/* Sends any partial line collected by AsyncConsole_WriteBuffered() to gdb. */
+void AsyncConsole_FlushLine(void)
+{
+    if (g_console.lineLength == 0)
+        return;
+    WriteSizedStringToGdbConsole(g_console.line, g_console.lineLength);
+    g_console.lineLength = 0;
+}
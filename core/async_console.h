@@ -0,0 +1,47 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Ring buffer of program console output which is sent to gdb from the comm channel interrupt while the program runs. */
+#ifndef ASYNC_CONSOLE_H_
+#define ASYNC_CONSOLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Maximum number of console bytes sent in each 'O' packet from the comm channel interrupt. */
+#ifndef MRI_ASYNC_CONSOLE_PACKET_SIZE
+    #define MRI_ASYNC_CONSOLE_PACKET_SIZE   64
+#endif
+
+/* Real name of functions are in mri namespace. */
+void mriAsyncConsole_Reset(void);
+int  mriAsyncConsole_Write(const char* pData, size_t length);
+int  mriAsyncConsole_ProcessCommInterrupt(void);
+void mriAsyncConsole_FinishPacket(void);
+void mriAsyncConsole_Flush(void);
+void mriAsyncConsole_Resume(void);
+void mriAsyncConsole_WriteBuffered(const char* pData, size_t length);
+void mriAsyncConsole_FlushLine(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define AsyncConsole_Reset                  mriAsyncConsole_Reset
+#define AsyncConsole_Write                  mriAsyncConsole_Write
+#define AsyncConsole_ProcessCommInterrupt   mriAsyncConsole_ProcessCommInterrupt
+#define AsyncConsole_FinishPacket           mriAsyncConsole_FinishPacket
+#define AsyncConsole_Flush                  mriAsyncConsole_Flush
+#define AsyncConsole_Resume                 mriAsyncConsole_Resume
+#define AsyncConsole_WriteBuffered          mriAsyncConsole_WriteBuffered
+#define AsyncConsole_FlushLine              mriAsyncConsole_FlushLine
+
+#endif /* ASYNC_CONSOLE_H_ */
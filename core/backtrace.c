@@ -0,0 +1,75 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Backtraces of the halted thread and every other RTOS thread, unwound on the target. */
+#include <core/core.h>
+#include <core/context.h>
+#include <core/platforms.h>
+#include <core/backtrace.h>
+
+
+typedef struct
+{
+    BacktraceRecord record;
+    int             isFirstRtosThread;
+} BacktraceState;
+
+/* Kept off of the stack since it is used from MRI's small debugger stack. */
+static BacktraceState g_backtrace;
+
+
+/* The records are regenerated for each qXfer read rather than being buffered. The program stays halted between reads
+   so the same records are produced each time. Each record is only valid until the next call and NULL is returned
+   once there are no more threads. */
+static const BacktraceRecord* fillRecord(uintmri_t threadId, MriContext* pContext);
+const BacktraceRecord* Backtrace_GetFirstRecord(void)
+{
+    g_backtrace.isFirstRtosThread = 1;
+    return fillRecord(Platform_RtosGetHaltedThreadId(), GetHaltedContext());
+}
+
+const BacktraceRecord* Backtrace_GetNextRecord(void)
+{
+    uintmri_t haltedThreadId = Platform_RtosGetHaltedThreadId();
+    uintmri_t threadId;
+
+    threadId = g_backtrace.isFirstRtosThread ? Platform_RtosGetFirstThreadId() : Platform_RtosGetNextThreadId();
+    g_backtrace.isFirstRtosThread = 0;
+    for ( ; threadId != 0 ; threadId = Platform_RtosGetNextThreadId())
+    {
+        MriContext* pContext;
+
+        if (threadId == haltedThreadId)
+            continue;
+        pContext = Platform_RtosGetThreadContext(threadId);
+        if (pContext)
+            return fillRecord(threadId, pContext);
+    }
+    return NULL;
+}
+
+static const BacktraceRecord* fillRecord(uintmri_t threadId, MriContext* pContext)
+{
+    BacktraceRecord* pRecord = &g_backtrace.record;
+
+    pRecord->threadId = threadId;
+    pRecord->frameCount = Platform_UnwindStack(pContext, pRecord->frames, MRI_BACKTRACE_MAX_FRAMES);
+    return pRecord;
+}
+
+
+uint32_t Backtrace_GetRecordSize(const BacktraceRecord* pRecord)
+{
+    return sizeof(pRecord->threadId) + sizeof(pRecord->frameCount) + pRecord->frameCount * sizeof(pRecord->frames[0]);
+}
@@ -0,0 +1,46 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Backtraces of the halted thread and every other RTOS thread, unwound on the target. */
+#ifndef BACKTRACE_H_
+#define BACKTRACE_H_
+
+#include <stdint.h>
+
+/* Maximum number of frames unwound for each thread. */
+#ifndef MRI_BACKTRACE_MAX_FRAMES
+    #define MRI_BACKTRACE_MAX_FRAMES    16
+#endif
+
+/* The qXfer:mri-backtrace object is a list of these records, packed back to back. Only the first frameCount entries
+   of frames are included in each one. The first frame is the thread's program counter and the rest are the return
+   addresses of its callers. threadId is 0 when no RTOS is in use. */
+typedef struct
+{
+    uint32_t threadId;
+    uint32_t frameCount;
+    uint32_t frames[MRI_BACKTRACE_MAX_FRAMES];
+} BacktraceRecord;
+
+/* Real name of functions are in mri namespace. */
+const BacktraceRecord* mriBacktrace_GetFirstRecord(void);
+const BacktraceRecord* mriBacktrace_GetNextRecord(void);
+uint32_t               mriBacktrace_GetRecordSize(const BacktraceRecord* pRecord);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Backtrace_GetFirstRecord    mriBacktrace_GetFirstRecord
+#define Backtrace_GetNextRecord     mriBacktrace_GetNextRecord
+#define Backtrace_GetRecordSize     mriBacktrace_GetRecordSize
+
+#endif /* BACKTRACE_H_ */
@@ -0,0 +1,238 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Deferred formatting log whose records are streamed in binary to a file on the gdb host. */
+#include <stdarg.h>
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/cmd_file.h>
+#include <core/fileio.h>
+#include <core/gdb_console.h>
+#include <core/mri.h>
+#include <core/binlog.h>
+
+
+typedef struct
+{
+    uint8_t*          pBuffer;
+    size_t            bufferSize;
+    volatile uint32_t used;
+    int               fileDescriptor;
+    uint32_t          flags;
+    char              filename[64];
+} BinLogState;
+
+static BinLogState g_binlog;
+
+/* BinLogState::flags bit definitions. */
+#define BINLOG_FLAGS_RUNNING        (1 << 0)
+#define BINLOG_FLAGS_STOP_REQUESTED (1 << 1)
+
+
+void mriSetLogBuffer(void* pBuffer, size_t bufferSize)
+{
+    g_binlog.used = 0;
+    g_binlog.pBuffer = (uint8_t*)pBuffer;
+    g_binlog.bufferSize = pBuffer ? bufferSize : 0;
+}
+
+
+void BinLog_Reset(void)
+{
+    g_binlog.used = 0;
+    g_binlog.fileDescriptor = -1;
+    g_binlog.flags = 0;
+}
+
+
+/* The log file isn't opened until the first time that records are flushed since gdb only services File-I/O requests
+   while the program is running. If a stop is still pending then the file which is already open is reused. */
+void BinLog_Start(const char* pFilename)
+{
+    size_t filenameLength = mri_strlen(pFilename);
+
+    if (g_binlog.pBuffer == NULL)
+        __throw(notFoundException);
+    if (g_binlog.bufferSize < MRI_BINLOG_HEADER_SIZE + MRI_LOG_MAX_ARGUMENTS * sizeof(uint32_t))
+        __throw(bufferOverrunException);
+    if (filenameLength == 0)
+        __throw(invalidArgumentException);
+    if (filenameLength >= sizeof(g_binlog.filename))
+        __throw(bufferOverrunException);
+
+    if (g_binlog.fileDescriptor < 0)
+        mri_memcpy(g_binlog.filename, pFilename, filenameLength + 1);
+    g_binlog.flags = BINLOG_FLAGS_RUNNING;
+}
+
+
+void BinLog_Stop(void)
+{
+    if (!BinLog_IsRunning())
+        return;
+    g_binlog.flags = BINLOG_FLAGS_STOP_REQUESTED;
+}
+
+
+int BinLog_IsRunning(void)
+{
+    return g_binlog.flags & BINLOG_FLAGS_RUNNING;
+}
+
+
+/* Space for each record is claimed with an atomic compare and swap so that interrupt handlers can log while the code
+   they interrupted is also logging. When the buffer is full, mriLogFlush() traps into the debug monitor to write it
+   out to the gdb host so, like the other semihost calls, it can't be called from handlers which run at a higher
+   priority than the debug monitor. */
+static uint8_t* claimRecord(uint32_t recordSize);
+static void     writeRecord(uint8_t* pRecord, const char* pFormat, uint32_t argCount, va_list args);
+void mriLogWrite(const char* pFormat, uint32_t argCount, ...)
+{
+    uint8_t* pRecord;
+    va_list  args;
+
+    if (!BinLog_IsRunning() || argCount > MRI_LOG_MAX_ARGUMENTS)
+        return;
+    pRecord = claimRecord(MRI_BINLOG_HEADER_SIZE + argCount * sizeof(uint32_t));
+    if (pRecord == NULL)
+        return;
+
+    va_start(args, argCount);
+    writeRecord(pRecord, pFormat, argCount, args);
+    va_end(args);
+}
+
+static uint8_t* claimRecord(uint32_t recordSize)
+{
+    uint32_t offset;
+
+    for (;;)
+    {
+        offset = g_binlog.used;
+        if (offset + recordSize > g_binlog.bufferSize)
+        {
+            mriLogFlush();
+            if (!BinLog_IsRunning())
+                return NULL;
+        }
+        else if (__sync_bool_compare_and_swap(&g_binlog.used, offset, offset + recordSize))
+        {
+            return g_binlog.pBuffer + offset;
+        }
+    }
+}
+
+static void writeRecord(uint8_t* pRecord, const char* pFormat, uint32_t argCount, va_list args)
+{
+    uint32_t formatAddress = (uint32_t)(uintptr_t)pFormat;
+    uint8_t  count = (uint8_t)argCount;
+
+    mri_memcpy(pRecord, &formatAddress, sizeof(formatAddress));
+    pRecord += sizeof(formatAddress);
+    mri_memcpy(pRecord, &count, sizeof(count));
+    pRecord += sizeof(count);
+    while (argCount-- > 0)
+    {
+        uint32_t arg = va_arg(args, uint32_t);
+
+        mri_memcpy(pRecord, &arg, sizeof(arg));
+        pRecord += sizeof(arg);
+    }
+}
+
+
+/* Called from the debug monitor, both when the program asks for the buffer to be flushed and before reporting a stop
+   to gdb. Returns 0 if CTRL+C was pressed in gdb before the records could be written. */
+static int writeBufferToFile(void);
+int BinLog_Flush(void)
+{
+    int wasCompleted;
+
+    if (g_binlog.used == 0 || (g_binlog.flags & (BINLOG_FLAGS_RUNNING | BINLOG_FLAGS_STOP_REQUESTED)) == 0)
+        return 1;
+
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = writeBufferToFile();
+    SetIssuingFileIOForDebugger(0);
+
+    return wasCompleted;
+}
+
+static int openFileIfNeeded(void);
+static int writeBufferToFile(void)
+{
+    TransferParameters writeParameters;
+    int                wasOpened;
+
+    wasOpened = openFileIfNeeded();
+    if (!wasOpened || g_binlog.fileDescriptor < 0)
+        return wasOpened;
+
+    writeParameters.fileDescriptor = g_binlog.fileDescriptor;
+    writeParameters.bufferAddress = (uint32_t)(uintptr_t)g_binlog.pBuffer;
+    writeParameters.bufferSize = g_binlog.used;
+    if (!IssueGdbFileWriteRequest(&writeParameters))
+        return 0;
+    if (GetSemihostReturnCode() != (int)g_binlog.used)
+        WriteStringToGdbConsole("Failed to write log output file.\r\n");
+    g_binlog.used = 0;
+
+    return 1;
+}
+
+static int openFileIfNeeded(void)
+{
+    OpenParameters openParameters;
+
+    if (g_binlog.fileDescriptor >= 0)
+        return 1;
+
+    openParameters.filenameAddress = (uint32_t)(uintptr_t)g_binlog.filename;
+    openParameters.filenameLength = mri_strlen(g_binlog.filename) + 1;
+    openParameters.flags = GDB_O_WRONLY | GDB_O_CREAT | GDB_O_TRUNC;
+    openParameters.mode = GDB_S_IRUSR | GDB_S_IWUSR | GDB_S_IRGRP | GDB_S_IROTH;
+    if (!IssueGdbFileOpenRequest(&openParameters))
+        return 0;
+    g_binlog.fileDescriptor = GetSemihostReturnCode();
+    if (g_binlog.fileDescriptor < 0)
+    {
+        WriteStringToGdbConsole("Failed to open log output file.\r\n");
+        g_binlog.fileDescriptor = -1;
+        g_binlog.flags = 0;
+        g_binlog.used = 0;
+    }
+
+    return 1;
+}
+
+
+/* Called as the program is being resumed after "monitor log stop" to write out the last of the records and close
+   the log file. Returns 0 if CTRL+C was pressed in gdb before this could be completed. */
+int BinLog_CompleteRequestedStop(void)
+{
+    int wasCompleted = 1;
+
+    if ((g_binlog.flags & BINLOG_FLAGS_STOP_REQUESTED) == 0)
+        return 1;
+
+    SetIssuingFileIOForDebugger(1);
+    if (g_binlog.used > 0)
+        wasCompleted = writeBufferToFile();
+    if (g_binlog.fileDescriptor >= 0)
+        wasCompleted = IssueGdbFileCloseRequest(g_binlog.fileDescriptor) && wasCompleted;
+    SetIssuingFileIOForDebugger(0);
+    BinLog_Reset();
+
+    return wasCompleted;
+}
@@ -0,0 +1,44 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Deferred formatting log whose records are streamed in binary to a file on the gdb host. */
+#ifndef BINLOG_H_
+#define BINLOG_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Each record in the log file is the 32-bit address of the format string, a 1-byte count of arguments, and then
+   each of the 32-bit arguments. All fields are little endian and records are packed with no padding. The format
+   strings are placed in the .mri_log section of the program's ELF file by MRI_LOG_FORMAT() so the host looks up each
+   address there to format the record. */
+#define MRI_BINLOG_HEADER_SIZE      (sizeof(uint32_t) + sizeof(uint8_t))
+
+/* Real name of functions are in mri namespace. */
+void          mriBinLog_Reset(void);
+__throws void mriBinLog_Start(const char* pFilename);
+void          mriBinLog_Stop(void);
+int           mriBinLog_IsRunning(void);
+int           mriBinLog_Flush(void);
+int           mriBinLog_CompleteRequestedStop(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define BinLog_Reset                    mriBinLog_Reset
+#define BinLog_Start                    mriBinLog_Start
+#define BinLog_Stop                     mriBinLog_Stop
+#define BinLog_IsRunning                mriBinLog_IsRunning
+#define BinLog_Flush                    mriBinLog_Flush
+#define BinLog_CompleteRequestedStop    mriBinLog_CompleteRequestedStop
+
+#endif /* BINLOG_H_ */
@@ -13,12 +13,25 @@
    limitations under the License.
 */
 /* Handlers for gdb breakpoint and watchpoint commands. */
+#include <core/libc.h>
 #include <core/platforms.h>
 #include <core/core.h>
 #include <core/mri.h>
+#include <core/agent.h>
+#include <core/record.h>
 #include <core/cmd_common.h>
 #include <core/cmd_break_watch.h>
 
+
+/* The number of breakpoints which can have target side commands attached and the number of bytes available to each
+   for storing its agent expression bytecode. */
+#ifndef MRI_BREAKPOINT_COMMANDS_COUNT
+    #define MRI_BREAKPOINT_COMMANDS_COUNT   4
+#endif
+#ifndef MRI_BREAKPOINT_COMMANDS_SIZE
+    #define MRI_BREAKPOINT_COMMANDS_SIZE    128
+#endif
+
 typedef struct
 {
     uint32_t address;
@@ -26,13 +39,44 @@ typedef struct
     char     type;
 } BreakpointWatchpointArguments;
 
+/* Each agent expression is stored in BreakpointCommands::bytecode as a 2-byte length followed by its bytecode. */
+typedef struct
+{
+    uint8_t  bytecode[MRI_BREAKPOINT_COMMANDS_SIZE];
+    uint32_t address;
+    uint32_t length;
+} BreakpointCommands;
+
+/* The number of watchpoint addresses which can have a data value match condition attached with the "monitor
+   watchvalue" command. The number of these which can be active at once is also limited by the hardware. */
+#ifndef MRI_WATCHPOINT_VALUE_COUNT
+    #define MRI_WATCHPOINT_VALUE_COUNT      2
+#endif
+
+/* Flag bits used in WatchpointValue::flags. An entry is free when no flags are set. */
+#define WATCHPOINT_VALUE_VALID  (1 << 0)
+#define WATCHPOINT_VALUE_ARMED  (1 << 1)
+
+/* armedValue is the value which was programmed into the hardware when gdb last inserted the watchpoint so that it can
+   be removed even if the value condition was changed in the meantime. */
+typedef struct
+{
+    uint32_t address;
+    uint32_t value;
+    uint32_t armedValue;
+    uint32_t flags;
+} WatchpointValue;
+
+static BreakpointCommands g_breakpointCommands[MRI_BREAKPOINT_COMMANDS_COUNT];
+static WatchpointValue    g_watchpointValues[MRI_WATCHPOINT_VALUE_COUNT];
+
 static void parseBreakpointWatchpointCommandArguments(BreakpointWatchpointArguments* pArguments);
 static void handleHardwareBreakpointSetCommand(BreakpointWatchpointArguments* pArguments);
 static void handleBreakpointWatchpointException(void);
 static void handleWatchpointSetCommand(PlatformWatchpointType type, BreakpointWatchpointArguments* pArguments);
 /* Handle the '"Z*" commands used by gdb to set hardware breakpoints/watchpoints.
 
-    Command Format:     Z*,AAAAAAAA,K
+    Command Format:     Z*,AAAAAAAA,K[;cmds:P,XLLLL,xx...]
     Response Format:    OK
     Where * is 1 for hardware breakpoint.
                2 for write watchpoint.
@@ -43,6 +87,10 @@ static void handleWatchpointSetCommand(PlatformWatchpointType type, BreakpointWa
                       3: 32-bit Thumb2 instruction.
                       4: 32-bit ARM insruction.
                       value: byte size for data watchpoint.
+          P is the persist flag for the breakpoint commands which is ignored.
+          XLLLL,xx... is an agent expression of LLLL bytes to be run on the target each time that the hardware
+          breakpoint is hit. There can be more than one. Breakpoints with commands don't halt in gdb, they run the
+          commands and then resume execution.
 */
 uint32_t HandleBreakpointWatchpointSetCommand(void)
 {
@@ -104,20 +152,147 @@ static void parseBreakpointWatchpointCommandArguments(BreakpointWatchpointArgume
     }
 }
 
+static void parseBreakpointCommands(BreakpointCommands* pCommands);
+static void throwIfNoRoomForBreakpointCommands(uint32_t address, BreakpointCommands* pCommands);
+static BreakpointCommands* findBreakpointCommands(uint32_t address);
+static BreakpointCommands* allocateBreakpointCommands(void);
+static void freeBreakpointCommands(uint32_t address);
 static void handleHardwareBreakpointSetCommand(BreakpointWatchpointArguments* pArguments)
 {
+    BreakpointCommands commands;
+
     __try
     {
-        Platform_SetHardwareBreakpointOfGdbKind(pArguments->address, pArguments->kind);
+        __throwing_func( parseBreakpointCommands(&commands) );
+        __throwing_func( throwIfNoRoomForBreakpointCommands(pArguments->address, &commands) );
+        __throwing_func( Platform_SetHardwareBreakpointOfGdbKind(pArguments->address, pArguments->kind) );
     }
     __catch
     {
         handleBreakpointWatchpointException();
         return;
     }
+
+    /* Setting a breakpoint again replaces any commands previously attached to it. */
+    freeBreakpointCommands(pArguments->address);
+    Record_ClearBreakpoint(pArguments->address);
+    if (commands.length > 0)
+    {
+        commands.address = pArguments->address;
+        *allocateBreakpointCommands() = commands;
+    }
+    else
+    {
+        /* Reverse continue should stop when it backs up onto a breakpoint that would halt the program going forward. */
+        Record_SetBreakpoint(pArguments->address);
+    }
     PrepareStringResponse("OK");
 }
 
+static void parseAgentExpression(Buffer* pBuffer, BreakpointCommands* pCommands);
+static void parseBreakpointCommands(BreakpointCommands* pCommands)
+{
+    Buffer*             pBuffer = GetBuffer();
+    static const char   commandsOption[] = "cmds";
+
+    pCommands->length = 0;
+    if (Buffer_BytesLeft(pBuffer) == 0)
+        return;
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ';') );
+        /* Target side conditions aren't supported so the only expected option is the command list. */
+        if (!Buffer_MatchesString(pBuffer, commandsOption, sizeof(commandsOption)-1))
+            __throw(invalidArgumentException);
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+        while (Buffer_BytesLeft(pBuffer) > 0)
+        {
+            __throwing_func( parseAgentExpression(pBuffer, pCommands) );
+        }
+    }
+    __catch
+    {
+        __rethrow;
+    }
+}
+
+static void parseAgentExpression(Buffer* pBuffer, BreakpointCommands* pCommands)
+{
+    uint8_t* pDest;
+    uint32_t length;
+    uint16_t storedLength;
+    uint32_t i;
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, 'X') );
+        __throwing_func( length = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    if (pCommands->length + sizeof(storedLength) + length > MRI_BREAKPOINT_COMMANDS_SIZE)
+        __throw(bufferOverrunException);
+
+    storedLength = length;
+    pDest = &pCommands->bytecode[pCommands->length];
+    mri_memcpy(pDest, &storedLength, sizeof(storedLength));
+    pDest += sizeof(storedLength);
+    for (i = 0 ; i < length ; i++)
+    {
+        __try
+            *pDest++ = Buffer_ReadByteAsHex(pBuffer);
+        __catch
+            __throw(invalidArgumentException);
+    }
+    pCommands->length += sizeof(storedLength) + length;
+}
+
+static void throwIfNoRoomForBreakpointCommands(uint32_t address, BreakpointCommands* pCommands)
+{
+    if (pCommands->length > 0 && !findBreakpointCommands(address) && !allocateBreakpointCommands())
+        __throw(exceededHardwareResourcesException);
+}
+
+static BreakpointCommands* findBreakpointCommands(uint32_t address)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_BREAKPOINT_COMMANDS_COUNT ; i++)
+    {
+        BreakpointCommands* pCommands = &g_breakpointCommands[i];
+        if (pCommands->length > 0 && pCommands->address == address)
+            return pCommands;
+    }
+    return NULL;
+}
+
+static BreakpointCommands* allocateBreakpointCommands(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_BREAKPOINT_COMMANDS_COUNT ; i++)
+    {
+        BreakpointCommands* pCommands = &g_breakpointCommands[i];
+        if (pCommands->length == 0)
+            return pCommands;
+    }
+    return NULL;
+}
+
+static void freeBreakpointCommands(uint32_t address)
+{
+    BreakpointCommands* pCommands = findBreakpointCommands(address);
+
+    if (pCommands)
+        pCommands->length = 0;
+}
+
 static void handleBreakpointWatchpointException(void)
 {
     switch(getExceptionCode())
@@ -125,6 +300,9 @@ static void handleBreakpointWatchpointException(void)
     case invalidArgumentException:
         PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
         break;
+    case bufferOverrunException:
+        PrepareStringResponse(MRI_ERROR_BUFFER_OVERRUN);
+        break;
     case exceededHardwareResourcesException:
     default:
         PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
@@ -134,23 +312,47 @@ static void handleBreakpointWatchpointException(void)
     return;
 }
 
+static WatchpointValue* findWatchpointValue(uint32_t address);
 static void handleWatchpointSetCommand(PlatformWatchpointType type, BreakpointWatchpointArguments* pArguments)
 {
-    uint32_t        address = pArguments->address;
-    uint32_t        size = pArguments->kind;
+    uint32_t         address = pArguments->address;
+    uint32_t         size = pArguments->kind;
+    WatchpointValue* pValue = findWatchpointValue(address);
+    int              useValueMatch = pValue && (pValue->flags & WATCHPOINT_VALUE_VALID);
 
     __try
     {
-        Platform_SetHardwareWatchpoint(address, size, type);
+        if (useValueMatch)
+            Platform_SetHardwareValueWatchpoint(address, size, pValue->value, type);
+        else
+            Platform_SetHardwareWatchpoint(address, size, type);
     }
     __catch
     {
         handleBreakpointWatchpointException();
         return;
     }
+    if (useValueMatch)
+    {
+        pValue->armedValue = pValue->value;
+        pValue->flags |= WATCHPOINT_VALUE_ARMED;
+    }
     PrepareStringResponse("OK");
 }
 
+static WatchpointValue* findWatchpointValue(uint32_t address)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_WATCHPOINT_VALUE_COUNT ; i++)
+    {
+        WatchpointValue* pValue = &g_watchpointValues[i];
+        if (pValue->flags != 0 && pValue->address == address)
+            return pValue;
+    }
+    return NULL;
+}
+
 
 static void handleHardwareBreakpointRemoveCommand(BreakpointWatchpointArguments* pArguments);
 static void handleWatchpointRemoveCommand(PlatformWatchpointType type, BreakpointWatchpointArguments* pArguments);
@@ -215,22 +417,133 @@ static void handleHardwareBreakpointRemoveCommand(BreakpointWatchpointArguments*
         handleBreakpointWatchpointException();
         return;
     }
+    freeBreakpointCommands(pArguments->address);
+    Record_ClearBreakpoint(pArguments->address);
     PrepareStringResponse("OK");
 }
 
 static void handleWatchpointRemoveCommand(PlatformWatchpointType type, BreakpointWatchpointArguments* pArguments)
 {
-    uint32_t        address = pArguments->address;
-    uint32_t        size = pArguments->kind;
+    uint32_t         address = pArguments->address;
+    uint32_t         size = pArguments->kind;
+    WatchpointValue* pValue = findWatchpointValue(address);
+    int              isValueMatch = pValue && (pValue->flags & WATCHPOINT_VALUE_ARMED);
 
     __try
     {
-        Platform_ClearHardwareWatchpoint(address, size, type);
+        if (isValueMatch)
+            Platform_ClearHardwareValueWatchpoint(address, size, pValue->armedValue, type);
+        else
+            Platform_ClearHardwareWatchpoint(address, size, type);
     }
     __catch
     {
         handleBreakpointWatchpointException();
         return;
     }
+    if (isValueMatch)
+        pValue->flags &= ~WATCHPOINT_VALUE_ARMED;
     PrepareStringResponse("OK");
 }
+
+
+static WatchpointValue* allocateWatchpointValue(void);
+/* Called from the "monitor watchvalue" command to make data watchpoints subsequently set by gdb at this address only
+   trigger when the specified value is accessed. Throws exceededHardwareResourcesException if there are no free
+   entries. */
+void SetWatchpointValue(uint32_t address, uint32_t value)
+{
+    WatchpointValue* pValue = findWatchpointValue(address);
+
+    if (!pValue)
+        pValue = allocateWatchpointValue();
+    if (!pValue)
+        __throw(exceededHardwareResourcesException);
+
+    pValue->address = address;
+    pValue->value = value;
+    pValue->flags |= WATCHPOINT_VALUE_VALID;
+}
+
+
+static WatchpointValue* allocateWatchpointValue(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_WATCHPOINT_VALUE_COUNT ; i++)
+    {
+        WatchpointValue* pValue = &g_watchpointValues[i];
+        if (pValue->flags == 0)
+            return pValue;
+    }
+    return NULL;
+}
+
+
+/* Called from the "monitor watchvalue" command to remove the value condition from watchpoints at this address. */
+void ClearWatchpointValue(uint32_t address)
+{
+    WatchpointValue* pValue = findWatchpointValue(address);
+
+    if (pValue)
+        pValue->flags &= ~WATCHPOINT_VALUE_VALID;
+}
+
+
+static void runAgentExpressions(BreakpointCommands* pCommands);
+/* Called from mriDebugException() to run the commands attached to a hardware breakpoint by gdb.
+
+   Returns non-zero if the commands were run and the program has been set up to resume execution without halting in
+   gdb. Returns 0 if this wasn't a breakpoint with commands or the commands failed to run, in which case the debug
+   exception should be reported to gdb as usual.
+*/
+int RunBreakpointCommands(void)
+{
+    uint32_t            pc = Platform_GetProgramCounter() & ~1;
+    BreakpointCommands* pCommands;
+
+    if (Platform_GetTrapReason().type != MRI_PLATFORM_TRAP_TYPE_HWBREAK)
+        return 0;
+    pCommands = findBreakpointCommands(pc);
+    if (!pCommands)
+        return 0;
+
+    __try
+    {
+        runAgentExpressions(pCommands);
+    }
+    __catch
+    {
+        clearExceptionCode();
+        return 0;
+    }
+    StepOverHardwareBreakpoint(pc);
+    return 1;
+}
+
+static void runAgentExpressions(BreakpointCommands* pCommands)
+{
+    uint8_t* pCurr = pCommands->bytecode;
+    uint8_t* pEnd = pCommands->bytecode + pCommands->length;
+
+    while (pCurr < pEnd)
+    {
+        uint16_t length;
+
+        mri_memcpy(&length, pCurr, sizeof(length));
+        pCurr += sizeof(length);
+        __try
+            Agent_RunExpression(pCurr, length);
+        __catch
+            __rethrow;
+        pCurr += length;
+    }
+}
+
+
+/* Discard all breakpoint commands and watchpoint value conditions. Called when MRI is initialized. */
+void ClearBreakpointCommands(void)
+{
+    mri_memset(g_breakpointCommands, 0, sizeof(g_breakpointCommands));
+    mri_memset(g_watchpointValues, 0, sizeof(g_watchpointValues));
+}
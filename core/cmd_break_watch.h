@@ -17,13 +17,22 @@
 #define CMD_BREAK_WATCH_H_
 
 #include <stdint.h>
+#include <core/try_catch.h>
 
 /* Real name of functions are in mri namespace. */
-uint32_t mriCmd_HandleBreakpointWatchpointSetCommand(void);
-uint32_t mriCmd_HandleBreakpointWatchpointRemoveCommand(void);
+uint32_t          mriCmd_HandleBreakpointWatchpointSetCommand(void);
+uint32_t          mriCmd_HandleBreakpointWatchpointRemoveCommand(void);
+int               mriCmd_RunBreakpointCommands(void);
+void              mriCmd_ClearBreakpointCommands(void);
+__throws void     mriCmd_SetWatchpointValue(uint32_t address, uint32_t value);
+void              mriCmd_ClearWatchpointValue(uint32_t address);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
 #define HandleBreakpointWatchpointSetCommand    mriCmd_HandleBreakpointWatchpointSetCommand
 #define HandleBreakpointWatchpointRemoveCommand mriCmd_HandleBreakpointWatchpointRemoveCommand
+#define RunBreakpointCommands                   mriCmd_RunBreakpointCommands
+#define ClearBreakpointCommands                 mriCmd_ClearBreakpointCommands
+#define SetWatchpointValue                      mriCmd_SetWatchpointValue
+#define ClearWatchpointValue                    mriCmd_ClearWatchpointValue
 
 #endif /* CMD_BREAK_WATCH_H_ */
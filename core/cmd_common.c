@@ -13,6 +13,7 @@
    limitations under the License.
 */
 /* Common functionality shared between gdb command handlers in mri. */
+#include <core/libc.h>
 #include <core/cmd_common.h>
 
 
@@ -63,3 +64,148 @@ void ThrowIfNextCharIsNotEqualTo(Buffer* pBuffer, char thisChar)
     if (!Buffer_IsNextCharEqualTo(pBuffer, thisChar))
         __throw(invalidArgumentException);
 }
+
+
+/* The text after a "monitor" command name is sent by gdb as hex encoded ASCII. This converts the rest of pBuffer into
+   plain text in place so that the arguments can be parsed with the ReadMonitor*Argument() routines. The packet buffer
+   is reused for the text so all arguments must be parsed before any response is written into it. */
+void ConvertMonitorArgumentsToText(Buffer* pBuffer)
+{
+    char* pText = pBuffer->pCurrent;
+    char* pDest = pText;
+
+    while (Buffer_BytesLeft(pBuffer) > 0)
+    {
+        __try
+            *pDest++ = (char)Buffer_ReadByteAsHex(pBuffer);
+        __catch
+            __throw(invalidArgumentException);
+    }
+    Buffer_Init(pBuffer, pText, pDest - pText);
+}
+
+
+static void skipSpaces(Buffer* pBuffer);
+int HasMoreMonitorArguments(Buffer* pBuffer)
+{
+    skipSpaces(pBuffer);
+    return Buffer_BytesLeft(pBuffer) > 0;
+}
+
+static void skipSpaces(Buffer* pBuffer)
+{
+    while (Buffer_BytesLeft(pBuffer) > 0 && *pBuffer->pCurrent == ' ')
+        Buffer_Advance(pBuffer, 1);
+}
+
+
+void ThrowIfMoreMonitorArguments(Buffer* pBuffer)
+{
+    if (HasMoreMonitorArguments(pBuffer))
+        __throw(invalidArgumentException);
+}
+
+
+static int  isNextMonitorArgumentHex(Buffer* pBuffer);
+static int  digitValue(char digit, uint32_t base);
+static int  isEndOfMonitorArgument(Buffer* pBuffer);
+/* Reads a space separated integer argument from a monitor command which has been converted to text by
+   ConvertMonitorArgumentsToText(). Numbers prefixed with 0x are hexadecimal and all others are decimal. A leading '-'
+   is allowed and results in the two's complement of the value being returned. */
+uintmri_t ReadMonitorUIntegerArgument(Buffer* pBuffer)
+{
+    uintmri_t value = 0;
+    uint32_t  base = 10;
+    int       isNegative = 0;
+    int       digitCount = 0;
+
+    skipSpaces(pBuffer);
+    if (Buffer_BytesLeft(pBuffer) > 0 && *pBuffer->pCurrent == '-')
+    {
+        isNegative = 1;
+        Buffer_Advance(pBuffer, 1);
+    }
+    if (isNextMonitorArgumentHex(pBuffer))
+    {
+        base = 16;
+        Buffer_Advance(pBuffer, 2);
+    }
+    while (!isEndOfMonitorArgument(pBuffer))
+    {
+        int digit = digitValue(*pBuffer->pCurrent, base);
+        if (digit < 0)
+            __throw_and_return(invalidArgumentException, 0);
+        value = value * base + digit;
+        digitCount++;
+        Buffer_Advance(pBuffer, 1);
+    }
+    if (digitCount == 0)
+        __throw_and_return(invalidArgumentException, 0);
+
+    return isNegative ? (uintmri_t)(0 - value) : value;
+}
+
+static int isNextMonitorArgumentHex(Buffer* pBuffer)
+{
+    return Buffer_BytesLeft(pBuffer) >= 2 &&
+           pBuffer->pCurrent[0] == '0' &&
+           (pBuffer->pCurrent[1] == 'x' || pBuffer->pCurrent[1] == 'X');
+}
+
+static int digitValue(char digit, uint32_t base)
+{
+    int value;
+
+    if (digit >= '0' && digit <= '9')
+        value = digit - '0';
+    else if (digit >= 'a' && digit <= 'f')
+        value = digit - 'a' + 10;
+    else if (digit >= 'A' && digit <= 'F')
+        value = digit - 'A' + 10;
+    else
+        return -1;
+
+    return value < (int)base ? value : -1;
+}
+
+static int isEndOfMonitorArgument(Buffer* pBuffer)
+{
+    return Buffer_BytesLeft(pBuffer) == 0 || *pBuffer->pCurrent == ' ';
+}
+
+
+/* Returns non-zero and advances past the next space separated monitor argument if it exactly matches pArgument. The
+   buffer is left untouched if it doesn't match. */
+int MatchesMonitorArgument(Buffer* pBuffer, const char* pArgument)
+{
+    size_t argumentLength = mri_strlen(pArgument);
+
+    skipSpaces(pBuffer);
+    if (Buffer_BytesLeft(pBuffer) < argumentLength ||
+        mri_strncmp(pBuffer->pCurrent, pArgument, argumentLength) != 0 ||
+        (Buffer_BytesLeft(pBuffer) > argumentLength && pBuffer->pCurrent[argumentLength] != ' '))
+    {
+        return 0;
+    }
+    Buffer_Advance(pBuffer, argumentLength);
+    return 1;
+}
+
+
+/* Copies the next space separated monitor argument into pDest as a NULL terminated string. */
+void ReadMonitorStringArgument(Buffer* pBuffer, char* pDest, size_t destSize)
+{
+    size_t length = 0;
+
+    skipSpaces(pBuffer);
+    while (!isEndOfMonitorArgument(pBuffer))
+    {
+        if (length + 1 >= destSize)
+            __throw(bufferOverrunException);
+        pDest[length++] = *pBuffer->pCurrent;
+        Buffer_Advance(pBuffer, 1);
+    }
+    if (length == 0)
+        __throw(invalidArgumentException);
+    pDest[length] = '\0';
+}
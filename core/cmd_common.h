@@ -40,11 +40,23 @@ __throws void      mriCmd_ReadAddressAndLengthArguments(Buffer* pBuffer, Address
 __throws void      mriCmd_ReadAddressAndLengthArgumentsWithColon(Buffer* pBuffer, AddressLength* pArguments);
 __throws uintmri_t mriCmd_ReadUIntegerArgument(Buffer* pBuffer);
 __throws void      mriCmd_ThrowIfNextCharIsNotEqualTo(Buffer* pBuffer, char thisChar);
+__throws void      mriCmd_ConvertMonitorArgumentsToText(Buffer* pBuffer);
+int                mriCmd_HasMoreMonitorArguments(Buffer* pBuffer);
+__throws void      mriCmd_ThrowIfMoreMonitorArguments(Buffer* pBuffer);
+__throws uintmri_t mriCmd_ReadMonitorUIntegerArgument(Buffer* pBuffer);
+int                mriCmd_MatchesMonitorArgument(Buffer* pBuffer, const char* pArgument);
+__throws void      mriCmd_ReadMonitorStringArgument(Buffer* pBuffer, char* pDest, size_t destSize);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
 #define ReadAddressAndLengthArguments           mriCmd_ReadAddressAndLengthArguments
 #define ReadAddressAndLengthArgumentsWithColon  mriCmd_ReadAddressAndLengthArgumentsWithColon
 #define ReadUIntegerArgument                    mriCmd_ReadUIntegerArgument
 #define ThrowIfNextCharIsNotEqualTo             mriCmd_ThrowIfNextCharIsNotEqualTo
+#define ConvertMonitorArgumentsToText           mriCmd_ConvertMonitorArgumentsToText
+#define HasMoreMonitorArguments                 mriCmd_HasMoreMonitorArguments
+#define ThrowIfMoreMonitorArguments             mriCmd_ThrowIfMoreMonitorArguments
+#define ReadMonitorUIntegerArgument             mriCmd_ReadMonitorUIntegerArgument
+#define MatchesMonitorArgument                  mriCmd_MatchesMonitorArgument
+#define ReadMonitorStringArgument               mriCmd_ReadMonitorStringArgument
 
 #endif /* CMD_COMMON_H_ */
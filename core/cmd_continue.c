@@ -19,6 +19,11 @@
 #include <core/mri.h>
 #include <core/cmd_common.h>
 #include <core/cmd_continue.h>
+#include <core/profile.h>
+#include <core/coredump.h>
+#include <core/snapshot.h>
+#include <core/binlog.h>
+#include <core/record.h>
 
 
 static int shouldSkipHardcodedBreakpoint(void);
@@ -129,6 +134,14 @@ uint32_t HandleDetachCommand(void)
     if (Platform_RtosIsSetThreadStateSupported())
         Platform_RtosSetThreadState(MRI_PLATFORM_ALL_THREADS, MRI_PLATFORM_THREAD_THAWED);
     SkipHardcodedBreakpoint();
+    /* gdb won't be around to service the File-I/O requests needed to transfer a pending profile dump, core dump,
+       snapshot or log. */
+    Profile_CancelDump();
+    Coredump_Cancel();
+    Snapshot_Cancel();
+    BinLog_Reset();
+    /* Stop single stepping every instruction once there is no debugger left to reverse through them. */
+    Record_Reset();
     PrepareStringResponse("OK");
     return HANDLER_RETURN_RESUME_PROGRAM;
 }
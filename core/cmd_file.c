@@ -241,6 +241,28 @@ int IssueGdbFileRenameRequest(const RenameParameters* pParameters)
 }
 
 
+/* Send gettimeofday request to gdb on behalf of the debugger's semi-hosting time keeping.
+
+    Data Format: Fgettimeofday,tt,zz
+
+    Where tt is the hex representation of the address of the GdbTimeVal structure to be filled in.
+          zz is the timezone pointer which gdb requires to be 0.
+*/
+int IssueGdbGetTimeOfDayRequest(uint32_t timeValBuffer)
+{
+    static const char  gdbGetTimeOfDayCommand[] = "Fgettimeofday,";
+    Buffer*            pBuffer = GetInitializedBuffer();
+
+    Buffer_WriteString(pBuffer, gdbGetTimeOfDayCommand);
+    Buffer_WriteUIntegerAsHex(pBuffer, timeValBuffer);
+    Buffer_WriteChar(pBuffer, ',');
+    Buffer_WriteUIntegerAsHex(pBuffer, 0);
+
+    SendPacketToGdb();
+    return processGdbFileResponseCommands();
+}
+
+
 /* Handle the 'F' command which is sent from gdb in response to a previously sent File I/O command from mri.
 
     Command Format:     Frr[,ee[,C]]
@@ -272,6 +294,7 @@ uint32_t HandleFileIOCommand(void)
     return (HANDLER_RETURN_RESUME_PROGRAM | HANDLER_RETURN_RETURN_IMMEDIATELY);
 }
 
+static void flagSemihostCallAsHandled(void);
 static int processGdbFileResponseCommands(void)
 {
     GdbCommandHandlingLoop();
@@ -279,14 +302,21 @@ static int processGdbFileResponseCommands(void)
     if (WasControlCFlagSentFromGdb())
     {
         if (!WasSemihostCallCancelledByGdb())
-            FlagSemihostCallAsHandled();
+            flagSemihostCallAsHandled();
 
         SetSignalValue(SIGINT);
         return 0;
     }
     else
     {
-        FlagSemihostCallAsHandled();
+        flagSemihostCallAsHandled();
         return 1;
     }
 }
+
+static void flagSemihostCallAsHandled(void)
+{
+    /* File I/O issued by the debugger itself (rather than a semihost call from the program) doesn't advance the PC. */
+    if (!IsIssuingFileIOForDebugger())
+        FlagSemihostCallAsHandled();
+}
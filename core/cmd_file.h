@@ -72,6 +72,7 @@ int      mriIssueGdbFileFStatRequest(uint32_t fileDescriptor, uint32_t fileStatB
 int      mriIssueGdbFileUnlinkRequest(const RemoveParameters* pParameters);
 int      mriIssueGdbFileStatRequest(const StatParameters* pParameters);
 int      mriIssueGdbFileRenameRequest(const RenameParameters* pParameters);
+int      mriIssueGdbGetTimeOfDayRequest(uint32_t timeValBuffer);
 uint32_t mriHandleFileIOCommand(void);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
@@ -84,6 +85,7 @@ uint32_t mriHandleFileIOCommand(void);
 #define IssueGdbFileUnlinkRequest   mriIssueGdbFileUnlinkRequest
 #define IssueGdbFileStatRequest     mriIssueGdbFileStatRequest
 #define IssueGdbFileRenameRequest   mriIssueGdbFileRenameRequest
+#define IssueGdbGetTimeOfDayRequest mriIssueGdbGetTimeOfDayRequest
 #define HandleFileIOCommand         mriHandleFileIOCommand
 
 #endif /* CMD_FILE_H_ */
@@ -20,6 +20,7 @@
 #include <core/memory.h>
 #include <core/cmd_common.h>
 #include <core/cmd_memory.h>
+#include <core/cmd_trace.h>
 
 
 /* Handle the 'm' command which is to read the specified address range from memory.
@@ -38,6 +39,9 @@ uint32_t HandleMemoryReadCommand(void)
     AddressLength addressLength;
     uint32_t      result;
 
+    if (IsTraceFrameSelected())
+        return HandleTraceFrameMemoryReadCommand();
+
     __try
     {
         ReadAddressAndLengthArguments(pBuffer, &addressLength);
@@ -57,6 +61,52 @@ uint32_t HandleMemoryReadCommand(void)
 }
 
 
+/* Handle the 'x' command which is to read the specified address range from memory in binary.
+
+    Command Format:     xAAAAAAAA,LLLLLLLL
+    Response Format:    bxx...
+
+    Where AAAAAAAA is the hexadecimal representation of the address where the read is to start.
+          LLLLLLLL is the hexadecimal representation of the length (in bytes) of the read to be conducted.
+          xx is the first byte read from the specified location in escaped binary format.
+          ... continue returning as many of the rest of the LLLLLLLL-1 bytes as fit in the packet.
+
+    Binary data takes half the space of hex so gdb can pull nearly twice as much memory per packet, which matters
+    most for large semihost writes. gdb is sent an empty response while a trace frame is selected so that it falls
+    back to the 'm' command.
+*/
+uint32_t HandleBinaryMemoryReadCommand(void)
+{
+    Buffer*       pBuffer = GetBuffer();
+    AddressLength addressLength;
+    uint32_t      result;
+
+    if (IsTraceFrameSelected())
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+
+    __try
+    {
+        ReadAddressAndLengthArguments(pBuffer, &addressLength);
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    pBuffer = GetInitializedBuffer();
+    Buffer_WriteChar(pBuffer, 'b');
+    result = ReadMemoryIntoBinaryBuffer(pBuffer, addressLength.address, addressLength.length);
+    if (result == 0 && addressLength.length > 0)
+        PrepareStringResponse(MRI_ERROR_MEMORY_ACCESS_FAILURE);
+
+    return 0;
+}
+
+
 /* Handle the 'M' command which is to write to the specified address range in memory.
 
     Command Format:     MAAAAAAAA,LLLLLLLL:xx...
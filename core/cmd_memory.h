@@ -21,11 +21,13 @@
 /* Real name of functions are in mri namespace. */
 uint32_t mriCmd_HandleMemoryReadCommand(void);
 uint32_t mriCmd_HandleMemoryWriteCommand(void);
+uint32_t mriCmd_HandleBinaryMemoryReadCommand(void);
 uint32_t mriCmd_HandleBinaryMemoryWriteCommand(void);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
 #define HandleMemoryReadCommand         mriCmd_HandleMemoryReadCommand
 #define HandleMemoryWriteCommand        mriCmd_HandleMemoryWriteCommand
+#define HandleBinaryMemoryReadCommand   mriCmd_HandleBinaryMemoryReadCommand
 #define HandleBinaryMemoryWriteCommand  mriCmd_HandleBinaryMemoryWriteCommand
 
 #endif /* CMD_MEMORY_H_ */
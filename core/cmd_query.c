@@ -20,7 +20,23 @@
 #include <core/mri.h>
 #include <core/cmd_common.h>
 #include <core/cmd_query.h>
+#include <core/cmd_break_watch.h>
+#include <core/cmd_trace.h>
 #include <core/gdb_console.h>
+#include <core/profile.h>
+#include <core/timing.h>
+#include <core/perf.h>
+#include <core/irqstats.h>
+#include <core/sampler.h>
+#include <core/flight_recorder.h>
+#include <core/fault_capture.h>
+#include <core/binlog.h>
+#include <core/record.h>
+#include <core/coverage.h>
+#include <core/cpuload.h>
+#include <core/coredump.h>
+#include <core/snapshot.h>
+#include <core/backtrace.h>
 
 
 typedef struct
@@ -41,6 +57,13 @@ static void        validateAnnexIsNull(const char* pAnnex);
 static void        handleQueryTransferReadCommand(AnnexOffsetLength* pArguments);
 static uint32_t    handleQueryTransferFeaturesCommand(void);
 static void        validateAnnexIs(const char* pAnnex, const char* pExpected);
+static uint32_t    handleQueryTransferFlightRecorderCommand(void);
+static uint32_t    handleQueryTransferFaultCaptureCommand(void);
+static uint32_t    handleQueryTransferCoverageCommand(void);
+static uint32_t    handleQueryTransferBacktraceCommand(void);
+static void        handleQueryTransferBinaryReadCommand(const uint8_t* pData, uint32_t dataSize, AnnexOffsetLength* pArguments);
+static uint32_t    writeBinaryData(Buffer* pBuffer, const uint8_t* pData, uint32_t length);
+static int         isBinaryCharToEscape(uint8_t byte);
 static uint32_t    handleQueryFirstThreadInfoCommand(void);
 static uint32_t    handleQuerySubsequentThreadInfoCommand(void);
 static uint32_t    outputThreadIds(uint32_t threadId);
@@ -48,6 +71,18 @@ static uint32_t    handleQueryThreadExtraInfoCommand(void);
 static uint32_t    handleMonitorCommand(void);
 static uint32_t    handleMonitorResetCommand(void);
 static uint32_t    handleMonitorShowFaultCommand(void);
+static uint32_t    handleMonitorWatchValueCommand(void);
+static uint32_t    handleMonitorProfileCommand(void);
+static uint32_t    handleMonitorTimeCommand(void);
+static uint32_t    handleMonitorPerfCommand(void);
+static uint32_t    handleMonitorIrqStatsCommand(void);
+static uint32_t    handleMonitorSampleCommand(void);
+static uint32_t    handleMonitorLogCommand(void);
+static uint32_t    handleMonitorRecordCommand(void);
+static uint32_t    handleMonitorCoverageCommand(void);
+static uint32_t    handleMonitorCpuLoadCommand(void);
+static uint32_t    handleMonitorCoredumpCommand(void);
+static uint32_t    handleMonitorSnapshotCommand(void);
 static uint32_t    handleMonitorHelpCommand(void);
 /* Handle the 'q' command used by gdb to communicate state to debug monitor and vice versa.
 
@@ -63,6 +98,10 @@ uint32_t HandleQueryCommand(void)
     static const char   qsThreadInfo[] = "sThreadInfo";
     static const char   qThreadExtraInfo[] = "ThreadExtraInfo";
     static const char   qRcmdCommand[] = "Rcmd";
+    static const char   qTStatusCommand[] = "TStatus";
+    static const char   qTfPCommand[] = "TfP";
+    static const char   qTsPCommand[] = "TsP";
+    static const char   qTBufferCommand[] = "TBuffer";
 
     if (Buffer_MatchesString(pBuffer, qSupportedCommand, sizeof(qSupportedCommand)-1))
     {
@@ -88,6 +127,42 @@ uint32_t HandleQueryCommand(void)
     {
         return handleMonitorCommand();
     }
+    else if (Buffer_MatchesString(pBuffer, qTStatusCommand, sizeof(qTStatusCommand)-1))
+    {
+        return HandleTraceStatusQuery();
+    }
+    else if (Buffer_MatchesString(pBuffer, qTfPCommand, sizeof(qTfPCommand)-1))
+    {
+        return HandleTraceFirstTracepointQuery();
+    }
+    else if (Buffer_MatchesString(pBuffer, qTsPCommand, sizeof(qTsPCommand)-1))
+    {
+        return HandleTraceSubsequentTracepointQuery();
+    }
+    else if (Buffer_MatchesString(pBuffer, qTBufferCommand, sizeof(qTBufferCommand)-1))
+    {
+        return HandleTraceBufferQuery();
+    }
+    else
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+}
+
+/* Handle the 'Q' command used by gdb to set state in the debug monitor.
+
+    Command Format: QSSS
+    Where SSS is a variable length string indicating which set command is being sent to the stub.
+*/
+uint32_t HandleGeneralSetCommand(void)
+{
+    Buffer* pBuffer = GetBuffer();
+
+    if (Buffer_IsNextCharEqualTo(pBuffer, 'T'))
+    {
+        return HandleTraceSetCommand();
+    }
     else
     {
         PrepareEmptyResponseForUnknownCommand();
@@ -99,31 +174,69 @@ uint32_t HandleQueryCommand(void)
 
     Reponse Format: qXfer:memory-map:read+;PacketSize==SSSSSSSS
     Where SSSSSSSS is the hexadecimal representation of the maximum packet size support by this stub.
+    qXfer:mri-trace:read+ is only included once the program has provided a flight recorder buffer.
+    qXfer:mri-fault:read+ is only included when the fault capture buffer holds a captured fault.
+    qXfer:mri-coverage:read+ is only included once the program has provided a coverage buffer.
+    ReverseStep+;ReverseContinue+ are only included once the program has provided a record buffer.
+    Optional features are only included if they fit in the packet buffer along with the PacketSize entry. Update
+    MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE when adding to them.
 */
+static void writeOptionalSupport(Buffer* pBuffer, const char* pSupport, size_t supportLength);
 static uint32_t handleQuerySupportedCommand(void)
 {
-    static const char querySupportResponse[] = "qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;PacketSize=";
+    static const char querySupportResponse[] = "qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;";
+    static const char flightRecorderSupport[] = "qXfer:mri-trace:read+;";
+    static const char faultCaptureSupport[] = "qXfer:mri-fault:read+;";
+    static const char coverageSupport[] = "qXfer:mri-coverage:read+;";
+    static const char reverseSupport[] = "ReverseStep+;ReverseContinue+;";
+    static const char packetSizeSupport[] = "PacketSize=";
     /* Subtract 4 for packet overhead ('$', '#', and 2-byte checksum) as GDB doesn't count those bytes. */
     uint32_t          PacketSize = Platform_GetPacketBufferSize()-4;
     Buffer*           pBuffer = GetInitializedBuffer();
 
     Buffer_WriteString(pBuffer, querySupportResponse);
+    if (FlightRecorder_GetSize() > 0)
+        writeOptionalSupport(pBuffer, flightRecorderSupport, sizeof(flightRecorderSupport)-1);
+    if (FaultCapture_GetSize() > 0)
+        writeOptionalSupport(pBuffer, faultCaptureSupport, sizeof(faultCaptureSupport)-1);
+    if (Coverage_HasBuffer())
+        writeOptionalSupport(pBuffer, coverageSupport, sizeof(coverageSupport)-1);
+    if (Record_HasBuffer())
+        writeOptionalSupport(pBuffer, reverseSupport, sizeof(reverseSupport)-1);
+    Buffer_WriteString(pBuffer, packetSizeSupport);
     Buffer_WriteUIntegerAsHex(pBuffer, PacketSize);
 
     return 0;
 }
 
+static void writeOptionalSupport(Buffer* pBuffer, const char* pSupport, size_t supportLength)
+{
+    /* Always leave room for the "PacketSize=" entry and up to 8 hex digits of size after it. */
+    if (Buffer_BytesLeft(pBuffer) < supportLength + sizeof("PacketSize=")-1 + 8)
+        return;
+    Buffer_WriteString(pBuffer, pSupport);
+}
+
 /* Handle the "qXfer" command used by gdb to transfer data to and from the stub for special functionality.
 
     Command Format: qXfer:object:read:annex:offset,length
     Where supported objects are currently:
         memory-map
+        features
+        mri-trace
+        mri-fault
+        mri-coverage
+        mri-backtrace
 */
 static uint32_t handleQueryTransferCommand(void)
 {
     Buffer*             pBuffer =GetBuffer();
     static const char   memoryMapObject[] = "memory-map";
     static const char   featureObject[] = "features";
+    static const char   flightRecorderObject[] = "mri-trace";
+    static const char   faultCaptureObject[] = "mri-fault";
+    static const char   coverageObject[] = "mri-coverage";
+    static const char   backtraceObject[] = "mri-backtrace";
 
     if (!Buffer_IsNextCharEqualTo(pBuffer, ':'))
     {
@@ -139,6 +252,22 @@ static uint32_t handleQueryTransferCommand(void)
     {
         return handleQueryTransferFeaturesCommand();
     }
+    else if (Buffer_MatchesString(pBuffer, flightRecorderObject, sizeof(flightRecorderObject)-1))
+    {
+        return handleQueryTransferFlightRecorderCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, faultCaptureObject, sizeof(faultCaptureObject)-1))
+    {
+        return handleQueryTransferFaultCaptureCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, coverageObject, sizeof(coverageObject)-1))
+    {
+        return handleQueryTransferCoverageCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, backtraceObject, sizeof(backtraceObject)-1))
+    {
+        return handleQueryTransferBacktraceCommand();
+    }
     else
     {
         PrepareEmptyResponseForUnknownCommand();
@@ -299,6 +428,204 @@ static void validateAnnexIs(const char* pAnnex, const char* pExpected)
         __throw(invalidArgumentException);
 }
 
+/* Handle the "qXfer:mri-trace" command used to read the raw contents of the buffer that the program has
+   been logging mriTrace() events into.
+
+    Command Format: qXfer:mri-trace:read::offset,length
+*/
+static uint32_t handleQueryTransferFlightRecorderCommand(void)
+{
+    Buffer*             pBuffer = GetBuffer();
+    AnnexOffsetLength   arguments;
+
+    __try
+    {
+        __throwing_func( readQueryTransferReadArguments(pBuffer, &arguments) );
+        __throwing_func( validateAnnexIsNull(arguments.pAnnex) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (FlightRecorder_GetSize() == 0)
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+    handleQueryTransferBinaryReadCommand(FlightRecorder_GetData(), FlightRecorder_GetSize(), &arguments);
+
+    return 0;
+}
+
+/* Handle the "qXfer:mri-fault" command used to read the registers, fault status registers, and stack window that
+   were captured when the program faulted with no gdb attached.
+
+    Command Format: qXfer:mri-fault:read::offset,length
+*/
+static uint32_t handleQueryTransferFaultCaptureCommand(void)
+{
+    Buffer*             pBuffer = GetBuffer();
+    AnnexOffsetLength   arguments;
+
+    __try
+    {
+        __throwing_func( readQueryTransferReadArguments(pBuffer, &arguments) );
+        __throwing_func( validateAnnexIsNull(arguments.pAnnex) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (FaultCapture_GetSize() == 0)
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+    handleQueryTransferBinaryReadCommand(FaultCapture_GetData(), FaultCapture_GetSize(), &arguments);
+
+    return 0;
+}
+
+/* Handle the "qXfer:mri-coverage" command used to read the bitmap of basic blocks hit since the last
+   "monitor coverage start". Bit i%8 of byte i/8 is set once the i'th block in the list has been executed.
+
+    Command Format: qXfer:mri-coverage:read::offset,length
+*/
+static uint32_t handleQueryTransferCoverageCommand(void)
+{
+    Buffer*             pBuffer = GetBuffer();
+    AnnexOffsetLength   arguments;
+
+    __try
+    {
+        __throwing_func( readQueryTransferReadArguments(pBuffer, &arguments) );
+        __throwing_func( validateAnnexIsNull(arguments.pAnnex) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (!Coverage_HasBuffer())
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+    handleQueryTransferBinaryReadCommand(Coverage_GetBitmap(), Coverage_GetBitmapSize(), &arguments);
+
+    return 0;
+}
+
+/* Handle the "qXfer:mri-backtrace" command used to read the backtraces of the halted thread and all of the other RTOS
+   threads in one transfer instead of gdb walking each stack with memory reads. The object is the list of
+   BacktraceRecord entries described in core/backtrace.h. It is always available so it isn't listed in the qSupported
+   response, which must still fit in the smallest packet buffers.
+
+    Command Format: qXfer:mri-backtrace:read::offset,length
+*/
+static uint32_t handleQueryTransferBacktraceCommand(void)
+{
+    Buffer*                 pBuffer = GetBuffer();
+    AnnexOffsetLength       arguments;
+    const BacktraceRecord*  pRecord;
+    char*                   pDataPrefix;
+    uint32_t                recordStart = 0;
+
+    __try
+    {
+        __throwing_func( readQueryTransferReadArguments(pBuffer, &arguments) );
+        __throwing_func( validateAnnexIsNull(arguments.pAnnex) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    pBuffer = GetInitializedBuffer();
+    pDataPrefix = Buffer_GetArray(pBuffer);
+    Buffer_WriteChar(pBuffer, 'm');
+    for (pRecord = Backtrace_GetFirstRecord() ; pRecord ; pRecord = Backtrace_GetNextRecord())
+    {
+        uint32_t recordEnd = recordStart + Backtrace_GetRecordSize(pRecord);
+
+        if (arguments.offset < recordEnd && arguments.length > 0)
+        {
+            uint32_t bytesToWrite = recordEnd - arguments.offset;
+            uint32_t bytesWritten;
+
+            if (bytesToWrite > arguments.length)
+                bytesToWrite = arguments.length;
+            bytesWritten = writeBinaryData(pBuffer, (const uint8_t*)pRecord + (arguments.offset - recordStart),
+                                           bytesToWrite);
+            arguments.offset += bytesWritten;
+            arguments.length -= bytesWritten;
+            if (bytesWritten < bytesToWrite)
+                return 0;
+        }
+        recordStart = recordEnd;
+    }
+    if (arguments.offset >= recordStart)
+        *pDataPrefix = 'l';
+
+    return 0;
+}
+
+/* Unlike the XML objects, binary data can contain the '$', '#', '}', and '*' characters which have special meaning
+   in the packet so those are escaped by sending '}' followed by the original character XORed with 0x20. The length
+   requested by gdb is a count of unescaped bytes so as many bytes as will fit in the packet buffer are sent. */
+static void handleQueryTransferBinaryReadCommand(const uint8_t* pData, uint32_t dataSize, AnnexOffsetLength* pArguments)
+{
+    Buffer*  pBuffer = GetInitializedBuffer();
+    char*    pDataPrefix = Buffer_GetArray(pBuffer);
+    uint32_t offset = pArguments->offset;
+    uint32_t length = pArguments->length;
+
+    Buffer_WriteChar(pBuffer, 'm');
+    if (offset >= dataSize)
+        offset = dataSize;
+    if (length > dataSize - offset)
+        length = dataSize - offset;
+    offset += writeBinaryData(pBuffer, pData + offset, length);
+    if (offset == dataSize)
+        *pDataPrefix = 'l';
+}
+
+/* Returns the number of bytes written, which is less than length if the packet buffer filled up first. */
+static uint32_t writeBinaryData(Buffer* pBuffer, const uint8_t* pData, uint32_t length)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < length ; i++)
+    {
+        uint8_t byte = pData[i];
+
+        if (isBinaryCharToEscape(byte))
+        {
+            if (Buffer_BytesLeft(pBuffer) < 2)
+                break;
+            Buffer_WriteChar(pBuffer, '}');
+            byte ^= 0x20;
+        }
+        else if (Buffer_BytesLeft(pBuffer) < 1)
+        {
+            break;
+        }
+        Buffer_WriteChar(pBuffer, byte);
+    }
+    return i;
+}
+
+static int isBinaryCharToEscape(uint8_t byte)
+{
+    return byte == '$' || byte == '#' || byte == '}' || byte == '*';
+}
+
 /* Handle the "qfThreadInfo" command used by gdb to start retrieving list of RTOS thread IDs.
 
     Reponse Format: mAAAAAAAA[,BBBBBBBB]...
@@ -398,6 +725,18 @@ static uint32_t handleMonitorCommand(void)
     Buffer*             pBuffer =GetBuffer();
     static const char   reset[] = "reset";
     static const char   showfault[] = "showfault";
+    static const char   watchvalue[] = "watchvalue";
+    static const char   profile[] = "profile";
+    static const char   time[] = "time";
+    static const char   perf[] = "perf";
+    static const char   irqstats[] = "irqstats";
+    static const char   sample[] = "sample";
+    static const char   logCommand[] = "log";
+    static const char   record[] = "record";
+    static const char   coverage[] = "coverage";
+    static const char   cpuload[] = "cpuload";
+    static const char   coredump[] = "coredump";
+    static const char   snapshot[] = "snapshot";
     static const char   help[] = "help";
 
     if (!Buffer_IsNextCharEqualTo(pBuffer, ','))
@@ -414,6 +753,54 @@ static uint32_t handleMonitorCommand(void)
     {
         return handleMonitorShowFaultCommand();
     }
+    else if (Buffer_MatchesHexString(pBuffer, watchvalue, sizeof(watchvalue)-1))
+    {
+        return handleMonitorWatchValueCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, profile, sizeof(profile)-1))
+    {
+        return handleMonitorProfileCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, time, sizeof(time)-1))
+    {
+        return handleMonitorTimeCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, perf, sizeof(perf)-1))
+    {
+        return handleMonitorPerfCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, irqstats, sizeof(irqstats)-1))
+    {
+        return handleMonitorIrqStatsCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, sample, sizeof(sample)-1))
+    {
+        return handleMonitorSampleCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, logCommand, sizeof(logCommand)-1))
+    {
+        return handleMonitorLogCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, record, sizeof(record)-1))
+    {
+        return handleMonitorRecordCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, coverage, sizeof(coverage)-1))
+    {
+        return handleMonitorCoverageCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, cpuload, sizeof(cpuload)-1))
+    {
+        return handleMonitorCpuLoadCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, coredump, sizeof(coredump)-1))
+    {
+        return handleMonitorCoredumpCommand();
+    }
+    else if (Buffer_MatchesHexString(pBuffer, snapshot, sizeof(snapshot)-1))
+    {
+        return handleMonitorSnapshotCommand();
+    }
     else if (Buffer_MatchesHexString(pBuffer, help, sizeof(help)-1))
     {
         return handleMonitorHelpCommand();
@@ -440,11 +827,1120 @@ static uint32_t handleMonitorShowFaultCommand(void)
     return 0;
 }
 
+/* Handle the "monitor watchvalue ADDRESS [VALUE]" command.
+
+    Makes the data watchpoints which gdb sets at ADDRESS only trigger when VALUE is read or written, using the data
+    value matching feature of the hardware. Leaving off VALUE removes the condition. The condition is applied the next
+    time that gdb inserts the watchpoint, which it normally does each time that execution is resumed. Numbers can be
+    decimal or prefixed with 0x for hexadecimal.
+*/
+static uint32_t handleMonitorWatchValueCommand(void)
+{
+    Buffer*   pBuffer = GetBuffer();
+    uint32_t  address;
+    uint32_t  value = 0;
+    int       hasValue = 0;
+
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        __throwing_func( address = ReadMonitorUIntegerArgument(pBuffer) );
+        if (HasMoreMonitorArguments(pBuffer))
+        {
+            __throwing_func( value = ReadMonitorUIntegerArgument(pBuffer) );
+            hasValue = 1;
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor watchvalue ADDRESS [VALUE]\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (!hasValue)
+    {
+        ClearWatchpointValue(address);
+        PrepareStringResponse("OK");
+        return 0;
+    }
+
+    __try
+        SetWatchpointValue(address, value);
+    __catch
+    {
+        WriteStringToGdbConsole("Too many watchpoint values.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+        return 0;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+/* Handle the "monitor profile start [CYCLES]|stop|dump [FILENAME]" command.
+
+    start begins sampling the PC every CYCLES CPU cycles (MRI_PROFILE_DEFAULT_INTERVAL by default) into the buffer
+    provided by the program through mriSetProfileBuffer(). Any previously collected samples are discarded.
+    stop halts sampling and reports how many samples were taken.
+    dump writes the collected histogram to FILENAME (gmon.out by default) on the gdb host in gprof format. gdb only
+    services File-I/O requests while the target is running so the file is written on the next continue or step.
+*/
+static void     readProfileCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval,
+                                            char* pFilename, size_t filenameSize);
+static uint32_t handleProfileException(void);
+static uint32_t handleMonitorProfileCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    char     filename[64];
+    uint32_t interval = MRI_PROFILE_DEFAULT_INTERVAL;
+    int      subcommand = 0;
+
+    __try
+        readProfileCommandArguments(pBuffer, &subcommand, &interval, filename, sizeof(filename));
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor profile start [CYCLES]|stop|dump [FILENAME]\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Profile_Start(interval);
+            __catch
+                return handleProfileException();
+            WriteStringToGdbConsole("Profiling started.\r\n");
+            break;
+        case 'S':
+            Profile_Stop();
+            WriteStringToGdbConsole("Profiling stopped with ");
+            WriteDecimalValueToGdbConsole(Profile_GetSampleCount());
+            WriteStringToGdbConsole(" samples (");
+            WriteDecimalValueToGdbConsole(Profile_GetOutOfRangeSampleCount());
+            WriteStringToGdbConsole(" out of range).\r\n");
+            break;
+        case 'd':
+            __try
+                Profile_RequestDump(filename);
+            __catch
+                return handleProfileException();
+            WriteStringToGdbConsole("Will write profile on next continue.\r\n");
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readProfileCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval,
+                                        char* pFilename, size_t filenameSize)
+{
+    static const char defaultFilename[] = "gmon.out";
+
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            if (HasMoreMonitorArguments(pBuffer))
+            {
+                __throwing_func( *pInterval = ReadMonitorUIntegerArgument(pBuffer) );
+            }
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        else if (MatchesMonitorArgument(pBuffer, "dump"))
+        {
+            *pSubcommand = 'd';
+            mri_memcpy(pFilename, defaultFilename, sizeof(defaultFilename));
+            if (HasMoreMonitorArguments(pBuffer))
+            {
+                __throwing_func( ReadMonitorStringArgument(pBuffer, pFilename, filenameSize) );
+            }
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 0 || *pInterval == 0)
+        __throw(invalidArgumentException);
+}
+
+static uint32_t handleProfileException(void)
+{
+    if (getExceptionCode() == notFoundException)
+    {
+        WriteStringToGdbConsole("Program must call mriSetProfileBuffer() first.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_PROFILE_BUFFER);
+    }
+    else if (getExceptionCode() == exceededHardwareResourcesException)
+    {
+        WriteStringToGdbConsole("No free hardware resources for profiling.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+    }
+    else
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+    }
+    return 0;
+}
+
+/* Handle the "monitor time [START END|stop]" command.
+
+    START END arms a pair of hardware breakpoints at these addresses and measures the number of CPU cycles taken to
+    get from START to END each time that the region is executed. The breakpoints resume execution immediately so that
+    statistics can be collected over thousands of iterations. Any previously collected statistics are discarded.
+    stop removes the breakpoints but keeps the statistics.
+    With no arguments, the count, minimum, maximum, and mean cycles are reported along with a histogram where each
+    bucket counts the regions which took at least that many cycles.
+*/
+static void     readTimeCommandArguments(Buffer* pBuffer, int* pSubcommand, uintmri_t* pStart, uintmri_t* pEnd);
+static void     writeTimingStatsToGdbConsole(void);
+static void     writeLabelledDecimalValueToGdbConsole(const char* pLabel, uint32_t value, const char* pSuffix);
+static uint32_t handleMonitorTimeCommand(void)
+{
+    Buffer*   pBuffer = GetBuffer();
+    uintmri_t startAddress = 0;
+    uintmri_t endAddress = 0;
+    int       subcommand = 0;
+
+    __try
+        readTimeCommandArguments(pBuffer, &subcommand, &startAddress, &endAddress);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor time [START END|stop]\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Timing_Start(startAddress, endAddress);
+            __catch
+            {
+                WriteStringToGdbConsole("No free hardware resources for timing.\r\n");
+                PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+                return 0;
+            }
+            WriteStringToGdbConsole("Timing started.\r\n");
+            break;
+        case 'S':
+            Timing_Stop();
+            WriteStringToGdbConsole("Timing stopped.\r\n");
+            break;
+        default:
+            writeTimingStatsToGdbConsole();
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readTimeCommandArguments(Buffer* pBuffer, int* pSubcommand, uintmri_t* pStart, uintmri_t* pEnd)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        else if (HasMoreMonitorArguments(pBuffer))
+        {
+            *pSubcommand = 's';
+            __throwing_func( *pStart = ReadMonitorUIntegerArgument(pBuffer) );
+            __throwing_func( *pEnd = ReadMonitorUIntegerArgument(pBuffer) );
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 's' && (*pStart & ~1) == (*pEnd & ~1))
+        __throw(invalidArgumentException);
+}
+
+static void writeTimingStatsToGdbConsole(void)
+{
+    const TimingStats* pStats = Timing_GetStats();
+    uint32_t           i;
+
+    if (pStats->count == 0)
+    {
+        WriteStringToGdbConsole("No timed regions have completed.\r\n");
+        return;
+    }
+
+    writeLabelledDecimalValueToGdbConsole("Regions: ", pStats->count, "\r\n");
+    writeLabelledDecimalValueToGdbConsole("Min: ", pStats->minimum, " cycles\r\n");
+    writeLabelledDecimalValueToGdbConsole("Max: ", pStats->maximum, " cycles\r\n");
+    writeLabelledDecimalValueToGdbConsole("Mean: ", Timing_GetMeanCycles(), " cycles\r\n");
+    for (i = 0 ; i < MRI_TIMING_BUCKET_COUNT ; i++)
+    {
+        if (pStats->buckets[i] == 0)
+            continue;
+        writeLabelledDecimalValueToGdbConsole(">= ", 1 << i, " cycles: ");
+        WriteDecimalValueToGdbConsole(pStats->buckets[i]);
+        WriteStringToGdbConsole("\r\n");
+    }
+}
+
+static void writeLabelledDecimalValueToGdbConsole(const char* pLabel, uint32_t value, const char* pSuffix)
+{
+    WriteStringToGdbConsole(pLabel);
+    WriteDecimalValueToGdbConsole(value);
+    WriteStringToGdbConsole(pSuffix);
+}
+
+/* Handle the "monitor perf start [CYCLES]|stop|show" command.
+
+    start clears and enables the hardware performance counters. The counters are small so the debug monitor is entered
+    every CYCLES CPU cycles (MRI_PERF_DEFAULT_INTERVAL by default) to accumulate them into larger totals.
+    stop disables the counters but keeps the totals.
+    show reports the totals along with each as a percentage of the elapsed cycles and the average cycles per
+    instruction.
+*/
+static void     readPerfCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval);
+static void     writePerfTotalsToGdbConsole(void);
+static void     writePerfCounterToGdbConsole(const char* pLabel, uint32_t count, uint32_t cycles);
+static void     writeCyclesPerInstructionToGdbConsole(const PerfCounters* pTotals);
+static uint32_t handleMonitorPerfCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    uint32_t interval = MRI_PERF_DEFAULT_INTERVAL;
+    int      subcommand = 0;
+
+    __try
+        readPerfCommandArguments(pBuffer, &subcommand, &interval);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor perf start [CYCLES]|stop|show\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Perf_Start(interval);
+            __catch
+            {
+                WriteStringToGdbConsole("No free hardware resources for performance counters.\r\n");
+                PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+                return 0;
+            }
+            WriteStringToGdbConsole("Performance counters started.\r\n");
+            break;
+        case 'S':
+            Perf_Stop();
+            WriteStringToGdbConsole("Performance counters stopped.\r\n");
+            break;
+        case 'r':
+            writePerfTotalsToGdbConsole();
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readPerfCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            if (HasMoreMonitorArguments(pBuffer))
+            {
+                __throwing_func( *pInterval = ReadMonitorUIntegerArgument(pBuffer) );
+            }
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        else if (MatchesMonitorArgument(pBuffer, "show"))
+        {
+            *pSubcommand = 'r';
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 0 || *pInterval == 0)
+        __throw(invalidArgumentException);
+}
+
+static void writePerfTotalsToGdbConsole(void)
+{
+    const PerfCounters* pTotals = Perf_GetTotals();
+
+    writeLabelledDecimalValueToGdbConsole("Cycles: ", pTotals->cycles, "\r\n");
+    writePerfCounterToGdbConsole("CPI stall cycles: ", pTotals->cpi, pTotals->cycles);
+    writePerfCounterToGdbConsole("Exception overhead cycles: ", pTotals->exception, pTotals->cycles);
+    writePerfCounterToGdbConsole("Sleep cycles: ", pTotals->sleep, pTotals->cycles);
+    writePerfCounterToGdbConsole("LSU stall cycles: ", pTotals->lsu, pTotals->cycles);
+    writePerfCounterToGdbConsole("Folded instructions: ", pTotals->fold, pTotals->cycles);
+    writeCyclesPerInstructionToGdbConsole(pTotals);
+    if (Perf_GetPossibleWrapCount() != 0)
+    {
+        writeLabelledDecimalValueToGdbConsole("Warning: Counters may have wrapped during ", Perf_GetPossibleWrapCount(),
+                                              " long samples.\r\n");
+    }
+    if (Perf_HasSaturated())
+        WriteStringToGdbConsole("Warning: Totals stopped once the cycle count overflowed.\r\n");
+}
+
+static void writePerfCounterToGdbConsole(const char* pLabel, uint32_t count, uint32_t cycles)
+{
+    uint32_t percent = cycles ? (uint32_t)(((uint64_t)count * 100) / cycles) : 0;
+
+    writeLabelledDecimalValueToGdbConsole(pLabel, count, " (");
+    WriteDecimalValueToGdbConsole(percent);
+    WriteStringToGdbConsole("%)\r\n");
+}
+
+static void writeCyclesPerInstructionToGdbConsole(const PerfCounters* pTotals)
+{
+    /* Every cycle is either used to execute an instruction or is counted by one of the overhead counters. Folded
+       instructions execute in zero cycles so they need to be added back in. */
+    uint32_t overhead = pTotals->cpi + pTotals->exception + pTotals->sleep + pTotals->lsu;
+    uint32_t instructions = (pTotals->cycles > overhead ? pTotals->cycles - overhead : 0) + pTotals->fold;
+    uint32_t hundredths;
+
+    if (instructions == 0)
+        return;
+    hundredths = (uint32_t)(((uint64_t)pTotals->cycles * 100) / instructions);
+    writeLabelledDecimalValueToGdbConsole("Instructions: ", instructions, "\r\n");
+    WriteStringToGdbConsole("Cycles per instruction: ");
+    WriteDecimalValueToGdbConsole(hundredths / 100);
+    WriteStringToGdbConsole(hundredths % 100 < 10 ? ".0" : ".");
+    WriteDecimalValueToGdbConsole(hundredths % 100);
+    WriteStringToGdbConsole("\r\n");
+}
+
+/* Handle the "monitor irqstats start IRQ [IRQ...]|stop|show" command.
+
+    start redirects each of the listed IRQs (up to MRI_IRQSTATS_MAX_IRQS) through a shim in the vector table provided
+    by the program through mriSetIrqVectorTable(). The shim uses the CPU cycle counter to timestamp the entry and exit
+    of each handler call. Any previously collected statistics are discarded.
+    stop puts the original vector table back but keeps the statistics.
+    show reports the number of calls along with the worst case latency and duration (in cycles) for each IRQ.
+*/
+static void     readIrqStatsCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pIrqs, uint32_t* pIrqCount);
+static uint32_t handleIrqStatsException(void);
+static void     writeIrqStatsToGdbConsole(void);
+static uint32_t handleMonitorIrqStatsCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    uint32_t irqs[MRI_IRQSTATS_MAX_IRQS];
+    uint32_t irqCount = 0;
+    int      subcommand = 0;
+
+    __try
+        readIrqStatsCommandArguments(pBuffer, &subcommand, irqs, &irqCount);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor irqstats start IRQ [IRQ...]|stop|show\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                IrqStats_Start(irqs, irqCount);
+            __catch
+                return handleIrqStatsException();
+            WriteStringToGdbConsole("IRQ statistics started.\r\n");
+            break;
+        case 'S':
+            IrqStats_Stop();
+            WriteStringToGdbConsole("IRQ statistics stopped.\r\n");
+            break;
+        case 'r':
+            writeIrqStatsToGdbConsole();
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readIrqStatsCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pIrqs, uint32_t* pIrqCount)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            while (HasMoreMonitorArguments(pBuffer) && *pIrqCount < MRI_IRQSTATS_MAX_IRQS)
+            {
+                __throwing_func( pIrqs[(*pIrqCount)++] = ReadMonitorUIntegerArgument(pBuffer) );
+            }
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        else if (MatchesMonitorArgument(pBuffer, "show"))
+        {
+            *pSubcommand = 'r';
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 0 || (*pSubcommand == 's' && *pIrqCount == 0))
+        __throw(invalidArgumentException);
+}
+
+static uint32_t handleIrqStatsException(void)
+{
+    if (getExceptionCode() == notFoundException)
+    {
+        WriteStringToGdbConsole("Program must call mriSetIrqVectorTable() first.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_VECTOR_TABLE);
+    }
+    else if (getExceptionCode() == exceededHardwareResourcesException)
+    {
+        WriteStringToGdbConsole("No free hardware resources for IRQ statistics.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+    }
+    else
+    {
+        WriteStringToGdbConsole("IRQ list is invalid or doesn't fit in the vector table.\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+    }
+    return 0;
+}
+
+static void writeIrqStatsToGdbConsole(void)
+{
+    uint32_t i;
+
+    if (IrqStats_GetCount() == 0)
+    {
+        WriteStringToGdbConsole("No IRQs are being monitored.\r\n");
+        return;
+    }
+
+    for (i = 0 ; i < IrqStats_GetCount() ; i++)
+    {
+        const IrqStats* pStats = IrqStats_Get(i);
+
+        writeLabelledDecimalValueToGdbConsole("IRQ ", pStats->irq, ": ");
+        writeLabelledDecimalValueToGdbConsole("Count: ", pStats->count, ", ");
+        writeLabelledDecimalValueToGdbConsole("Max latency: ", pStats->maxLatency, " cycles, ");
+        writeLabelledDecimalValueToGdbConsole("Max duration: ", pStats->maxDuration, " cycles\r\n");
+    }
+}
+
+/* Handle the "monitor sample start CYCLES ADDR SIZE [...]|stop" command.
+
+    start reads each of the listed variables (up to MRI_SAMPLER_MAX_VARIABLES) every CYCLES CPU cycles while the
+    program runs. SIZE is the size of the variable in bytes and must be 1, 2, or 4. The timestamped samples are
+    collected in the buffer provided by the program through mriSetSampleBuffer() and streamed to the gdb console as
+    it fills up.
+    stop halts sampling and sends any samples still in the buffer.
+*/
+static void     readSampleCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval,
+                                           SamplerVariable* pVariables, uint32_t* pVariableCount);
+static uint32_t handleSampleException(void);
+static uint32_t handleMonitorSampleCommand(void)
+{
+    Buffer*         pBuffer = GetBuffer();
+    SamplerVariable variables[MRI_SAMPLER_MAX_VARIABLES];
+    uint32_t        variableCount = 0;
+    uint32_t        interval = 0;
+    int             subcommand = 0;
+
+    __try
+        readSampleCommandArguments(pBuffer, &subcommand, &interval, variables, &variableCount);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Sampler_Start(interval, variables, variableCount);
+            __catch
+                return handleSampleException();
+            WriteStringToGdbConsole("Sampling started.\r\n");
+            break;
+        case 'S':
+            Sampler_Stop();
+            Sampler_Drain();
+            WriteStringToGdbConsole("Sampling stopped.\r\n");
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readSampleCommandArguments(Buffer* pBuffer, int* pSubcommand, uint32_t* pInterval,
+                                       SamplerVariable* pVariables, uint32_t* pVariableCount)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            __throwing_func( *pInterval = ReadMonitorUIntegerArgument(pBuffer) );
+            while (HasMoreMonitorArguments(pBuffer) && *pVariableCount < MRI_SAMPLER_MAX_VARIABLES)
+            {
+                SamplerVariable* pVariable = &pVariables[(*pVariableCount)++];
+
+                __throwing_func( pVariable->address = ReadMonitorUIntegerArgument(pBuffer) );
+                __throwing_func( pVariable->size = ReadMonitorUIntegerArgument(pBuffer) );
+            }
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 0 || (*pSubcommand == 's' && (*pInterval == 0 || *pVariableCount == 0)))
+        __throw(invalidArgumentException);
+}
+
+static uint32_t handleSampleException(void)
+{
+    if (getExceptionCode() == notFoundException)
+    {
+        WriteStringToGdbConsole("Program must call mriSetSampleBuffer() first.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_SAMPLE_BUFFER);
+    }
+    else if (getExceptionCode() == bufferOverrunException)
+    {
+        WriteStringToGdbConsole("Sample buffer is too small.\r\n");
+        PrepareStringResponse(MRI_ERROR_BUFFER_OVERRUN);
+    }
+    else if (getExceptionCode() == memFaultException)
+    {
+        WriteStringToGdbConsole("Can't read sampled variable.\r\n");
+        PrepareStringResponse(MRI_ERROR_MEMORY_ACCESS_FAILURE);
+    }
+    else if (getExceptionCode() == exceededHardwareResourcesException)
+    {
+        WriteStringToGdbConsole("No free hardware resources for sampling.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+    }
+    else
+    {
+        WriteStringToGdbConsole("Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+    }
+    return 0;
+}
+
+/* Handle the "monitor log start [FILENAME]|stop" command.
+
+    start records the mriLogWrite() calls made by the program in the buffer provided through mriSetLogBuffer() and
+    streams them in binary to FILENAME (mri.log by default) on the gdb host each time that the buffer fills up or the
+    program halts.
+    stop halts logging. The last of the records are written and the file is closed on the next continue or step since
+    gdb only services File-I/O requests while the program is running.
+*/
+static void     readLogCommandArguments(Buffer* pBuffer, int* pSubcommand, char* pFilename, size_t filenameSize);
+static uint32_t handleLogException(void);
+static uint32_t handleMonitorLogCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    char     filename[64];
+    int      subcommand = 0;
+
+    __try
+        readLogCommandArguments(pBuffer, &subcommand, filename, sizeof(filename));
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor log start [FILENAME]|stop\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                BinLog_Start(filename);
+            __catch
+                return handleLogException();
+            WriteStringToGdbConsole("Logging started.\r\n");
+            break;
+        case 'S':
+            BinLog_Stop();
+            WriteStringToGdbConsole("Logging stopped.\r\n");
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readLogCommandArguments(Buffer* pBuffer, int* pSubcommand, char* pFilename, size_t filenameSize)
+{
+    static const char defaultFilename[] = "mri.log";
+
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            mri_memcpy(pFilename, defaultFilename, sizeof(defaultFilename));
+            if (HasMoreMonitorArguments(pBuffer))
+            {
+                __throwing_func( ReadMonitorStringArgument(pBuffer, pFilename, filenameSize) );
+            }
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 0)
+        __throw(invalidArgumentException);
+}
+
+static uint32_t handleLogException(void)
+{
+    if (getExceptionCode() == notFoundException)
+    {
+        WriteStringToGdbConsole("Program must call mriSetLogBuffer() first.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_LOG_BUFFER);
+    }
+    else if (getExceptionCode() == bufferOverrunException)
+    {
+        WriteStringToGdbConsole("Log buffer is too small.\r\n");
+        PrepareStringResponse(MRI_ERROR_BUFFER_OVERRUN);
+    }
+    else
+    {
+        WriteStringToGdbConsole("Usage: monitor log start [FILENAME]|stop\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+    }
+    return 0;
+}
+
+/* Handle the "monitor record start|stop" command.
+
+    start single steps the program from then on, even when gdb asks it to continue, so that the registers and memory
+    modified by each instruction can be logged in the buffer provided through mriSetRecordBuffer(). gdb can then
+    reverse-step and reverse-continue back through the logged instructions.
+    stop discards the log and lets the program run at full speed again.
+*/
+static int      readRecordCommandArguments(Buffer* pBuffer);
+static uint32_t handleRecordException(void);
+static uint32_t handleMonitorRecordCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    int      subcommand = 0;
+
+    __try
+        subcommand = readRecordCommandArguments(pBuffer);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor record start|stop\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Record_Start();
+            __catch
+                return handleRecordException();
+            WriteStringToGdbConsole("Recording started.\r\n");
+            break;
+        case 'S':
+            Record_Stop();
+            WriteStringToGdbConsole("Recording stopped.\r\n");
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static int readRecordCommandArguments(Buffer* pBuffer)
+{
+    int subcommand = 0;
+
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+            subcommand = 's';
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+            subcommand = 'S';
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow_and_return(0);
+    if (subcommand == 0)
+        __throw_and_return(invalidArgumentException, 0);
+    return subcommand;
+}
+
+static uint32_t handleRecordException(void)
+{
+    if (getExceptionCode() == notFoundException)
+    {
+        WriteStringToGdbConsole("Program must call mriSetRecordBuffer() first.\r\n");
+        PrepareStringResponse(MRI_ERROR_NO_RECORD_BUFFER);
+    }
+    else
+    {
+        WriteStringToGdbConsole("Record buffer is too small.\r\n");
+        PrepareStringResponse(MRI_ERROR_BUFFER_OVERRUN);
+    }
+    return 0;
+}
+
+/* Handle the "monitor coverage [start ADDRESS COUNT|stop]" command.
+
+    start ADDRESS COUNT clears the coverage bitmap and keeps hardware breakpoints armed on the blocks, from the array of
+    COUNT 32-bit block addresses at ADDRESS, which haven't been hit yet. Each breakpoint is retired as soon as it is hit
+    and the program is resumed without halting.
+    stop removes any breakpoints which are still armed but keeps the bitmap so that it can still be read with
+    qXfer:mri-coverage:read.
+    With no arguments, the number of blocks hit so far is reported.
+*/
+static void     readCoverageCommandArguments(Buffer* pBuffer, int* pSubcommand, uintmri_t* pAddress, uint32_t* pCount);
+static uint32_t handleCoverageException(void);
+static void     writeCoverageStatusToGdbConsole(void);
+static uint32_t handleMonitorCoverageCommand(void)
+{
+    Buffer*   pBuffer = GetBuffer();
+    uintmri_t listAddress = 0;
+    uint32_t  blockCount = 0;
+    int       subcommand = 0;
+
+    __try
+        readCoverageCommandArguments(pBuffer, &subcommand, &listAddress, &blockCount);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor coverage [start ADDRESS COUNT|stop]\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                Coverage_Start(listAddress, blockCount);
+            __catch
+                return handleCoverageException();
+            WriteStringToGdbConsole("Coverage started.\r\n");
+            break;
+        case 'S':
+            Coverage_Stop();
+            WriteStringToGdbConsole("Coverage stopped.\r\n");
+            break;
+        default:
+            writeCoverageStatusToGdbConsole();
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readCoverageCommandArguments(Buffer* pBuffer, int* pSubcommand, uintmri_t* pAddress, uint32_t* pCount)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "start"))
+        {
+            *pSubcommand = 's';
+            __throwing_func( *pAddress = ReadMonitorUIntegerArgument(pBuffer) );
+            __throwing_func( *pCount = ReadMonitorUIntegerArgument(pBuffer) );
+        }
+        else if (MatchesMonitorArgument(pBuffer, "stop"))
+        {
+            *pSubcommand = 'S';
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+    if (*pSubcommand == 's' && *pCount == 0)
+        __throw(invalidArgumentException);
+}
+
+static uint32_t handleCoverageException(void)
+{
+    switch (getExceptionCode())
+    {
+        case notFoundException:
+            WriteStringToGdbConsole("Program must call mriSetCoverageBuffer() first.\r\n");
+            PrepareStringResponse(MRI_ERROR_NO_COVERAGE_BUFFER);
+            break;
+        case bufferOverrunException:
+            WriteStringToGdbConsole("Coverage buffer is too small.\r\n");
+            PrepareStringResponse(MRI_ERROR_BUFFER_OVERRUN);
+            break;
+        case memFaultException:
+            WriteStringToGdbConsole("Failed to read block address list.\r\n");
+            PrepareStringResponse(MRI_ERROR_MEMORY_ACCESS_FAILURE);
+            break;
+        default:
+            WriteStringToGdbConsole("No free hardware resources for coverage.\r\n");
+            PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+            break;
+    }
+    return 0;
+}
+
+static void writeCoverageStatusToGdbConsole(void)
+{
+    if (Coverage_GetBlockCount() == 0)
+    {
+        WriteStringToGdbConsole("Coverage hasn't been started.\r\n");
+        return;
+    }
+    writeLabelledDecimalValueToGdbConsole("Blocks: ", Coverage_GetBlockCount(), "\r\n");
+    writeLabelledDecimalValueToGdbConsole("Hit: ", Coverage_GetHitCount(), "\r\n");
+    writeLabelledDecimalValueToGdbConsole("Armed: ", Coverage_GetArmedCount(), "\r\n");
+}
+
+/* Handle the "monitor cpuload start [CYCLES]|stop|show" command.
+
+    start samples the running RTOS thread every CYCLES CPU cycles (MRI_CPULOAD_DEFAULT_INTERVAL by default) while the
+    program continues to run. Samples which land in an exception handler are counted as interrupt time instead.
+    Any previously collected tick counts are discarded.
+    stop ends the sampling but keeps the tick counts.
+    show reports the ticks counted for interrupts and each thread along with their percentage of all samples.
+*/
+static void     writeCpuLoadToGdbConsole(void);
+static uint32_t handleMonitorCpuLoadCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    uint32_t interval = MRI_CPULOAD_DEFAULT_INTERVAL;
+    int      subcommand = 0;
+
+    __try
+        readPerfCommandArguments(pBuffer, &subcommand, &interval);
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor cpuload start [CYCLES]|stop|show\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    switch (subcommand)
+    {
+        case 's':
+            __try
+                CpuLoad_Start(interval);
+            __catch
+            {
+                WriteStringToGdbConsole("No free hardware resources for CPU load sampling.\r\n");
+                PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+                return 0;
+            }
+            WriteStringToGdbConsole("CPU load sampling started.\r\n");
+            break;
+        case 'S':
+            CpuLoad_Stop();
+            WriteStringToGdbConsole("CPU load sampling stopped.\r\n");
+            break;
+        case 'r':
+            writeCpuLoadToGdbConsole();
+            break;
+    }
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void writeCpuLoadToGdbConsole(void)
+{
+    uint32_t totalTicks = CpuLoad_GetTotalTicks();
+    uint32_t i;
+
+    if (totalTicks == 0)
+    {
+        WriteStringToGdbConsole("No CPU load samples have been taken.\r\n");
+        return;
+    }
+
+    writeLabelledDecimalValueToGdbConsole("Samples: ", totalTicks, "\r\n");
+    writePerfCounterToGdbConsole("Interrupts: ", CpuLoad_GetInterruptTicks(), totalTicks);
+    for (i = 0 ; i < CpuLoad_GetThreadCount() ; i++)
+    {
+        const CpuLoadThread* pThread = CpuLoad_GetThread(i);
+        const char*          pThreadInfo = Platform_RtosGetExtraThreadInfo(pThread->threadId);
+
+        WriteStringToGdbConsole("Thread ");
+        WriteHexValueToGdbConsole(pThread->threadId);
+        if (pThreadInfo)
+        {
+            WriteStringToGdbConsole(" ");
+            WriteStringToGdbConsole(pThreadInfo);
+        }
+        writePerfCounterToGdbConsole(": ", pThread->ticks, totalTicks);
+    }
+    if (CpuLoad_GetOtherThreadTicks() != 0)
+        writePerfCounterToGdbConsole("Other threads: ", CpuLoad_GetOtherThreadTicks(), totalTicks);
+}
+
+/* Handle the "monitor coredump [FILENAME]" command.
+
+    Writes an ELF core file of the halted program to FILENAME (core by default) on the gdb host. It holds a
+    NT_PRSTATUS note for the halted thread followed by one for each of the other RTOS threads and a load segment for
+    each RAM region in the device's memory map. gdb only services File-I/O requests while the target is running so
+    the file is written on the next continue or step, before the program gets to run again. The resulting file can
+    be loaded into gdb with "target core FILENAME" once the board has been reset.
+*/
+static void     readCoredumpCommandArguments(Buffer* pBuffer, char* pFilename, size_t filenameSize);
+static uint32_t handleMonitorCoredumpCommand(void)
+{
+    Buffer* pBuffer = GetBuffer();
+    char    filename[64];
+
+    __try
+    {
+        __throwing_func( readCoredumpCommandArguments(pBuffer, filename, sizeof(filename)) );
+        __throwing_func( Coredump_Request(filename) );
+    }
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor coredump [FILENAME]\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    WriteStringToGdbConsole("Will write core dump on next continue.\r\n");
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readCoredumpCommandArguments(Buffer* pBuffer, char* pFilename, size_t filenameSize)
+{
+    static const char defaultFilename[] = "core";
+
+    mri_memcpy(pFilename, defaultFilename, sizeof(defaultFilename));
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (HasMoreMonitorArguments(pBuffer))
+        {
+            __throwing_func( ReadMonitorStringArgument(pBuffer, pFilename, filenameSize) );
+        }
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+}
+
+/* Handle the "monitor snapshot save|restore FILENAME" command.
+
+    Saves the registers and the memory regions provided by mriSetSnapshotRegions() to FILENAME on the gdb host or
+    restores them from it. Like coredump, the file is transferred on the next continue or step, before the program
+    gets to run again. After a restore, the program resumes from the point where the snapshot was saved.
+*/
+static void     readSnapshotCommandArguments(Buffer* pBuffer, int* pSubcommand, char* pFilename, size_t filenameSize);
+static uint32_t handleMonitorSnapshotCommand(void)
+{
+    Buffer*  pBuffer = GetBuffer();
+    char     filename[64];
+    int      subcommand = 0;
+
+    __try
+        readSnapshotCommandArguments(pBuffer, &subcommand, filename, sizeof(filename));
+    __catch
+    {
+        WriteStringToGdbConsole("Usage: monitor snapshot save|restore FILENAME\r\n");
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    __try
+    {
+        if (subcommand == 's')
+            Snapshot_RequestSave(filename);
+        else
+            Snapshot_RequestRestore(filename);
+    }
+    __catch
+    {
+        if (getExceptionCode() == notFoundException)
+        {
+            WriteStringToGdbConsole("Program must call mriSetSnapshotRegions() first.\r\n");
+            PrepareStringResponse(MRI_ERROR_NO_SNAPSHOT_REGIONS);
+        }
+        else
+        {
+            WriteStringToGdbConsole("Usage: monitor snapshot save|restore FILENAME\r\n");
+            PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        }
+        return 0;
+    }
+
+    WriteStringToGdbConsole(subcommand == 's' ? "Will save snapshot on next continue.\r\n" :
+                                                "Will restore snapshot on next continue.\r\n");
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void readSnapshotCommandArguments(Buffer* pBuffer, int* pSubcommand, char* pFilename, size_t filenameSize)
+{
+    __try
+    {
+        __throwing_func( ConvertMonitorArgumentsToText(pBuffer) );
+        if (MatchesMonitorArgument(pBuffer, "save"))
+            *pSubcommand = 's';
+        else if (MatchesMonitorArgument(pBuffer, "restore"))
+            *pSubcommand = 'r';
+        else
+            __throw(invalidArgumentException);
+        __throwing_func( ReadMonitorStringArgument(pBuffer, pFilename, filenameSize) );
+        __throwing_func( ThrowIfMoreMonitorArguments(pBuffer) );
+    }
+    __catch
+        __rethrow;
+}
+
 static uint32_t handleMonitorHelpCommand(void)
 {
     WriteStringToGdbConsole("Supported monitor commands:\r\n");
     WriteStringToGdbConsole("reset\r\n");
     WriteStringToGdbConsole("showfault\r\n");
+    WriteStringToGdbConsole("watchvalue ADDRESS [VALUE]\r\n");
+    WriteStringToGdbConsole("profile start [CYCLES]|stop|dump [FILENAME]\r\n");
+    WriteStringToGdbConsole("time [START END|stop]\r\n");
+    WriteStringToGdbConsole("perf start [CYCLES]|stop|show\r\n");
+    WriteStringToGdbConsole("irqstats start IRQ [IRQ...]|stop|show\r\n");
+    WriteStringToGdbConsole("sample start CYCLES ADDR SIZE [...]|stop\r\n");
+    WriteStringToGdbConsole("log start [FILENAME]|stop\r\n");
+    WriteStringToGdbConsole("record start|stop\r\n");
+    WriteStringToGdbConsole("coverage [start ADDRESS COUNT|stop]\r\n");
+    WriteStringToGdbConsole("cpuload start [CYCLES]|stop|show\r\n");
+    WriteStringToGdbConsole("coredump [FILENAME]\r\n");
+    WriteStringToGdbConsole("snapshot save|restore FILENAME\r\n");
     PrepareStringResponse("OK");
     return 0;
 }
@@ -20,8 +20,10 @@
 
 /* Real name of functions are in mri namespace. */
 uint32_t mriCmd_HandleQueryCommand(void);
+uint32_t mriCmd_HandleGeneralSetCommand(void);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
-#define HandleQueryCommand mriCmd_HandleQueryCommand
+#define HandleQueryCommand      mriCmd_HandleQueryCommand
+#define HandleGeneralSetCommand mriCmd_HandleGeneralSetCommand
 
 #endif /* CMD_QUERY_H_ */
@@ -20,6 +20,7 @@
 #include <core/core.h>
 #include <core/mri.h>
 #include <core/cmd_registers.h>
+#include <core/cmd_trace.h>
 
 
 static void writeThreadIdToBuffer(Buffer* pBuffer, uint32_t threadId);
@@ -104,6 +105,9 @@ static void writeTrapReasonToBuffer(Buffer* pBuffer)
 */
 uint32_t HandleRegisterReadCommand(void)
 {
+    if (IsTraceFrameSelected())
+        return HandleTraceFrameRegisterReadCommand();
+
     Context_CopyToBuffer(GetContext(), GetInitializedBuffer());
     return 0;
 }
@@ -12,8 +12,12 @@
    See the License for the specific language governing permissions and
    limitations under the License.
 */
-/* Handler for single step gdb command. */
+/* Handlers for single step and reverse step/continue gdb commands. */
 #include <core/platforms.h>
+#include <core/buffer.h>
+#include <core/core.h>
+#include <core/signal.h>
+#include <core/record.h>
 #include <core/cmd_common.h>
 #include <core/cmd_continue.h>
 #include <core/cmd_registers.h>
@@ -92,3 +96,67 @@ uint32_t HandleSingleStepWithSignalCommand(void)
 
     return returnValue;
 }
+
+
+static uint32_t handleReverseStepCommand(void);
+static uint32_t handleReverseContinueCommand(void);
+/* Handle the 'bs' and 'bc' commands which are sent from gdb to step or continue backwards through the instructions
+   that were logged on the target after "monitor record start". Each instruction is undone by restoring the registers
+   and memory that it modified.
+
+    Command Format:     bs or bc
+    Response Format:    Tssii:xxxxxxxx;...
+
+    The 'T' stop response includes replaylog:begin; if there are no older instructions left in the log to undo.
+    Reverse continue stops at the first gdb breakpoint that it backs up onto.
+*/
+uint32_t HandleReverseCommand(void)
+{
+    Buffer* pBuffer = GetBuffer();
+
+    if (Buffer_IsNextCharEqualTo(pBuffer, 's'))
+        return handleReverseStepCommand();
+    if (Buffer_IsNextCharEqualTo(pBuffer, 'c'))
+        return handleReverseContinueCommand();
+    PrepareEmptyResponseForUnknownCommand();
+    return 0;
+}
+
+static uint32_t sendReverseStopResponse(const char* pReason);
+static uint32_t handleReverseStepCommand(void)
+{
+    if (!Record_StepBack())
+        return sendReverseStopResponse("replaylog:begin;");
+    return sendReverseStopResponse("");
+}
+
+static uint32_t handleReverseContinueCommand(void)
+{
+    while (Record_StepBack())
+    {
+        if (Record_IsBreakpointAt(Platform_GetProgramCounter()))
+            return sendReverseStopResponse("");
+    }
+    return sendReverseStopResponse("replaylog:begin;");
+}
+
+static uint32_t sendReverseStopResponse(const char* pReason)
+{
+    Buffer*   pBuffer = GetInitializedBuffer();
+    uintmri_t threadId = Platform_RtosGetHaltedThreadId();
+
+    SetSignalValue(SIGTRAP);
+    Buffer_WriteChar(pBuffer, 'T');
+    Buffer_WriteByteAsHex(pBuffer, SIGTRAP);
+    if (threadId != 0)
+    {
+        Buffer_WriteString(pBuffer, "thread:");
+        Buffer_WriteUIntegerAsHex(pBuffer, threadId);
+        Buffer_WriteChar(pBuffer, ';');
+    }
+    Buffer_WriteString(pBuffer, pReason);
+    Platform_WriteTResponseRegistersToBuffer(pBuffer);
+
+    SendPacketToGdb();
+    return HANDLER_RETURN_RETURN_IMMEDIATELY;
+}
@@ -12,7 +12,7 @@
    See the License for the specific language governing permissions and
    limitations under the License.
 */
-/* Handler for single step gdb command. */
+/* Handlers for single step and reverse step/continue gdb commands. */
 #ifndef CMD_STEP_H_
 #define CMD_STEP_H_
 
@@ -21,9 +21,11 @@
 /* Real name of functions are in mri namespace. */
 uint32_t mriCmd_HandleSingleStepCommand(void);
 uint32_t mriCmd_HandleSingleStepWithSignalCommand(void);
+uint32_t mriCmd_HandleReverseCommand(void);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
 #define HandleSingleStepCommand           mriCmd_HandleSingleStepCommand
 #define HandleSingleStepWithSignalCommand mriCmd_HandleSingleStepWithSignalCommand
+#define HandleReverseCommand              mriCmd_HandleReverseCommand
 
 #endif /* CMD_STEP_H_ */
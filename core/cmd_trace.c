@@ -0,0 +1,1203 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Handlers for gdb tracepoint commands and the collection of trace frames into the user supplied trace buffer. */
+#include <core/libc.h>
+#include <core/buffer.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/mri.h>
+#include <core/cmd_common.h>
+#include <core/cmd_trace.h>
+
+
+/* The maximum number of tracepoints and the number of memory ranges that each can collect. Tracepoints are armed with
+   hardware breakpoints so there is no point in making MRI_TRACEPOINT_COUNT larger than the number of FPB comparators. */
+#ifndef MRI_TRACEPOINT_COUNT
+    #define MRI_TRACEPOINT_COUNT            6
+#endif
+#ifndef MRI_TRACEPOINT_MEMORY_RANGES
+    #define MRI_TRACEPOINT_MEMORY_RANGES    4
+#endif
+
+typedef struct
+{
+    uintmri_t   offset;
+    uint32_t    length;
+    int32_t     baseRegister;
+} TraceMemoryRange;
+
+typedef struct
+{
+    TraceMemoryRange    memoryRanges[MRI_TRACEPOINT_MEMORY_RANGES];
+    uintmri_t           address;
+    uint32_t            number;
+    uint32_t            passCount;
+    uint32_t            hitCount;
+    uint32_t            memoryRangeCount;
+    uint32_t            flags;
+} Tracepoint;
+
+/* Tracepoint::flags bit definitions. */
+#define TRACEPOINT_FLAGS_DEFINED            (1 << 0)
+#define TRACEPOINT_FLAGS_ENABLED            (1 << 1)
+#define TRACEPOINT_FLAGS_COLLECT_REGISTERS  (1 << 2)
+#define TRACEPOINT_FLAGS_ARMED              (1 << 3)
+
+typedef enum
+{
+    TRACE_STOP_NOT_RUN = 0,
+    TRACE_STOP_COMMAND,
+    TRACE_STOP_BUFFER_FULL,
+    TRACE_STOP_PASS_COUNT
+} TraceStopReason;
+
+/* Frames are stored in the trace buffer using the same layout as gdb's trace file format so that they can be streamed
+   back to gdb as-is with qTBuffer:
+        2-byte tracepoint number
+        4-byte length of the blocks which follow
+        'R' followed by the raw register context
+        'M' followed by 8-byte address, 2-byte length, and then the memory contents
+   A frame is never split across the end of the buffer. When the buffer wraps, the frames which precede wrapOffset
+   are followed by the frames at the start of the buffer. */
+typedef struct
+{
+    Tracepoint      tracepoints[MRI_TRACEPOINT_COUNT];
+    uint8_t*        pBuffer;
+    uint32_t        bufferSize;
+    uint32_t        head;
+    uint32_t        tail;
+    uint32_t        wrapOffset;
+    uint32_t        frameCount;
+    uint32_t        framesCreated;
+    uint32_t        selectedFrame;
+    uint32_t        selectedFrameOffset;
+    uint32_t        uploadIndex;
+    uint32_t        stopTracepoint;
+    TraceStopReason stopReason;
+    uint32_t        flags;
+} TraceState;
+
+static TraceState g_trace;
+
+/* TraceState::flags bit definitions. */
+#define TRACE_FLAGS_RUNNING         (1 << 0)
+#define TRACE_FLAGS_CIRCULAR        (1 << 1)
+#define TRACE_FLAGS_WRAPPED         (1 << 2)
+#define TRACE_FLAGS_FRAME_SELECTED  (1 << 3)
+
+#define TRACE_FRAME_HEADER_SIZE     (sizeof(uint16_t) + sizeof(uint32_t))
+#define TRACE_MEMORY_HEADER_SIZE    (1 + sizeof(uint64_t) + sizeof(uint16_t))
+#define TRACE_NOT_FOUND             0xFFFFFFFF
+
+
+static void clearTraceFrames(void);
+static void disarmTracepoints(void);
+void mriSetTraceBuffer(void* pBuffer, size_t bufferSize)
+{
+    disarmTracepoints();
+    g_trace.flags &= ~TRACE_FLAGS_RUNNING;
+    g_trace.pBuffer = (uint8_t*)pBuffer;
+    g_trace.bufferSize = bufferSize;
+    clearTraceFrames();
+}
+
+static void clearTraceFrames(void)
+{
+    g_trace.head = 0;
+    g_trace.tail = 0;
+    g_trace.wrapOffset = 0;
+    g_trace.frameCount = 0;
+    g_trace.framesCreated = 0;
+    g_trace.flags &= ~(TRACE_FLAGS_WRAPPED | TRACE_FLAGS_FRAME_SELECTED);
+}
+
+static void disarmTracepoints(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_TRACEPOINT_COUNT ; i++)
+    {
+        Tracepoint* pTracepoint = &g_trace.tracepoints[i];
+
+        if ((pTracepoint->flags & TRACEPOINT_FLAGS_ARMED) == 0)
+            continue;
+        __try
+            Platform_ClearHardwareBreakpoint(pTracepoint->address);
+        __catch
+            clearExceptionCode();
+        pTracepoint->flags &= ~TRACEPOINT_FLAGS_ARMED;
+    }
+}
+
+
+static uint32_t handleTraceInitCommand(void);
+static uint32_t handleTraceDefineTracepointCommand(void);
+static uint32_t handleTraceStartCommand(void);
+static uint32_t handleTraceStopCommand(void);
+static uint32_t handleTraceFrameCommand(void);
+static uint32_t handleTraceBufferCommand(void);
+/* Handle the 'QT' commands used by gdb to download tracepoints and control the trace experiment.
+
+    Command Format: QTSSS
+    Where SSS is a variable length string indicating which tracepoint command is being sent to the stub.
+*/
+uint32_t HandleTraceSetCommand(void)
+{
+    Buffer*             pBuffer = GetBuffer();
+    static const char   initCommand[] = "init";
+    static const char   defineCommand[] = "DP";
+    static const char   startCommand[] = "Start";
+    static const char   stopCommand[] = "Stop";
+    static const char   frameCommand[] = "Frame";
+    static const char   bufferCommand[] = "Buffer";
+
+    if (Buffer_MatchesString(pBuffer, initCommand, sizeof(initCommand)-1))
+    {
+        return handleTraceInitCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, defineCommand, sizeof(defineCommand)-1))
+    {
+        return handleTraceDefineTracepointCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, startCommand, sizeof(startCommand)-1))
+    {
+        return handleTraceStartCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, stopCommand, sizeof(stopCommand)-1))
+    {
+        return handleTraceStopCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, frameCommand, sizeof(frameCommand)-1))
+    {
+        return handleTraceFrameCommand();
+    }
+    else if (Buffer_MatchesString(pBuffer, bufferCommand, sizeof(bufferCommand)-1))
+    {
+        return handleTraceBufferCommand();
+    }
+    else
+    {
+        PrepareEmptyResponseForUnknownCommand();
+        return 0;
+    }
+}
+
+/* Handle the "QTinit" command used by gdb to clear out any existing tracepoints and trace frames.
+
+    Command Format: QTinit
+*/
+static uint32_t handleTraceInitCommand(void)
+{
+    disarmTracepoints();
+    mri_memset(g_trace.tracepoints, 0, sizeof(g_trace.tracepoints));
+    clearTraceFrames();
+    g_trace.flags &= ~TRACE_FLAGS_RUNNING;
+    g_trace.stopReason = TRACE_STOP_NOT_RUN;
+    g_trace.stopTracepoint = 0;
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void parseTracepointDefinition(Buffer* pBuffer);
+static void parseTracepointActions(Buffer* pBuffer);
+/* Handle the "QTDP" command used by gdb to define a tracepoint and the data to be collected when it is hit.
+
+    Command Format: QTDP:NNNN:AAAAAAAA:E:SSSS:PPPP[-]
+                    QTDP:-NNNN:AAAAAAAA:action...[-]
+    Where NNNN is the tracepoint number.
+          AAAAAAAA is the address of the tracepoint.
+          E is 'E' for an enabled tracepoint and 'D' for a disabled one.
+          SSSS is the while-stepping count which must be 0 as while-stepping isn't supported.
+          PPPP is the pass count after which tracing should stop or 0 to never stop.
+          action is R followed by a register mask to collect the registers or MBB,OOOO,LLLL to collect LLLL bytes of
+          memory at offset OOOO from base register BB (-1 for an absolute address).
+*/
+static uint32_t handleTraceDefineTracepointCommand(void)
+{
+    Buffer* pBuffer = GetBuffer();
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        if (Buffer_IsNextCharEqualTo(pBuffer, '-'))
+        {
+            __throwing_func( parseTracepointActions(pBuffer) );
+        }
+        else
+        {
+            __throwing_func( parseTracepointDefinition(pBuffer) );
+        }
+    }
+    __catch
+    {
+        if (getExceptionCode() == exceededHardwareResourcesException)
+            PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+        else
+            PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static Tracepoint* findTracepoint(uint32_t number);
+static Tracepoint* allocateTracepoint(void);
+static void        throwIfNotEndOfPacket(Buffer* pBuffer);
+static void parseTracepointDefinition(Buffer* pBuffer)
+{
+    Tracepoint* pTracepoint;
+    uint32_t    number;
+    uintmri_t   address;
+    uint32_t    stepCount;
+    uint32_t    passCount;
+    char        enabled;
+
+    __try
+    {
+        __throwing_func( number = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( address = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( enabled = Buffer_ReadChar(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( stepCount = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( passCount = ReadUIntegerArgument(pBuffer) );
+        if (Buffer_BytesLeft(pBuffer) > 0)
+            Buffer_IsNextCharEqualTo(pBuffer, '-');
+        /* Fast tracepoints, conditions, and while-stepping actions aren't supported. */
+        __throwing_func( throwIfNotEndOfPacket(pBuffer) );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    if ((enabled != 'E' && enabled != 'D') || stepCount != 0)
+        __throw(invalidArgumentException);
+
+    pTracepoint = findTracepoint(number);
+    if (!pTracepoint)
+        pTracepoint = allocateTracepoint();
+    if (!pTracepoint)
+        __throw(exceededHardwareResourcesException);
+
+    mri_memset(pTracepoint, 0, sizeof(*pTracepoint));
+    pTracepoint->number = number;
+    pTracepoint->address = address;
+    pTracepoint->passCount = passCount;
+    pTracepoint->flags = TRACEPOINT_FLAGS_DEFINED;
+    if (enabled == 'E')
+        pTracepoint->flags |= TRACEPOINT_FLAGS_ENABLED;
+}
+
+static Tracepoint* findTracepoint(uint32_t number)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_TRACEPOINT_COUNT ; i++)
+    {
+        Tracepoint* pTracepoint = &g_trace.tracepoints[i];
+        if ((pTracepoint->flags & TRACEPOINT_FLAGS_DEFINED) && pTracepoint->number == number)
+            return pTracepoint;
+    }
+    return NULL;
+}
+
+static Tracepoint* allocateTracepoint(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_TRACEPOINT_COUNT ; i++)
+    {
+        Tracepoint* pTracepoint = &g_trace.tracepoints[i];
+        if ((pTracepoint->flags & TRACEPOINT_FLAGS_DEFINED) == 0)
+            return pTracepoint;
+    }
+    return NULL;
+}
+
+static void throwIfNotEndOfPacket(Buffer* pBuffer)
+{
+    if (Buffer_BytesLeft(pBuffer) != 0)
+        __throw(invalidArgumentException);
+}
+
+static void parseMemoryRangeAction(Buffer* pBuffer, Tracepoint* pTracepoint);
+static void parseTracepointActions(Buffer* pBuffer)
+{
+    Tracepoint* pTracepoint;
+    uint32_t    number;
+    uintmri_t   address;
+
+    __try
+    {
+        __throwing_func( number = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( address = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    pTracepoint = findTracepoint(number);
+    if (!pTracepoint || pTracepoint->address != address)
+        __throw(invalidArgumentException);
+
+    while (Buffer_BytesLeft(pBuffer) > 0)
+    {
+        switch (Buffer_ReadChar(pBuffer))
+        {
+        case 'R':
+            /* All registers in the context are collected no matter which ones are flagged in the mask. */
+            __try
+                ReadUIntegerArgument(pBuffer);
+            __catch
+                __rethrow;
+            pTracepoint->flags |= TRACEPOINT_FLAGS_COLLECT_REGISTERS;
+            break;
+        case 'M':
+            __try
+                parseMemoryRangeAction(pBuffer, pTracepoint);
+            __catch
+                __rethrow;
+            break;
+        case '-':
+            __try
+                throwIfNotEndOfPacket(pBuffer);
+            __catch
+                __rethrow;
+            break;
+        default:
+            /* Agent expressions (X) and while-stepping actions (S) aren't supported. */
+            __throw(invalidArgumentException);
+        }
+    }
+}
+
+static void parseMemoryRangeAction(Buffer* pBuffer, Tracepoint* pTracepoint)
+{
+    TraceMemoryRange range;
+
+    __try
+    {
+        __throwing_func( range.baseRegister = Buffer_ReadIntegerAsHex(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+        __throwing_func( range.offset = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+        __throwing_func( range.length = ReadUIntegerArgument(pBuffer) );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    /* The length field in a trace frame memory block is only 16-bits. */
+    if (range.length == 0 || range.length > 0xFFFF)
+        __throw(invalidArgumentException);
+    if (pTracepoint->memoryRangeCount >= MRI_TRACEPOINT_MEMORY_RANGES)
+        __throw(exceededHardwareResourcesException);
+
+    pTracepoint->memoryRanges[pTracepoint->memoryRangeCount++] = range;
+}
+
+static void armTracepoints(void);
+static void resetHitCounts(void);
+/* Handle the "QTStart" command used by gdb to arm the tracepoints and start collecting trace frames.
+
+    Command Format: QTStart
+*/
+static uint32_t handleTraceStartCommand(void)
+{
+    if (g_trace.pBuffer == NULL || g_trace.bufferSize == 0)
+    {
+        PrepareStringResponse(MRI_ERROR_NO_TRACE_BUFFER);
+        return 0;
+    }
+
+    clearTraceFrames();
+    resetHitCounts();
+    __try
+    {
+        armTracepoints();
+    }
+    __catch
+    {
+        disarmTracepoints();
+        PrepareStringResponse(MRI_ERROR_NO_FREE_BREAKPOINT);
+        return 0;
+    }
+    g_trace.flags |= TRACE_FLAGS_RUNNING;
+    g_trace.stopReason = TRACE_STOP_NOT_RUN;
+    g_trace.stopTracepoint = 0;
+
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void armTracepoints(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_TRACEPOINT_COUNT ; i++)
+    {
+        Tracepoint* pTracepoint = &g_trace.tracepoints[i];
+        uint32_t    armFlags = TRACEPOINT_FLAGS_DEFINED | TRACEPOINT_FLAGS_ENABLED;
+
+        if ((pTracepoint->flags & armFlags) != armFlags)
+            continue;
+        __try
+            Platform_SetHardwareBreakpoint(pTracepoint->address);
+        __catch
+            __rethrow;
+        pTracepoint->flags |= TRACEPOINT_FLAGS_ARMED;
+    }
+}
+
+static void resetHitCounts(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < MRI_TRACEPOINT_COUNT ; i++)
+        g_trace.tracepoints[i].hitCount = 0;
+}
+
+static void stopTrace(TraceStopReason reason, uint32_t tracepointNumber);
+/* Handle the "QTStop" command used by gdb to disarm the tracepoints and stop collecting trace frames.
+
+    Command Format: QTStop
+*/
+static uint32_t handleTraceStopCommand(void)
+{
+    stopTrace(TRACE_STOP_COMMAND, 0);
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void stopTrace(TraceStopReason reason, uint32_t tracepointNumber)
+{
+    if ((g_trace.flags & TRACE_FLAGS_RUNNING) == 0)
+        return;
+    disarmTracepoints();
+    g_trace.flags &= ~TRACE_FLAGS_RUNNING;
+    g_trace.stopReason = reason;
+    g_trace.stopTracepoint = tracepointNumber;
+}
+
+typedef int (*FrameMatchFuncPtr)(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value);
+static uint32_t findFrame(uint32_t startIndex, FrameMatchFuncPtr pMatch, uintmri_t value);
+static int      isFrameAtIndex(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value);
+static int      isFrameAtAddress(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value);
+static int      isFrameForTracepoint(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value);
+static uint32_t getNextSearchStartIndex(void);
+static uint16_t getFrameTracepointNumber(uint32_t frameOffset);
+/* Handle the "QTFrame" command used by gdb to select the trace frame to be used for subsequent register and memory
+   reads.
+
+    Command Format: QTFrame:NNNN
+                    QTFrame:pc:AAAAAAAA
+                    QTFrame:tdp:TTTT
+    Where NNNN is the index of the frame to select (-1 to return to examining the live target).
+          AAAAAAAA selects the next frame collected at this address.
+          TTTT selects the next frame collected by this tracepoint number.
+
+    Response Format: FNNNNTTTT
+                     F-1
+    Where NNNN is the index of the selected frame and TTTT is the number of the tracepoint which collected it.
+*/
+static uint32_t handleTraceFrameCommand(void)
+{
+    Buffer*             pBuffer = GetBuffer();
+    static const char   pcOption[] = "pc";
+    static const char   tdpOption[] = "tdp";
+    FrameMatchFuncPtr   pMatch = isFrameAtIndex;
+    uint32_t            startIndex = 0;
+    uint32_t            frameIndex;
+    uintmri_t           value;
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        if (Buffer_MatchesString(pBuffer, pcOption, sizeof(pcOption)-1))
+        {
+            pMatch = isFrameAtAddress;
+            startIndex = getNextSearchStartIndex();
+            __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        }
+        else if (Buffer_MatchesString(pBuffer, tdpOption, sizeof(tdpOption)-1))
+        {
+            pMatch = isFrameForTracepoint;
+            startIndex = getNextSearchStartIndex();
+            __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        }
+        __throwing_func( value = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( throwIfNotEndOfPacket(pBuffer) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    frameIndex = findFrame(startIndex, pMatch, value);
+    pBuffer = GetInitializedBuffer();
+    if (frameIndex == TRACE_NOT_FOUND)
+    {
+        g_trace.flags &= ~TRACE_FLAGS_FRAME_SELECTED;
+        Buffer_WriteString(pBuffer, "F-1");
+        return 0;
+    }
+
+    g_trace.flags |= TRACE_FLAGS_FRAME_SELECTED;
+    Buffer_WriteChar(pBuffer, 'F');
+    Buffer_WriteUIntegerAsHex(pBuffer, frameIndex);
+    Buffer_WriteChar(pBuffer, 'T');
+    Buffer_WriteUIntegerAsHex(pBuffer, getFrameTracepointNumber(g_trace.selectedFrameOffset));
+    return 0;
+}
+
+static uint32_t getFirstFrameOffset(void);
+static uint32_t getNextFrameOffset(uint32_t frameOffset);
+static uint32_t findFrame(uint32_t startIndex, FrameMatchFuncPtr pMatch, uintmri_t value)
+{
+    uint32_t frameOffset = getFirstFrameOffset();
+    uint32_t i;
+
+    for (i = 0 ; i < g_trace.frameCount ; i++)
+    {
+        if (i >= startIndex && pMatch(i, frameOffset, value))
+        {
+            g_trace.selectedFrame = i;
+            g_trace.selectedFrameOffset = frameOffset;
+            return i;
+        }
+        frameOffset = getNextFrameOffset(frameOffset);
+    }
+    return TRACE_NOT_FOUND;
+}
+
+static int isFrameAtIndex(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value)
+{
+    return frameIndex == value;
+}
+
+static Tracepoint* findTracepointForFrame(uint32_t frameOffset);
+static int isFrameAtAddress(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value)
+{
+    Tracepoint* pTracepoint = findTracepointForFrame(frameOffset);
+    return pTracepoint && pTracepoint->address == value;
+}
+
+static Tracepoint* findTracepointForFrame(uint32_t frameOffset)
+{
+    return findTracepoint(getFrameTracepointNumber(frameOffset));
+}
+
+static int isFrameForTracepoint(uint32_t frameIndex, uint32_t frameOffset, uintmri_t value)
+{
+    return getFrameTracepointNumber(frameOffset) == value;
+}
+
+static uint32_t getNextSearchStartIndex(void)
+{
+    if (g_trace.flags & TRACE_FLAGS_FRAME_SELECTED)
+        return g_trace.selectedFrame + 1;
+    return 0;
+}
+
+static uint16_t getFrameTracepointNumber(uint32_t frameOffset)
+{
+    uint16_t number;
+
+    mri_memcpy(&number, g_trace.pBuffer + frameOffset, sizeof(number));
+    return number;
+}
+
+static uint32_t getFirstFrameOffset(void)
+{
+    return g_trace.head;
+}
+
+static uint32_t getFrameSize(uint32_t frameOffset);
+static uint32_t getNextFrameOffset(uint32_t frameOffset)
+{
+    frameOffset += getFrameSize(frameOffset);
+    if ((g_trace.flags & TRACE_FLAGS_WRAPPED) && frameOffset == g_trace.wrapOffset)
+        return 0;
+    return frameOffset;
+}
+
+static uint32_t getFrameSize(uint32_t frameOffset)
+{
+    uint32_t length;
+
+    mri_memcpy(&length, g_trace.pBuffer + frameOffset + sizeof(uint16_t), sizeof(length));
+    return TRACE_FRAME_HEADER_SIZE + length;
+}
+
+static void parseTraceBufferOption(Buffer* pBuffer);
+/* Handle the "QTBuffer" command used by gdb to configure the trace buffer.
+
+    Command Format: QTBuffer:circular:B
+                    QTBuffer:size:SSSS
+    Where B is 1 to overwrite the oldest frames once the buffer fills or 0 to stop tracing instead.
+          SSSS is the requested buffer size which is ignored as the program supplies the trace buffer.
+*/
+static uint32_t handleTraceBufferCommand(void)
+{
+    Buffer* pBuffer = GetBuffer();
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( parseTraceBufferOption(pBuffer) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    PrepareStringResponse("OK");
+    return 0;
+}
+
+static void parseTraceBufferOption(Buffer* pBuffer)
+{
+    static const char   circularOption[] = "circular";
+    static const char   sizeOption[] = "size";
+    uintmri_t           value;
+
+    if (Buffer_MatchesString(pBuffer, sizeOption, sizeof(sizeOption)-1))
+        return;
+    if (!Buffer_MatchesString(pBuffer, circularOption, sizeof(circularOption)-1))
+        __throw(invalidArgumentException);
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( value = ReadUIntegerArgument(pBuffer) );
+    }
+    __catch
+    {
+        __rethrow;
+    }
+    if (value)
+        g_trace.flags |= TRACE_FLAGS_CIRCULAR;
+    else
+        g_trace.flags &= ~TRACE_FLAGS_CIRCULAR;
+}
+
+
+static uint32_t getUsedBufferSize(void);
+/* Handle the "qTStatus" command used by gdb to query the state of the trace experiment.
+
+    Response Format: TR;RRRR:NNNN;tframes:FFFF;tcreated:CCCC;tfree:SSSS;tsize:TTTT;circular:B;disconn:0
+    Where R is 1 if the trace is running and 0 otherwise.
+          RRRR:NNNN is the reason that the trace stopped (tnotrun, tstop, tfull, or tpasscount) and the tracepoint
+          number which caused it to stop.
+          FFFF is the number of frames currently in the trace buffer.
+          CCCC is the number of frames created since the trace was started.
+          SSSS is the number of free bytes in the trace buffer.
+          TTTT is the total size of the trace buffer.
+          B is 1 if the trace buffer is circular and 0 otherwise.
+*/
+uint32_t HandleTraceStatusQuery(void)
+{
+    Buffer*             pBuffer = GetInitializedBuffer();
+    static const char*  stopReasons[] = { "tnotrun:", "tstop::", "tfull:", "tpasscount:" };
+
+    Buffer_WriteChar(pBuffer, 'T');
+    Buffer_WriteChar(pBuffer, (g_trace.flags & TRACE_FLAGS_RUNNING) ? '1' : '0');
+    Buffer_WriteChar(pBuffer, ';');
+    Buffer_WriteString(pBuffer, stopReasons[g_trace.stopReason]);
+    Buffer_WriteUIntegerAsHex(pBuffer, g_trace.stopTracepoint);
+    Buffer_WriteString(pBuffer, ";tframes:");
+    Buffer_WriteUIntegerAsHex(pBuffer, g_trace.frameCount);
+    Buffer_WriteString(pBuffer, ";tcreated:");
+    Buffer_WriteUIntegerAsHex(pBuffer, g_trace.framesCreated);
+    Buffer_WriteString(pBuffer, ";tfree:");
+    Buffer_WriteUIntegerAsHex(pBuffer, g_trace.bufferSize - getUsedBufferSize());
+    Buffer_WriteString(pBuffer, ";tsize:");
+    Buffer_WriteUIntegerAsHex(pBuffer, g_trace.bufferSize);
+    Buffer_WriteString(pBuffer, ";circular:");
+    Buffer_WriteChar(pBuffer, (g_trace.flags & TRACE_FLAGS_CIRCULAR) ? '1' : '0');
+    Buffer_WriteString(pBuffer, ";disconn:0");
+
+    return 0;
+}
+
+static uint32_t getUsedBufferSize(void)
+{
+    if (g_trace.flags & TRACE_FLAGS_WRAPPED)
+        return (g_trace.wrapOffset - g_trace.head) + g_trace.tail;
+    return g_trace.tail;
+}
+
+
+static uint32_t outputNextTracepointDefinition(void);
+/* Handle the "qTfP" command used by gdb to start uploading the tracepoint definitions from the stub.
+
+    Response Format: TNNNN:AAAAAAAA:E:0:PPPP
+                        -or-
+                     l
+    Where the fields match those used in the QTDP command which defined the tracepoint.
+          The 'l' response indicates that there are no more tracepoints to be uploaded.
+*/
+uint32_t HandleTraceFirstTracepointQuery(void)
+{
+    g_trace.uploadIndex = 0;
+    return outputNextTracepointDefinition();
+}
+
+/* Handle the "qTsP" command used by gdb to upload subsequent tracepoint definitions from the stub.
+
+    Response Format: Same as qTfP.
+*/
+uint32_t HandleTraceSubsequentTracepointQuery(void)
+{
+    return outputNextTracepointDefinition();
+}
+
+static uint32_t outputNextTracepointDefinition(void)
+{
+    Buffer* pBuffer = GetInitializedBuffer();
+
+    while (g_trace.uploadIndex < MRI_TRACEPOINT_COUNT)
+    {
+        Tracepoint* pTracepoint = &g_trace.tracepoints[g_trace.uploadIndex++];
+
+        if ((pTracepoint->flags & TRACEPOINT_FLAGS_DEFINED) == 0)
+            continue;
+        Buffer_WriteChar(pBuffer, 'T');
+        Buffer_WriteUIntegerAsHex(pBuffer, pTracepoint->number);
+        Buffer_WriteChar(pBuffer, ':');
+        Buffer_WriteUIntegerAsHex(pBuffer, pTracepoint->address);
+        Buffer_WriteChar(pBuffer, ':');
+        Buffer_WriteChar(pBuffer, (pTracepoint->flags & TRACEPOINT_FLAGS_ENABLED) ? 'E' : 'D');
+        Buffer_WriteString(pBuffer, ":0:");
+        Buffer_WriteUIntegerAsHex(pBuffer, pTracepoint->passCount);
+        return 0;
+    }
+    Buffer_WriteChar(pBuffer, 'l');
+    return 0;
+}
+
+
+static uint8_t readTraceBufferByte(uint32_t logicalOffset);
+/* Handle the "qTBuffer" command used by gdb to read the raw trace frames (used by tsave).
+
+    Command Format: qTBuffer:OOOO,LLLL
+    Response Format: xx...
+                        -or-
+                     l
+    Where OOOO is the offset into the trace data at which to start reading.
+          LLLL is the number of bytes to be read.
+          xx is the hexadecimal representation of each byte of trace data.
+          The 'l' response indicates that the offset is past the end of the trace data.
+*/
+uint32_t HandleTraceBufferQuery(void)
+{
+    Buffer*         pBuffer = GetBuffer();
+    AddressLength   offsetLength;
+    uint32_t        usedSize = getUsedBufferSize();
+    uint32_t        offset;
+    uint32_t        length;
+
+    __try
+    {
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ':') );
+        __throwing_func( ReadAddressAndLengthArguments(pBuffer, &offsetLength) );
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    pBuffer = GetInitializedBuffer();
+    offset = offsetLength.address;
+    length = offsetLength.length;
+    if (offset >= usedSize)
+    {
+        Buffer_WriteChar(pBuffer, 'l');
+        return 0;
+    }
+    if (length > usedSize - offset)
+        length = usedSize - offset;
+    if (length > Buffer_BytesLeft(pBuffer) / 2)
+        length = Buffer_BytesLeft(pBuffer) / 2;
+
+    while (length--)
+        Buffer_WriteByteAsHex(pBuffer, readTraceBufferByte(offset++));
+
+    return 0;
+}
+
+static uint8_t readTraceBufferByte(uint32_t logicalOffset)
+{
+    uint32_t firstSegmentSize;
+
+    if ((g_trace.flags & TRACE_FLAGS_WRAPPED) == 0)
+        return g_trace.pBuffer[logicalOffset];
+
+    firstSegmentSize = g_trace.wrapOffset - g_trace.head;
+    if (logicalOffset < firstSegmentSize)
+        return g_trace.pBuffer[g_trace.head + logicalOffset];
+    return g_trace.pBuffer[logicalOffset - firstSegmentSize];
+}
+
+
+int IsTraceFrameSelected(void)
+{
+    return (g_trace.flags & TRACE_FLAGS_FRAME_SELECTED) != 0;
+}
+
+
+static uint32_t getRegisterBlockSize(void);
+static uint8_t* findFrameBlock(char blockType, uintmri_t address);
+/* Handle the 'g' command while a trace frame is selected with QTFrame.
+
+    Response Format: xxxxxxxxyyyyyyyy...
+    Where the registers are sent from the frame's register block or as 'x' characters if they weren't collected.
+*/
+uint32_t HandleTraceFrameRegisterReadCommand(void)
+{
+    Buffer*     pBuffer = GetInitializedBuffer();
+    uint32_t    blockSize = getRegisterBlockSize();
+    uint8_t*    pBlock = findFrameBlock('R', 0);
+    uint32_t    i;
+
+    for (i = 0 ; i < blockSize ; i++)
+    {
+        if (pBlock)
+        {
+            Buffer_WriteByteAsHex(pBuffer, pBlock[i]);
+        }
+        else
+        {
+            Buffer_WriteChar(pBuffer, 'x');
+            Buffer_WriteChar(pBuffer, 'x');
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t getRegisterBlockSize(void)
+{
+    return Context_Count(GetContext()) * sizeof(uintmri_t);
+}
+
+static int      doesMemoryBlockContainAddress(uint8_t* pBlock, uintmri_t address);
+static uint64_t getMemoryBlockAddress(uint8_t* pBlock);
+static uint16_t getMemoryBlockLength(uint8_t* pBlock);
+static uint8_t* findFrameBlock(char blockType, uintmri_t address)
+{
+    uint8_t* pFrame = g_trace.pBuffer + g_trace.selectedFrameOffset;
+    uint8_t* pCurr = pFrame + TRACE_FRAME_HEADER_SIZE;
+    uint8_t* pEnd = pFrame + getFrameSize(g_trace.selectedFrameOffset);
+
+    while (pCurr < pEnd)
+    {
+        switch (*pCurr)
+        {
+        case 'R':
+            if (blockType == 'R')
+                return pCurr + 1;
+            pCurr += 1 + getRegisterBlockSize();
+            break;
+        case 'M':
+            if (blockType == 'M' && doesMemoryBlockContainAddress(pCurr, address))
+                return pCurr;
+            pCurr += TRACE_MEMORY_HEADER_SIZE + getMemoryBlockLength(pCurr);
+            break;
+        default:
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static int doesMemoryBlockContainAddress(uint8_t* pBlock, uintmri_t address)
+{
+    uint64_t start = getMemoryBlockAddress(pBlock);
+    return address >= start && address < start + getMemoryBlockLength(pBlock);
+}
+
+static uint64_t getMemoryBlockAddress(uint8_t* pBlock)
+{
+    uint64_t address;
+
+    mri_memcpy(&address, pBlock + 1, sizeof(address));
+    return address;
+}
+
+static uint16_t getMemoryBlockLength(uint8_t* pBlock)
+{
+    uint16_t length;
+
+    mri_memcpy(&length, pBlock + 1 + sizeof(uint64_t), sizeof(length));
+    return length;
+}
+
+/* Handle the 'm' command while a trace frame is selected with QTFrame.
+
+    Command Format:     mAAAAAAAA,LLLLLLLL
+    Response Format:    xx...
+
+    Only memory which was collected in the selected frame can be read and the read will be truncated at the end of
+    the memory block which contains the starting address.
+*/
+uint32_t HandleTraceFrameMemoryReadCommand(void)
+{
+    Buffer*       pBuffer = GetBuffer();
+    AddressLength addressLength;
+    uint8_t*      pBlock;
+    uint64_t      offset;
+    uint32_t      length;
+    uint32_t      available;
+
+    __try
+    {
+        ReadAddressAndLengthArguments(pBuffer, &addressLength);
+    }
+    __catch
+    {
+        PrepareStringResponse(MRI_ERROR_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    pBlock = findFrameBlock('M', addressLength.address);
+    if (!pBlock)
+    {
+        PrepareStringResponse(MRI_ERROR_MEMORY_ACCESS_FAILURE);
+        return 0;
+    }
+
+    offset = addressLength.address - getMemoryBlockAddress(pBlock);
+    available = getMemoryBlockLength(pBlock) - (uint32_t)offset;
+    length = addressLength.length;
+    if (length > available)
+        length = available;
+
+    pBuffer = GetInitializedBuffer();
+    pBlock += TRACE_MEMORY_HEADER_SIZE + offset;
+    while (length--)
+        Buffer_WriteByteAsHex(pBuffer, *pBlock++);
+
+    return 0;
+}
+
+
+static Tracepoint* findArmedTracepointAtAddress(uintmri_t address, Tracepoint* pStart);
+static int         collectTraceFrame(Tracepoint* pTracepoint);
+static int         hasPassCountBeenReached(Tracepoint* pTracepoint);
+int ProcessTracepointHit(void)
+{
+    uintmri_t   pc = Platform_GetProgramCounter() & ~1;
+    Tracepoint* pTracepoint;
+    uint32_t    stopTracepointNumber = 0;
+    int         passCountReached = 0;
+
+    if ((g_trace.flags & TRACE_FLAGS_RUNNING) == 0 ||
+        Platform_GetTrapReason().type != MRI_PLATFORM_TRAP_TYPE_HWBREAK)
+    {
+        return 0;
+    }
+    pTracepoint = findArmedTracepointAtAddress(pc, g_trace.tracepoints);
+    if (!pTracepoint)
+        return 0;
+
+    do
+    {
+        pTracepoint->hitCount++;
+        if (!collectTraceFrame(pTracepoint))
+        {
+            stopTrace(TRACE_STOP_BUFFER_FULL, 0);
+            return 1;
+        }
+        if (!passCountReached && hasPassCountBeenReached(pTracepoint))
+        {
+            passCountReached = 1;
+            stopTracepointNumber = pTracepoint->number;
+        }
+        pTracepoint = findArmedTracepointAtAddress(pc, pTracepoint + 1);
+    } while (pTracepoint);
+
+    if (passCountReached)
+        stopTrace(TRACE_STOP_PASS_COUNT, stopTracepointNumber);
+    else
+        StepOverHardwareBreakpoint(pc);
+    return 1;
+}
+
+static Tracepoint* findArmedTracepointAtAddress(uintmri_t address, Tracepoint* pStart)
+{
+    Tracepoint* pEnd = &g_trace.tracepoints[MRI_TRACEPOINT_COUNT];
+    Tracepoint* pCurr;
+
+    for (pCurr = pStart ; pCurr < pEnd ; pCurr++)
+    {
+        if ((pCurr->flags & TRACEPOINT_FLAGS_ARMED) && (pCurr->address & ~1) == address)
+            return pCurr;
+    }
+    return NULL;
+}
+
+static uint32_t calculateFrameSize(Tracepoint* pTracepoint);
+static uint8_t* allocateFrame(uint32_t frameSize);
+static uint8_t* writeRegisterBlock(uint8_t* pDest);
+static uint8_t* writeMemoryBlock(uint8_t* pDest, TraceMemoryRange* pRange);
+static int collectTraceFrame(Tracepoint* pTracepoint)
+{
+    uint32_t frameSize = calculateFrameSize(pTracepoint);
+    uint8_t* pFrame = allocateFrame(frameSize);
+    uint8_t* pCurr;
+    uint16_t number = (uint16_t)pTracepoint->number;
+    uint32_t length = frameSize - TRACE_FRAME_HEADER_SIZE;
+    uint32_t i;
+
+    if (!pFrame)
+        return 0;
+
+    mri_memcpy(pFrame, &number, sizeof(number));
+    mri_memcpy(pFrame + sizeof(number), &length, sizeof(length));
+    pCurr = pFrame + TRACE_FRAME_HEADER_SIZE;
+    if (pTracepoint->flags & TRACEPOINT_FLAGS_COLLECT_REGISTERS)
+        pCurr = writeRegisterBlock(pCurr);
+    for (i = 0 ; i < pTracepoint->memoryRangeCount ; i++)
+        pCurr = writeMemoryBlock(pCurr, &pTracepoint->memoryRanges[i]);
+
+    return 1;
+}
+
+static uint32_t calculateFrameSize(Tracepoint* pTracepoint)
+{
+    uint32_t size = TRACE_FRAME_HEADER_SIZE;
+    uint32_t i;
+
+    if (pTracepoint->flags & TRACEPOINT_FLAGS_COLLECT_REGISTERS)
+        size += 1 + getRegisterBlockSize();
+    for (i = 0 ; i < pTracepoint->memoryRangeCount ; i++)
+        size += TRACE_MEMORY_HEADER_SIZE + pTracepoint->memoryRanges[i].length;
+
+    return size;
+}
+
+static void discardOldestFrame(void);
+static uint8_t* allocateFrame(uint32_t frameSize)
+{
+    uint8_t* pFrame;
+
+    if (frameSize > g_trace.bufferSize)
+        return NULL;
+
+    for (;;)
+    {
+        if ((g_trace.flags & TRACE_FLAGS_WRAPPED) == 0)
+        {
+            if (g_trace.tail + frameSize <= g_trace.bufferSize)
+                break;
+            if ((g_trace.flags & TRACE_FLAGS_CIRCULAR) == 0)
+                return NULL;
+            /* Leave the unused space at the end of the buffer and wrap back around to the beginning. */
+            g_trace.wrapOffset = g_trace.tail;
+            g_trace.tail = 0;
+            g_trace.flags |= TRACE_FLAGS_WRAPPED;
+        }
+        if (g_trace.tail + frameSize <= g_trace.head)
+            break;
+        discardOldestFrame();
+    }
+
+    pFrame = g_trace.pBuffer + g_trace.tail;
+    g_trace.tail += frameSize;
+    g_trace.frameCount++;
+    g_trace.framesCreated++;
+    return pFrame;
+}
+
+static void discardOldestFrame(void)
+{
+    g_trace.head += getFrameSize(g_trace.head);
+    g_trace.frameCount--;
+    if (g_trace.head >= g_trace.wrapOffset)
+    {
+        g_trace.head = 0;
+        g_trace.wrapOffset = 0;
+        g_trace.flags &= ~TRACE_FLAGS_WRAPPED;
+    }
+}
+
+static uint8_t* writeRegisterBlock(uint8_t* pDest)
+{
+    MriContext* pContext = GetContext();
+    size_t      count = Context_Count(pContext);
+    size_t      i;
+
+    *pDest++ = 'R';
+    for (i = 0 ; i < count ; i++)
+    {
+        uintmri_t reg = Context_Get(pContext, i);
+        mri_memcpy(pDest, &reg, sizeof(reg));
+        pDest += sizeof(reg);
+    }
+    return pDest;
+}
+
+static uintmri_t calculateRangeAddress(TraceMemoryRange* pRange);
+static uint8_t* writeMemoryBlock(uint8_t* pDest, TraceMemoryRange* pRange)
+{
+    uint64_t  address = calculateRangeAddress(pRange);
+    uint16_t  length = (uint16_t)pRange->length;
+    uintmri_t curr = (uintmri_t)address;
+    uint16_t  i;
+
+    *pDest++ = 'M';
+    mri_memcpy(pDest, &address, sizeof(address));
+    pDest += sizeof(address);
+    mri_memcpy(pDest, &length, sizeof(length));
+    pDest += sizeof(length);
+    for (i = 0 ; i < length ; i++)
+    {
+        uint8_t byte = Platform_MemRead8(curr++);
+
+        /* Record inaccessible bytes as 0 so that the frame layout remains fixed. */
+        if (Platform_WasMemoryFaultEncountered())
+            byte = 0;
+        *pDest++ = byte;
+    }
+    return pDest;
+}
+
+static uintmri_t calculateRangeAddress(TraceMemoryRange* pRange)
+{
+    uintmri_t baseAddress = 0;
+
+    if (pRange->baseRegister >= 0)
+    {
+        __try
+            baseAddress = Context_Get(GetContext(), pRange->baseRegister);
+        __catch
+            clearExceptionCode();
+    }
+    return baseAddress + pRange->offset;
+}
+
+static int hasPassCountBeenReached(Tracepoint* pTracepoint)
+{
+    return pTracepoint->passCount != 0 && pTracepoint->hitCount >= pTracepoint->passCount;
+}
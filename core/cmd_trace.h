@@ -0,0 +1,43 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Handlers for gdb tracepoint commands and the collection of trace frames into the user supplied trace buffer. */
+#ifndef CMD_TRACE_H_
+#define CMD_TRACE_H_
+
+#include <stdint.h>
+
+/* Real name of functions are in mri namespace. */
+uint32_t mriCmd_HandleTraceSetCommand(void);
+uint32_t mriCmd_HandleTraceStatusQuery(void);
+uint32_t mriCmd_HandleTraceFirstTracepointQuery(void);
+uint32_t mriCmd_HandleTraceSubsequentTracepointQuery(void);
+uint32_t mriCmd_HandleTraceBufferQuery(void);
+int      mriCmd_IsTraceFrameSelected(void);
+uint32_t mriCmd_HandleTraceFrameRegisterReadCommand(void);
+uint32_t mriCmd_HandleTraceFrameMemoryReadCommand(void);
+int      mriCmd_ProcessTracepointHit(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define HandleTraceSetCommand                   mriCmd_HandleTraceSetCommand
+#define HandleTraceStatusQuery                  mriCmd_HandleTraceStatusQuery
+#define HandleTraceFirstTracepointQuery         mriCmd_HandleTraceFirstTracepointQuery
+#define HandleTraceSubsequentTracepointQuery    mriCmd_HandleTraceSubsequentTracepointQuery
+#define HandleTraceBufferQuery                  mriCmd_HandleTraceBufferQuery
+#define IsTraceFrameSelected                    mriCmd_IsTraceFrameSelected
+#define HandleTraceFrameRegisterReadCommand     mriCmd_HandleTraceFrameRegisterReadCommand
+#define HandleTraceFrameMemoryReadCommand       mriCmd_HandleTraceFrameMemoryReadCommand
+#define ProcessTracepointHit                    mriCmd_ProcessTracepointHit
+
+#endif /* CMD_TRACE_H_ */
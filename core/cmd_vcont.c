@@ -20,6 +20,7 @@
 #include <core/cmd_continue.h>
 #include <core/cmd_registers.h>
 #include <core/cmd_step.h>
+#include <core/cmd_vfile.h>
 #include <core/core.h>
 #include <core/mri.h>
 #include <core/platforms.h>
@@ -89,6 +90,7 @@ uint32_t HandleVContCommands(void)
     Buffer*             pBuffer = GetBuffer();
     static const char   vContQueryCommand[] = "Cont?";
     static const char   vContCommand[] = "Cont";
+    static const char   vFileCommand[] = "File";
 
     if (Buffer_MatchesString(pBuffer, vContQueryCommand, sizeof(vContQueryCommand)-1))
     {
@@ -98,6 +100,10 @@ uint32_t HandleVContCommands(void)
     {
         return handleVContCommand();
     }
+    else if (Buffer_MatchesString(pBuffer, vFileCommand, sizeof(vFileCommand)-1))
+    {
+        return HandleVFileCommand();
+    }
     else
     {
         PrepareEmptyResponseForUnknownCommand();
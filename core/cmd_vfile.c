@@ -0,0 +1,377 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Handler for gdb's vFile host I/O commands which give gdb access to files on the target's filesystem. */
+#include <core/libc.h>
+#include <core/buffer.h>
+#include <core/cmd_common.h>
+#include <core/cmd_vfile.h>
+#include <core/core.h>
+#include <core/fileio.h>
+#include <core/platforms.h>
+#include <core/try_catch.h>
+
+
+/* Space reserved at the start of a pread response for the 'F', up to 8 hex digits of byte count, and the ';'. */
+#define PREAD_HEADER_SIZE   10
+
+static uint32_t handleOpenCommand(Buffer* pBuffer);
+static uint32_t handleCloseCommand(Buffer* pBuffer);
+static uint32_t handlePReadCommand(Buffer* pBuffer);
+static uint32_t handlePWriteCommand(Buffer* pBuffer);
+static uint32_t handleFStatCommand(Buffer* pBuffer);
+static uint32_t handleUnlinkCommand(Buffer* pBuffer);
+static int      matchesOperation(Buffer* pBuffer, const char* pOperation, size_t operationLength);
+static void     prepareResultResponse(int result);
+/* Handle the "vFile" commands used by gdb's remote get, remote put, and remote delete commands. The actual file
+   operations are carried out by the Platform_Fs*() hooks. Arguments which can't be parsed are reported back to gdb
+   as EINVAL and unsupported operations get an empty response.
+
+    Command Format: vFile:operation:parameter...
+    Response Format: Fresult[,errno][;attachment]
+*/
+uint32_t HandleVFileCommand(void)
+{
+    static const char openCommand[] = "open";
+    static const char closeCommand[] = "close";
+    static const char preadCommand[] = "pread";
+    static const char pwriteCommand[] = "pwrite";
+    static const char fstatCommand[] = "fstat";
+    static const char unlinkCommand[] = "unlink";
+    Buffer*           pBuffer = GetBuffer();
+
+    if (Buffer_IsNextCharEqualTo(pBuffer, ':'))
+    {
+        if (matchesOperation(pBuffer, openCommand, sizeof(openCommand)-1))
+            return handleOpenCommand(pBuffer);
+        else if (matchesOperation(pBuffer, closeCommand, sizeof(closeCommand)-1))
+            return handleCloseCommand(pBuffer);
+        else if (matchesOperation(pBuffer, preadCommand, sizeof(preadCommand)-1))
+            return handlePReadCommand(pBuffer);
+        else if (matchesOperation(pBuffer, pwriteCommand, sizeof(pwriteCommand)-1))
+            return handlePWriteCommand(pBuffer);
+        else if (matchesOperation(pBuffer, fstatCommand, sizeof(fstatCommand)-1))
+            return handleFStatCommand(pBuffer);
+        else if (matchesOperation(pBuffer, unlinkCommand, sizeof(unlinkCommand)-1))
+            return handleUnlinkCommand(pBuffer);
+    }
+
+    PrepareEmptyResponseForUnknownCommand();
+    return 0;
+}
+
+static int matchesOperation(Buffer* pBuffer, const char* pOperation, size_t operationLength)
+{
+    return Buffer_MatchesString(pBuffer, pOperation, operationLength) && Buffer_IsNextCharEqualTo(pBuffer, ':');
+}
+
+static void prepareResultResponse(int result)
+{
+    Buffer* pBuffer = GetInitializedBuffer();
+
+    Buffer_WriteChar(pBuffer, 'F');
+    if (result >= 0)
+    {
+        Buffer_WriteUIntegerAsHex(pBuffer, result);
+        return;
+    }
+    Buffer_WriteString(pBuffer, "-1,");
+    Buffer_WriteUIntegerAsHex(pBuffer, -result);
+}
+
+
+/* Handle the "vFile:open" command.
+
+    Command Format: vFile:open:filename,flags,mode
+    Where filename is hex encoded and flags and mode are the GDB_O_* and GDB_S_* values in hex.
+*/
+static const char* readHexFilename(Buffer* pBuffer);
+static uint32_t handleOpenCommand(Buffer* pBuffer)
+{
+    const char* pFilename;
+    uint32_t    flags;
+    uint32_t    mode;
+
+    __try
+    {
+        __throwing_func( pFilename = readHexFilename(pBuffer) );
+        __throwing_func( flags = ReadUIntegerArgument(pBuffer) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+        __throwing_func( mode = ReadUIntegerArgument(pBuffer) );
+    }
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    prepareResultResponse(Platform_FsOpen(pFilename, flags, mode));
+    return 0;
+}
+
+/* The filename is decoded in place, overwriting the hex digits it came from. The ',' which follows it (or the end of
+   the packet) is replaced with the '\0' terminator. */
+static const char* readHexFilename(Buffer* pBuffer)
+{
+    char* pFilename = pBuffer->pCurrent;
+    char* pDest = pFilename;
+
+    while (Buffer_BytesLeft(pBuffer) > 0 && !Buffer_IsNextCharEqualTo(pBuffer, ','))
+    {
+        __try
+            *pDest++ = (char)Buffer_ReadByteAsHex(pBuffer);
+        __catch
+            __throw_and_return(invalidArgumentException, NULL);
+    }
+    *pDest = '\0';
+    return pFilename;
+}
+
+
+/* Handle the "vFile:close" command.
+
+    Command Format: vFile:close:fd
+*/
+static uint32_t handleCloseCommand(Buffer* pBuffer)
+{
+    int fileDescriptor;
+
+    __try
+        fileDescriptor = ReadUIntegerArgument(pBuffer);
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    prepareResultResponse(Platform_FsClose(fileDescriptor));
+    return 0;
+}
+
+
+/* Handle the "vFile:pread" command.
+
+    Command Format:  vFile:pread:fd,count,offset
+    Response Format: Fcount;data
+    Where data is the bytes read in escaped binary format.
+
+    The data is read into the end of the packet buffer and then escaped towards the front of it. A little less than
+    the whole buffer is read so that the escaped output has some room to grow before it catches up with the bytes
+    still to be escaped. If it does catch up then the response is cut short there, which gdb handles like any other
+    short read.
+*/
+static uint32_t escapeBytesInPlace(char* pDest, const char* pSrc, uint32_t count, uint32_t* pEscapedSize);
+static int      isBinaryCharToEscape(char byte);
+static uint32_t maxPReadCount(uint32_t bufferSize);
+static uint32_t handlePReadCommand(Buffer* pBuffer)
+{
+    AddressLength fileDescriptorCount;
+    uint32_t      offset;
+    char*         pStart;
+    char*         pData;
+    uint32_t      size;
+    uint32_t      count;
+    uint32_t      escapedSize;
+    int32_t       result;
+
+    __try
+    {
+        __throwing_func( ReadAddressAndLengthArguments(pBuffer, &fileDescriptorCount) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+        __throwing_func( offset = ReadUIntegerArgument(pBuffer) );
+    }
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    pBuffer = GetInitializedBuffer();
+    pStart = Buffer_GetArray(pBuffer);
+    size = Buffer_BytesLeft(pBuffer);
+    count = fileDescriptorCount.length;
+    if (count > maxPReadCount(size))
+        count = maxPReadCount(size);
+    pData = pStart + size - count;
+
+    result = Platform_FsPRead(fileDescriptorCount.address, pData, count, offset);
+    if (result < 0)
+    {
+        prepareResultResponse(result);
+        return 0;
+    }
+    if ((uint32_t)result > count)
+        result = count;
+
+    count = escapeBytesInPlace(pStart + PREAD_HEADER_SIZE, pData, result, &escapedSize);
+    prepareResultResponse(count);
+    Buffer_WriteChar(pBuffer, ';');
+    mri_memmove(pBuffer->pCurrent, pStart + PREAD_HEADER_SIZE, escapedSize);
+    Buffer_Advance(pBuffer, escapedSize);
+    return 0;
+}
+
+/* Random data only needs to escape 1 in 64 bytes so leaving 1/16th of the space free rarely cuts a read short. At
+   least 1 byte is always left free so that the first byte can be sent even if it needs to be escaped. */
+static uint32_t maxPReadCount(uint32_t bufferSize)
+{
+    uint32_t space = bufferSize - PREAD_HEADER_SIZE;
+
+    return space - space / 16 - 1;
+}
+
+/* Returns the number of source bytes which were escaped before the output would have caught up with them. */
+static uint32_t escapeBytesInPlace(char* pDest, const char* pSrc, uint32_t count, uint32_t* pEscapedSize)
+{
+    const char* pSrcStart = pSrc;
+    char*       pDestStart = pDest;
+
+    while (count-- > 0)
+    {
+        char byte = *pSrc;
+
+        if (isBinaryCharToEscape(byte))
+        {
+            if (pDest >= pSrc)
+                break;
+            *pDest++ = '}';
+            byte ^= 0x20;
+        }
+        *pDest++ = byte;
+        pSrc++;
+    }
+    *pEscapedSize = pDest - pDestStart;
+    return pSrc - pSrcStart;
+}
+
+static int isBinaryCharToEscape(char byte)
+{
+    return byte == '$' || byte == '#' || byte == '}' || byte == '*';
+}
+
+
+/* Handle the "vFile:pwrite" command.
+
+    Command Format:  vFile:pwrite:fd,offset,data
+    Response Format: Fcount
+    Where data is the bytes to be written in binary format. The packet layer has already removed the escaping.
+*/
+static uint32_t handlePWriteCommand(Buffer* pBuffer)
+{
+    AddressLength fileDescriptorOffset;
+
+    __try
+    {
+        __throwing_func( ReadAddressAndLengthArguments(pBuffer, &fileDescriptorOffset) );
+        __throwing_func( ThrowIfNextCharIsNotEqualTo(pBuffer, ',') );
+    }
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    prepareResultResponse(Platform_FsPWrite(fileDescriptorOffset.address, pBuffer->pCurrent,
+                                            Buffer_BytesLeft(pBuffer), fileDescriptorOffset.length));
+    return 0;
+}
+
+
+/* Handle the "vFile:fstat" command.
+
+    Command Format:  vFile:fstat:fd
+    Response Format: Fsize;stat
+    Where stat is a big endian GdbStats structure in escaped binary format and size is its length.
+*/
+static void writeBigEndianWordAsBinary(Buffer* pBuffer, uint32_t word);
+static uint32_t handleFStatCommand(Buffer* pBuffer)
+{
+    PlatformFileStat fileStat;
+    GdbStats         gdbStats;
+    const uint32_t*  pWord;
+    size_t           i;
+    int              fileDescriptor;
+    int              result;
+
+    __try
+        fileDescriptor = ReadUIntegerArgument(pBuffer);
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    mri_memset(&fileStat, 0, sizeof(fileStat));
+    result = Platform_FsFStat(fileDescriptor, &fileStat);
+    if (result < 0)
+    {
+        prepareResultResponse(result);
+        return 0;
+    }
+
+    mri_memset(&gdbStats, 0, sizeof(gdbStats));
+    gdbStats.mode = fileStat.mode;
+    gdbStats.numberOfLinks = 1;
+    gdbStats.totalSizeLowerWord = fileStat.size;
+    gdbStats.lastAccessTime = fileStat.lastModifiedTime;
+    gdbStats.lastModifiedTime = fileStat.lastModifiedTime;
+    gdbStats.lastChangeTime = fileStat.lastModifiedTime;
+
+    prepareResultResponse(sizeof(gdbStats));
+    pBuffer = GetBuffer();
+    Buffer_WriteChar(pBuffer, ';');
+    pWord = (const uint32_t*)&gdbStats;
+    for (i = 0 ; i < sizeof(gdbStats) / sizeof(*pWord) ; i++)
+        writeBigEndianWordAsBinary(pBuffer, pWord[i]);
+    return 0;
+}
+
+static void writeBigEndianWordAsBinary(Buffer* pBuffer, uint32_t word)
+{
+    int shift;
+
+    for (shift = 24 ; shift >= 0 ; shift -= 8)
+    {
+        char byte = (char)(word >> shift);
+
+        if (isBinaryCharToEscape(byte))
+        {
+            Buffer_WriteChar(pBuffer, '}');
+            byte ^= 0x20;
+        }
+        Buffer_WriteChar(pBuffer, byte);
+    }
+}
+
+
+/* Handle the "vFile:unlink" command.
+
+    Command Format: vFile:unlink:filename
+    Where filename is hex encoded.
+*/
+static uint32_t handleUnlinkCommand(Buffer* pBuffer)
+{
+    const char* pFilename;
+
+    __try
+        pFilename = readHexFilename(pBuffer);
+    __catch
+    {
+        prepareResultResponse(-GDB_EINVAL);
+        return 0;
+    }
+
+    prepareResultResponse(Platform_FsUnlink(pFilename));
+    return 0;
+}
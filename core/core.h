@@ -45,6 +45,8 @@ int     mriCore_WasControlCEncountered(void);
 void    mriCore_ControlCEncountered(void);
 int     mriCore_WasSemihostCallCancelledByGdb(void);
 void    mriCore_FlagSemihostCallAsHandled(void);
+void    mriCore_SetIssuingFileIOForDebugger(int isIssuing);
+int     mriCore_IsIssuingFileIOForDebugger(void);
 int     mriCore_IsFirstException(void);
 int     mriCore_WasSuccessfullyInit(void);
 void    mriCore_RequestResetOnNextContinue(void);
@@ -54,6 +56,7 @@ void    mriCore_SetSingleSteppingRange(const AddressRange* pRange);
 
 MriContext* mriCore_GetContext(void);
 void        mriCore_SetContext(MriContext* pContext);
+MriContext* mriCore_GetHaltedContext(void);
 
 void    mriCore_SetSignalValue(uint8_t signalValue);
 uint8_t mriCore_GetSignalValue(void);
@@ -66,6 +69,7 @@ void    mriCore_GdbCommandHandlingLoop(void);
 
 typedef int (*TempBreakpointCallbackPtr)(void*);
 int     mriCore_SetTempBreakpoint(uint32_t breakpointAddress, TempBreakpointCallbackPtr pCallback, void* pvContext);
+void    mriCore_StepOverHardwareBreakpoint(uint32_t breakpointAddress);
 
 void    mriCoreSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHookPtr pLeavingHook, void* pvContext);
 
@@ -81,6 +85,8 @@ void    mriCoreSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHoo
 #define ControlCEncountered              mriCore_ControlCEncountered
 #define WasSemihostCallCancelledByGdb    mriCore_WasSemihostCallCancelledByGdb
 #define FlagSemihostCallAsHandled        mriCore_FlagSemihostCallAsHandled
+#define SetIssuingFileIOForDebugger      mriCore_SetIssuingFileIOForDebugger
+#define IsIssuingFileIOForDebugger       mriCore_IsIssuingFileIOForDebugger
 #define IsFirstException                 mriCore_IsFirstException
 #define WasSuccessfullyInit              mriCore_WasSuccessfullyInit
 #define RequestResetOnNextContinue       mriCore_RequestResetOnNextContinue
@@ -89,6 +95,7 @@ void    mriCoreSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHoo
 #define SetSingleSteppingRange           mriCore_SetSingleSteppingRange
 #define GetContext                       mriCore_GetContext
 #define SetContext                       mriCore_SetContext
+#define GetHaltedContext                 mriCore_GetHaltedContext
 #define SetSignalValue                   mriCore_SetSignalValue
 #define GetSignalValue                   mriCore_GetSignalValue
 #define SetSemihostReturnValues          mriCore_SetSemihostReturnValues
@@ -97,6 +104,7 @@ void    mriCoreSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHoo
 #define SendPacketToGdb                  mriCore_SendPacketToGdb
 #define GdbCommandHandlingLoop           mriCore_GdbCommandHandlingLoop
 #define SetTempBreakpoint                mriCore_SetTempBreakpoint
+#define StepOverHardwareBreakpoint       mriCore_StepOverHardwareBreakpoint
 #define SetDebuggerHooks                 mriCoreSetDebuggerHooks
 
 #endif /* CORE_H_ */
@@ -0,0 +1,401 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* ELF core dumps of the halted program which are streamed to the gdb host through File-I/O. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/context.h>
+#include <core/platforms.h>
+#include <core/fileio.h>
+#include <core/cmd_file.h>
+#include <core/gdb_console.h>
+#include <core/coredump.h>
+
+
+/* Sizes and field values for a 32-bit little endian ARM ELF core file. */
+#define ELF_HEADER_SIZE         52
+#define PROGRAM_HEADER_SIZE     32
+#define ELF_ET_CORE             4
+#define ELF_EM_ARM              40
+#define ELF_EF_ARM_EABI_VER5    0x05000000
+#define ELF_PT_LOAD             1
+#define ELF_PT_NOTE             4
+#define ELF_PF_W                2
+#define ELF_PF_R                4
+
+/* Each thread gets a NT_PRSTATUS note laid out like the ARM Linux elf_prstatus structure since that is what gdb
+   knows how to pull the registers from. Its register set is r0-r15 followed by cpsr and orig_r0. */
+#define NOTE_HEADER_SIZE        12
+#define NOTE_NAME_SIZE          8
+#define NOTE_NT_PRSTATUS        1
+#define PRSTATUS_SIZE           148
+#define PRSTATUS_CURSIG_OFFSET  12
+#define PRSTATUS_PID_OFFSET     24
+#define PRSTATUS_REGS_OFFSET    72
+#define PRSTATUS_CONTEXT_REGS   17
+#define NOTE_SIZE               (NOTE_HEADER_SIZE + NOTE_NAME_SIZE + PRSTATUS_SIZE)
+
+typedef struct
+{
+    uint32_t start;
+    uint32_t length;
+} CoredumpRegion;
+
+/* The file headers and each note are built in the staging buffer before gdb is asked to write them out. The RAM
+   regions themselves are written straight from their place in memory. */
+typedef struct
+{
+    union
+    {
+        uint8_t headers[ELF_HEADER_SIZE + (1 + MRI_COREDUMP_MAX_REGIONS) * PROGRAM_HEADER_SIZE];
+        uint8_t note[NOTE_SIZE];
+    } staging;
+    CoredumpRegion regions[MRI_COREDUMP_MAX_REGIONS];
+    char           filename[64];
+    uint32_t       regionCount;
+    uint32_t       threadCount;
+    int            isRequested;
+} CoredumpState;
+
+static CoredumpState g_coredump;
+
+
+/* The core file can't be written from within a monitor command since gdb only accepts File-I/O requests from the
+   target while it thinks that the target is running. It is instead written by Coredump_WriteRequested() once gdb
+   next resumes execution and before the program has had a chance to run. */
+void Coredump_Request(const char* pFilename)
+{
+    size_t filenameLength = mri_strlen(pFilename);
+
+    if (filenameLength == 0)
+        __throw(invalidArgumentException);
+    if (filenameLength >= sizeof(g_coredump.filename))
+        __throw(bufferOverrunException);
+
+    mri_memcpy(g_coredump.filename, pFilename, filenameLength + 1);
+    g_coredump.isRequested = 1;
+}
+
+
+void Coredump_Cancel(void)
+{
+    g_coredump.isRequested = 0;
+}
+
+
+/* Returns 0 if CTRL+C was pressed in gdb while the core file was being written. */
+static int writeCoreFileToGdbHost(void);
+int Coredump_WriteRequested(void)
+{
+    int wasCompleted;
+
+    if (!g_coredump.isRequested)
+        return 1;
+    Coredump_Cancel();
+
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = writeCoreFileToGdbHost();
+    SetIssuingFileIOForDebugger(0);
+
+    return wasCompleted;
+}
+
+static void     findRamRegions(void);
+static uint32_t countThreads(void);
+static int      writeHeaders(uint32_t fileDescriptor, int* pWasWritten);
+static int      writeNotes(uint32_t fileDescriptor, int* pWasWritten);
+static int      writeRegions(uint32_t fileDescriptor, int* pWasWritten);
+static int writeCoreFileToGdbHost(void)
+{
+    OpenParameters openParameters;
+    int            fileDescriptor;
+    int            wasWritten = 1;
+
+    findRamRegions();
+    g_coredump.threadCount = countThreads();
+
+    openParameters.filenameAddress = (uint32_t)(uintptr_t)g_coredump.filename;
+    openParameters.filenameLength = mri_strlen(g_coredump.filename) + 1;
+    openParameters.flags = GDB_O_WRONLY | GDB_O_CREAT | GDB_O_TRUNC;
+    openParameters.mode = GDB_S_IRUSR | GDB_S_IWUSR | GDB_S_IRGRP | GDB_S_IROTH;
+    if (!IssueGdbFileOpenRequest(&openParameters))
+        return 0;
+    fileDescriptor = GetSemihostReturnCode();
+    if (fileDescriptor < 0)
+    {
+        WriteStringToGdbConsole("Failed to open core dump file.\r\n");
+        return 1;
+    }
+
+    if (!writeHeaders(fileDescriptor, &wasWritten) ||
+        !writeNotes(fileDescriptor, &wasWritten) ||
+        !writeRegions(fileDescriptor, &wasWritten))
+    {
+        IssueGdbFileCloseRequest(fileDescriptor);
+        return 0;
+    }
+
+    if (!IssueGdbFileCloseRequest(fileDescriptor))
+        return 0;
+    WriteStringToGdbConsole(wasWritten ? "Core dump written.\r\n" : "Failed to write core dump file.\r\n");
+    return 1;
+}
+
+/* Pulls the RAM regions out of the same memory map XML that is sent to gdb for qXfer:memory-map:read. */
+static const char* findTagEnd(const char* pTag);
+static const char* findAttribute(const char* pTag, const char* pTagEnd, const char* pAttribute);
+static uint32_t    parseNumber(const char* pText);
+static void findRamRegions(void)
+{
+    static const char memoryTag[] = "<memory ";
+    const char*       pCurr = Platform_GetDeviceMemoryMapXml();
+
+    g_coredump.regionCount = 0;
+    while (g_coredump.regionCount < MRI_COREDUMP_MAX_REGIONS && (pCurr = mri_strstr(pCurr, memoryTag)) != NULL)
+    {
+        CoredumpRegion* pRegion = &g_coredump.regions[g_coredump.regionCount];
+        const char*     pTagEnd = findTagEnd(pCurr);
+        const char*     pType = findAttribute(pCurr, pTagEnd, "type=\"");
+        const char*     pStart = findAttribute(pCurr, pTagEnd, "start=\"");
+        const char*     pLength = findAttribute(pCurr, pTagEnd, "length=\"");
+
+        pCurr = pTagEnd;
+        if (pType == NULL || pStart == NULL || pLength == NULL || mri_strncmp(pType, "ram\"", 4) != 0)
+            continue;
+        pRegion->start = parseNumber(pStart);
+        pRegion->length = parseNumber(pLength);
+        if (pRegion->length != 0)
+            g_coredump.regionCount++;
+    }
+}
+
+static const char* findTagEnd(const char* pTag)
+{
+    while (*pTag && *pTag != '>')
+        pTag++;
+    return pTag;
+}
+
+static const char* findAttribute(const char* pTag, const char* pTagEnd, const char* pAttribute)
+{
+    const char* pFound = mri_strstr(pTag, pAttribute);
+
+    if (pFound == NULL || pFound >= pTagEnd)
+        return NULL;
+    return pFound + mri_strlen(pAttribute);
+}
+
+static int isHexDigit(char c);
+static int hexDigitValue(char c);
+static uint32_t parseNumber(const char* pText)
+{
+    uint32_t value = 0;
+
+    if (pText[0] == '0' && (pText[1] == 'x' || pText[1] == 'X'))
+    {
+        for (pText += 2 ; isHexDigit(*pText) ; pText++)
+            value = (value << 4) | hexDigitValue(*pText);
+        return value;
+    }
+    for ( ; *pText >= '0' && *pText <= '9' ; pText++)
+        value = value * 10 + (*pText - '0');
+    return value;
+}
+
+static int isHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int hexDigitValue(char c)
+{
+    if (c >= 'a')
+        return c - 'a' + 10;
+    if (c >= 'A')
+        return c - 'A' + 10;
+    return c - '0';
+}
+
+/* The halted thread always gets the first note so that gdb selects it when the core file is opened. The program
+   stays halted while the file is written so the thread list walked by writeNotes() will match this count. */
+static MriContext* getOtherThreadContext(uintmri_t threadId, uintmri_t haltedThreadId);
+static uint32_t countThreads(void)
+{
+    uintmri_t haltedThreadId = Platform_RtosGetHaltedThreadId();
+    uintmri_t threadId;
+    uint32_t  count = 1;
+
+    for (threadId = Platform_RtosGetFirstThreadId() ; threadId != 0 ; threadId = Platform_RtosGetNextThreadId())
+    {
+        if (getOtherThreadContext(threadId, haltedThreadId))
+            count++;
+    }
+    return count;
+}
+
+static MriContext* getOtherThreadContext(uintmri_t threadId, uintmri_t haltedThreadId)
+{
+    if (threadId == haltedThreadId)
+        return NULL;
+    return Platform_RtosGetThreadContext(threadId);
+}
+
+static uint8_t* writeLE16(uint8_t* pDest, uint16_t value);
+static uint8_t* writeLE32(uint8_t* pDest, uint32_t value);
+static uint8_t* writeProgramHeader(uint8_t* pDest, uint32_t type, uint32_t offset, uint32_t address,
+                                   uint32_t size, uint32_t flags);
+static int      writeToFile(uint32_t fileDescriptor, uint32_t address, uint32_t size, int* pWasWritten);
+static int writeHeaders(uint32_t fileDescriptor, int* pWasWritten)
+{
+    static const uint8_t ident[16] = { 0x7F, 'E', 'L', 'F', 1 /* 32-bit */, 1 /* little endian */, 1 /* version */ };
+    uint8_t*             pCurr = g_coredump.staging.headers;
+    uint32_t             programHeaderCount = 1 + g_coredump.regionCount;
+    uint32_t             notesOffset = ELF_HEADER_SIZE + programHeaderCount * PROGRAM_HEADER_SIZE;
+    uint32_t             offset = notesOffset + g_coredump.threadCount * NOTE_SIZE;
+    uint32_t             i;
+
+    mri_memcpy(pCurr, ident, sizeof(ident));
+    pCurr += sizeof(ident);
+    pCurr = writeLE16(pCurr, ELF_ET_CORE);
+    pCurr = writeLE16(pCurr, ELF_EM_ARM);
+    pCurr = writeLE32(pCurr, 1);
+    pCurr = writeLE32(pCurr, 0);
+    pCurr = writeLE32(pCurr, ELF_HEADER_SIZE);
+    pCurr = writeLE32(pCurr, 0);
+    pCurr = writeLE32(pCurr, ELF_EF_ARM_EABI_VER5);
+    pCurr = writeLE16(pCurr, ELF_HEADER_SIZE);
+    pCurr = writeLE16(pCurr, PROGRAM_HEADER_SIZE);
+    pCurr = writeLE16(pCurr, programHeaderCount);
+    pCurr = writeLE16(pCurr, 0);
+    pCurr = writeLE16(pCurr, 0);
+    pCurr = writeLE16(pCurr, 0);
+
+    pCurr = writeProgramHeader(pCurr, ELF_PT_NOTE, notesOffset, 0, g_coredump.threadCount * NOTE_SIZE, 0);
+    for (i = 0 ; i < g_coredump.regionCount ; i++)
+    {
+        CoredumpRegion* pRegion = &g_coredump.regions[i];
+
+        pCurr = writeProgramHeader(pCurr, ELF_PT_LOAD, offset, pRegion->start, pRegion->length, ELF_PF_R | ELF_PF_W);
+        offset += pRegion->length;
+    }
+
+    return writeToFile(fileDescriptor, (uint32_t)(uintptr_t)g_coredump.staging.headers,
+                       pCurr - g_coredump.staging.headers, pWasWritten);
+}
+
+static uint8_t* writeLE16(uint8_t* pDest, uint16_t value)
+{
+    *pDest++ = value & 0xFF;
+    *pDest++ = value >> 8;
+    return pDest;
+}
+
+static uint8_t* writeLE32(uint8_t* pDest, uint32_t value)
+{
+    pDest = writeLE16(pDest, value & 0xFFFF);
+    return writeLE16(pDest, value >> 16);
+}
+
+static uint8_t* writeProgramHeader(uint8_t* pDest, uint32_t type, uint32_t offset, uint32_t address,
+                                   uint32_t size, uint32_t flags)
+{
+    pDest = writeLE32(pDest, type);
+    pDest = writeLE32(pDest, offset);
+    pDest = writeLE32(pDest, address);
+    pDest = writeLE32(pDest, address);
+    pDest = writeLE32(pDest, size);
+    pDest = writeLE32(pDest, size);
+    pDest = writeLE32(pDest, flags);
+    return writeLE32(pDest, type == ELF_PT_NOTE ? 4 : 1);
+}
+
+/* Once a write has failed, the rest of the file is skipped but 1 is still returned so that the file gets closed. */
+static int writeToFile(uint32_t fileDescriptor, uint32_t address, uint32_t size, int* pWasWritten)
+{
+    TransferParameters parameters;
+
+    if (!*pWasWritten)
+        return 1;
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.bufferAddress = address;
+    parameters.bufferSize = size;
+    if (!IssueGdbFileWriteRequest(&parameters))
+        return 0;
+    *pWasWritten = GetSemihostReturnCode() == (int)size;
+    return 1;
+}
+
+static int writeNote(uint32_t fileDescriptor, uintmri_t threadId, MriContext* pContext, uint8_t signal,
+                     int* pWasWritten);
+static int writeNotes(uint32_t fileDescriptor, int* pWasWritten)
+{
+    uintmri_t haltedThreadId = Platform_RtosGetHaltedThreadId();
+    uintmri_t threadId;
+
+    if (!writeNote(fileDescriptor, haltedThreadId, GetHaltedContext(), GetSignalValue(), pWasWritten))
+        return 0;
+    for (threadId = Platform_RtosGetFirstThreadId() ; threadId != 0 ; threadId = Platform_RtosGetNextThreadId())
+    {
+        MriContext* pContext = getOtherThreadContext(threadId, haltedThreadId);
+
+        if (pContext && !writeNote(fileDescriptor, threadId, pContext, 0, pWasWritten))
+            return 0;
+    }
+    return 1;
+}
+
+static int writeNote(uint32_t fileDescriptor, uintmri_t threadId, MriContext* pContext, uint8_t signal,
+                     int* pWasWritten)
+{
+    static const char name[NOTE_NAME_SIZE] = "CORE";
+    uint8_t*          pNote = g_coredump.staging.note;
+    uint8_t*          pStatus = pNote + NOTE_HEADER_SIZE + NOTE_NAME_SIZE;
+    uint8_t*          pRegs = pStatus + PRSTATUS_REGS_OFFSET;
+    size_t            regCount = pContext ? Context_Count(pContext) : 0;
+    size_t            i;
+
+    /* There is nothing more to write once a write has failed. */
+    if (!*pWasWritten)
+        return 1;
+    mri_memset(pNote, 0, NOTE_SIZE);
+    writeLE32(pNote, sizeof("CORE"));
+    writeLE32(pNote + 4, PRSTATUS_SIZE);
+    writeLE32(pNote + 8, NOTE_NT_PRSTATUS);
+    mri_memcpy(pNote + NOTE_HEADER_SIZE, name, sizeof(name));
+
+    writeLE16(pStatus + PRSTATUS_CURSIG_OFFSET, signal);
+    /* gdb treats a pid of 0 as no thread at all so use 1 when there is no RTOS. */
+    writeLE32(pStatus + PRSTATUS_PID_OFFSET, threadId ? (uint32_t)threadId : 1);
+    if (regCount > PRSTATUS_CONTEXT_REGS)
+        regCount = PRSTATUS_CONTEXT_REGS;
+    for (i = 0 ; i < regCount ; i++)
+        pRegs = writeLE32(pRegs, (uint32_t)Context_Get(pContext, i));
+
+    return writeToFile(fileDescriptor, (uint32_t)(uintptr_t)pNote, NOTE_SIZE, pWasWritten);
+}
+
+static int writeRegions(uint32_t fileDescriptor, int* pWasWritten)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_coredump.regionCount ; i++)
+    {
+        CoredumpRegion* pRegion = &g_coredump.regions[i];
+
+        if (!writeToFile(fileDescriptor, pRegion->start, pRegion->length, pWasWritten))
+            return 0;
+    }
+    return 1;
+}
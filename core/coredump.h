@@ -0,0 +1,37 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* ELF core dumps of the halted program which are streamed to the gdb host through File-I/O. */
+#ifndef COREDUMP_H_
+#define COREDUMP_H_
+
+#include <core/try_catch.h>
+
+/* Maximum number of RAM regions from the device's memory map which will be saved in a core dump. Any extra regions
+   are left out of the dump. */
+#ifndef MRI_COREDUMP_MAX_REGIONS
+#define MRI_COREDUMP_MAX_REGIONS    8
+#endif
+
+/* Real name of functions are in mri namespace. */
+__throws void mriCoredump_Request(const char* pFilename);
+void          mriCoredump_Cancel(void);
+int           mriCoredump_WriteRequested(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Coredump_Request        mriCoredump_Request
+#define Coredump_Cancel         mriCoredump_Cancel
+#define Coredump_WriteRequested mriCoredump_WriteRequested
+
+#endif /* COREDUMP_H_ */
@@ -0,0 +1,284 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Basic block code coverage collected by rotating hardware breakpoints through a list of block addresses. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/mri.h>
+#include <core/coverage.h>
+
+
+typedef struct
+{
+    uintmri_t address;
+    uint32_t  index;
+} CoverageArmedBlock;
+
+typedef struct
+{
+    CoverageArmedBlock armed[MRI_COVERAGE_MAX_ARMED];
+    uint8_t*           pBitmap;
+    size_t             bitmapCapacity;
+    uintmri_t          listAddress;
+    uint32_t           blockCount;
+    uint32_t           nextBlock;
+    uint32_t           hitCount;
+    uint32_t           armedCount;
+    uint32_t           flags;
+} CoverageState;
+
+static CoverageState g_coverage;
+
+/* CoverageState::flags bit definitions. */
+#define COVERAGE_FLAGS_RUNNING  (1 << 0)
+
+
+void mriSetCoverageBuffer(void* pBuffer, size_t bufferSize)
+{
+    Coverage_Reset();
+    g_coverage.pBitmap = (uint8_t*)pBuffer;
+    g_coverage.bitmapCapacity = pBuffer ? bufferSize : 0;
+}
+
+
+void Coverage_Reset(void)
+{
+    Coverage_Stop();
+    g_coverage.blockCount = 0;
+    g_coverage.nextBlock = 0;
+    g_coverage.hitCount = 0;
+}
+
+
+static size_t    calculateBitmapSize(uint32_t blockCount);
+static void      validateBlockList(uintmri_t listAddress, uint32_t blockCount);
+static uintmri_t readBlockAddress(uintmri_t listAddress, uint32_t index);
+static void      armBlocks(void);
+void Coverage_Start(uintmri_t listAddress, uint32_t blockCount)
+{
+    if (g_coverage.pBitmap == NULL)
+        __throw(notFoundException);
+    if (blockCount == 0)
+        __throw(invalidArgumentException);
+    if (calculateBitmapSize(blockCount) > g_coverage.bitmapCapacity)
+        __throw(bufferOverrunException);
+    __try
+        validateBlockList(listAddress, blockCount);
+    __catch
+        __rethrow;
+
+    Coverage_Reset();
+    mri_memset(g_coverage.pBitmap, 0, calculateBitmapSize(blockCount));
+    g_coverage.listAddress = listAddress;
+    g_coverage.blockCount = blockCount;
+    g_coverage.flags = COVERAGE_FLAGS_RUNNING;
+    armBlocks();
+    if (g_coverage.armedCount == 0 && g_coverage.nextBlock < g_coverage.blockCount)
+    {
+        Coverage_Reset();
+        __throw(exceededHardwareResourcesException);
+    }
+}
+
+static size_t calculateBitmapSize(uint32_t blockCount)
+{
+    return ((size_t)blockCount + 7) / 8;
+}
+
+static void validateBlockList(uintmri_t listAddress, uint32_t blockCount)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < blockCount ; i++)
+    {
+        __try
+            readBlockAddress(listAddress, i);
+        __catch
+            __rethrow;
+    }
+}
+
+static uintmri_t readBlockAddress(uintmri_t listAddress, uint32_t index)
+{
+    uint32_t address = Platform_MemRead32(listAddress + (uintmri_t)index * sizeof(uint32_t));
+
+    if (Platform_WasMemoryFaultEncountered())
+        __throw_and_return(memFaultException, 0);
+    return address & ~1;
+}
+
+/* Blocks are armed in list order so every block before nextBlock has either already been armed or couldn't be.
+   Blocks which the platform refuses to set a breakpoint on (an address that can't be read for example) are skipped
+   and stay clear in the bitmap. Arming stops as soon as the platform runs out of comparators and picks up from the
+   same block the next time that one is retired. */
+static void armBlock(CoverageArmedBlock* pArmed, uint32_t index);
+static void armBlocks(void)
+{
+    while (g_coverage.armedCount < MRI_COVERAGE_MAX_ARMED && g_coverage.nextBlock < g_coverage.blockCount)
+    {
+        __try
+            armBlock(&g_coverage.armed[g_coverage.armedCount], g_coverage.nextBlock);
+        __catch
+        {
+            int exceptionCode = getExceptionCode();
+
+            clearExceptionCode();
+            if (exceptionCode == exceededHardwareResourcesException)
+                return;
+            g_coverage.nextBlock++;
+            continue;
+        }
+        g_coverage.armedCount++;
+        g_coverage.nextBlock++;
+    }
+}
+
+static int isAddressArmed(uintmri_t address);
+static void armBlock(CoverageArmedBlock* pArmed, uint32_t index)
+{
+    pArmed->index = index;
+    __try
+        pArmed->address = readBlockAddress(g_coverage.listAddress, index);
+    __catch
+        __rethrow;
+    if (isAddressArmed(pArmed->address))
+        return;
+    __try
+        Platform_SetHardwareBreakpoint(pArmed->address);
+    __catch
+        __rethrow;
+}
+
+static int isAddressArmed(uintmri_t address)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_coverage.armedCount ; i++)
+    {
+        if (g_coverage.armed[i].address == address)
+            return 1;
+    }
+    return 0;
+}
+
+
+static void clearBreakpoint(uintmri_t address);
+void Coverage_Stop(void)
+{
+    while (g_coverage.armedCount > 0)
+    {
+        uintmri_t address = g_coverage.armed[--g_coverage.armedCount].address;
+
+        if (!isAddressArmed(address))
+            clearBreakpoint(address);
+    }
+    g_coverage.flags = 0;
+}
+
+static void clearBreakpoint(uintmri_t address)
+{
+    __try
+        Platform_ClearHardwareBreakpoint(address);
+    __catch
+        clearExceptionCode();
+}
+
+
+int Coverage_IsRunning(void)
+{
+    return g_coverage.flags & COVERAGE_FLAGS_RUNNING;
+}
+
+
+int Coverage_HasBuffer(void)
+{
+    return g_coverage.pBitmap != NULL;
+}
+
+
+uint32_t Coverage_GetBlockCount(void)
+{
+    return g_coverage.blockCount;
+}
+
+
+uint32_t Coverage_GetHitCount(void)
+{
+    return g_coverage.hitCount;
+}
+
+
+uint32_t Coverage_GetArmedCount(void)
+{
+    return g_coverage.armedCount;
+}
+
+
+const uint8_t* Coverage_GetBitmap(void)
+{
+    return g_coverage.pBitmap;
+}
+
+
+size_t Coverage_GetBitmapSize(void)
+{
+    if (g_coverage.pBitmap == NULL)
+        return 0;
+    return calculateBitmapSize(g_coverage.blockCount);
+}
+
+
+/* A hit breakpoint is retired rather than stepped over so the program resumes by executing the instruction at the
+   start of the block as normal. Its comparator is then free to be armed on the next block in the list. */
+static int retireBlocksAt(uintmri_t address);
+int Coverage_ProcessBreakpointHit(void)
+{
+    uintmri_t pc = Platform_GetProgramCounter() & ~1;
+
+    if (!Coverage_IsRunning() || Platform_GetTrapReason().type != MRI_PLATFORM_TRAP_TYPE_HWBREAK)
+        return 0;
+    if (!retireBlocksAt(pc))
+        return 0;
+
+    clearBreakpoint(pc);
+    armBlocks();
+    return 1;
+}
+
+static void markBlockAsHit(uint32_t index);
+static int retireBlocksAt(uintmri_t address)
+{
+    int      retiredCount = 0;
+    uint32_t i = 0;
+
+    while (i < g_coverage.armedCount)
+    {
+        if (g_coverage.armed[i].address != address)
+        {
+            i++;
+            continue;
+        }
+        markBlockAsHit(g_coverage.armed[i].index);
+        g_coverage.armed[i] = g_coverage.armed[--g_coverage.armedCount];
+        retiredCount++;
+    }
+    return retiredCount;
+}
+
+static void markBlockAsHit(uint32_t index)
+{
+    g_coverage.pBitmap[index / 8] |= 1 << (index % 8);
+    g_coverage.hitCount++;
+}
@@ -0,0 +1,56 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Basic block code coverage collected by rotating hardware breakpoints through a list of block addresses. */
+#ifndef COVERAGE_H_
+#define COVERAGE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <core/try_catch.h>
+#include <core/mri_int.h>
+
+/* Maximum number of hardware breakpoints that coverage will keep armed at once. Fewer are used if gdb or other
+   monitor commands already have some of the comparators. */
+#ifndef MRI_COVERAGE_MAX_ARMED
+    #define MRI_COVERAGE_MAX_ARMED  8
+#endif
+
+/* Real name of functions are in mri namespace. */
+void           mriCoverage_Reset(void);
+__throws void  mriCoverage_Start(uintmri_t listAddress, uint32_t blockCount);
+void           mriCoverage_Stop(void);
+int            mriCoverage_IsRunning(void);
+int            mriCoverage_HasBuffer(void);
+uint32_t       mriCoverage_GetBlockCount(void);
+uint32_t       mriCoverage_GetHitCount(void);
+uint32_t       mriCoverage_GetArmedCount(void);
+const uint8_t* mriCoverage_GetBitmap(void);
+size_t         mriCoverage_GetBitmapSize(void);
+int            mriCoverage_ProcessBreakpointHit(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Coverage_Reset                  mriCoverage_Reset
+#define Coverage_Start                  mriCoverage_Start
+#define Coverage_Stop                   mriCoverage_Stop
+#define Coverage_IsRunning              mriCoverage_IsRunning
+#define Coverage_HasBuffer              mriCoverage_HasBuffer
+#define Coverage_GetBlockCount          mriCoverage_GetBlockCount
+#define Coverage_GetHitCount            mriCoverage_GetHitCount
+#define Coverage_GetArmedCount          mriCoverage_GetArmedCount
+#define Coverage_GetBitmap              mriCoverage_GetBitmap
+#define Coverage_GetBitmapSize          mriCoverage_GetBitmapSize
+#define Coverage_ProcessBreakpointHit   mriCoverage_ProcessBreakpointHit
+
+#endif /* COVERAGE_H_ */
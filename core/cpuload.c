@@ -0,0 +1,147 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Per-thread CPU utilization built from periodic samples of the running RTOS thread. */
+#include <core/libc.h>
+#include <core/platforms.h>
+#include <core/cpuload.h>
+
+
+typedef struct
+{
+    CpuLoadThread threads[MRI_CPULOAD_MAX_THREADS];
+    uint32_t      threadCount;
+    uint32_t      totalTicks;
+    uint32_t      interruptTicks;
+    uint32_t      otherThreadTicks;
+    uint32_t      flags;
+} CpuLoadState;
+
+static CpuLoadState g_cpuLoad;
+
+/* CpuLoadState::flags bit definitions. */
+#define CPULOAD_FLAGS_RUNNING   (1 << 0)
+
+
+void CpuLoad_Reset(void)
+{
+    CpuLoad_Stop();
+    mri_memset(&g_cpuLoad, 0, sizeof(g_cpuLoad));
+}
+
+
+void CpuLoad_Start(uint32_t sampleInterval)
+{
+    if (sampleInterval == 0)
+        __throw(invalidArgumentException);
+
+    CpuLoad_Reset();
+    __try
+        Platform_StartCpuLoadSampling(sampleInterval);
+    __catch
+        __rethrow;
+    g_cpuLoad.flags |= CPULOAD_FLAGS_RUNNING;
+}
+
+
+void CpuLoad_Stop(void)
+{
+    if (!CpuLoad_IsRunning())
+        return;
+    Platform_StopCpuLoadSampling();
+    g_cpuLoad.flags &= ~CPULOAD_FLAGS_RUNNING;
+}
+
+
+int CpuLoad_IsRunning(void)
+{
+    return g_cpuLoad.flags & CPULOAD_FLAGS_RUNNING;
+}
+
+
+/* Called by the platform each time that the sample interval elapses. Samples taken while an exception handler was
+   running are only counted as interrupt time. Otherwise the sample is charged to whichever thread the RTOS reports
+   as currently running, which is always thread 0 when there is no RTOS. */
+static CpuLoadThread* findOrAddThread(uintmri_t threadId);
+void CpuLoad_RecordSample(int wasInterruptActive)
+{
+    CpuLoadThread* pThread;
+
+    if (!CpuLoad_IsRunning())
+        return;
+
+    g_cpuLoad.totalTicks++;
+    if (wasInterruptActive)
+    {
+        g_cpuLoad.interruptTicks++;
+        return;
+    }
+
+    pThread = findOrAddThread(Platform_RtosGetHaltedThreadId());
+    if (pThread)
+        pThread->ticks++;
+    else
+        g_cpuLoad.otherThreadTicks++;
+}
+
+static CpuLoadThread* findOrAddThread(uintmri_t threadId)
+{
+    CpuLoadThread* pThread;
+    uint32_t       i;
+
+    for (i = 0 ; i < g_cpuLoad.threadCount ; i++)
+    {
+        if (g_cpuLoad.threads[i].threadId == threadId)
+            return &g_cpuLoad.threads[i];
+    }
+    if (g_cpuLoad.threadCount >= MRI_CPULOAD_MAX_THREADS)
+        return NULL;
+
+    pThread = &g_cpuLoad.threads[g_cpuLoad.threadCount++];
+    pThread->threadId = threadId;
+    pThread->ticks = 0;
+    return pThread;
+}
+
+
+uint32_t CpuLoad_GetTotalTicks(void)
+{
+    return g_cpuLoad.totalTicks;
+}
+
+
+uint32_t CpuLoad_GetInterruptTicks(void)
+{
+    return g_cpuLoad.interruptTicks;
+}
+
+
+uint32_t CpuLoad_GetOtherThreadTicks(void)
+{
+    return g_cpuLoad.otherThreadTicks;
+}
+
+
+uint32_t CpuLoad_GetThreadCount(void)
+{
+    return g_cpuLoad.threadCount;
+}
+
+
+const CpuLoadThread* CpuLoad_GetThread(uint32_t index)
+{
+    if (index >= g_cpuLoad.threadCount)
+        return NULL;
+    return &g_cpuLoad.threads[index];
+}
@@ -0,0 +1,62 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Per-thread CPU utilization built from periodic samples of the running RTOS thread. */
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+#include <core/mri_int.h>
+
+/* Default number of CPU cycles between samples when "monitor cpuload start" isn't given an interval. */
+#define MRI_CPULOAD_DEFAULT_INTERVAL    100000
+
+/* Number of distinct threads which get their own tick count. Samples from any threads after that are lumped
+   together. */
+#ifndef MRI_CPULOAD_MAX_THREADS
+    #define MRI_CPULOAD_MAX_THREADS     16
+#endif
+
+typedef struct
+{
+    uintmri_t threadId;
+    uint32_t  ticks;
+} CpuLoadThread;
+
+/* Real name of functions are in mri namespace. */
+void                 mriCpuLoad_Reset(void);
+__throws void        mriCpuLoad_Start(uint32_t sampleInterval);
+void                 mriCpuLoad_Stop(void);
+int                  mriCpuLoad_IsRunning(void);
+void                 mriCpuLoad_RecordSample(int wasInterruptActive);
+uint32_t             mriCpuLoad_GetTotalTicks(void);
+uint32_t             mriCpuLoad_GetInterruptTicks(void);
+uint32_t             mriCpuLoad_GetOtherThreadTicks(void);
+uint32_t             mriCpuLoad_GetThreadCount(void);
+const CpuLoadThread* mriCpuLoad_GetThread(uint32_t index);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define CpuLoad_Reset               mriCpuLoad_Reset
+#define CpuLoad_Start               mriCpuLoad_Start
+#define CpuLoad_Stop                mriCpuLoad_Stop
+#define CpuLoad_IsRunning           mriCpuLoad_IsRunning
+#define CpuLoad_RecordSample        mriCpuLoad_RecordSample
+#define CpuLoad_GetTotalTicks       mriCpuLoad_GetTotalTicks
+#define CpuLoad_GetInterruptTicks   mriCpuLoad_GetInterruptTicks
+#define CpuLoad_GetOtherThreadTicks mriCpuLoad_GetOtherThreadTicks
+#define CpuLoad_GetThreadCount      mriCpuLoad_GetThreadCount
+#define CpuLoad_GetThread           mriCpuLoad_GetThread
+
+#endif /* CPULOAD_H_ */
@@ -0,0 +1,172 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* 64-bit clock built on the cycle counter so that semihost timing calls can be answered without a gdb round trip. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/fileio.h>
+#include <core/cmd_file.h>
+#include <core/cycle_clock.h>
+
+
+/* The 32-bit cycle counter is extended to 64-bits each time that it is read. It is also read each time the debugger
+   is entered so that a wrap is only missed if the program runs for longer than a full counter period without making
+   a timing call or stopping. */
+typedef struct
+{
+    GdbTimeVal timeVal;
+    uint64_t   cycles;
+    uint64_t   syncCycles;
+    uint32_t   lastCounter;
+    uint32_t   syncSeconds;
+    int        isStarted;
+    int        isSynced;
+} CycleClockState;
+
+static CycleClockState g_clock;
+
+
+void CycleClock_Reset(void)
+{
+    mri_memset(&g_clock, 0, sizeof(g_clock));
+}
+
+
+/* Called each time the debugger is entered to account for any cycle counter wraps since the last timing call. */
+static void updateCycles(void);
+void CycleClock_Update(void)
+{
+    if (g_clock.isStarted)
+        updateCycles();
+}
+
+static void updateCycles(void)
+{
+    uint32_t counter = Platform_GetCycleCounter();
+
+    g_clock.cycles += (uint32_t)(counter - g_clock.lastCounter);
+    g_clock.lastCounter = counter;
+}
+
+
+/* Returns the number of cycles since the program's first timing call. The cycle counter is enabled on that first
+   call, which throws if the device doesn't have one. */
+uint64_t CycleClock_GetCycles(void)
+{
+    if (!g_clock.isStarted)
+    {
+        __try
+            Platform_EnableCycleCounter();
+        __catch
+            __rethrow_and_return(0);
+        g_clock.lastCounter = Platform_GetCycleCounter();
+        g_clock.isStarted = 1;
+    }
+    updateCycles();
+    return g_clock.cycles;
+}
+
+
+static uint32_t getCpuClockFrequency(void);
+uint32_t CycleClock_GetCentiseconds(void)
+{
+    uint64_t cycles;
+    uint32_t frequency;
+
+    __try
+    {
+        __throwing_func( frequency = getCpuClockFrequency() );
+        __throwing_func( cycles = CycleClock_GetCycles() );
+    }
+    __catch
+        __rethrow_and_return(0);
+    return (uint32_t)(cycles / (frequency / 100));
+}
+
+static uint32_t getCpuClockFrequency(void)
+{
+    uint32_t frequency = Platform_GetCpuClockFrequency();
+
+    if (frequency < 100)
+        __throw_and_return(invalidValueException, 0);
+    return frequency;
+}
+
+
+/* Returns the seconds since the Unix epoch. gdb is asked for the host's time of day on the first call and the cycle
+   counter is used to advance it locally after that. Returns 0 if CTRL+C was pressed in gdb while waiting for the
+   time so that the semihost call is retried when execution resumes. Sets *pSeconds to -1 if gdb couldn't provide
+   the time or if the device has no cycle counter or known clock frequency. */
+static int      syncWithGdb(void);
+static uint32_t extractWordFromBigEndian(const uint32_t* pBigEndianWord);
+int CycleClock_GetEpochSeconds(uint32_t* pSeconds)
+{
+    uint64_t cycles;
+    uint32_t frequency;
+
+    __try
+    {
+        __throwing_func( frequency = getCpuClockFrequency() );
+        __throwing_func( cycles = CycleClock_GetCycles() );
+    }
+    __catch
+    {
+        clearExceptionCode();
+        *pSeconds = (uint32_t)-1;
+        return 1;
+    }
+
+    if (!g_clock.isSynced && !syncWithGdb())
+        return 0;
+    if (!g_clock.isSynced)
+    {
+        *pSeconds = (uint32_t)-1;
+        return 1;
+    }
+    *pSeconds = g_clock.syncSeconds + (uint32_t)((cycles - g_clock.syncCycles) / frequency);
+    return 1;
+}
+
+static int syncWithGdb(void)
+{
+    int wasCompleted;
+
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = IssueGdbGetTimeOfDayRequest((uint32_t)(uintptr_t)&g_clock.timeVal);
+    SetIssuingFileIOForDebugger(0);
+    if (!wasCompleted)
+        return 0;
+    if (GetSemihostReturnCode() != 0)
+        return 1;
+
+    g_clock.syncCycles = g_clock.cycles;
+    g_clock.syncSeconds = extractWordFromBigEndian(&g_clock.timeVal.seconds);
+    g_clock.isSynced = 1;
+    return 1;
+}
+
+static uint32_t extractWordFromBigEndian(const uint32_t* pBigEndianWord)
+{
+    const uint8_t* pBytes = (const uint8_t*)pBigEndianWord;
+
+    return ((uint32_t)pBytes[0] << 24) | ((uint32_t)pBytes[1] << 16) | ((uint32_t)pBytes[2] << 8) | pBytes[3];
+}
+
+
+/* Returns non-zero once the host's time of day has been fetched so that SYS_TIME no longer needs to talk to gdb. */
+int CycleClock_IsSyncedWithGdb(void)
+{
+    return g_clock.isSynced;
+}
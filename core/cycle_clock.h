@@ -0,0 +1,38 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* 64-bit clock built on the cycle counter so that semihost timing calls can be answered without a gdb round trip. */
+#ifndef CYCLE_CLOCK_H_
+#define CYCLE_CLOCK_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Real name of functions are in mri namespace. */
+void              mriCycleClock_Reset(void);
+void              mriCycleClock_Update(void);
+__throws uint64_t mriCycleClock_GetCycles(void);
+__throws uint32_t mriCycleClock_GetCentiseconds(void);
+int               mriCycleClock_GetEpochSeconds(uint32_t* pSeconds);
+int               mriCycleClock_IsSyncedWithGdb(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define CycleClock_Reset            mriCycleClock_Reset
+#define CycleClock_Update           mriCycleClock_Update
+#define CycleClock_GetCycles        mriCycleClock_GetCycles
+#define CycleClock_GetCentiseconds  mriCycleClock_GetCentiseconds
+#define CycleClock_GetEpochSeconds  mriCycleClock_GetEpochSeconds
+#define CycleClock_IsSyncedWithGdb  mriCycleClock_IsSyncedWithGdb
+
+#endif /* CYCLE_CLOCK_H_ */
@@ -0,0 +1,204 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Unattended capture of the program's state into RAM which survives a reset when it faults with no gdb attached. */
+#include <core/platforms.h>
+#include <core/core.h>
+#include <core/buffer.h>
+#include <core/context.h>
+#include <core/signal.h>
+#include <core/mri.h>
+#include <core/fault_capture.h>
+
+
+typedef struct
+{
+    FaultCaptureHeader* pHeader;
+    uint32_t            timeoutMilliseconds;
+    int                 isCycleCounterEnabled;
+} FaultCaptureState;
+
+static FaultCaptureState g_faultCapture;
+
+
+static int  isHeaderValid(const FaultCaptureHeader* pHeader, size_t bufferSize);
+static int  enableCycleCounter(void);
+void mriSetFaultCaptureBuffer(void* pBuffer, size_t bufferSize, uint32_t timeoutMilliseconds)
+{
+    FaultCaptureHeader* pHeader = (FaultCaptureHeader*)pBuffer;
+
+    g_faultCapture.pHeader = NULL;
+    if (pBuffer == NULL || bufferSize < sizeof(*pHeader))
+        return;
+
+    if (!isHeaderValid(pHeader, bufferSize))
+    {
+        pHeader->magic = MRI_FAULT_CAPTURE_MAGIC;
+        pHeader->bufferSize = bufferSize;
+        pHeader->captureSize = 0;
+        pHeader->captureCount = 0;
+    }
+    g_faultCapture.isCycleCounterEnabled = enableCycleCounter();
+    g_faultCapture.timeoutMilliseconds = timeoutMilliseconds;
+    g_faultCapture.pHeader = pHeader;
+}
+
+static int isHeaderValid(const FaultCaptureHeader* pHeader, size_t bufferSize)
+{
+    return pHeader->magic == MRI_FAULT_CAPTURE_MAGIC &&
+           pHeader->bufferSize == bufferSize &&
+           pHeader->captureSize <= bufferSize;
+}
+
+static int enableCycleCounter(void)
+{
+    __try
+        Platform_EnableCycleCounter();
+    __catch
+    {
+        clearExceptionCode();
+        return 0;
+    }
+    return 1;
+}
+
+
+/* Called once the program has halted. When it halted because of a fault, an empty console output packet is sent
+   to gdb as a probe since gdb will acknowledge it while waiting for the program to stop. If nothing is received
+   before the timeout then the program's state is captured and 1 is returned so that the caller can reset the device.
+   Returns 0 to wait for gdb as usual if gdb responded, the cycle counter needed to time the wait isn't available,
+   or the program didn't fault. */
+static int  isFault(uint8_t signalValue);
+static void sendProbeToGdb(void);
+static int  waitForGdbResponse(uint32_t cyclesPerMillisecond);
+static void captureFault(void);
+int FaultCapture_CaptureIfGdbIsAbsent(void)
+{
+    uint32_t cyclesPerMillisecond = Platform_GetCpuClockFrequency() / 1000;
+
+    if (g_faultCapture.pHeader == NULL || !g_faultCapture.isCycleCounterEnabled || cyclesPerMillisecond == 0)
+        return 0;
+    if (!isFault(GetSignalValue()))
+        return 0;
+
+    sendProbeToGdb();
+    if (waitForGdbResponse(cyclesPerMillisecond))
+        return 0;
+    captureFault();
+    return 1;
+}
+
+static int isFault(uint8_t signalValue)
+{
+    switch (signalValue)
+    {
+        case SIGSEGV:
+        case SIGBUS:
+        case SIGILL:
+        case SIGFPE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void sendProbeToGdb(void)
+{
+    static const char probePacket[] = "$O#4f";
+    Buffer            buffer;
+
+    Buffer_Init(&buffer, (char*)probePacket, sizeof(probePacket) - 1);
+    Platform_CommSendBuffer(&buffer);
+}
+
+static int waitForGdbResponse(uint32_t cyclesPerMillisecond)
+{
+    uint32_t lastCycleCount = Platform_GetCycleCounter();
+    uint32_t elapsedCycles = 0;
+    uint32_t elapsedMilliseconds = 0;
+
+    /* Elapsed time is accumulated a millisecond at a time so that long timeouts still work after the 32-bit cycle
+       counter wraps around. */
+    while (elapsedMilliseconds < g_faultCapture.timeoutMilliseconds)
+    {
+        uint32_t currentCycleCount;
+
+        if (Platform_CommHasReceiveData())
+        {
+            /* gdb only sends the '+' acknowledge or a CTRL+C while waiting for the program to stop. */
+            Platform_CommReceiveChar();
+            return 1;
+        }
+
+        currentCycleCount = Platform_GetCycleCounter();
+        elapsedCycles += currentCycleCount - lastCycleCount;
+        lastCycleCount = currentCycleCount;
+        while (elapsedCycles >= cyclesPerMillisecond)
+        {
+            elapsedCycles -= cyclesPerMillisecond;
+            elapsedMilliseconds++;
+        }
+    }
+    return 0;
+}
+
+/* Fills in as much of the registers, fault status registers, and stack window as fits in the buffer. The capture
+   size is only set once the rest of the capture is complete. */
+static void captureFault(void)
+{
+    FaultCaptureHeader* pHeader = g_faultCapture.pHeader;
+    MriContext*         pContext = GetHaltedContext();
+    uint32_t*           pWords = (uint32_t*)(pHeader + 1);
+    size_t              wordsLeft = (pHeader->bufferSize - sizeof(*pHeader)) / sizeof(uint32_t);
+    size_t              registerCount = Context_Count(pContext);
+    size_t              faultStatusCount;
+    uintmri_t           stackPointer;
+    size_t              i;
+
+    pHeader->captureSize = 0;
+    if (registerCount > wordsLeft)
+        registerCount = wordsLeft;
+    for (i = 0 ; i < registerCount ; i++)
+        pWords[i] = Context_Get(pContext, i);
+    pWords += registerCount;
+    wordsLeft -= registerCount;
+
+    faultStatusCount = Platform_GetFaultStatusRegisters(pWords, wordsLeft);
+    pWords += faultStatusCount;
+    wordsLeft -= faultStatusCount;
+
+    stackPointer = Platform_GetStackPointer();
+    pHeader->signal = GetSignalValue();
+    pHeader->registerCount = registerCount;
+    pHeader->faultStatusCount = faultStatusCount;
+    pHeader->stackAddress = (uint32_t)stackPointer;
+    pHeader->stackSize = Platform_ReadMemory(pWords, stackPointer, wordsLeft * sizeof(uint32_t));
+    pHeader->captureCount++;
+    pHeader->captureSize = sizeof(*pHeader) + (registerCount + faultStatusCount) * sizeof(uint32_t) +
+                           pHeader->stackSize;
+}
+
+
+const void* FaultCapture_GetData(void)
+{
+    return g_faultCapture.pHeader;
+}
+
+
+size_t FaultCapture_GetSize(void)
+{
+    if (g_faultCapture.pHeader == NULL)
+        return 0;
+    return g_faultCapture.pHeader->captureSize;
+}
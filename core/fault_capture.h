@@ -0,0 +1,52 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Unattended capture of the program's state into RAM which survives a reset when it faults with no gdb attached. */
+#ifndef FAULT_CAPTURE_H_
+#define FAULT_CAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The buffer handed to mriSetFaultCaptureBuffer() starts with this header. captureSize is 0 until a fault has been
+   captured and is then the number of bytes in the capture, this header included. The header is followed by
+   registerCount context registers, faultStatusCount platform specific fault status registers (CFSR, HFSR, DFSR,
+   MMFAR, and BFAR on Cortex-M), and then stackSize bytes of stack copied from stackAddress. captureCount is the
+   number of faults captured since the buffer was first initialized. */
+#define MRI_FAULT_CAPTURE_MAGIC 0x4346524D
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t bufferSize;
+    uint32_t captureSize;
+    uint32_t captureCount;
+    uint32_t signal;
+    uint32_t registerCount;
+    uint32_t faultStatusCount;
+    uint32_t stackAddress;
+    uint32_t stackSize;
+} FaultCaptureHeader;
+
+/* Real name of functions are in mri namespace. */
+int         mriFaultCapture_CaptureIfGdbIsAbsent(void);
+const void* mriFaultCapture_GetData(void);
+size_t      mriFaultCapture_GetSize(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define FaultCapture_CaptureIfGdbIsAbsent   mriFaultCapture_CaptureIfGdbIsAbsent
+#define FaultCapture_GetData                mriFaultCapture_GetData
+#define FaultCapture_GetSize                mriFaultCapture_GetSize
+
+#endif /* FAULT_CAPTURE_H_ */
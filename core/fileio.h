@@ -38,6 +38,27 @@
 #define GDB_S_IWOTH     02
 #define GDB_S_IXOTH     01
 
+#define GDB_EPERM           1
+#define GDB_ENOENT          2
+#define GDB_EINTR           4
+#define GDB_EBADF           9
+#define GDB_EACCES          13
+#define GDB_EFAULT          14
+#define GDB_EBUSY           16
+#define GDB_EEXIST          17
+#define GDB_ENODEV          19
+#define GDB_ENOTDIR         20
+#define GDB_EISDIR          21
+#define GDB_EINVAL          22
+#define GDB_ENFILE          23
+#define GDB_EMFILE          24
+#define GDB_EFBIG           27
+#define GDB_ENOSPC          28
+#define GDB_ESPIPE          29
+#define GDB_EROFS           30
+#define GDB_ENAMETOOLONG    91
+#define GDB_EUNKNOWN        9999
+
 #define GDB_SEEK_SET    0
 #define GDB_SEEK_CUR    1
 #define GDB_SEEK_END    2
@@ -62,4 +83,11 @@ typedef struct
     uint32_t lastChangeTime;
 } GdbStats;
 
+typedef struct
+{
+    uint32_t seconds;
+    uint32_t microsecondsUpperWord;
+    uint32_t microsecondsLowerWord;
+} GdbTimeVal;
+
 #endif /* FILEIO_H_ */
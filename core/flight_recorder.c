@@ -0,0 +1,113 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Post-mortem flight recorder of timestamped events logged by the program through mriTrace(). */
+#include <core/platforms.h>
+#include <core/mri.h>
+#include <core/flight_recorder.h>
+
+
+typedef struct
+{
+    FlightRecorderHeader* pHeader;
+    FlightRecorderRecord* pRecords;
+    uint32_t              indexMask;
+} FlightRecorderState;
+
+static FlightRecorderState g_flightRecorder;
+
+
+static uint32_t roundDownToPowerOf2(uint32_t value);
+static int      isHeaderValid(const FlightRecorderHeader* pHeader, uint32_t recordCapacity);
+static void     enableTimestamps(void);
+void mriSetFlightRecorderBuffer(void* pBuffer, size_t bufferSize)
+{
+    FlightRecorderHeader* pHeader = (FlightRecorderHeader*)pBuffer;
+    uint32_t              recordCapacity;
+
+    g_flightRecorder.pHeader = NULL;
+    if (pBuffer == NULL || bufferSize < sizeof(*pHeader) + sizeof(FlightRecorderRecord))
+        return;
+
+    recordCapacity = roundDownToPowerOf2((bufferSize - sizeof(*pHeader)) / sizeof(FlightRecorderRecord));
+    if (!isHeaderValid(pHeader, recordCapacity))
+    {
+        pHeader->magic = MRI_FLIGHT_RECORDER_MAGIC;
+        pHeader->recordCapacity = recordCapacity;
+        pHeader->writeCount = 0;
+        pHeader->recordSize = sizeof(FlightRecorderRecord);
+    }
+    enableTimestamps();
+
+    g_flightRecorder.pRecords = (FlightRecorderRecord*)(pHeader + 1);
+    g_flightRecorder.indexMask = recordCapacity - 1;
+    g_flightRecorder.pHeader = pHeader;
+}
+
+static uint32_t roundDownToPowerOf2(uint32_t value)
+{
+    uint32_t powerOf2 = 1;
+
+    while (powerOf2 <= value / 2)
+        powerOf2 <<= 1;
+    return powerOf2;
+}
+
+static int isHeaderValid(const FlightRecorderHeader* pHeader, uint32_t recordCapacity)
+{
+    return pHeader->magic == MRI_FLIGHT_RECORDER_MAGIC &&
+           pHeader->recordCapacity == recordCapacity &&
+           pHeader->recordSize == sizeof(FlightRecorderRecord);
+}
+
+static void enableTimestamps(void)
+{
+    /* Records are still logged with 0 timestamps if the cycle counter isn't available. */
+    __try
+        Platform_EnableCycleCounter();
+    __catch
+        clearExceptionCode();
+}
+
+
+/* Can be called from any priority level, including interrupt handlers which preempt another call to mriTrace().
+   Each caller atomically claims its own record slot before filling it in so no locks are needed. A record which was
+   being filled in when the program faulted can be left partially written. */
+void mriTrace(uint16_t id, uint32_t value)
+{
+    FlightRecorderHeader* pHeader = g_flightRecorder.pHeader;
+    FlightRecorderRecord* pRecord;
+
+    if (pHeader == NULL)
+        return;
+    pRecord = &g_flightRecorder.pRecords[__sync_fetch_and_add(&pHeader->writeCount, 1) & g_flightRecorder.indexMask];
+    pRecord->timestamp = Platform_GetCycleCounter();
+    pRecord->id = id;
+    pRecord->reserved = 0;
+    pRecord->value = value;
+}
+
+
+const void* FlightRecorder_GetData(void)
+{
+    return g_flightRecorder.pHeader;
+}
+
+
+size_t FlightRecorder_GetSize(void)
+{
+    if (g_flightRecorder.pHeader == NULL)
+        return 0;
+    return sizeof(FlightRecorderHeader) + g_flightRecorder.pHeader->recordCapacity * sizeof(FlightRecorderRecord);
+}
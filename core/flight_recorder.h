@@ -0,0 +1,53 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Post-mortem flight recorder of timestamped events logged by the program through mriTrace(). */
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The buffer handed to mriSetFlightRecorderBuffer() starts with this header and is followed by recordCapacity
+   FlightRecorderRecord entries. The header is kept in the buffer itself so that a buffer placed in RAM which isn't
+   initialized by the C runtime still makes sense after a reset. writeCount is the total number of records ever
+   claimed so the oldest record still in the buffer is at index (writeCount - recordCapacity) when it is larger than
+   recordCapacity. recordCapacity is always a power of 2 so that the index is still correct after writeCount wraps. */
+#define MRI_FLIGHT_RECORDER_MAGIC   0x4649524D
+
+typedef struct
+{
+    uint32_t          magic;
+    uint32_t          recordCapacity;
+    volatile uint32_t writeCount;
+    uint32_t          recordSize;
+} FlightRecorderHeader;
+
+typedef struct
+{
+    uint32_t timestamp;
+    uint16_t id;
+    uint16_t reserved;
+    uint32_t value;
+} FlightRecorderRecord;
+
+/* Real name of functions are in mri namespace. */
+const void* mriFlightRecorder_GetData(void);
+size_t      mriFlightRecorder_GetSize(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define FlightRecorder_GetData  mriFlightRecorder_GetData
+#define FlightRecorder_GetSize  mriFlightRecorder_GetSize
+
+#endif /* FLIGHT_RECORDER_H_ */
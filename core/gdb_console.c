@@ -57,3 +57,19 @@ void WriteHexValueToGdbConsole(uint32_t Value)
 
     WriteSizedStringToGdbConsole(Buffer_GetArray(&BufferObject), Buffer_GetLength(&BufferObject));
 }
+
+
+void WriteDecimalValueToGdbConsole(uint32_t Value)
+{
+    char  StringBuffer[10];
+    char* pEnd = StringBuffer + sizeof(StringBuffer);
+    char* pCurr = pEnd;
+
+    do
+    {
+        *--pCurr = '0' + Value % 10;
+        Value /= 10;
+    } while (Value != 0);
+
+    WriteSizedStringToGdbConsole(pCurr, pEnd - pCurr);
+}
@@ -22,10 +22,12 @@
 size_t mriGdbConsole_WriteString(const char* pString);
 size_t mriGdbConsole_WriteSizedString(const char* pString, size_t length);
 void mriGdbConsole_WriteHexValue(uint32_t value);
+void mriGdbConsole_WriteDecimalValue(uint32_t value);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
-#define WriteStringToGdbConsole      mriGdbConsole_WriteString
-#define WriteSizedStringToGdbConsole mriGdbConsole_WriteSizedString
-#define WriteHexValueToGdbConsole    mriGdbConsole_WriteHexValue
+#define WriteStringToGdbConsole       mriGdbConsole_WriteString
+#define WriteSizedStringToGdbConsole  mriGdbConsole_WriteSizedString
+#define WriteHexValueToGdbConsole     mriGdbConsole_WriteHexValue
+#define WriteDecimalValueToGdbConsole mriGdbConsole_WriteDecimalValue
 
 #endif /* GDB_CONSOLE_H_ */
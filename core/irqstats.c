@@ -0,0 +1,209 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Per-IRQ latency and duration statistics collected from shimmed interrupt handlers for "monitor irqstats". */
+#include <core/libc.h>
+#include <core/platforms.h>
+#include <core/irqstats.h>
+
+
+typedef struct
+{
+    IrqStats stats;
+    uint32_t entryCycles;
+    uint32_t pendingCycles;
+    uint32_t flags;
+} IrqStatsSlot;
+
+typedef struct
+{
+    IrqStatsSlot slots[MRI_IRQSTATS_MAX_IRQS];
+    uint32_t     count;
+    uint32_t     flags;
+} IrqStatsState;
+
+static IrqStatsState g_irqStats;
+
+/* IrqStatsState::flags bit definitions. */
+#define IRQSTATS_FLAGS_RUNNING      (1 << 0)
+
+/* IrqStatsSlot::flags bit definitions. */
+#define IRQSTATS_SLOT_SEEN_PENDING  (1 << 0)
+
+
+void IrqStats_Reset(void)
+{
+    IrqStats_Stop();
+    mri_memset(&g_irqStats, 0, sizeof(g_irqStats));
+}
+
+
+static int  isValidIrqList(const uint32_t* pIrqs, uint32_t irqCount);
+static void unhookIrqs(void);
+void IrqStats_Start(const uint32_t* pIrqs, uint32_t irqCount)
+{
+    uint32_t i;
+
+    if (!isValidIrqList(pIrqs, irqCount))
+        __throw(invalidArgumentException);
+
+    IrqStats_Reset();
+    __try
+        Platform_EnableCycleCounter();
+    __catch
+        __rethrow;
+    for (i = 0 ; i < irqCount ; i++)
+    {
+        /* Fill in the slot before hooking the IRQ since its handler could run as soon as it is hooked. */
+        g_irqStats.slots[i].stats.irq = pIrqs[i];
+        g_irqStats.count = i + 1;
+        __try
+            Platform_HookIrq(pIrqs[i]);
+        __catch
+        {
+            g_irqStats.count = i;
+            unhookIrqs();
+            __rethrow;
+        }
+    }
+    g_irqStats.flags |= IRQSTATS_FLAGS_RUNNING;
+}
+
+static int isValidIrqList(const uint32_t* pIrqs, uint32_t irqCount)
+{
+    uint32_t i;
+    uint32_t j;
+
+    if (irqCount == 0 || irqCount > MRI_IRQSTATS_MAX_IRQS)
+        return 0;
+    for (i = 0 ; i < irqCount ; i++)
+    {
+        for (j = i + 1 ; j < irqCount ; j++)
+        {
+            if (pIrqs[i] == pIrqs[j])
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static void unhookIrqs(void)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_irqStats.count ; i++)
+        Platform_UnhookIrq(g_irqStats.slots[i].stats.irq);
+}
+
+
+void IrqStats_Stop(void)
+{
+    if (!IrqStats_IsRunning())
+        return;
+    unhookIrqs();
+    g_irqStats.flags &= ~IRQSTATS_FLAGS_RUNNING;
+}
+
+
+int IrqStats_IsRunning(void)
+{
+    return g_irqStats.flags & IRQSTATS_FLAGS_RUNNING;
+}
+
+
+uint32_t IrqStats_GetCount(void)
+{
+    return g_irqStats.count;
+}
+
+
+const IrqStats* IrqStats_Get(uint32_t index)
+{
+    if (index >= g_irqStats.count)
+        return NULL;
+    return &g_irqStats.slots[index].stats;
+}
+
+
+/* Called by the platform's shim just before it calls the original handler for a hooked IRQ. There is no way to know
+   exactly when an interrupt was raised so latency is measured from the first time that the IRQ was seen pending on
+   entry to or exit from any of the hooked handlers. This catches the common case where one handler delays another
+   but any latency before that point, such as code running with interrupts disabled, isn't counted. */
+static IrqStatsSlot* findSlot(uint32_t irq);
+static void          recordPendingIrqs(uint32_t cycles);
+void IrqStats_Enter(uint32_t irq)
+{
+    uint32_t      cycles = Platform_GetCycleCounter();
+    IrqStatsSlot* pSlot = findSlot(irq);
+
+    if (pSlot != NULL)
+    {
+        uint32_t latency = 0;
+
+        if (pSlot->flags & IRQSTATS_SLOT_SEEN_PENDING)
+            latency = cycles - pSlot->pendingCycles;
+        pSlot->flags &= ~IRQSTATS_SLOT_SEEN_PENDING;
+        pSlot->stats.count++;
+        if (latency > pSlot->stats.maxLatency)
+            pSlot->stats.maxLatency = latency;
+        pSlot->entryCycles = cycles;
+    }
+    recordPendingIrqs(cycles);
+}
+
+static IrqStatsSlot* findSlot(uint32_t irq)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_irqStats.count ; i++)
+    {
+        if (g_irqStats.slots[i].stats.irq == irq)
+            return &g_irqStats.slots[i];
+    }
+    return NULL;
+}
+
+static void recordPendingIrqs(uint32_t cycles)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_irqStats.count ; i++)
+    {
+        IrqStatsSlot* pSlot = &g_irqStats.slots[i];
+
+        if ((pSlot->flags & IRQSTATS_SLOT_SEEN_PENDING) == 0 && Platform_IsIrqPending(pSlot->stats.irq))
+        {
+            pSlot->pendingCycles = cycles;
+            pSlot->flags |= IRQSTATS_SLOT_SEEN_PENDING;
+        }
+    }
+}
+
+
+/* Called by the platform's shim once the original handler for a hooked IRQ has returned. The duration includes any
+   time spent in higher priority handlers which preempted it. */
+void IrqStats_Exit(uint32_t irq)
+{
+    uint32_t      cycles = Platform_GetCycleCounter();
+    IrqStatsSlot* pSlot = findSlot(irq);
+
+    if (pSlot != NULL)
+    {
+        uint32_t duration = cycles - pSlot->entryCycles;
+
+        if (duration > pSlot->stats.maxDuration)
+            pSlot->stats.maxDuration = duration;
+    }
+    recordPendingIrqs(cycles);
+}
@@ -0,0 +1,53 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Per-IRQ latency and duration statistics collected from shimmed interrupt handlers for "monitor irqstats". */
+#ifndef IRQSTATS_H_
+#define IRQSTATS_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Maximum number of IRQs which can have their statistics collected at the same time. */
+#define MRI_IRQSTATS_MAX_IRQS   8
+
+typedef struct
+{
+    uint32_t irq;
+    uint32_t count;
+    uint32_t maxLatency;
+    uint32_t maxDuration;
+} IrqStats;
+
+/* Real name of functions are in mri namespace. */
+void            mriIrqStats_Reset(void);
+__throws void   mriIrqStats_Start(const uint32_t* pIrqs, uint32_t irqCount);
+void            mriIrqStats_Stop(void);
+int             mriIrqStats_IsRunning(void);
+uint32_t        mriIrqStats_GetCount(void);
+const IrqStats* mriIrqStats_Get(uint32_t index);
+void            mriIrqStats_Enter(uint32_t irq);
+void            mriIrqStats_Exit(uint32_t irq);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define IrqStats_Reset          mriIrqStats_Reset
+#define IrqStats_Start          mriIrqStats_Start
+#define IrqStats_Stop           mriIrqStats_Stop
+#define IrqStats_IsRunning      mriIrqStats_IsRunning
+#define IrqStats_GetCount       mriIrqStats_GetCount
+#define IrqStats_Get            mriIrqStats_Get
+#define IrqStats_Enter          mriIrqStats_Enter
+#define IrqStats_Exit           mriIrqStats_Exit
+
+#endif /* IRQSTATS_H_ */
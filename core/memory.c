@@ -134,6 +134,87 @@ static int isNot64BitAligned(uintmri_t address)
 }
 
 
+/* Binary data is sent with the '$', '#', '}', and '*' characters escaped by sending '}' followed by the original
+   character XORed with 0x20. Reads stop early, returning the number of bytes actually read, once the buffer is full
+   or a fault is encountered. Aligned 2 and 4 byte reads are made with a single access so that device registers can
+   be read. */
+static uintmri_t readMemoryBytesIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount);
+static uintmri_t readMemoryValueIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount);
+static int       writeByteToBufferAsBinary(Buffer* pBuffer, uint8_t byte);
+uintmri_t ReadMemoryIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount)
+{
+    if ((readByteCount == 2 && !isNotHalfWordAligned(address)) ||
+        (readByteCount == 4 && !isNotWordAligned(address)))
+        return readMemoryValueIntoBinaryBuffer(pBuffer, address, readByteCount);
+    return readMemoryBytesIntoBinaryBuffer(pBuffer, address, readByteCount);
+}
+
+static uintmri_t readMemoryBytesIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount)
+{
+    uintmri_t byteCount = 0;
+
+    while (readByteCount-- > 0)
+    {
+        uint8_t byte;
+
+        byte = Platform_MemRead8(address++);
+        if (Platform_WasMemoryFaultEncountered())
+            break;
+        if (!writeByteToBufferAsBinary(pBuffer, byte))
+            break;
+        byteCount++;
+    }
+
+    return byteCount;
+}
+
+static uintmri_t readMemoryValueIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount)
+{
+    uint8_t*  pBytes;
+    uint32_t  value;
+    uint16_t  halfWord;
+    uintmri_t i;
+
+    /* Each byte can take 2 characters once escaped. */
+    if (Buffer_BytesLeft(pBuffer) < 2 * readByteCount)
+        return readMemoryBytesIntoBinaryBuffer(pBuffer, address, readByteCount);
+
+    if (readByteCount == sizeof(uint16_t))
+    {
+        halfWord = Platform_MemRead16(address);
+        pBytes = (uint8_t*)&halfWord;
+    }
+    else
+    {
+        value = Platform_MemRead32(address);
+        pBytes = (uint8_t*)&value;
+    }
+    if (Platform_WasMemoryFaultEncountered())
+        return 0;
+
+    for (i = 0 ; i < readByteCount ; i++)
+        writeByteToBufferAsBinary(pBuffer, pBytes[i]);
+    return readByteCount;
+}
+
+static int writeByteToBufferAsBinary(Buffer* pBuffer, uint8_t byte)
+{
+    if (byte == '$' || byte == '#' || byte == '}' || byte == '*')
+    {
+        if (Buffer_BytesLeft(pBuffer) < 2)
+            return 0;
+        Buffer_WriteChar(pBuffer, '}');
+        byte ^= 0x20;
+    }
+    else if (Buffer_BytesLeft(pBuffer) < 1)
+    {
+        return 0;
+    }
+    Buffer_WriteChar(pBuffer, byte);
+    return 1;
+}
+
+
 static int writeHexBufferToByteMemory(Buffer* pBuffer, uintmri_t address, uintmri_t writeByteCount);
 static int writeHexBufferToHalfWordMemory(Buffer* pBuffer, uintmri_t address);
 static int readBytesFromHexBuffer(Buffer* pBuffer, void* pv, size_t length);
@@ -21,11 +21,13 @@
 
 /* Real name of functions are in mri namespace. */
 uintmri_t mriMem_ReadMemoryIntoHexBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount);
+uintmri_t mriMem_ReadMemoryIntoBinaryBuffer(Buffer* pBuffer, uintmri_t address, uintmri_t readByteCount);
 int       mriMem_WriteHexBufferToMemory(Buffer* pBuffer, uintmri_t address, uintmri_t writeByteCount);
 int       mriMem_WriteBinaryBufferToMemory(Buffer* pBuffer, uintmri_t address, uintmri_t writeByteCount);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
 #define ReadMemoryIntoHexBuffer     mriMem_ReadMemoryIntoHexBuffer
+#define ReadMemoryIntoBinaryBuffer  mriMem_ReadMemoryIntoBinaryBuffer
 #define WriteHexBufferToMemory      mriMem_WriteHexBufferToMemory
 #define WriteBinaryBufferToMemory   mriMem_WriteBinaryBufferToMemory
 
@@ -36,7 +36,24 @@
 #include <core/cmd_step.h>
 #include <core/cmd_thread.h>
 #include <core/cmd_vcont.h>
+#include <core/cmd_trace.h>
 #include <core/memory.h>
+#include <core/profile.h>
+#include <core/coredump.h>
+#include <core/fault_capture.h>
+#include <core/snapshot.h>
+#include <core/timing.h>
+#include <core/perf.h>
+#include <core/irqstats.h>
+#include <core/sampler.h>
+#include <core/binlog.h>
+#include <core/record.h>
+#include <core/coverage.h>
+#include <core/cpuload.h>
+#include <core/write_behind.h>
+#include <core/read_ahead.h>
+#include <core/cycle_clock.h>
+#include <core/async_console.h>
 
 
 typedef struct
@@ -47,8 +64,10 @@ typedef struct
     MriDebuggerHookPtr          pLeavingHook;
     void*                       pvEnteringLeavingContext;
     MriContext*                 pContext;
+    MriContext*                 pHaltedContext;
     Packet                      packet;
     uint32_t                    tempBreakpointAddress;
+    uint32_t                    stepOverBreakpointAddress;
     uint32_t                    flags;
     AddressRange                rangeForSingleStepping;
     int                         semihostReturnCode;
@@ -66,6 +85,8 @@ static MriCore g_mri;
 #define MRI_FLAGS_RESET_ON_CONTINUE     (1 << 4)
 #define MRI_FLAGS_RANGED_SINGLE_STEP    (1 << 5)
 #define MRI_FLAGS_ENCOUNTERED_CTRL_C    (1 << 6)
+#define MRI_FLAGS_STEP_OVER_BREAKPOINT  (1 << 7)
+#define MRI_FLAGS_DEBUGGER_FILE_IO      (1 << 8)
 
 /* Calculates the number of items in a static array at compile time. */
 #define ARRAY_SIZE(X) (sizeof(X)/sizeof(X[0]))
@@ -90,6 +111,22 @@ void mriInit(const char* pDebuggerParameters)
 static void clearCoreStructure(void)
 {
     mri_memset(&g_mri, 0, sizeof(g_mri));
+    ClearBreakpointCommands();
+    Profile_Reset();
+    Coredump_Cancel();
+    Snapshot_Cancel();
+    Timing_Reset();
+    Perf_Reset();
+    IrqStats_Reset();
+    Sampler_Reset();
+    BinLog_Reset();
+    Record_Reset();
+    Coverage_Reset();
+    CpuLoad_Reset();
+    WriteBehind_Reset();
+    ReadAhead_Reset();
+    CycleClock_Reset();
+    AsyncConsole_Reset();
 }
 
 static void initializePlatformSpecificModulesWithDebuggerParameters(const char* pDebuggerParameters)
@@ -156,6 +193,45 @@ static void setTempBreakpointFlag(void)
 }
 
 
+static void rearmHardwareBreakpoint(uint32_t breakpointAddress);
+static void setStepOverBreakpointFlag(void);
+void StepOverHardwareBreakpoint(uint32_t breakpointAddress)
+{
+    breakpointAddress = clearThumbBitOfAddress(breakpointAddress);
+    __try
+        Platform_ClearHardwareBreakpoint(breakpointAddress);
+    __catch
+        clearExceptionCode();
+
+    Platform_EnableSingleStep();
+    if (Platform_IsSingleStepping())
+    {
+        g_mri.stepOverBreakpointAddress = breakpointAddress;
+        setStepOverBreakpointFlag();
+        return;
+    }
+
+    /* The platform either emulated the instruction and advanced the PC past it or can't single step it at all. Only
+       rearm in the first case since rearming on the current PC would just trigger the breakpoint again. */
+    Platform_DisableSingleStep();
+    if (clearThumbBitOfAddress(Platform_GetProgramCounter()) != breakpointAddress)
+        rearmHardwareBreakpoint(breakpointAddress);
+}
+
+static void rearmHardwareBreakpoint(uint32_t breakpointAddress)
+{
+    __try
+        Platform_SetHardwareBreakpoint(breakpointAddress);
+    __catch
+        clearExceptionCode();
+}
+
+static void setStepOverBreakpointFlag(void)
+{
+    g_mri.flags |= MRI_FLAGS_STEP_OVER_BREAKPOINT;
+}
+
+
 void mriCoreSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHookPtr pLeavingHook, void* pvContext)
 {
     g_mri.pEnteringHook = pEnteringHook;
@@ -172,6 +248,8 @@ static int areSingleSteppingInRange(void);
 static void clearSingleSteppingInRange(void);
 static void determineSignalValue(void);
 static int  isDebugTrap(void);
+static int  isSteppingOverBreakpoint(void);
+static void completeStepOverBreakpoint(void);
 static void prepareForDebuggerExit(void);
 static void clearFirstExceptionFlag(void);
 static void waitForAckToBeTransmitted(void);
@@ -180,7 +258,9 @@ void mriDebugException(MriContext* pContext)
     int justSingleStepped;
 
     SetContext(pContext);
+    g_mri.pHaltedContext = pContext;
     clearControlCEncounteredFlag();
+    CycleClock_Update();
     justSingleStepped = Platform_IsSingleStepping();
 
     if (wasTempBreakpointHit())
@@ -202,6 +282,27 @@ void mriDebugException(MriContext* pContext)
     }
 
     determineSignalValue();
+    if (isSteppingOverBreakpoint())
+    {
+        completeStepOverBreakpoint();
+        if (justSingleStepped && isDebugTrap() && !Record_IsRunning())
+        {
+            Platform_DisableSingleStep();
+            RestoreThreadStates();
+            return;
+        }
+    }
+    if (justSingleStepped && Record_IsRunning())
+    {
+        if (Record_ProcessSingleStep())
+        {
+            RestoreThreadStates();
+            return;
+        }
+        /* Only stepped so that the instruction could be recorded so treat it as a stop from a gdb continue. */
+        if (Record_IsContinuing())
+            justSingleStepped = 0;
+    }
     if (areSingleSteppingInRange())
     {
         uint32_t pc = Platform_GetProgramCounter();
@@ -209,6 +310,7 @@ void mriDebugException(MriContext* pContext)
         {
             Platform_DisableSingleStep();
             Platform_EnableSingleStep();
+            Record_PrepareToResume();
             RestoreThreadStates();
             return;
         }
@@ -219,6 +321,15 @@ void mriDebugException(MriContext* pContext)
         g_mri.pEnteringHook(g_mri.pvEnteringLeavingContext);
     Platform_EnteringDebugger();
 
+    if (isDebugTrap() && !justSingleStepped &&
+        (Timing_ProcessBreakpointHit() || Coverage_ProcessBreakpointHit() || ProcessTracepointHit() ||
+         RunBreakpointCommands()))
+    {
+        RestoreThreadStates();
+        prepareForDebuggerExit();
+        return;
+    }
+
     if (isDebugTrap() &&
         Semihost_IsDebuggeeMakingSemihostCall() &&
         Semihost_HandleSemihostRequest() &&
@@ -229,12 +340,32 @@ void mriDebugException(MriContext* pContext)
         return;
     }
 
+    if (FaultCapture_CaptureIfGdbIsAbsent())
+    {
+        /* Only returns when running in the unit tests. */
+        Platform_ResetDevice();
+        return;
+    }
+
+    AsyncConsole_Flush();
+    Sampler_Drain();
+    BinLog_Flush();
+    WriteBehind_FlushAll();
     if (!IsFirstException())
         Platform_DisplayFaultCauseToGdbConsole();
     Send_T_StopResponse();
 
     GdbCommandHandlingLoop();
+    while (!Profile_WriteRequestedDump() || !Coredump_WriteRequested() || !Snapshot_HandleRequest() ||
+           !BinLog_CompleteRequestedStop())
+    {
+        /* CTRL+C was pressed while the profile, core dump, snapshot or log was being transferred so stop again
+           instead of resuming. */
+        Send_T_StopResponse();
+        GdbCommandHandlingLoop();
+    }
 
+    Record_TrackGdbResume();
     prepareForDebuggerExit();
 }
 
@@ -306,6 +437,18 @@ static int isDebugTrap(void)
     return g_mri.signalValue == SIGTRAP;
 }
 
+static int isSteppingOverBreakpoint(void)
+{
+    return g_mri.flags & MRI_FLAGS_STEP_OVER_BREAKPOINT;
+}
+
+static void completeStepOverBreakpoint(void)
+{
+    rearmHardwareBreakpoint(g_mri.stepOverBreakpointAddress);
+    g_mri.stepOverBreakpointAddress = 0;
+    g_mri.flags &= ~MRI_FLAGS_STEP_OVER_BREAKPOINT;
+}
+
 static void prepareForDebuggerExit(void)
 {
     if (WasResetOnNextContinueRequested() && !Platform_IsSingleStepping()) {
@@ -313,6 +456,8 @@ static void prepareForDebuggerExit(void)
         Platform_ResetDevice();
         CancelResetRequestOnNextContinue();
     }
+    Record_PrepareToResume();
+    AsyncConsole_Resume();
     Platform_LeavingDebugger();
     if (g_mri.pLeavingHook)
         g_mri.pLeavingHook(g_mri.pvEnteringLeavingContext);
@@ -362,6 +507,7 @@ static int handleGDBCommand(void)
     } commandTable[] =
     {
         {Send_T_StopResponse,                       '?'},
+        {HandleReverseCommand,                      'b'},
         {HandleContinueCommand,                     'c'},
         {HandleContinueWithSignalCommand,           'C'},
         {HandleDetachCommand,                       'D'},
@@ -372,10 +518,12 @@ static int handleGDBCommand(void)
         {HandleMemoryReadCommand,                   'm'},
         {HandleMemoryWriteCommand,                  'M'},
         {HandleQueryCommand,                        'q'},
+        {HandleGeneralSetCommand,                   'Q'},
         {HandleSingleStepCommand,                   's'},
         {HandleSingleStepWithSignalCommand,         'S'},
         {HandleIsThreadActiveCommand,               'T'},
         {HandleVContCommands,                       'v'},
+        {HandleBinaryMemoryReadCommand,             'x'},
         {HandleBinaryMemoryWriteCommand,            'X'},
         {HandleBreakpointWatchpointRemoveCommand,   'z'},
         {HandleBreakpointWatchpointSetCommand,      'Z'}
@@ -479,6 +627,12 @@ void SetContext(MriContext* pContext)
     g_mri.pContext = pContext;
 }
 
+/* The context of the thread which was running when the debugger was entered, even after gdb has switched threads. */
+MriContext* GetHaltedContext(void)
+{
+    return g_mri.pHaltedContext;
+}
+
 
 void RecordControlCFlagSentFromGdb(int controlCFlag)
 {
@@ -495,6 +649,21 @@ int WasSemihostCallCancelledByGdb(void)
 }
 
 
+void SetIssuingFileIOForDebugger(int isIssuing)
+{
+    if (isIssuing)
+        g_mri.flags |= MRI_FLAGS_DEBUGGER_FILE_IO;
+    else
+        g_mri.flags &= ~MRI_FLAGS_DEBUGGER_FILE_IO;
+}
+
+
+int IsIssuingFileIOForDebugger(void)
+{
+    return (int)(g_mri.flags & MRI_FLAGS_DEBUGGER_FILE_IO);
+}
+
+
 void FlagSemihostCallAsHandled(void)
 {
     Platform_AdvanceProgramCounterToNextInstruction();
@@ -554,6 +723,7 @@ Buffer* GetInitializedBuffer(void)
 
 void SendPacketToGdb(void)
 {
+    AsyncConsole_FinishPacket();
     if (Buffer_OverrunDetected(GetBuffer()))
     {
         InitPacketBuffers();
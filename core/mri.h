@@ -29,6 +29,14 @@
 #define     MRI_ERROR_MEMORY_ACCESS_FAILURE "E03"   /* Couldn't access requested memory. */
 #define     MRI_ERROR_BUFFER_OVERRUN        "E04"   /* Overflowed internal input/output buffer. */
 #define     MRI_ERROR_NO_FREE_BREAKPOINT    "E05"   /* No free FPB breakpoint comparator slots. */
+#define     MRI_ERROR_NO_TRACE_BUFFER       "E06"   /* Program hasn't provided a buffer for tracepoint frames. */
+#define     MRI_ERROR_NO_PROFILE_BUFFER     "E07"   /* Program hasn't provided a buffer for profile samples. */
+#define     MRI_ERROR_NO_VECTOR_TABLE       "E08"   /* Program hasn't provided a RAM vector table for IRQ stats. */
+#define     MRI_ERROR_NO_SAMPLE_BUFFER      "E09"   /* Program hasn't provided a buffer for variable samples. */
+#define     MRI_ERROR_NO_LOG_BUFFER         "E0A"   /* Program hasn't provided a buffer for binary log records. */
+#define     MRI_ERROR_NO_RECORD_BUFFER      "E0B"   /* Program hasn't provided a buffer for the execution record. */
+#define     MRI_ERROR_NO_COVERAGE_BUFFER    "E0C"   /* Program hasn't provided a buffer for the coverage bitmap. */
+#define     MRI_ERROR_NO_SNAPSHOT_REGIONS   "E0D"   /* Program hasn't provided the memory regions to snapshot. */
 
 
 #ifdef __cplusplus
@@ -113,8 +121,127 @@ void mriInit(const char* pDebuggerParameters);
 typedef void (*MriDebuggerHookPtr)(void*);
 void mriSetDebuggerHooks(MriDebuggerHookPtr pEnteringHook, MriDebuggerHookPtr pLeavingHook, void* pvContext);
 
+/* Provide the RAM buffer into which tracepoint frames should be collected. Frames are recorded in this buffer while
+   the program continues to run and are later pulled by GDB with tfind/tsave. The contents of the buffer are
+   discarded by this call so it should be made before GDB starts a trace experiment with tstart. */
+void mriSetTraceBuffer(void* pBuffer, size_t bufferSize);
+
+/* Provide the RAM buffer into which "monitor profile start" should collect a histogram of sampled PC values. Only
+   samples which land in the lowPc to highPc code range are binned and the bin size grows (by powers of 2) until the
+   histogram fits in the buffer. "monitor profile dump" writes the histogram out as a gprof compatible gmon.out file
+   on the gdb host. Any profile that is currently running is stopped by this call. */
+void mriSetProfileBuffer(void* pBuffer, size_t bufferSize, uintptr_t lowPc, uintptr_t highPc);
+
+/* Provide the RAM into which "monitor irqstats start" can relocate the interrupt vector table so that the selected
+   IRQs are redirected through a shim which timestamps the entry and exit of their handlers. The table must be large
+   enough to hold all of the device's vectors (16 + number of IRQs, 4 bytes each) and be aligned to that size rounded
+   up to the next power of 2 (minimum of 128 bytes) as required by the VTOR register. The original table is put back
+   once "monitor irqstats stop" is issued. Any IRQ statistics that are currently being collected are stopped by
+   this call. */
+void mriSetIrqVectorTable(void* pTable, size_t tableSize);
+
+/* Provide the RAM buffer used by "monitor sample" as a ring buffer of timestamped variable samples. Samples are taken
+   while the program continues to run and are streamed to the gdb console each time that the buffer becomes half full
+   or the program halts. Any sampling that is currently running is stopped by this call. */
+void mriSetSampleBuffer(void* pBuffer, size_t bufferSize);
+
+/* Provide the RAM buffer used by mriTrace() as a flight recorder of the most recent events logged by the program.
+   The buffer should be placed in a section which isn't cleared or initialized at startup (.noinit for example) so
+   that events logged before a reset can still be read afterwards. Its contents are kept when this call finds a
+   previously initialized recorder of the same size already in the buffer. GDB can pull the whole buffer with the
+   qXfer:mri-trace:read packet once the program has halted. */
+void mriSetFlightRecorderBuffer(void* pBuffer, size_t bufferSize);
+
+/* Provide the RAM buffer used to capture the program's state when it faults with no gdb attached. Instead of waiting
+   forever for gdb, MRI waits up to timeoutMilliseconds for gdb to respond after a fault. If it doesn't, the registers,
+   fault status registers, and as much of the stack as fits are saved to the buffer and the device is reset. The
+   buffer should be 4-byte aligned and placed in a section which isn't cleared or initialized at startup (.noinit for
+   example) so that the capture survives the reset. Once gdb connects, it can pull the capture with the
+   qXfer:mri-fault:read packet. Requires the cycle counter to time the wait. */
+void mriSetFaultCaptureBuffer(void* pBuffer, size_t bufferSize, uint32_t timeoutMilliseconds);
+
+/* Provide the list of memory regions which "monitor snapshot save FILENAME" writes to a file on the gdb host along with
+   the registers, and which "monitor snapshot restore FILENAME" loads back into place before the program resumes so
+   that a test can be rewound to a known point. Regions can be writable RAM or blocks of peripheral registers and are
+   restored in list order. They must not cover MRI's own variables or the debugger stack since those are in use while
+   the snapshot is being restored. Linking MRI's .data and .bss into their own section makes this easy to arrange.
+   The list isn't copied so it needs to stay valid. */
+typedef struct
+{
+    uintptr_t address;
+    uint32_t  size;
+} MriSnapshotRegion;
+
+void mriSetSnapshotRegions(const MriSnapshotRegion* pRegions, size_t regionCount);
+
+/* Append a record containing the cycle counter, the id, and the value to the flight recorder, overwriting the oldest
+   record once the buffer is full. It is safe to call from interrupt handlers and does nothing until
+   mriSetFlightRecorderBuffer() has been called. */
+void mriTrace(uint16_t id, uint32_t value);
+
+/* Deferred formatting log. Only the address of the format string and the raw 32-bit arguments are recorded on the
+   target and "monitor log start" streams these records in binary to a file on the gdb host. The format strings are
+   kept in the .mri_log section of the program's ELF file and scripts/mri_log_decode.py looks them up there.
+   That section can be marked as (INFO) in the linker script so that it doesn't take up any FLASH on the device:
+        .mri_log 0 (INFO) : { KEEP(*(.mri_log)) }
+   Arguments are always logged as 32-bit values so the format string should only contain integer and character
+   conversions (no %s, %f, or 64-bit integers).
+
+    mriLog2("Motor %d speed %u", motor, speed);
+
+   mriSetLogBuffer() provides the RAM in which records are collected until it fills up, the program halts, or
+   mriLogFlush() is called. Those are the only times that the program stops to send them to gdb. mriLogWrite() and
+   the mriLog*() macros can be called from interrupt handlers as long as they run at a lower priority than MRI. */
+#define MRI_LOG_MAX_ARGUMENTS   4
+#define MRI_LOG_FORMAT(FORMAT) \
+    __extension__ ({ static const char mriLogFormat[] __attribute__((section(".mri_log"), used)) = FORMAT; mriLogFormat; })
+#define mriLog0(FORMAT)             mriLogWrite(MRI_LOG_FORMAT(FORMAT), 0)
+#define mriLog1(FORMAT,A)           mriLogWrite(MRI_LOG_FORMAT(FORMAT), 1, (uint32_t)(A))
+#define mriLog2(FORMAT,A,B)         mriLogWrite(MRI_LOG_FORMAT(FORMAT), 2, (uint32_t)(A), (uint32_t)(B))
+#define mriLog3(FORMAT,A,B,C)       mriLogWrite(MRI_LOG_FORMAT(FORMAT), 3, (uint32_t)(A), (uint32_t)(B), (uint32_t)(C))
+#define mriLog4(FORMAT,A,B,C,D)     mriLogWrite(MRI_LOG_FORMAT(FORMAT), 4, (uint32_t)(A), (uint32_t)(B), (uint32_t)(C), \
+                                                (uint32_t)(D))
+void mriSetLogBuffer(void* pBuffer, size_t bufferSize);
+void mriLogWrite(const char* pFormat, uint32_t argCount, ...);
+void mriLogFlush(void);
+
+/* Provide the RAM buffer used by "monitor record start" to log the registers and memory modified by each instruction
+   as the program executes. While recording, MRI single steps the program on the target, even when gdb asks it to
+   continue, so that GDB's reverse-step and reverse-continue can be serviced from this log without any further
+   round trips to the program. The oldest instructions are dropped once the buffer fills up. Execution runs much
+   slower while recording so it is best to only start it just before the code of interest. */
+void mriSetRecordBuffer(void* pBuffer, size_t bufferSize);
+
+/* Provide the RAM buffer used by "monitor coverage start ADDRESS COUNT" to hold a bitmap with one bit per basic block.
+   ADDRESS points at an array of COUNT 32-bit block start addresses supplied by the host, either linked into the
+   program or written into spare RAM with gdb's restore command. MRI keeps hardware breakpoints armed on blocks that
+   haven't been hit yet and each hit sets the block's bit (bit i%8 of byte i/8), retires its breakpoint, and arms the
+   next block before resuming, all without involving GDB. The buffer must hold at least (COUNT+7)/8 bytes and GDB can
+   read the bitmap with the qXfer:mri-coverage:read packet. Any coverage that is currently running is stopped by this
+   call. */
+void mriSetCoverageBuffer(void* pBuffer, size_t bufferSize);
+
+/* Provide a RAM ring buffer for the program's stdout output. Without it, each write halts the program while MRI
+   sends the text to gdb and waits for it to be acknowledged. With it, the text is copied into the buffer and the
+   program resumes right away while the UART transmit interrupt sends it to gdb in the background. If a write doesn't
+   fit in the remaining space then MRI falls back to sending everything before resuming. Call this before the
+   program starts writing to stdout. */
+void mriSetConsoleBuffer(void* pBuffer, size_t bufferSize);
+
+/* Bulk transfers between a program buffer and a file (or stdin/stdout) on the GDB host. Each call halts the program
+   once and issues a single GDB File-I/O write or read for the whole buffer, with GDB pulling or pushing the data
+   directly from/to the program's buffer in packets as large as MRI supports. Unlike mriNewlib_SemihostWrite() and
+   mriNewlib_SemihostRead(), no data is held in MRI's write-behind, read-ahead, or console buffers, although anything
+   already held for the file is sent or used first so that the data stays in order. Returns the number of bytes
+   transferred or -1 on error, in which case mriNewlib_SemihostGetErrNo() returns the errno value. */
+int mriHostWrite(int file, const void* pBuffer, size_t length);
+int mriHostRead(int file, void* pBuffer, size_t length);
+
 /* Simple assembly language stubs that can be called from user's newlib stubs routines which will cause the operations
-   to be redirected to the GDB host via MRI. The filenameLength parameters must include the terminating '\0'. */
+   to be redirected to the GDB host via MRI. The filenameLength parameters must include the terminating '\0'.
+   Writes to files other than stdin/stdout/stderr are held in a small buffer (MRI_WRITE_BEHIND_BUFFER_SIZE bytes) and
+   only sent to the host when it fills up, the file is read, seeked, stat'ed, or closed, the program halts, or
+   mriNewlib_SemihostFSync() is called. A failed buffered write is reported by the next write, fsync, or close. */
 int mriNewLib_SemihostOpen(const char *pFilename, size_t filenameLength, int flags, int mode);
 int mriNewLib_SemihostRename(const char *pOldFilename, size_t oldFilenameLength, const char *pNewFilename, size_t newFilenameLength);
 int mriNewLib_SemihostUnlink(const char *pFilename, size_t filenameLength);
@@ -124,6 +251,7 @@ int mriNewlib_SemihostRead(int file, char *ptr, int len);
 int mriNewlib_SemihostLSeek(int file, int offset, int whence);
 int mriNewlib_SemihostClose(int file);
 int mriNewlib_SemihostFStat(int file, void *pStat);
+int mriNewlib_SemihostFSync(int file);
 int mriNewlib_SemihostGetErrNo(void);
 
 
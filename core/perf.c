@@ -0,0 +1,115 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Accumulates the small hardware performance counters into 32-bit totals for "monitor perf". */
+#include <core/libc.h>
+#include <core/platforms.h>
+#include <core/perf.h>
+
+
+typedef struct
+{
+    PerfCounters totals;
+    uint32_t     possibleWrapCount;
+    uint32_t     flags;
+} PerfState;
+
+static PerfState g_perf;
+
+/* PerfState::flags bit definitions. */
+#define PERF_FLAGS_RUNNING      (1 << 0)
+#define PERF_FLAGS_SATURATED    (1 << 1)
+
+
+void Perf_Reset(void)
+{
+    Perf_Stop();
+    mri_memset(&g_perf, 0, sizeof(g_perf));
+}
+
+
+void Perf_Start(uint32_t sampleInterval)
+{
+    if (sampleInterval == 0)
+        __throw(invalidArgumentException);
+
+    Perf_Stop();
+    mri_memset(&g_perf, 0, sizeof(g_perf));
+
+    __try
+        Platform_StartPerfCounters(sampleInterval);
+    __catch
+        __rethrow;
+    g_perf.flags |= PERF_FLAGS_RUNNING;
+}
+
+
+void Perf_Stop(void)
+{
+    if (!Perf_IsRunning())
+        return;
+    Platform_StopPerfCounters();
+    g_perf.flags &= ~PERF_FLAGS_RUNNING;
+}
+
+
+int Perf_IsRunning(void)
+{
+    return g_perf.flags & PERF_FLAGS_RUNNING;
+}
+
+
+/* Called by the platform each time that the debug monitor is entered with the counts accumulated since it last
+   cleared the counters. Each counter can only advance by one per cycle so none of them can have wrapped if no more
+   than MRI_PERF_COUNTER_MAX cycles have elapsed. Longer spans are still accumulated but are counted so that the
+   results can be flagged as possibly too low. */
+void Perf_Accumulate(const PerfCounters* pSample)
+{
+    PerfCounters* pTotals = &g_perf.totals;
+
+    if (!Perf_IsRunning() || Perf_HasSaturated())
+        return;
+    if (pTotals->cycles + pSample->cycles < pTotals->cycles)
+    {
+        g_perf.flags |= PERF_FLAGS_SATURATED;
+        return;
+    }
+
+    if (pSample->cycles > MRI_PERF_COUNTER_MAX)
+        g_perf.possibleWrapCount++;
+    pTotals->cycles += pSample->cycles;
+    pTotals->cpi += pSample->cpi;
+    pTotals->exception += pSample->exception;
+    pTotals->sleep += pSample->sleep;
+    pTotals->lsu += pSample->lsu;
+    pTotals->fold += pSample->fold;
+}
+
+
+const PerfCounters* Perf_GetTotals(void)
+{
+    return &g_perf.totals;
+}
+
+
+uint32_t Perf_GetPossibleWrapCount(void)
+{
+    return g_perf.possibleWrapCount;
+}
+
+
+int Perf_HasSaturated(void)
+{
+    return g_perf.flags & PERF_FLAGS_SATURATED;
+}
@@ -0,0 +1,59 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Accumulates the small hardware performance counters into 32-bit totals for "monitor perf". */
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Default number of CPU cycles between forced samples of the performance counters. It is kept under 256 so that
+   none of the 8-bit counters can wrap between samples, even after accounting for exception entry latency. */
+#define MRI_PERF_DEFAULT_INTERVAL   200
+
+/* Largest count that the platform's performance counters can hold before wrapping back to 0. */
+#define MRI_PERF_COUNTER_MAX        0xFF
+
+typedef struct
+{
+    uint32_t cycles;
+    uint32_t cpi;
+    uint32_t exception;
+    uint32_t sleep;
+    uint32_t lsu;
+    uint32_t fold;
+} PerfCounters;
+
+/* Real name of functions are in mri namespace. */
+void                mriPerf_Reset(void);
+__throws void       mriPerf_Start(uint32_t sampleInterval);
+void                mriPerf_Stop(void);
+int                 mriPerf_IsRunning(void);
+void                mriPerf_Accumulate(const PerfCounters* pSample);
+const PerfCounters* mriPerf_GetTotals(void);
+uint32_t            mriPerf_GetPossibleWrapCount(void);
+int                 mriPerf_HasSaturated(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Perf_Reset                  mriPerf_Reset
+#define Perf_Start                  mriPerf_Start
+#define Perf_Stop                   mriPerf_Stop
+#define Perf_IsRunning              mriPerf_IsRunning
+#define Perf_Accumulate             mriPerf_Accumulate
+#define Perf_GetTotals              mriPerf_GetTotals
+#define Perf_GetPossibleWrapCount   mriPerf_GetPossibleWrapCount
+#define Perf_HasSaturated           mriPerf_HasSaturated
+
+#endif /* PERF_H_ */
@@ -23,6 +23,11 @@
 #include <core/buffer.h>
 #include <core/try_catch.h>
 
+/* Packet buffers must be at least this large for the qSupported response to advertise every optional feature. This is
+   the 226 byte response with the largest PacketSize value plus 4 bytes for the '$', '#', and 2-byte checksum. Optional
+   features are left out of the response when they don't fit in a smaller buffer. */
+#define MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE  (226 + 4)
+
 void      mriPlatform_Init(Token* pParameterTokens);
 char*     mriPlatform_GetPacketBuffer(void);
 size_t    mriPlatform_GetPacketBufferSize(void);
@@ -45,6 +50,8 @@ int       mriPlatform_CommHasTransmitCompleted(void);
 int       mriPlatform_CommReceiveChar(void);
 void      mriPlatform_CommSendBuffer(Buffer* pBuffer);
 void      mriPlatform_CommSendChar(int character);
+int       mriPlatform_CommIsTransmitReady(void);
+void      mriPlatform_CommSetTransmitInterrupt(int isEnabled);
 
 uint32_t  mriPlatform_HandleGDBCommand(Buffer* pBuffer);
 
@@ -67,11 +74,14 @@ typedef struct
 uint8_t             mriPlatform_DetermineCauseOfException(void);
 PlatformTrapReason  mriPlatform_GetTrapReason(void);
 void                mriPlatform_DisplayFaultCauseToGdbConsole(void);
+size_t              mriPlatform_GetFaultStatusRegisters(uint32_t* pRegisters, size_t maxRegisters);
+size_t              mriPlatform_UnwindStack(MriContext* pContext, uint32_t* pFrames, size_t maxFrames);
 
 void      mriPlatform_EnableSingleStep(void);
 void      mriPlatform_DisableSingleStep(void);
 int       mriPlatform_IsSingleStepping(void);
 uintmri_t mriPlatform_GetProgramCounter(void);
+uintmri_t mriPlatform_GetStackPointer(void);
 void      mriPlatform_SetProgramCounter(uintmri_t newPC);
 void      mriPlatform_AdvanceProgramCounterToNextInstruction(void);
 int       mriPlatform_WasProgramCounterModifiedByUser(void);
@@ -97,6 +107,25 @@ __throws void  mriPlatform_ClearHardwareBreakpointOfGdbKind(uintmri_t address, u
 __throws void  mriPlatform_ClearHardwareBreakpoint(uintmri_t address);
 __throws void  mriPlatform_SetHardwareWatchpoint(uintmri_t address, uintmri_t size,  PlatformWatchpointType type);
 __throws void  mriPlatform_ClearHardwareWatchpoint(uintmri_t address, uintmri_t size,  PlatformWatchpointType type);
+__throws void  mriPlatform_SetHardwareValueWatchpoint(uintmri_t address, uintmri_t size, uintmri_t value,
+                                                      PlatformWatchpointType type);
+__throws void  mriPlatform_ClearHardwareValueWatchpoint(uintmri_t address, uintmri_t size, uintmri_t value,
+                                                        PlatformWatchpointType type);
+
+__throws void  mriPlatform_StartProfiling(uint32_t sampleInterval);
+void           mriPlatform_StopProfiling(void);
+uint32_t       mriPlatform_GetCpuClockFrequency(void);
+__throws void  mriPlatform_EnableCycleCounter(void);
+uint32_t       mriPlatform_GetCycleCounter(void);
+__throws void  mriPlatform_StartPerfCounters(uint32_t sampleInterval);
+void           mriPlatform_StopPerfCounters(void);
+__throws void  mriPlatform_HookIrq(uint32_t irq);
+void           mriPlatform_UnhookIrq(uint32_t irq);
+int            mriPlatform_IsIrqPending(uint32_t irq);
+__throws void  mriPlatform_StartSampling(uint32_t sampleInterval);
+void           mriPlatform_StopSampling(void);
+__throws void  mriPlatform_StartCpuLoadSampling(uint32_t sampleInterval);
+void           mriPlatform_StopCpuLoadSampling(void);
 
 typedef enum
 {
@@ -119,6 +148,15 @@ PlatformSemihostParameters  mriPlatform_GetSemihostCallParameters(void);
 uintmri_t                   mriPlatform_GetNewlibSemihostOperation(void);
 void                        mriPlatform_SetSemihostCallReturnAndErrnoValues(int returnValue, int errNo);
 
+/* The memory that the instruction at the current PC could write to when executed. size is 0 if it isn't a store. */
+typedef struct
+{
+    uintmri_t   address;
+    uint32_t    size;
+} PlatformMemoryWrite;
+
+PlatformMemoryWrite         mriPlatform_GetMemoryWriteOfCurrentInstruction(void);
+
 const uint8_t*  mriPlatform_GetUid(void);
 size_t          mriPlatform_GetUidSize(void);
 
@@ -146,6 +184,23 @@ int             mriPlatform_RtosIsSetThreadStateSupported(void);
 void            mriPlatform_RtosSetThreadState(uintmri_t threadId, PlatformThreadState state);
 void            mriPlatform_RtosRestorePrevThreadState(void);
 
+/* Filesystem hooks used by gdb's vFile host I/O packets (remote get, remote put, and remote delete). Filenames are
+   '\0' terminated, flags and mode use the GDB_O_* and GDB_S_* values from fileio.h, and failures are returned as a
+   negated GDB_E* errno value from fileio.h. The weak defaults in fs/fs_weak.c report that there is no filesystem. */
+typedef struct
+{
+    uint32_t mode;
+    uint32_t size;
+    uint32_t lastModifiedTime;
+} PlatformFileStat;
+
+int             mriPlatform_FsOpen(const char* pFilename, uint32_t flags, uint32_t mode);
+int             mriPlatform_FsClose(int fileDescriptor);
+int32_t         mriPlatform_FsPRead(int fileDescriptor, void* pBuffer, uint32_t count, uint32_t offset);
+int32_t         mriPlatform_FsPWrite(int fileDescriptor, const void* pBuffer, uint32_t count, uint32_t offset);
+int             mriPlatform_FsFStat(int fileDescriptor, PlatformFileStat* pStat);
+int             mriPlatform_FsUnlink(const char* pFilename);
+
 void            mriPlatform_HandleFaultFromHighPriorityCode(void);
 
 /* Macroes which allow code to drop the mri namespace prefix. */
@@ -169,14 +224,19 @@ void            mriPlatform_HandleFaultFromHighPriorityCode(void);
 #define Platform_CommReceiveChar                            mriPlatform_CommReceiveChar
 #define Platform_CommSendBuffer                             mriPlatform_CommSendBuffer
 #define Platform_CommSendChar                               mriPlatform_CommSendChar
+#define Platform_CommIsTransmitReady                        mriPlatform_CommIsTransmitReady
+#define Platform_CommSetTransmitInterrupt                   mriPlatform_CommSetTransmitInterrupt
 #define Platform_HandleGDBCommand                           mriPlatform_HandleGDBCommand
 #define Platform_DetermineCauseOfException                  mriPlatform_DetermineCauseOfException
 #define Platform_GetTrapReason                              mriPlatform_GetTrapReason
 #define Platform_DisplayFaultCauseToGdbConsole              mriPlatform_DisplayFaultCauseToGdbConsole
+#define Platform_GetFaultStatusRegisters                    mriPlatform_GetFaultStatusRegisters
+#define Platform_UnwindStack                                mriPlatform_UnwindStack
 #define Platform_EnableSingleStep                           mriPlatform_EnableSingleStep
 #define Platform_DisableSingleStep                          mriPlatform_DisableSingleStep
 #define Platform_IsSingleStepping                           mriPlatform_IsSingleStepping
 #define Platform_GetProgramCounter                          mriPlatform_GetProgramCounter
+#define Platform_GetStackPointer                            mriPlatform_GetStackPointer
 #define Platform_SetProgramCounter                          mriPlatform_SetProgramCounter
 #define Platform_AdvanceProgramCounterToNextInstruction     mriPlatform_AdvanceProgramCounterToNextInstruction
 #define Platform_WasProgramCounterModifiedByUser            mriPlatform_WasProgramCounterModifiedByUser
@@ -192,10 +252,27 @@ void            mriPlatform_HandleFaultFromHighPriorityCode(void);
 #define Platform_ClearHardwareBreakpoint                    mriPlatform_ClearHardwareBreakpoint
 #define Platform_SetHardwareWatchpoint                      mriPlatform_SetHardwareWatchpoint
 #define Platform_ClearHardwareWatchpoint                    mriPlatform_ClearHardwareWatchpoint
+#define Platform_SetHardwareValueWatchpoint                 mriPlatform_SetHardwareValueWatchpoint
+#define Platform_ClearHardwareValueWatchpoint               mriPlatform_ClearHardwareValueWatchpoint
+#define Platform_StartProfiling                             mriPlatform_StartProfiling
+#define Platform_StopProfiling                              mriPlatform_StopProfiling
+#define Platform_GetCpuClockFrequency                       mriPlatform_GetCpuClockFrequency
+#define Platform_EnableCycleCounter                         mriPlatform_EnableCycleCounter
+#define Platform_GetCycleCounter                            mriPlatform_GetCycleCounter
+#define Platform_StartPerfCounters                          mriPlatform_StartPerfCounters
+#define Platform_StopPerfCounters                           mriPlatform_StopPerfCounters
+#define Platform_HookIrq                                    mriPlatform_HookIrq
+#define Platform_UnhookIrq                                  mriPlatform_UnhookIrq
+#define Platform_IsIrqPending                               mriPlatform_IsIrqPending
+#define Platform_StartSampling                              mriPlatform_StartSampling
+#define Platform_StopSampling                               mriPlatform_StopSampling
+#define Platform_StartCpuLoadSampling                       mriPlatform_StartCpuLoadSampling
+#define Platform_StopCpuLoadSampling                        mriPlatform_StopCpuLoadSampling
 #define Platform_TypeOfCurrentInstruction                   mriPlatform_TypeOfCurrentInstruction
 #define Platform_GetSemihostCallParameters                  mriPlatform_GetSemihostCallParameters
 #define Platform_GetNewlibSemihostOperation                 mriPlatform_GetNewlibSemihostOperation
 #define Platform_SetSemihostCallReturnAndErrnoValues        mriPlatform_SetSemihostCallReturnAndErrnoValues
+#define Platform_GetMemoryWriteOfCurrentInstruction         mriPlatform_GetMemoryWriteOfCurrentInstruction
 #define Platform_GetUid                                     mriPlatform_GetUid
 #define Platform_GetUidSize                                 mriPlatform_GetUidSize
 #define Platform_ResetDevice                                mriPlatform_ResetDevice
@@ -208,6 +285,12 @@ void            mriPlatform_HandleFaultFromHighPriorityCode(void);
 #define Platform_RtosIsSetThreadStateSupported              mriPlatform_RtosIsSetThreadStateSupported
 #define Platform_RtosSetThreadState                         mriPlatform_RtosSetThreadState
 #define Platform_RtosRestorePrevThreadState                 mriPlatform_RtosRestorePrevThreadState
+#define Platform_FsOpen                                     mriPlatform_FsOpen
+#define Platform_FsClose                                    mriPlatform_FsClose
+#define Platform_FsPRead                                    mriPlatform_FsPRead
+#define Platform_FsPWrite                                   mriPlatform_FsPWrite
+#define Platform_FsFStat                                    mriPlatform_FsFStat
+#define Platform_FsUnlink                                   mriPlatform_FsUnlink
 #define Platform_HandleFaultFromHighPriorityCode            mriPlatform_HandleFaultFromHighPriorityCode
 
 #endif /* PLATFORMS_H_ */
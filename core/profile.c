@@ -0,0 +1,302 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Statistical PC sampling profiler which builds a gprof compatible histogram in a user supplied buffer. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/fileio.h>
+#include <core/cmd_file.h>
+#include <core/gdb_console.h>
+#include <core/mri.h>
+#include <core/profile.h>
+
+
+/* The histogram is written to the GDB host as a gmon.out file which gprof can read directly:
+        20-byte gmon header ("gmon", 4-byte version of 1, and 12 spare bytes)
+        1-byte GMON_TAG_TIME_HIST tag
+        Histogram header (low_pc, high_pc, 4-byte bin count, 4-byte sample rate, 15-byte dimension, 1-byte abbreviation)
+        2-byte sample count for each bin
+   The headers are built in the user supplied buffer just ahead of the bins so that the whole file can be written with
+   a single Fwrite request. All values are in the target's byte order which is what gprof expects. */
+#define GMON_HEADER_SIZE        20
+#define GMON_VERSION            1
+#define GMON_TAG_TIME_HIST      0
+#define GMON_DIMENSION_SIZE     15
+#define GMON_FILE_HEADER_SIZE   (GMON_HEADER_SIZE + 1 + 2 * sizeof(uintmri_t) + 2 * sizeof(uint32_t) + \
+                                 GMON_DIMENSION_SIZE + 1)
+
+#define PROFILE_FILENAME_SIZE   64
+
+typedef struct
+{
+    uint16_t*   pBins;
+    uint32_t    binCount;
+    uint32_t    binShift;
+    uintmri_t   lowPc;
+    uint32_t    sampleInterval;
+    uint32_t    sampleCount;
+    uint32_t    outOfRangeCount;
+    uint32_t    flags;
+    char        filename[PROFILE_FILENAME_SIZE];
+} ProfileState;
+
+static ProfileState g_profile;
+
+/* ProfileState::flags bit definitions. */
+#define PROFILE_FLAGS_RUNNING           (1 << 0)
+#define PROFILE_FLAGS_DUMP_REQUESTED    (1 << 1)
+
+
+static uint16_t* calculateBinsAddress(void* pBuffer, size_t bufferSize);
+static uint32_t  calculateBinShift(uintmri_t range, uint32_t binCapacity);
+static uint32_t  calculateBinCount(uintmri_t range, uint32_t binShift);
+void mriSetProfileBuffer(void* pBuffer, size_t bufferSize, uintptr_t lowPc, uintptr_t highPc)
+{
+    uint16_t* pBins;
+    uint32_t  binCapacity;
+
+    Profile_Reset();
+    g_profile.pBins = NULL;
+    g_profile.binCount = 0;
+
+    pBins = calculateBinsAddress(pBuffer, bufferSize);
+    if (pBins == NULL || highPc <= lowPc)
+        return;
+    binCapacity = ((uint8_t*)pBuffer + bufferSize - (uint8_t*)pBins) / sizeof(*pBins);
+
+    g_profile.pBins = pBins;
+    g_profile.lowPc = lowPc;
+    g_profile.binShift = calculateBinShift(highPc - lowPc, binCapacity);
+    g_profile.binCount = calculateBinCount(highPc - lowPc, g_profile.binShift);
+}
+
+static uint16_t* calculateBinsAddress(void* pBuffer, size_t bufferSize)
+{
+    /* Leave room for the gmon headers and start the bins on a word boundary. */
+    uintptr_t bufferStart = (uintptr_t)pBuffer;
+    uintptr_t bufferEnd = bufferStart + bufferSize;
+    uintptr_t binsStart = (bufferStart + GMON_FILE_HEADER_SIZE + 3) & ~(uintptr_t)3;
+
+    if (pBuffer == NULL || binsStart < bufferStart || binsStart + sizeof(uint16_t) > bufferEnd)
+        return NULL;
+    return (uint16_t*)binsStart;
+}
+
+static uint32_t calculateBinShift(uintmri_t range, uint32_t binCapacity)
+{
+    /* Bins cover a power of 2 number of bytes so that samples can be binned with a shift. Instructions are at least
+       2 bytes in size so there is no point in making them any smaller than that. */
+    uint32_t binShift = 1;
+
+    while (calculateBinCount(range, binShift) > binCapacity)
+        binShift++;
+    return binShift;
+}
+
+static uint32_t calculateBinCount(uintmri_t range, uint32_t binShift)
+{
+    uintmri_t binMask = ((uintmri_t)1 << binShift) - 1;
+
+    return (uint32_t)((range >> binShift) + ((range & binMask) != 0));
+}
+
+
+void Profile_Reset(void)
+{
+    Profile_Stop();
+    g_profile.flags = 0;
+}
+
+
+void Profile_Start(uint32_t sampleInterval)
+{
+    if (g_profile.pBins == NULL)
+        __throw(notFoundException);
+    if (sampleInterval == 0)
+        __throw(invalidArgumentException);
+
+    Profile_Stop();
+    mri_memset(g_profile.pBins, 0, g_profile.binCount * sizeof(*g_profile.pBins));
+    g_profile.sampleCount = 0;
+    g_profile.outOfRangeCount = 0;
+    g_profile.sampleInterval = sampleInterval;
+
+    __try
+        Platform_StartProfiling(sampleInterval);
+    __catch
+        __rethrow;
+    g_profile.flags |= PROFILE_FLAGS_RUNNING;
+}
+
+
+void Profile_Stop(void)
+{
+    if (!Profile_IsRunning())
+        return;
+    Platform_StopProfiling();
+    g_profile.flags &= ~PROFILE_FLAGS_RUNNING;
+}
+
+
+int Profile_IsRunning(void)
+{
+    return g_profile.flags & PROFILE_FLAGS_RUNNING;
+}
+
+
+uint32_t Profile_GetSampleCount(void)
+{
+    return g_profile.sampleCount;
+}
+
+
+uint32_t Profile_GetOutOfRangeSampleCount(void)
+{
+    return g_profile.outOfRangeCount;
+}
+
+
+/* The profile can't be written from within a monitor command since gdb only accepts File-I/O requests from the target
+   while it thinks that the target is running. The dump is instead written by Profile_WriteRequestedDump() once gdb
+   next resumes execution. */
+void Profile_RequestDump(const char* pFilename)
+{
+    size_t filenameLength = mri_strlen(pFilename);
+
+    if (g_profile.pBins == NULL)
+        __throw(notFoundException);
+    if (filenameLength == 0)
+        __throw(invalidArgumentException);
+    if (filenameLength >= sizeof(g_profile.filename))
+        __throw(bufferOverrunException);
+
+    mri_memcpy(g_profile.filename, pFilename, filenameLength + 1);
+    g_profile.flags |= PROFILE_FLAGS_DUMP_REQUESTED;
+}
+
+
+void Profile_CancelDump(void)
+{
+    g_profile.flags &= ~PROFILE_FLAGS_DUMP_REQUESTED;
+}
+
+
+static uint8_t* writeGmonHeaders(void);
+static int      writeFileToGdbHost(const uint8_t* pData, uint32_t dataSize);
+int Profile_WriteRequestedDump(void)
+{
+    const uint8_t* pFile;
+    int            wasCompleted;
+
+    if ((g_profile.flags & PROFILE_FLAGS_DUMP_REQUESTED) == 0)
+        return 1;
+    Profile_CancelDump();
+
+    pFile = writeGmonHeaders();
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = writeFileToGdbHost(pFile, GMON_FILE_HEADER_SIZE + g_profile.binCount * sizeof(*g_profile.pBins));
+    SetIssuingFileIOForDebugger(0);
+
+    return wasCompleted;
+}
+
+static uint8_t* writeGmonBytes(uint8_t* pDest, const void* pSrc, size_t size);
+static uint8_t* writeGmonHeaders(void)
+{
+    static const char gmonCookie[4] = { 'g', 'm', 'o', 'n' };
+    static const char dimension[GMON_DIMENSION_SIZE] = "seconds";
+    uint8_t*          pFile = (uint8_t*)g_profile.pBins - GMON_FILE_HEADER_SIZE;
+    uint8_t*          pCurr = pFile;
+    uint32_t          version = GMON_VERSION;
+    uint8_t           tag = GMON_TAG_TIME_HIST;
+    uintmri_t         highPc = g_profile.lowPc + ((uintmri_t)g_profile.binCount << g_profile.binShift);
+    uint32_t          sampleRate = Platform_GetCpuClockFrequency() / g_profile.sampleInterval;
+    char              dimensionAbbreviation = 's';
+
+    /* Fall back to reporting raw sample counts as seconds if the clock rate isn't known. */
+    if (sampleRate == 0)
+        sampleRate = 1;
+
+    mri_memset(pFile, 0, GMON_HEADER_SIZE);
+    pCurr = writeGmonBytes(pCurr, gmonCookie, sizeof(gmonCookie));
+    pCurr = writeGmonBytes(pCurr, &version, sizeof(version));
+    pCurr = pFile + GMON_HEADER_SIZE;
+    pCurr = writeGmonBytes(pCurr, &tag, sizeof(tag));
+    pCurr = writeGmonBytes(pCurr, &g_profile.lowPc, sizeof(g_profile.lowPc));
+    pCurr = writeGmonBytes(pCurr, &highPc, sizeof(highPc));
+    pCurr = writeGmonBytes(pCurr, &g_profile.binCount, sizeof(g_profile.binCount));
+    pCurr = writeGmonBytes(pCurr, &sampleRate, sizeof(sampleRate));
+    pCurr = writeGmonBytes(pCurr, dimension, sizeof(dimension));
+    writeGmonBytes(pCurr, &dimensionAbbreviation, sizeof(dimensionAbbreviation));
+
+    return pFile;
+}
+
+static uint8_t* writeGmonBytes(uint8_t* pDest, const void* pSrc, size_t size)
+{
+    mri_memcpy(pDest, pSrc, size);
+    return pDest + size;
+}
+
+static int writeFileToGdbHost(const uint8_t* pData, uint32_t dataSize)
+{
+    OpenParameters     openParameters;
+    TransferParameters writeParameters;
+    int                fileDescriptor;
+    int                wasWritten;
+
+    openParameters.filenameAddress = (uint32_t)(uintptr_t)g_profile.filename;
+    openParameters.filenameLength = mri_strlen(g_profile.filename) + 1;
+    openParameters.flags = GDB_O_WRONLY | GDB_O_CREAT | GDB_O_TRUNC;
+    openParameters.mode = GDB_S_IRUSR | GDB_S_IWUSR | GDB_S_IRGRP | GDB_S_IROTH;
+    if (!IssueGdbFileOpenRequest(&openParameters))
+        return 0;
+    fileDescriptor = GetSemihostReturnCode();
+    if (fileDescriptor < 0)
+    {
+        WriteStringToGdbConsole("Failed to open profile output file.\r\n");
+        return 1;
+    }
+
+    writeParameters.fileDescriptor = fileDescriptor;
+    writeParameters.bufferAddress = (uint32_t)(uintptr_t)pData;
+    writeParameters.bufferSize = dataSize;
+    if (!IssueGdbFileWriteRequest(&writeParameters))
+    {
+        IssueGdbFileCloseRequest(fileDescriptor);
+        return 0;
+    }
+    wasWritten = GetSemihostReturnCode() == (int)dataSize;
+
+    if (!IssueGdbFileCloseRequest(fileDescriptor))
+        return 0;
+    WriteStringToGdbConsole(wasWritten ? "Profile written.\r\n" : "Failed to write profile output file.\r\n");
+    return 1;
+}
+
+
+void Profile_RecordSample(uintmri_t pc)
+{
+    uintmri_t bin = (pc - g_profile.lowPc) >> g_profile.binShift;
+
+    g_profile.sampleCount++;
+    if (pc < g_profile.lowPc || bin >= g_profile.binCount)
+    {
+        g_profile.outOfRangeCount++;
+        return;
+    }
+    if (g_profile.pBins[bin] != 0xFFFF)
+        g_profile.pBins[bin]++;
+}
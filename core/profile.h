@@ -0,0 +1,51 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Statistical PC sampling profiler which builds a gprof compatible histogram in a user supplied buffer. */
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <core/try_catch.h>
+#include <core/mri_int.h>
+
+/* Default number of CPU cycles between PC samples when "monitor profile start" isn't given an interval. */
+#define MRI_PROFILE_DEFAULT_INTERVAL    100000
+
+/* Real name of functions are in mri namespace. */
+void          mriProfile_Reset(void);
+__throws void mriProfile_Start(uint32_t sampleInterval);
+void          mriProfile_Stop(void);
+int           mriProfile_IsRunning(void);
+uint32_t      mriProfile_GetSampleCount(void);
+uint32_t      mriProfile_GetOutOfRangeSampleCount(void);
+__throws void mriProfile_RequestDump(const char* pFilename);
+void          mriProfile_CancelDump(void);
+int           mriProfile_WriteRequestedDump(void);
+void          mriProfile_RecordSample(uintmri_t pc);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Profile_Reset                     mriProfile_Reset
+#define Profile_Start                     mriProfile_Start
+#define Profile_Stop                      mriProfile_Stop
+#define Profile_IsRunning                 mriProfile_IsRunning
+#define Profile_GetSampleCount            mriProfile_GetSampleCount
+#define Profile_GetOutOfRangeSampleCount  mriProfile_GetOutOfRangeSampleCount
+#define Profile_RequestDump               mriProfile_RequestDump
+#define Profile_CancelDump                mriProfile_CancelDump
+#define Profile_WriteRequestedDump        mriProfile_WriteRequestedDump
+#define Profile_RecordSample              mriProfile_RecordSample
+
+#endif /* PROFILE_H_ */
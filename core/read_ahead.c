@@ -0,0 +1,273 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Read-ahead caching of semihosted file reads so that many small reads cost a single gdb round trip. */
+#include <errno.h>
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/buffer.h>
+#include <core/memory.h>
+#include <core/fileio.h>
+#include <core/cmd_file.h>
+#include <core/read_ahead.h>
+
+
+/* A file only holds on to its entry while it has cached data that the program hasn't read yet. gdb's file position
+   is always ahead of the program's by the number of unread bytes. */
+typedef struct
+{
+    uint8_t  buffer[MRI_READ_AHEAD_BUFFER_SIZE];
+    uint32_t fileDescriptor;
+    uint32_t used;
+    uint32_t readIndex;
+} ReadAheadFile;
+
+static ReadAheadFile g_files[MRI_READ_AHEAD_FILE_COUNT];
+
+
+void ReadAhead_Reset(void)
+{
+    mri_memset(g_files, 0, sizeof(g_files));
+}
+
+
+/* Handles the program's semihost read request. Small reads are satisfied from the file's cache, which is refilled
+   with a single large gdb read once it runs dry. Returns 0 if CTRL+C was pressed in gdb while the cache was being
+   filled, leaving the PC on the semihost call so that it is retried when execution resumes. */
+static ReadAheadFile* findFile(uint32_t fileDescriptor);
+static ReadAheadFile* findFreeFile(uint32_t fileDescriptor);
+static int            readDirectly(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize);
+static int            fillFile(ReadAheadFile* pFile);
+static int            copyFromFile(ReadAheadFile* pFile, uintmri_t bufferAddress, int32_t bufferSize);
+static int            completeCall(int returnCode, int errNo);
+int ReadAhead_Read(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    ReadAheadFile* pFile;
+
+    if (bufferSize <= 0)
+        return readDirectly(fileDescriptor, bufferAddress, bufferSize);
+    pFile = findFile(fileDescriptor);
+    if (pFile)
+        return copyFromFile(pFile, bufferAddress, bufferSize);
+    if ((uint32_t)bufferSize >= sizeof(pFile->buffer))
+        return readDirectly(fileDescriptor, bufferAddress, bufferSize);
+    pFile = findFreeFile(fileDescriptor);
+    if (pFile == NULL)
+        return readDirectly(fileDescriptor, bufferAddress, bufferSize);
+
+    if (!fillFile(pFile))
+        return 0;
+    /* Pass along end of file and errors from gdb. */
+    if (pFile->used == 0)
+        return completeCall(GetSemihostReturnCode(), GetSemihostErrno());
+    return copyFromFile(pFile, bufferAddress, bufferSize);
+}
+
+static ReadAheadFile* findFile(uint32_t fileDescriptor)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(g_files)/sizeof(g_files[0]) ; i++)
+    {
+        ReadAheadFile* pFile = &g_files[i];
+
+        if (pFile->used && pFile->fileDescriptor == fileDescriptor)
+            return pFile;
+    }
+    return NULL;
+}
+
+static ReadAheadFile* findFreeFile(uint32_t fileDescriptor)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(g_files)/sizeof(g_files[0]) ; i++)
+    {
+        ReadAheadFile* pFile = &g_files[i];
+
+        if (pFile->used == 0)
+        {
+            pFile->fileDescriptor = fileDescriptor;
+            return pFile;
+        }
+    }
+    return NULL;
+}
+
+static int readDirectly(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    TransferParameters parameters;
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.bufferAddress = (uint32_t)bufferAddress;
+    parameters.bufferSize = bufferSize;
+    return IssueGdbFileReadRequest(&parameters);
+}
+
+/* Reads into the cache on behalf of the debugger so that the PC is left alone for the program's current semihost
+   call to be completed afterwards. */
+static int fillFile(ReadAheadFile* pFile)
+{
+    TransferParameters parameters;
+    int                wasCompleted;
+    int                bytesRead;
+
+    parameters.fileDescriptor = pFile->fileDescriptor;
+    parameters.bufferAddress = (uint32_t)(uintptr_t)pFile->buffer;
+    parameters.bufferSize = sizeof(pFile->buffer);
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = IssueGdbFileReadRequest(&parameters);
+    SetIssuingFileIOForDebugger(0);
+    if (!wasCompleted)
+        return 0;
+
+    bytesRead = GetSemihostReturnCode();
+    if (bytesRead < 0)
+        bytesRead = 0;
+    if ((uint32_t)bytesRead > sizeof(pFile->buffer))
+        bytesRead = sizeof(pFile->buffer);
+    pFile->used = bytesRead;
+    pFile->readIndex = 0;
+    return 1;
+}
+
+/* Like a POSIX read() from a pipe, this returns just the cached bytes when fewer than requested are available. */
+static int  writeCachedDataToMemory(ReadAheadFile* pFile, uintmri_t bufferAddress, uint32_t size);
+static void freeFile(ReadAheadFile* pFile);
+static int copyFromFile(ReadAheadFile* pFile, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    uint32_t bytesToCopy = pFile->used - pFile->readIndex;
+
+    if ((uint32_t)bufferSize < bytesToCopy)
+        bytesToCopy = bufferSize;
+    if (!writeCachedDataToMemory(pFile, bufferAddress, bytesToCopy))
+        return completeCall(-1, EFAULT);
+
+    pFile->readIndex += bytesToCopy;
+    if (pFile->readIndex >= pFile->used)
+        freeFile(pFile);
+    return completeCall(bytesToCopy, 0);
+}
+
+static int writeCachedDataToMemory(ReadAheadFile* pFile, uintmri_t bufferAddress, uint32_t size)
+{
+    Buffer buffer;
+
+    Buffer_Init(&buffer, (char*)pFile->buffer + pFile->readIndex, size);
+    return WriteBinaryBufferToMemory(&buffer, bufferAddress, size);
+}
+
+static void freeFile(ReadAheadFile* pFile)
+{
+    pFile->used = 0;
+    pFile->readIndex = 0;
+}
+
+static int completeCall(int returnCode, int errNo)
+{
+    SetSemihostReturnValues(returnCode, errNo);
+    FlagSemihostCallAsHandled();
+    return 1;
+}
+
+
+/* Handles mriHostRead() requests, which bypass the cache. Data that was already read ahead for the file is handed
+   out first and the rest of the buffer is then read straight from gdb so that the program gets as much data as a
+   single read of the whole buffer would have returned. Returns 0 if CTRL+C was pressed in gdb, leaving the cache
+   intact so that the call can be retried. */
+int ReadAhead_ReadAll(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    ReadAheadFile*     pFile = findFile(fileDescriptor);
+    TransferParameters parameters;
+    uint32_t           cachedSize;
+    int                wasCompleted;
+    int                bytesRead;
+
+    if (bufferSize <= 0 || pFile == NULL)
+        return readDirectly(fileDescriptor, bufferAddress, bufferSize);
+    cachedSize = pFile->used - pFile->readIndex;
+    if ((uint32_t)bufferSize <= cachedSize)
+        return copyFromFile(pFile, bufferAddress, bufferSize);
+    if (!writeCachedDataToMemory(pFile, bufferAddress, cachedSize))
+        return completeCall(-1, EFAULT);
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.bufferAddress = (uint32_t)(bufferAddress + cachedSize);
+    parameters.bufferSize = bufferSize - cachedSize;
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = IssueGdbFileReadRequest(&parameters);
+    SetIssuingFileIOForDebugger(0);
+    if (!wasCompleted)
+        return 0;
+
+    /* The cached bytes have been read even if gdb hit the end of the file or failed while reading the rest. */
+    freeFile(pFile);
+    bytesRead = GetSemihostReturnCode();
+    if (bytesRead < 0)
+        bytesRead = 0;
+    return completeCall(cachedSize + bytesRead, 0);
+}
+
+
+/* Handles the program's semihost seek request. Relative seeks are adjusted for the data that gdb has already read
+   ahead and the cache is dropped once gdb has moved to the new position. A failed seek, like on stdin, leaves the
+   cache intact. */
+int ReadAhead_Seek(const SeekParameters* pParameters)
+{
+    ReadAheadFile* pFile = findFile(pParameters->fileDescriptor);
+    SeekParameters parameters = *pParameters;
+
+    if (pFile && parameters.whence == GDB_SEEK_CUR)
+        parameters.offset -= (int32_t)(pFile->used - pFile->readIndex);
+    if (!IssueGdbFileSeekRequest(&parameters))
+        return 0;
+    if (pFile && GetSemihostReturnCode() >= 0)
+        freeFile(pFile);
+    return 1;
+}
+
+
+/* Called before the program writes to a file. gdb's file position is moved back to where the program expects it to
+   be and the cache is dropped. Returns 0 if CTRL+C was pressed in gdb before the position could be moved. */
+int ReadAhead_Rewind(uint32_t fileDescriptor)
+{
+    ReadAheadFile* pFile = findFile(fileDescriptor);
+    SeekParameters parameters;
+    int            wasCompleted;
+
+    if (pFile == NULL)
+        return 1;
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.offset = -(int32_t)(pFile->used - pFile->readIndex);
+    parameters.whence = GDB_SEEK_CUR;
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = IssueGdbFileSeekRequest(&parameters);
+    SetIssuingFileIOForDebugger(0);
+    if (!wasCompleted)
+        return 0;
+
+    freeFile(pFile);
+    return 1;
+}
+
+
+/* Called when the program closes a file so that its cache isn't handed to the next file which reuses the descriptor. */
+void ReadAhead_Invalidate(uint32_t fileDescriptor)
+{
+    ReadAheadFile* pFile = findFile(fileDescriptor);
+
+    if (pFile)
+        freeFile(pFile);
+}
@@ -0,0 +1,50 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Read-ahead caching of semihosted file reads so that many small reads cost a single gdb round trip. */
+#ifndef READ_AHEAD_H_
+#define READ_AHEAD_H_
+
+#include <stdint.h>
+#include <core/mri_int.h>
+#include <core/cmd_file.h>
+
+/* Number of bytes requested from gdb each time that a file's cache is refilled. Reads which are at least this large
+   bypass the cache. */
+#ifndef MRI_READ_AHEAD_BUFFER_SIZE
+    #define MRI_READ_AHEAD_BUFFER_SIZE  128
+#endif
+
+/* Number of files which can have read-ahead data cached at once. Reads from other files go straight to gdb. */
+#ifndef MRI_READ_AHEAD_FILE_COUNT
+    #define MRI_READ_AHEAD_FILE_COUNT   2
+#endif
+
+/* Real name of functions are in mri namespace. */
+void mriReadAhead_Reset(void);
+int  mriReadAhead_Read(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize);
+int  mriReadAhead_ReadAll(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize);
+int  mriReadAhead_Seek(const SeekParameters* pParameters);
+int  mriReadAhead_Rewind(uint32_t fileDescriptor);
+void mriReadAhead_Invalidate(uint32_t fileDescriptor);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define ReadAhead_Reset         mriReadAhead_Reset
+#define ReadAhead_Read          mriReadAhead_Read
+#define ReadAhead_ReadAll       mriReadAhead_ReadAll
+#define ReadAhead_Seek          mriReadAhead_Seek
+#define ReadAhead_Rewind        mriReadAhead_Rewind
+#define ReadAhead_Invalidate    mriReadAhead_Invalidate
+
+#endif /* READ_AHEAD_H_ */
@@ -0,0 +1,405 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* On-target execution recorder which logs the state changed by each instruction so that it can be undone later. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/signal.h>
+#include <core/mri.h>
+#include <core/record.h>
+
+
+#define RECORD_MASK_WORDS   ((MRI_RECORD_MAX_REGISTERS + 31) / 32)
+#define RECORD_STORE_SLOTS  ((MRI_RECORD_MAX_STORE_SIZE + sizeof(uintmri_t) - 1) / sizeof(uintmri_t))
+
+/* Each entry in the log is made up of uintmri_t slots:
+        entry length in slots
+        PC before the instruction executed
+        RECORD_MASK_WORDS of bitmask indicating which context registers were modified
+        previous value of each modified register, in ascending order
+        address of the memory which the instruction could write
+        byte size of that memory (0 for instructions which don't store)
+        previous contents of that memory, padded out to a whole number of slots
+        entry length in slots again
+   The length is at both ends so that the ring can be walked forwards to drop the oldest entry when it fills up and
+   backwards to undo the newest. */
+#define RECORD_FIXED_SLOTS  (1 + 1 + RECORD_MASK_WORDS + 2 + 1)
+#define RECORD_MAX_SLOTS    (RECORD_FIXED_SLOTS + MRI_RECORD_MAX_REGISTERS + RECORD_STORE_SLOTS)
+
+/* State from just before the instruction which is currently being stepped. */
+typedef struct
+{
+    uintmri_t           registers[MRI_RECORD_MAX_REGISTERS];
+    uintmri_t           memory[RECORD_STORE_SLOTS];
+    PlatformMemoryWrite store;
+    uintmri_t           pc;
+    size_t              registerCount;
+} RecordSnapshot;
+
+typedef struct
+{
+    RecordSnapshot  before;
+    uintmri_t       breakpoints[MRI_RECORD_BREAKPOINT_COUNT];
+    uintmri_t*      pSlots;
+    uint32_t        slotCount;
+    uint32_t        head;
+    uint32_t        used;
+    uint32_t        entryCount;
+    uint32_t        breakpointCount;
+    uint32_t        flags;
+} RecordState;
+
+static RecordState g_record;
+
+/* RecordState::flags bit definitions. */
+#define RECORD_FLAGS_RUNNING        (1 << 0)
+#define RECORD_FLAGS_CONTINUING     (1 << 1)
+#define RECORD_FLAGS_SNAPSHOT_VALID (1 << 2)
+
+
+static void clearLog(void);
+void mriSetRecordBuffer(void* pBuffer, size_t bufferSize)
+{
+    Record_Stop();
+    g_record.pSlots = (uintmri_t*)pBuffer;
+    g_record.slotCount = pBuffer ? bufferSize / sizeof(uintmri_t) : 0;
+}
+
+static void clearLog(void)
+{
+    g_record.head = 0;
+    g_record.used = 0;
+    g_record.entryCount = 0;
+}
+
+
+void Record_Reset(void)
+{
+    Record_Stop();
+    g_record.breakpointCount = 0;
+}
+
+
+void Record_Start(void)
+{
+    if (g_record.pSlots == NULL)
+        __throw(notFoundException);
+    if (g_record.slotCount < RECORD_MAX_SLOTS)
+        __throw(bufferOverrunException);
+
+    clearLog();
+    g_record.flags = RECORD_FLAGS_RUNNING;
+}
+
+
+void Record_Stop(void)
+{
+    clearLog();
+    g_record.flags = 0;
+}
+
+
+int Record_IsRunning(void)
+{
+    return g_record.flags & RECORD_FLAGS_RUNNING;
+}
+
+
+int Record_HasBuffer(void)
+{
+    return g_record.pSlots != NULL;
+}
+
+
+uint32_t Record_GetEntryCount(void)
+{
+    return g_record.entryCount;
+}
+
+
+/* Called once gdb has resumed execution. Stepping hasn't been enabled yet if gdb wants to continue so the recorder
+   will step the whole way to the next stop instead. */
+void Record_TrackGdbResume(void)
+{
+    if (!Record_IsRunning())
+        return;
+    if (Platform_IsSingleStepping())
+        g_record.flags &= ~RECORD_FLAGS_CONTINUING;
+    else
+        g_record.flags |= RECORD_FLAGS_CONTINUING;
+}
+
+
+static void takeSnapshot(void);
+void Record_PrepareToResume(void)
+{
+    if (!Record_IsRunning())
+        return;
+    if (!Platform_IsSingleStepping())
+        Platform_EnableSingleStep();
+    takeSnapshot();
+}
+
+static void takeSnapshot(void)
+{
+    RecordSnapshot* pBefore = &g_record.before;
+    MriContext*     pContext = GetContext();
+    size_t          i;
+
+    pBefore->registerCount = Context_Count(pContext);
+    if (pBefore->registerCount > MRI_RECORD_MAX_REGISTERS)
+        pBefore->registerCount = MRI_RECORD_MAX_REGISTERS;
+    for (i = 0 ; i < pBefore->registerCount ; i++)
+        pBefore->registers[i] = Context_Get(pContext, i);
+    pBefore->pc = Platform_GetProgramCounter();
+
+    pBefore->store = Platform_GetMemoryWriteOfCurrentInstruction();
+    if (pBefore->store.size > MRI_RECORD_MAX_STORE_SIZE)
+        pBefore->store.size = MRI_RECORD_MAX_STORE_SIZE;
+    if (pBefore->store.size > 0)
+        pBefore->store.size = Platform_ReadMemory(pBefore->memory, pBefore->store.address, pBefore->store.size);
+    g_record.flags |= RECORD_FLAGS_SNAPSHOT_VALID;
+}
+
+
+/* Called each time that the program stops after a single step while recording. Returns non-zero if the step was only
+   taken on the way to the next stop of a gdb continue and execution has already been resumed. */
+static void appendEntry(void);
+static int  isPlainSingleStep(void);
+int Record_ProcessSingleStep(void)
+{
+    if (!Record_IsRunning())
+        return 0;
+    appendEntry();
+    Platform_DisableSingleStep();
+    if (!Record_IsContinuing() || !isPlainSingleStep())
+        return 0;
+
+    Record_PrepareToResume();
+    return 1;
+}
+
+static uint32_t buildRegisterMask(uint32_t* pMask);
+static uint32_t calculateMemorySlots(uint32_t byteCount);
+static void     makeRoomForEntry(uint32_t entrySlots);
+static void     writeSlot(uintmri_t value);
+static void appendEntry(void)
+{
+    RecordSnapshot* pBefore = &g_record.before;
+    uint32_t        mask[RECORD_MASK_WORDS];
+    uint32_t        registerCount;
+    uint32_t        memorySlots;
+    uint32_t        entrySlots;
+    size_t          i;
+
+    if ((g_record.flags & RECORD_FLAGS_SNAPSHOT_VALID) == 0)
+        return;
+    g_record.flags &= ~RECORD_FLAGS_SNAPSHOT_VALID;
+
+    /* Nothing executed if the step stopped on a breakpoint before the instruction could run. */
+    registerCount = buildRegisterMask(mask);
+    if (registerCount == 0 && Platform_GetProgramCounter() == pBefore->pc)
+        return;
+
+    memorySlots = calculateMemorySlots(pBefore->store.size);
+    entrySlots = RECORD_FIXED_SLOTS + registerCount + memorySlots;
+    makeRoomForEntry(entrySlots);
+
+    writeSlot(entrySlots);
+    writeSlot(pBefore->pc);
+    for (i = 0 ; i < RECORD_MASK_WORDS ; i++)
+        writeSlot(mask[i]);
+    for (i = 0 ; i < pBefore->registerCount ; i++)
+    {
+        if (mask[i / 32] & (1U << (i % 32)))
+            writeSlot(pBefore->registers[i]);
+    }
+    writeSlot(pBefore->store.address);
+    writeSlot(pBefore->store.size);
+    for (i = 0 ; i < memorySlots ; i++)
+        writeSlot(pBefore->memory[i]);
+    writeSlot(entrySlots);
+
+    g_record.used += entrySlots;
+    g_record.entryCount++;
+}
+
+static uint32_t buildRegisterMask(uint32_t* pMask)
+{
+    RecordSnapshot* pBefore = &g_record.before;
+    MriContext*     pContext = GetContext();
+    size_t          registerCount = Context_Count(pContext);
+    uint32_t        changedCount = 0;
+    size_t          i;
+
+    mri_memset(pMask, 0, RECORD_MASK_WORDS * sizeof(*pMask));
+    if (registerCount > pBefore->registerCount)
+        registerCount = pBefore->registerCount;
+    for (i = 0 ; i < registerCount ; i++)
+    {
+        if (Context_Get(pContext, i) != pBefore->registers[i])
+        {
+            pMask[i / 32] |= 1U << (i % 32);
+            changedCount++;
+        }
+    }
+    return changedCount;
+}
+
+static uint32_t calculateMemorySlots(uint32_t byteCount)
+{
+    return (byteCount + sizeof(uintmri_t) - 1) / sizeof(uintmri_t);
+}
+
+static uint32_t slotIndex(uint32_t index);
+static void makeRoomForEntry(uint32_t entrySlots)
+{
+    while (g_record.slotCount - g_record.used < entrySlots)
+    {
+        /* Drop the oldest entry to make room for this one. */
+        uint32_t tail = slotIndex(g_record.head + g_record.slotCount - g_record.used);
+        g_record.used -= g_record.pSlots[tail];
+        g_record.entryCount--;
+    }
+}
+
+static uint32_t slotIndex(uint32_t index)
+{
+    return index % g_record.slotCount;
+}
+
+static void writeSlot(uintmri_t value)
+{
+    g_record.pSlots[g_record.head] = value;
+    g_record.head = slotIndex(g_record.head + 1);
+}
+
+static int isPlainSingleStep(void)
+{
+    return GetSignalValue() == SIGTRAP && Platform_GetTrapReason().type == MRI_PLATFORM_TRAP_TYPE_UNKNOWN;
+}
+
+
+int Record_IsContinuing(void)
+{
+    return g_record.flags & RECORD_FLAGS_CONTINUING;
+}
+
+
+/* Undoes the most recently recorded instruction by putting back the memory and registers that it modified. Returns 0
+   if there are no more entries left in the log to undo. */
+static uintmri_t readSlot(uint32_t* pIndex);
+static void      restoreMemory(uint32_t* pIndex, uintmri_t address, uint32_t byteCount);
+int Record_StepBack(void)
+{
+    MriContext* pContext = GetContext();
+    size_t      registerCount = Context_Count(pContext);
+    uint32_t    mask[RECORD_MASK_WORDS];
+    uint32_t    entrySlots;
+    uint32_t    index;
+    uintmri_t   pc;
+    uintmri_t   address;
+    uint32_t    byteCount;
+    size_t      i;
+
+    if (g_record.entryCount == 0)
+        return 0;
+
+    entrySlots = g_record.pSlots[slotIndex(g_record.head + g_record.slotCount - 1)];
+    index = slotIndex(g_record.head + g_record.slotCount - entrySlots + 1);
+    pc = readSlot(&index);
+    for (i = 0 ; i < RECORD_MASK_WORDS ; i++)
+        mask[i] = readSlot(&index);
+    if (registerCount > MRI_RECORD_MAX_REGISTERS)
+        registerCount = MRI_RECORD_MAX_REGISTERS;
+    for (i = 0 ; i < MRI_RECORD_MAX_REGISTERS ; i++)
+    {
+        if ((mask[i / 32] & (1U << (i % 32))) == 0)
+            continue;
+        if (i < registerCount)
+            Context_Set(pContext, i, readSlot(&index));
+        else
+            readSlot(&index);
+    }
+    address = readSlot(&index);
+    byteCount = readSlot(&index);
+    restoreMemory(&index, address, byteCount);
+    Platform_SetProgramCounter(pc);
+
+    g_record.head = slotIndex(g_record.head + g_record.slotCount - entrySlots);
+    g_record.used -= entrySlots;
+    g_record.entryCount--;
+    g_record.flags &= ~RECORD_FLAGS_SNAPSHOT_VALID;
+    return 1;
+}
+
+static uintmri_t readSlot(uint32_t* pIndex)
+{
+    uintmri_t value = g_record.pSlots[*pIndex];
+    *pIndex = slotIndex(*pIndex + 1);
+    return value;
+}
+
+static void restoreMemory(uint32_t* pIndex, uintmri_t address, uint32_t byteCount)
+{
+    while (byteCount > 0)
+    {
+        uintmri_t slot = readSlot(pIndex);
+        uint8_t*  pBytes = (uint8_t*)&slot;
+        uint32_t  i;
+
+        for (i = 0 ; i < sizeof(slot) && byteCount > 0 ; i++, byteCount--)
+            Platform_MemWrite8(address++, pBytes[i]);
+    }
+}
+
+
+void Record_SetBreakpoint(uintmri_t address)
+{
+    address &= ~1;
+    if (Record_IsBreakpointAt(address) || g_record.breakpointCount >= MRI_RECORD_BREAKPOINT_COUNT)
+        return;
+    g_record.breakpoints[g_record.breakpointCount++] = address;
+}
+
+
+void Record_ClearBreakpoint(uintmri_t address)
+{
+    uint32_t i;
+
+    address &= ~1;
+    for (i = 0 ; i < g_record.breakpointCount ; i++)
+    {
+        if (g_record.breakpoints[i] == address)
+        {
+            g_record.breakpoints[i] = g_record.breakpoints[--g_record.breakpointCount];
+            return;
+        }
+    }
+}
+
+
+int Record_IsBreakpointAt(uintmri_t address)
+{
+    uint32_t i;
+
+    address &= ~1;
+    for (i = 0 ; i < g_record.breakpointCount ; i++)
+    {
+        if (g_record.breakpoints[i] == address)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* On-target execution recorder which logs the state changed by each instruction so that it can be undone later. */
+#ifndef RECORD_H_
+#define RECORD_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+
+/* Only the first MRI_RECORD_MAX_REGISTERS registers in the context are recorded. */
+#define MRI_RECORD_MAX_REGISTERS    64
+
+/* Largest store that a single instruction can make (VSTM/VPUSH of 16 double precision registers). */
+#define MRI_RECORD_MAX_STORE_SIZE   128
+
+/* Number of gdb breakpoints which reverse continue can stop at. */
+#ifndef MRI_RECORD_BREAKPOINT_COUNT
+    #define MRI_RECORD_BREAKPOINT_COUNT 8
+#endif
+
+/* Real name of functions are in mri namespace. */
+void          mriRecord_Reset(void);
+__throws void mriRecord_Start(void);
+void          mriRecord_Stop(void);
+int           mriRecord_IsRunning(void);
+int           mriRecord_HasBuffer(void);
+uint32_t      mriRecord_GetEntryCount(void);
+void          mriRecord_TrackGdbResume(void);
+void          mriRecord_PrepareToResume(void);
+int           mriRecord_ProcessSingleStep(void);
+int           mriRecord_IsContinuing(void);
+int           mriRecord_StepBack(void);
+void          mriRecord_SetBreakpoint(uintmri_t address);
+void          mriRecord_ClearBreakpoint(uintmri_t address);
+int           mriRecord_IsBreakpointAt(uintmri_t address);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Record_Reset                mriRecord_Reset
+#define Record_Start                mriRecord_Start
+#define Record_Stop                 mriRecord_Stop
+#define Record_IsRunning            mriRecord_IsRunning
+#define Record_HasBuffer            mriRecord_HasBuffer
+#define Record_GetEntryCount        mriRecord_GetEntryCount
+#define Record_TrackGdbResume       mriRecord_TrackGdbResume
+#define Record_PrepareToResume      mriRecord_PrepareToResume
+#define Record_ProcessSingleStep    mriRecord_ProcessSingleStep
+#define Record_IsContinuing         mriRecord_IsContinuing
+#define Record_StepBack             mriRecord_StepBack
+#define Record_SetBreakpoint        mriRecord_SetBreakpoint
+#define Record_ClearBreakpoint      mriRecord_ClearBreakpoint
+#define Record_IsBreakpointAt       mriRecord_IsBreakpointAt
+
+#endif /* RECORD_H_ */
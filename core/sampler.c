@@ -0,0 +1,238 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Periodically samples a list of variables into a ring buffer which is streamed to the gdb console. */
+#include <core/libc.h>
+#include <core/buffer.h>
+#include <core/platforms.h>
+#include <core/gdb_console.h>
+#include <core/mri.h>
+#include <core/sampler.h>
+
+
+/* Each record in the ring buffer is a 32-bit cycle counter timestamp followed by the value of each variable using
+   its own size. Records are streamed to gdb as a line of text with each field in fixed width hexadecimal:
+        TTTTTTTT VV VVVV VVVVVVVV\r\n
+*/
+#define SAMPLER_TIMESTAMP_SIZE  sizeof(uint32_t)
+#define SAMPLER_LINE_SIZE       (2 * SAMPLER_TIMESTAMP_SIZE + MRI_SAMPLER_MAX_VARIABLES * (1 + 2 * sizeof(uint32_t)) + 2)
+
+typedef struct
+{
+    SamplerVariable variables[MRI_SAMPLER_MAX_VARIABLES];
+    uint8_t*        pBuffer;
+    size_t          bufferSize;
+    uint32_t        variableCount;
+    uint32_t        recordSize;
+    uint32_t        recordCapacity;
+    uint32_t        readIndex;
+    uint32_t        recordCount;
+    uint32_t        flags;
+} SamplerState;
+
+static SamplerState g_sampler;
+
+/* SamplerState::flags bit definitions. */
+#define SAMPLER_FLAGS_RUNNING   (1 << 0)
+
+
+void mriSetSampleBuffer(void* pBuffer, size_t bufferSize)
+{
+    Sampler_Reset();
+    g_sampler.pBuffer = (uint8_t*)pBuffer;
+    g_sampler.bufferSize = pBuffer ? bufferSize : 0;
+}
+
+
+void Sampler_Reset(void)
+{
+    Sampler_Stop();
+    g_sampler.flags = 0;
+    g_sampler.recordCount = 0;
+}
+
+
+static int      isValidVariableList(const SamplerVariable* pVariables, uint32_t variableCount);
+static uint32_t calculateRecordSize(const SamplerVariable* pVariables, uint32_t variableCount);
+static uint32_t readVariable(const SamplerVariable* pVariable);
+void Sampler_Start(uint32_t sampleInterval, const SamplerVariable* pVariables, uint32_t variableCount)
+{
+    uint32_t recordSize;
+    uint32_t i;
+
+    if (g_sampler.pBuffer == NULL)
+        __throw(notFoundException);
+    if (sampleInterval == 0 || !isValidVariableList(pVariables, variableCount))
+        __throw(invalidArgumentException);
+    recordSize = calculateRecordSize(pVariables, variableCount);
+    if (g_sampler.bufferSize / recordSize < 2)
+        __throw(bufferOverrunException);
+    for (i = 0 ; i < variableCount ; i++)
+    {
+        readVariable(&pVariables[i]);
+        if (Platform_WasMemoryFaultEncountered())
+            __throw(memFaultException);
+    }
+
+    Sampler_Reset();
+    mri_memcpy(g_sampler.variables, pVariables, variableCount * sizeof(*pVariables));
+    g_sampler.variableCount = variableCount;
+    g_sampler.recordSize = recordSize;
+    g_sampler.recordCapacity = g_sampler.bufferSize / recordSize;
+    g_sampler.readIndex = 0;
+
+    __try
+        Platform_StartSampling(sampleInterval);
+    __catch
+        __rethrow;
+    g_sampler.flags |= SAMPLER_FLAGS_RUNNING;
+}
+
+static int isValidVariableList(const SamplerVariable* pVariables, uint32_t variableCount)
+{
+    uint32_t i;
+
+    if (variableCount == 0 || variableCount > MRI_SAMPLER_MAX_VARIABLES)
+        return 0;
+    for (i = 0 ; i < variableCount ; i++)
+    {
+        uint32_t size = pVariables[i].size;
+
+        if (size != sizeof(uint8_t) && size != sizeof(uint16_t) && size != sizeof(uint32_t))
+            return 0;
+    }
+    return 1;
+}
+
+static uint32_t calculateRecordSize(const SamplerVariable* pVariables, uint32_t variableCount)
+{
+    uint32_t recordSize = SAMPLER_TIMESTAMP_SIZE;
+    uint32_t i;
+
+    for (i = 0 ; i < variableCount ; i++)
+        recordSize += pVariables[i].size;
+    return recordSize;
+}
+
+static uint32_t readVariable(const SamplerVariable* pVariable)
+{
+    switch (pVariable->size)
+    {
+        case sizeof(uint8_t):
+            return Platform_MemRead8(pVariable->address);
+        case sizeof(uint16_t):
+            return Platform_MemRead16(pVariable->address);
+        default:
+            return Platform_MemRead32(pVariable->address);
+    }
+}
+
+
+void Sampler_Stop(void)
+{
+    if (!Sampler_IsRunning())
+        return;
+    Platform_StopSampling();
+    g_sampler.flags &= ~SAMPLER_FLAGS_RUNNING;
+}
+
+
+int Sampler_IsRunning(void)
+{
+    return g_sampler.flags & SAMPLER_FLAGS_RUNNING;
+}
+
+
+/* Called by the platform every sampleInterval cycles while the program is running. MRI's communication channel
+   doesn't support transmitting in the background so the records are instead batched up and sent to gdb all at once
+   when the ring buffer becomes half full. The platform doesn't schedule the next sample until this returns so no
+   samples are lost while the buffer is being drained but there will be a gap in the timestamps. */
+static uint8_t* getRecord(uint32_t index);
+void Sampler_ProcessTick(void)
+{
+    uint8_t* pRecord;
+    uint32_t timestamp = Platform_GetCycleCounter();
+    uint32_t i;
+
+    if (!Sampler_IsRunning())
+        return;
+
+    pRecord = getRecord(g_sampler.readIndex + g_sampler.recordCount);
+    mri_memcpy(pRecord, &timestamp, sizeof(timestamp));
+    pRecord += sizeof(timestamp);
+    for (i = 0 ; i < g_sampler.variableCount ; i++)
+    {
+        const SamplerVariable* pVariable = &g_sampler.variables[i];
+        uint32_t               value = readVariable(pVariable);
+
+        if (Platform_WasMemoryFaultEncountered())
+            value = 0;
+        mri_memcpy(pRecord, &value, pVariable->size);
+        pRecord += pVariable->size;
+    }
+    g_sampler.recordCount++;
+
+    if (g_sampler.recordCount >= g_sampler.recordCapacity / 2)
+        Sampler_Drain();
+}
+
+static uint8_t* getRecord(uint32_t index)
+{
+    return g_sampler.pBuffer + (index % g_sampler.recordCapacity) * g_sampler.recordSize;
+}
+
+
+static void writeRecordToGdbConsole(const uint8_t* pRecord);
+void Sampler_Drain(void)
+{
+    while (g_sampler.recordCount > 0)
+    {
+        writeRecordToGdbConsole(getRecord(g_sampler.readIndex));
+        g_sampler.readIndex = (g_sampler.readIndex + 1) % g_sampler.recordCapacity;
+        g_sampler.recordCount--;
+    }
+}
+
+static void writeFieldAsHex(Buffer* pBuffer, const uint8_t* pField, uint32_t size);
+static void writeRecordToGdbConsole(const uint8_t* pRecord)
+{
+    Buffer   buffer;
+    char     line[SAMPLER_LINE_SIZE];
+    uint32_t i;
+
+    Buffer_Init(&buffer, line, sizeof(line));
+    writeFieldAsHex(&buffer, pRecord, SAMPLER_TIMESTAMP_SIZE);
+    pRecord += SAMPLER_TIMESTAMP_SIZE;
+    for (i = 0 ; i < g_sampler.variableCount ; i++)
+    {
+        uint32_t size = g_sampler.variables[i].size;
+
+        Buffer_WriteChar(&buffer, ' ');
+        writeFieldAsHex(&buffer, pRecord, size);
+        pRecord += size;
+    }
+    Buffer_WriteString(&buffer, "\r\n");
+    Buffer_SetEndOfBuffer(&buffer);
+
+    WriteSizedStringToGdbConsole(Buffer_GetArray(&buffer), Buffer_GetLength(&buffer));
+}
+
+static void writeFieldAsHex(Buffer* pBuffer, const uint8_t* pField, uint32_t size)
+{
+    uint32_t value = 0;
+
+    mri_memcpy(&value, pField, size);
+    while (size-- > 0)
+        Buffer_WriteByteAsHex(pBuffer, (uint8_t)(value >> (8 * size)));
+}
@@ -0,0 +1,48 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Periodically samples a list of variables into a ring buffer which is streamed to the gdb console. */
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+#include <core/mri_int.h>
+
+/* Maximum number of variables which can be sampled at the same time. */
+#define MRI_SAMPLER_MAX_VARIABLES   4
+
+typedef struct
+{
+    uintmri_t address;
+    uint32_t  size;
+} SamplerVariable;
+
+/* Real name of functions are in mri namespace. */
+void          mriSampler_Reset(void);
+__throws void mriSampler_Start(uint32_t sampleInterval, const SamplerVariable* pVariables, uint32_t variableCount);
+void          mriSampler_Stop(void);
+int           mriSampler_IsRunning(void);
+void          mriSampler_ProcessTick(void);
+void          mriSampler_Drain(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Sampler_Reset       mriSampler_Reset
+#define Sampler_Start       mriSampler_Start
+#define Sampler_Stop        mriSampler_Stop
+#define Sampler_IsRunning   mriSampler_IsRunning
+#define Sampler_ProcessTick mriSampler_ProcessTick
+#define Sampler_Drain       mriSampler_Drain
+
+#endif /* SAMPLER_H_ */
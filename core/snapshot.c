@@ -0,0 +1,302 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Snapshots of the registers and selected memory regions which are saved to and restored from the gdb host. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/context.h>
+#include <core/fileio.h>
+#include <core/cmd_file.h>
+#include <core/gdb_console.h>
+#include <core/mri.h>
+#include <core/snapshot.h>
+
+
+#define SNAPSHOT_HEADER_WORDS   4
+
+typedef enum
+{
+    SNAPSHOT_NONE = 0,
+    SNAPSHOT_SAVE,
+    SNAPSHOT_RESTORE
+} SnapshotRequest;
+
+/* The header, region table, and registers are staged here on their way to and from the file. The regions themselves
+   are transferred straight from and to their place in memory. */
+typedef struct
+{
+    uint32_t                 staging[SNAPSHOT_HEADER_WORDS + 2 * MRI_SNAPSHOT_MAX_REGIONS + MRI_SNAPSHOT_MAX_REGISTERS];
+    char                     filename[64];
+    const MriSnapshotRegion* pRegions;
+    uint32_t                 regionCount;
+    SnapshotRequest          request;
+} SnapshotState;
+
+static SnapshotState g_snapshot;
+
+
+void mriSetSnapshotRegions(const MriSnapshotRegion* pRegions, size_t regionCount)
+{
+    if (pRegions == NULL)
+        regionCount = 0;
+    if (regionCount > MRI_SNAPSHOT_MAX_REGIONS)
+        regionCount = MRI_SNAPSHOT_MAX_REGIONS;
+    g_snapshot.pRegions = pRegions;
+    g_snapshot.regionCount = regionCount;
+}
+
+
+/* Like core dumps, snapshots can't be transferred from within a monitor command since gdb only accepts File-I/O
+   requests from the target while it thinks that the target is running. They are instead handled by
+   Snapshot_HandleRequest() once gdb next resumes execution and before the program has had a chance to run. */
+static void requestTransfer(const char* pFilename, SnapshotRequest request);
+void Snapshot_RequestSave(const char* pFilename)
+{
+    requestTransfer(pFilename, SNAPSHOT_SAVE);
+}
+
+void Snapshot_RequestRestore(const char* pFilename)
+{
+    requestTransfer(pFilename, SNAPSHOT_RESTORE);
+}
+
+static void requestTransfer(const char* pFilename, SnapshotRequest request)
+{
+    size_t filenameLength = mri_strlen(pFilename);
+
+    if (g_snapshot.regionCount == 0)
+        __throw(notFoundException);
+    if (filenameLength == 0)
+        __throw(invalidArgumentException);
+    if (filenameLength >= sizeof(g_snapshot.filename))
+        __throw(bufferOverrunException);
+
+    mri_memcpy(g_snapshot.filename, pFilename, filenameLength + 1);
+    g_snapshot.request = request;
+}
+
+
+void Snapshot_Cancel(void)
+{
+    g_snapshot.request = SNAPSHOT_NONE;
+}
+
+
+/* Returns 0 if CTRL+C was pressed in gdb while the snapshot was being transferred. */
+static int saveSnapshot(void);
+static int restoreSnapshot(void);
+int Snapshot_HandleRequest(void)
+{
+    SnapshotRequest request = g_snapshot.request;
+    int             wasCompleted;
+
+    if (request == SNAPSHOT_NONE)
+        return 1;
+    Snapshot_Cancel();
+
+    if (Context_Count(GetHaltedContext()) > MRI_SNAPSHOT_MAX_REGISTERS)
+    {
+        WriteStringToGdbConsole("Too many registers to fit in snapshot.\r\n");
+        return 1;
+    }
+
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = request == SNAPSHOT_SAVE ? saveSnapshot() : restoreSnapshot();
+    SetIssuingFileIOForDebugger(0);
+
+    return wasCompleted;
+}
+
+static int      openFile(uint32_t flags, int* pFileDescriptor);
+static uint32_t buildHeader(void);
+static int      transferFile(uint32_t fileDescriptor, int isRead, uint32_t address, uint32_t size,
+                             int* pWasTransferred);
+static int      transferRegions(uint32_t fileDescriptor, int isRead, int* pWasTransferred);
+static int saveSnapshot(void)
+{
+    int      fileDescriptor;
+    int      wasWritten = 1;
+    uint32_t headerSize;
+
+    if (!openFile(GDB_O_WRONLY | GDB_O_CREAT | GDB_O_TRUNC, &fileDescriptor))
+        return 0;
+    if (fileDescriptor < 0)
+        return 1;
+
+    headerSize = buildHeader();
+    if (!transferFile(fileDescriptor, 0, (uint32_t)(uintptr_t)g_snapshot.staging, headerSize, &wasWritten) ||
+        !transferRegions(fileDescriptor, 0, &wasWritten))
+    {
+        IssueGdbFileCloseRequest(fileDescriptor);
+        return 0;
+    }
+
+    if (!IssueGdbFileCloseRequest(fileDescriptor))
+        return 0;
+    WriteStringToGdbConsole(wasWritten ? "Snapshot saved.\r\n" : "Failed to write snapshot file.\r\n");
+    return 1;
+}
+
+static int openFile(uint32_t flags, int* pFileDescriptor)
+{
+    OpenParameters parameters;
+
+    parameters.filenameAddress = (uint32_t)(uintptr_t)g_snapshot.filename;
+    parameters.filenameLength = mri_strlen(g_snapshot.filename) + 1;
+    parameters.flags = flags;
+    parameters.mode = GDB_S_IRUSR | GDB_S_IWUSR | GDB_S_IRGRP | GDB_S_IROTH;
+    if (!IssueGdbFileOpenRequest(&parameters))
+        return 0;
+
+    *pFileDescriptor = GetSemihostReturnCode();
+    if (*pFileDescriptor < 0)
+        WriteStringToGdbConsole("Failed to open snapshot file.\r\n");
+    return 1;
+}
+
+/* Returns the size of the header, region table, and registers in bytes. */
+static uint32_t buildHeader(void)
+{
+    MriContext* pContext = GetHaltedContext();
+    size_t      registerCount = Context_Count(pContext);
+    uint32_t*   pCurr = g_snapshot.staging;
+    size_t      i;
+
+    *pCurr++ = MRI_SNAPSHOT_MAGIC;
+    *pCurr++ = MRI_SNAPSHOT_VERSION;
+    *pCurr++ = registerCount;
+    *pCurr++ = g_snapshot.regionCount;
+    for (i = 0 ; i < g_snapshot.regionCount ; i++)
+    {
+        *pCurr++ = (uint32_t)g_snapshot.pRegions[i].address;
+        *pCurr++ = g_snapshot.pRegions[i].size;
+    }
+    for (i = 0 ; i < registerCount ; i++)
+        *pCurr++ = Context_Get(pContext, i);
+    return (pCurr - g_snapshot.staging) * sizeof(uint32_t);
+}
+
+/* Once a transfer has failed, the rest of the file is skipped but 1 is still returned so that the file gets closed. */
+static int transferFile(uint32_t fileDescriptor, int isRead, uint32_t address, uint32_t size, int* pWasTransferred)
+{
+    TransferParameters parameters;
+    int                wasCompleted;
+
+    if (!*pWasTransferred)
+        return 1;
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.bufferAddress = address;
+    parameters.bufferSize = size;
+    wasCompleted = isRead ? IssueGdbFileReadRequest(&parameters) : IssueGdbFileWriteRequest(&parameters);
+    if (!wasCompleted)
+        return 0;
+    *pWasTransferred = GetSemihostReturnCode() == (int)size;
+    return 1;
+}
+
+static int transferRegions(uint32_t fileDescriptor, int isRead, int* pWasTransferred)
+{
+    uint32_t i;
+
+    for (i = 0 ; i < g_snapshot.regionCount ; i++)
+    {
+        const MriSnapshotRegion* pRegion = &g_snapshot.pRegions[i];
+
+        if (!transferFile(fileDescriptor, isRead, (uint32_t)pRegion->address, pRegion->size, pWasTransferred))
+            return 0;
+    }
+    return 1;
+}
+
+/* gdb writes the contents of each region straight into place with binary memory writes. The registers are only
+   restored once all of the regions have been read successfully. */
+static int  doesHeaderMatch(void);
+static void restoreRegisters(void);
+static int restoreSnapshot(void)
+{
+    int      fileDescriptor;
+    int      wasRead = 1;
+    int      doesMatch = 0;
+    uint32_t headerSize = (SNAPSHOT_HEADER_WORDS + 2 * g_snapshot.regionCount + Context_Count(GetHaltedContext())) *
+                          sizeof(uint32_t);
+
+    if (!openFile(GDB_O_RDONLY, &fileDescriptor))
+        return 0;
+    if (fileDescriptor < 0)
+        return 1;
+
+    if (!transferFile(fileDescriptor, 1, (uint32_t)(uintptr_t)g_snapshot.staging, headerSize, &wasRead))
+    {
+        IssueGdbFileCloseRequest(fileDescriptor);
+        return 0;
+    }
+    if (wasRead)
+    {
+        doesMatch = doesHeaderMatch();
+        if (doesMatch && !transferRegions(fileDescriptor, 1, &wasRead))
+        {
+            IssueGdbFileCloseRequest(fileDescriptor);
+            return 0;
+        }
+    }
+
+    if (!IssueGdbFileCloseRequest(fileDescriptor))
+        return 0;
+    if (wasRead && !doesMatch)
+    {
+        WriteStringToGdbConsole("Snapshot file doesn't match this program.\r\n");
+        return 1;
+    }
+    if (!wasRead)
+    {
+        WriteStringToGdbConsole("Failed to read snapshot file.\r\n");
+        return 1;
+    }
+    restoreRegisters();
+    WriteStringToGdbConsole("Snapshot restored.\r\n");
+    return 1;
+}
+
+static int doesHeaderMatch(void)
+{
+    const uint32_t* pCurr = g_snapshot.staging;
+    size_t          i;
+
+    if (pCurr[0] != MRI_SNAPSHOT_MAGIC ||
+        pCurr[1] != MRI_SNAPSHOT_VERSION ||
+        pCurr[2] != Context_Count(GetHaltedContext()) ||
+        pCurr[3] != g_snapshot.regionCount)
+    {
+        return 0;
+    }
+    pCurr += SNAPSHOT_HEADER_WORDS;
+    for (i = 0 ; i < g_snapshot.regionCount ; i++, pCurr += 2)
+    {
+        if (pCurr[0] != (uint32_t)g_snapshot.pRegions[i].address || pCurr[1] != g_snapshot.pRegions[i].size)
+            return 0;
+    }
+    return 1;
+}
+
+static void restoreRegisters(void)
+{
+    MriContext*     pContext = GetHaltedContext();
+    size_t          registerCount = Context_Count(pContext);
+    const uint32_t* pRegisters = g_snapshot.staging + SNAPSHOT_HEADER_WORDS + 2 * g_snapshot.regionCount;
+    size_t          i;
+
+    for (i = 0 ; i < registerCount ; i++)
+        Context_Set(pContext, i, pRegisters[i]);
+}
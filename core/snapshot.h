@@ -0,0 +1,49 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Snapshots of the registers and selected memory regions which are saved to and restored from the gdb host. */
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <core/try_catch.h>
+
+/* Maximum number of regions passed to mriSetSnapshotRegions() which will be saved. Any extra regions are ignored. */
+#ifndef MRI_SNAPSHOT_MAX_REGIONS
+#define MRI_SNAPSHOT_MAX_REGIONS    8
+#endif
+
+/* Maximum number of context registers which can be saved. Large enough for Cortex-M devices with a FPU. */
+#ifndef MRI_SNAPSHOT_MAX_REGISTERS
+#define MRI_SNAPSHOT_MAX_REGISTERS  64
+#endif
+
+/* A snapshot file starts with this magic value, the version, the register count and the region count. These are
+   followed by the address and size of each region, the registers, and then the contents of each region in order. All
+   header fields are 32-bit words in the target's byte order. */
+#define MRI_SNAPSHOT_MAGIC      0x5349524D
+#define MRI_SNAPSHOT_VERSION    1
+
+/* Real name of functions are in mri namespace. */
+__throws void mriSnapshot_RequestSave(const char* pFilename);
+__throws void mriSnapshot_RequestRestore(const char* pFilename);
+void          mriSnapshot_Cancel(void);
+int           mriSnapshot_HandleRequest(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Snapshot_RequestSave    mriSnapshot_RequestSave
+#define Snapshot_RequestRestore mriSnapshot_RequestRestore
+#define Snapshot_Cancel         mriSnapshot_Cancel
+#define Snapshot_HandleRequest  mriSnapshot_HandleRequest
+
+#endif /* SNAPSHOT_H_ */
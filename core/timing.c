@@ -0,0 +1,177 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Cycle count statistics for a region of code bracketed by a pair of auto-resuming hardware breakpoints. */
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/timing.h>
+
+
+typedef struct
+{
+    TimingStats stats;
+    uintmri_t   startAddress;
+    uintmri_t   endAddress;
+    uint32_t    startCycles;
+    uint32_t    flags;
+} TimingState;
+
+static TimingState g_timing;
+
+/* TimingState::flags bit definitions. */
+#define TIMING_FLAGS_RUNNING        (1 << 0)
+#define TIMING_FLAGS_IN_REGION      (1 << 1)
+
+
+void Timing_Reset(void)
+{
+    Timing_Stop();
+    mri_memset(&g_timing, 0, sizeof(g_timing));
+}
+
+
+static void clearStats(void);
+void Timing_Start(uintmri_t startAddress, uintmri_t endAddress)
+{
+    int exceptionCode;
+
+    startAddress &= ~1;
+    endAddress &= ~1;
+    if (startAddress == endAddress)
+        __throw(invalidArgumentException);
+
+    Timing_Stop();
+    __try
+    {
+        __throwing_func( Platform_EnableCycleCounter() );
+        __throwing_func( Platform_SetHardwareBreakpoint(startAddress) );
+    }
+    __catch
+        __rethrow;
+    __try
+        Platform_SetHardwareBreakpoint(endAddress);
+    __catch
+    {
+        exceptionCode = getExceptionCode();
+        Platform_ClearHardwareBreakpoint(startAddress);
+        clearExceptionCode();
+        __throw(exceptionCode);
+    }
+
+    clearStats();
+    g_timing.startAddress = startAddress;
+    g_timing.endAddress = endAddress;
+    g_timing.flags = TIMING_FLAGS_RUNNING;
+}
+
+static void clearStats(void)
+{
+    mri_memset(&g_timing.stats, 0, sizeof(g_timing.stats));
+    g_timing.stats.minimum = ~0U;
+}
+
+
+static void clearBreakpoint(uintmri_t address);
+void Timing_Stop(void)
+{
+    if (!Timing_IsRunning())
+        return;
+    clearBreakpoint(g_timing.startAddress);
+    clearBreakpoint(g_timing.endAddress);
+    g_timing.flags = 0;
+}
+
+static void clearBreakpoint(uintmri_t address)
+{
+    __try
+        Platform_ClearHardwareBreakpoint(address);
+    __catch
+        clearExceptionCode();
+}
+
+
+int Timing_IsRunning(void)
+{
+    return g_timing.flags & TIMING_FLAGS_RUNNING;
+}
+
+
+const TimingStats* Timing_GetStats(void)
+{
+    return &g_timing.stats;
+}
+
+
+uint32_t Timing_GetMeanCycles(void)
+{
+    if (g_timing.stats.count == 0)
+        return 0;
+    return (uint32_t)(g_timing.stats.total / g_timing.stats.count);
+}
+
+
+/* Both breakpoints resume execution as soon as they have been handled. The cycle count is read as early as possible
+   when entering at the end of the region and as late as possible when leaving from the start of the region. The time
+   spent stepping over the start breakpoint and entering the debug monitor at the end breakpoint is still included in
+   each sample but it is close to constant so it shifts the results without widening their spread. */
+static void recordRegionCycles(uint32_t cycles);
+int Timing_ProcessBreakpointHit(void)
+{
+    uint32_t  endCycles = Platform_GetCycleCounter();
+    uintmri_t pc = Platform_GetProgramCounter() & ~1;
+
+    if (!Timing_IsRunning() || Platform_GetTrapReason().type != MRI_PLATFORM_TRAP_TYPE_HWBREAK)
+        return 0;
+
+    if (pc == g_timing.endAddress)
+    {
+        if (g_timing.flags & TIMING_FLAGS_IN_REGION)
+            recordRegionCycles(endCycles - g_timing.startCycles);
+        g_timing.flags &= ~TIMING_FLAGS_IN_REGION;
+        StepOverHardwareBreakpoint(pc);
+        return 1;
+    }
+    if (pc == g_timing.startAddress)
+    {
+        StepOverHardwareBreakpoint(pc);
+        g_timing.flags |= TIMING_FLAGS_IN_REGION;
+        g_timing.startCycles = Platform_GetCycleCounter();
+        return 1;
+    }
+    return 0;
+}
+
+static uint32_t calculateBucket(uint32_t cycles);
+static void recordRegionCycles(uint32_t cycles)
+{
+    TimingStats* pStats = &g_timing.stats;
+
+    pStats->count++;
+    pStats->total += cycles;
+    if (cycles < pStats->minimum)
+        pStats->minimum = cycles;
+    if (cycles > pStats->maximum)
+        pStats->maximum = cycles;
+    pStats->buckets[calculateBucket(cycles)]++;
+}
+
+static uint32_t calculateBucket(uint32_t cycles)
+{
+    uint32_t bucket = 0;
+
+    while ((cycles >>= 1) != 0 && bucket < MRI_TIMING_BUCKET_COUNT - 1)
+        bucket++;
+    return bucket;
+}
@@ -0,0 +1,54 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Cycle count statistics for a region of code bracketed by a pair of auto-resuming hardware breakpoints. */
+#ifndef TIMING_H_
+#define TIMING_H_
+
+#include <stdint.h>
+#include <core/try_catch.h>
+#include <core/mri_int.h>
+
+/* Bucket i of the histogram counts regions which took at least 2^i cycles. The last bucket also counts everything
+   longer than that. */
+#define MRI_TIMING_BUCKET_COUNT 16
+
+typedef struct
+{
+    uint64_t total;
+    uint32_t count;
+    uint32_t minimum;
+    uint32_t maximum;
+    uint32_t buckets[MRI_TIMING_BUCKET_COUNT];
+} TimingStats;
+
+/* Real name of functions are in mri namespace. */
+void               mriTiming_Reset(void);
+__throws void      mriTiming_Start(uintmri_t startAddress, uintmri_t endAddress);
+void               mriTiming_Stop(void);
+int                mriTiming_IsRunning(void);
+const TimingStats* mriTiming_GetStats(void);
+uint32_t           mriTiming_GetMeanCycles(void);
+int                mriTiming_ProcessBreakpointHit(void);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define Timing_Reset                mriTiming_Reset
+#define Timing_Start                mriTiming_Start
+#define Timing_Stop                 mriTiming_Stop
+#define Timing_IsRunning            mriTiming_IsRunning
+#define Timing_GetStats             mriTiming_GetStats
+#define Timing_GetMeanCycles        mriTiming_GetMeanCycles
+#define Timing_ProcessBreakpointHit mriTiming_ProcessBreakpointHit
+
+#endif /* TIMING_H_ */
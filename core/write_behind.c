@@ -0,0 +1,227 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Write-behind buffering of semihosted file writes so that many small writes cost a single gdb round trip. */
+#include <errno.h>
+#include <core/libc.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/cmd_file.h>
+#include <core/write_behind.h>
+
+
+/* A file only holds on to its entry while it has buffered data or a failed write that hasn't been reported yet. */
+typedef struct
+{
+    uint8_t  buffer[MRI_WRITE_BEHIND_BUFFER_SIZE];
+    uint32_t fileDescriptor;
+    uint32_t used;
+    int      errNo;
+} WriteBehindFile;
+
+static WriteBehindFile g_files[MRI_WRITE_BEHIND_FILE_COUNT];
+
+/* stdin, stdout, and stderr are never buffered so that console output and errors show up as soon as written. */
+#define LAST_STANDARD_FILE_NO   2
+
+
+void WriteBehind_Reset(void)
+{
+    mri_memset(g_files, 0, sizeof(g_files));
+}
+
+
+/* Handles the program's semihost write request. The data is normally just copied into the file's buffer and the call
+   completes without any communication with gdb. Returns 0 if CTRL+C was pressed in gdb while earlier data was being
+   flushed, leaving the PC on the semihost call so that it is retried when execution resumes. */
+static WriteBehindFile* findFile(uint32_t fileDescriptor);
+static WriteBehindFile* findFreeFile(uint32_t fileDescriptor);
+static int              writeDirectly(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize);
+static int              flushFile(WriteBehindFile* pFile);
+static int              reportPendingError(WriteBehindFile* pFile);
+static int              completeCall(int returnCode, int errNo);
+int WriteBehind_Write(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    WriteBehindFile* pFile;
+
+    if (fileDescriptor <= LAST_STANDARD_FILE_NO || bufferSize <= 0)
+        return writeDirectly(fileDescriptor, bufferAddress, bufferSize);
+    pFile = findFile(fileDescriptor);
+    if (pFile == NULL)
+        pFile = findFreeFile(fileDescriptor);
+    if (pFile == NULL)
+        return writeDirectly(fileDescriptor, bufferAddress, bufferSize);
+
+    if (pFile->used + (uint32_t)bufferSize > sizeof(pFile->buffer) && !flushFile(pFile))
+        return 0;
+    if (pFile->errNo)
+        return reportPendingError(pFile);
+    if ((uint32_t)bufferSize > sizeof(pFile->buffer))
+        return writeDirectly(fileDescriptor, bufferAddress, bufferSize);
+    /* Let gdb fail the write with the appropriate error if the program passed in an invalid buffer. */
+    if (Platform_ReadMemory(pFile->buffer + pFile->used, bufferAddress, bufferSize) != (uintmri_t)bufferSize)
+        return writeDirectly(fileDescriptor, bufferAddress, bufferSize);
+
+    pFile->used += bufferSize;
+    return completeCall(bufferSize, 0);
+}
+
+static WriteBehindFile* findFile(uint32_t fileDescriptor)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(g_files)/sizeof(g_files[0]) ; i++)
+    {
+        WriteBehindFile* pFile = &g_files[i];
+
+        if ((pFile->used || pFile->errNo) && pFile->fileDescriptor == fileDescriptor)
+            return pFile;
+    }
+    return NULL;
+}
+
+static WriteBehindFile* findFreeFile(uint32_t fileDescriptor)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(g_files)/sizeof(g_files[0]) ; i++)
+    {
+        WriteBehindFile* pFile = &g_files[i];
+
+        if (pFile->used == 0 && pFile->errNo == 0)
+        {
+            pFile->fileDescriptor = fileDescriptor;
+            return pFile;
+        }
+    }
+    return NULL;
+}
+
+static int writeDirectly(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize)
+{
+    TransferParameters parameters;
+
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.bufferAddress = (uint32_t)bufferAddress;
+    parameters.bufferSize = bufferSize;
+    return IssueGdbFileWriteRequest(&parameters);
+}
+
+/* Writes the buffered data on behalf of the debugger so that the PC is left alone for the program's current semihost
+   call to be completed afterwards. If gdb can't write all of the data, it is dropped and the error is held until it
+   can be reported by the next write, fsync, or close on that file. */
+static int flushFile(WriteBehindFile* pFile)
+{
+    TransferParameters parameters;
+    int                wasCompleted;
+
+    if (pFile->used == 0)
+        return 1;
+
+    parameters.fileDescriptor = pFile->fileDescriptor;
+    parameters.bufferAddress = (uint32_t)(uintptr_t)pFile->buffer;
+    parameters.bufferSize = pFile->used;
+    SetIssuingFileIOForDebugger(1);
+    wasCompleted = IssueGdbFileWriteRequest(&parameters);
+    SetIssuingFileIOForDebugger(0);
+    if (!wasCompleted)
+        return 0;
+
+    if (GetSemihostReturnCode() != (int)pFile->used)
+        pFile->errNo = GetSemihostErrno() ? GetSemihostErrno() : EIO;
+    pFile->used = 0;
+    return 1;
+}
+
+static int reportPendingError(WriteBehindFile* pFile)
+{
+    int errNo = pFile->errNo;
+
+    pFile->errNo = 0;
+    return completeCall(-1, errNo);
+}
+
+static int completeCall(int returnCode, int errNo)
+{
+    SetSemihostReturnValues(returnCode, errNo);
+    FlagSemihostCallAsHandled();
+    return 1;
+}
+
+
+/* Called before semihost requests like read, lseek, and fstat which need the file on the gdb host to be up to date.
+   Returns 0 if CTRL+C was pressed in gdb before the buffered data could be written. */
+int WriteBehind_Flush(uint32_t fileDescriptor)
+{
+    WriteBehindFile* pFile = findFile(fileDescriptor);
+
+    if (pFile == NULL)
+        return 1;
+    return flushFile(pFile);
+}
+
+
+/* Called before reporting a stop to gdb so that files on the host are up to date while the program is halted. */
+int WriteBehind_FlushAll(void)
+{
+    size_t i;
+
+    for (i = 0 ; i < sizeof(g_files)/sizeof(g_files[0]) ; i++)
+    {
+        if (!flushFile(&g_files[i]))
+            return 0;
+    }
+    return 1;
+}
+
+
+/* Handles the program's semihost fsync request by flushing the file and reporting any earlier write failure. */
+int WriteBehind_FSync(uint32_t fileDescriptor)
+{
+    WriteBehindFile* pFile = findFile(fileDescriptor);
+
+    if (pFile == NULL)
+        return completeCall(0, 0);
+    if (!flushFile(pFile))
+        return 0;
+    if (pFile->errNo)
+        return reportPendingError(pFile);
+    return completeCall(0, 0);
+}
+
+
+/* Handles the program's semihost close request. The file is flushed first and a failure to write that data is
+   reported by close, like it would be for a file on a POSIX system with write-behind caching. */
+int WriteBehind_Close(uint32_t fileDescriptor)
+{
+    WriteBehindFile* pFile = findFile(fileDescriptor);
+    int              errNo = 0;
+
+    if (pFile && !flushFile(pFile))
+        return 0;
+    if (!IssueGdbFileCloseRequest(fileDescriptor))
+        return 0;
+
+    if (pFile)
+    {
+        errNo = pFile->errNo;
+        pFile->errNo = 0;
+    }
+    if (errNo && GetSemihostReturnCode() == 0)
+    {
+        SetSemihostReturnValues(-1, errNo);
+        Platform_SetSemihostCallReturnAndErrnoValues(-1, errNo);
+    }
+    return 1;
+}
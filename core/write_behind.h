@@ -0,0 +1,49 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Write-behind buffering of semihosted file writes so that many small writes cost a single gdb round trip. */
+#ifndef WRITE_BEHIND_H_
+#define WRITE_BEHIND_H_
+
+#include <stdint.h>
+#include <core/mri_int.h>
+
+/* Number of bytes that can be buffered for each file before they must be sent to gdb. Writes which are larger than
+   this bypass the buffer. */
+#ifndef MRI_WRITE_BEHIND_BUFFER_SIZE
+    #define MRI_WRITE_BEHIND_BUFFER_SIZE    128
+#endif
+
+/* Number of files which can have buffered writes outstanding at once. Writes to other files go straight to gdb. */
+#ifndef MRI_WRITE_BEHIND_FILE_COUNT
+    #define MRI_WRITE_BEHIND_FILE_COUNT     2
+#endif
+
+/* Real name of functions are in mri namespace. */
+void mriWriteBehind_Reset(void);
+int  mriWriteBehind_Write(uint32_t fileDescriptor, uintmri_t bufferAddress, int32_t bufferSize);
+int  mriWriteBehind_Flush(uint32_t fileDescriptor);
+int  mriWriteBehind_FlushAll(void);
+int  mriWriteBehind_FSync(uint32_t fileDescriptor);
+int  mriWriteBehind_Close(uint32_t fileDescriptor);
+
+/* Macroes which allow code to drop the mri namespace prefix. */
+#define WriteBehind_Reset       mriWriteBehind_Reset
+#define WriteBehind_Write       mriWriteBehind_Write
+#define WriteBehind_Flush       mriWriteBehind_Flush
+#define WriteBehind_FlushAll    mriWriteBehind_FlushAll
+#define WriteBehind_FSync       mriWriteBehind_FSync
+#define WriteBehind_Close       mriWriteBehind_Close
+
+#endif /* WRITE_BEHIND_H_ */
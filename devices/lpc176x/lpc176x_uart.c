@@ -490,3 +490,30 @@ static uint32_t targetUartCanTransmit(void)
 
     return mriLpc176xState.pCurrentUart->pUartRegisters->LSR & transmitterHoldRegisterEmptyBit;
 }
+
+
+int Platform_CommIsTransmitReady(void)
+{
+    return targetUartCanTransmit() != 0;
+}
+
+
+void Platform_CommSetTransmitInterrupt(int isEnabled)
+{
+    static const uint32_t baudDivisorLatchBit = (1 << 7);
+    static const uint32_t enableTransmitHoldingRegisterEmptyInterrupt = (1 << 1);
+    IRQn_Type             currentUartIRQ = (IRQn_Type)((int)UART0_IRQn + commUartIndex());
+    uint32_t              originalLCR;
+
+    originalLCR = mriLpc176xState.pCurrentUart->pUartRegisters->LCR;
+    mriLpc176xState.pCurrentUart->pUartRegisters->LCR &= ~baudDivisorLatchBit;
+    if (isEnabled)
+        mriLpc176xState.pCurrentUart->pUartRegisters->IER |= enableTransmitHoldingRegisterEmptyInterrupt;
+    else
+        mriLpc176xState.pCurrentUart->pUartRegisters->IER &= ~enableTransmitHoldingRegisterEmptyInterrupt;
+    mriLpc176xState.pCurrentUart->pUartRegisters->LCR = originalLCR;
+
+    /* The THRE interrupt isn't raised when it is enabled with the holding register already empty so pend it here. */
+    if (isEnabled && targetUartCanTransmit())
+        NVIC_SetPendingIRQ(currentUartIRQ);
+}
@@ -710,3 +710,30 @@ static uint32_t targetUartCanTransmit(void)
 
     return mriLpc43xxState.pCurrentUart->pUartRegisters->LSR & transmitterHoldRegisterEmptyBit;
 }
+
+
+int Platform_CommIsTransmitReady(void)
+{
+    return targetUartCanTransmit() != 0;
+}
+
+
+void Platform_CommSetTransmitInterrupt(int isEnabled)
+{
+    static const uint32_t baudDivisorLatchBit = (1 << 7);
+    static const uint32_t enableTransmitHoldingRegisterEmptyInterrupt = (1 << 1);
+    IRQn_Type             currentUartIRQ = (IRQn_Type)((int)USART0_IRQn + commUartIndex());
+    uint32_t              originalLCR;
+
+    originalLCR = mriLpc43xxState.pCurrentUart->pUartRegisters->LCR;
+    mriLpc43xxState.pCurrentUart->pUartRegisters->LCR &= ~baudDivisorLatchBit;
+    if (isEnabled)
+        mriLpc43xxState.pCurrentUart->pUartRegisters->IER |= enableTransmitHoldingRegisterEmptyInterrupt;
+    else
+        mriLpc43xxState.pCurrentUart->pUartRegisters->IER &= ~enableTransmitHoldingRegisterEmptyInterrupt;
+    mriLpc43xxState.pCurrentUart->pUartRegisters->LCR = originalLCR;
+
+    /* The THRE interrupt isn't raised when it is enabled with the holding register already empty so pend it here. */
+    if (isEnabled && targetUartCanTransmit())
+        NVIC_SetPendingIRQ(currentUartIRQ);
+}
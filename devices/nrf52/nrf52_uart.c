@@ -191,6 +191,21 @@ static uint32_t hasTransmitCompleted(void)
 }
 
 
+int Platform_CommIsTransmitReady(void)
+{
+    /* Platform_CommSendChar() always waits for byte to be sent before returning so it is always ready for another. */
+    return 1;
+}
+
+
+void Platform_CommSetTransmitInterrupt(int isEnabled)
+{
+    /* Platform_CommSendChar() clears the TXDRDY event itself so just pend the UART interrupt to have it send more. */
+    if (isEnabled)
+        NVIC_SetPendingIRQ(UARTE0_UART0_IRQn);
+}
+
+
 /* Implementation of nRF52xxx UART0 ISR to be intercepted and sent to mri instead. */
 void __attribute__((naked)) UARTE0_UART0_IRQHandler(void)
 {
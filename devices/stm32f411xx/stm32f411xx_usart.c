@@ -492,6 +492,20 @@ void Platform_CommSendChar(int Character)
     uart->DR = (Character & 0x1FF);
 }
 
+int Platform_CommIsTransmitReady(void)
+{
+    return (mriStm32f411xxState.pCurrentUart->pUartRegisters->SR & USART_SR_TXE) != 0;
+}
+
+void Platform_CommSetTransmitInterrupt(int isEnabled)
+{
+    /* TXE is level triggered so the interrupt fires right away if the transmit data register is already empty. */
+    if (isEnabled)
+        mriStm32f411xxState.pCurrentUart->pUartRegisters->CR1 |= USART_CR1_TXEIE;
+    else
+        mriStm32f411xxState.pCurrentUart->pUartRegisters->CR1 &= ~USART_CR1_TXEIE;
+}
+
 static void configureNVICForUartInterrupt(uint32_t index)
 {
     IRQn_Type irq_num_base = USART1_IRQn;
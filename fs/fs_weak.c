@@ -0,0 +1,48 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Default filesystem hooks for programs which don't expose a filesystem to gdb's vFile packets. */
+#include <core/platforms.h>
+#include <core/fileio.h>
+
+
+__attribute__((weak)) int Platform_FsOpen(const char* pFilename, uint32_t flags, uint32_t mode)
+{
+    return -GDB_ENODEV;
+}
+
+__attribute__((weak)) int Platform_FsClose(int fileDescriptor)
+{
+    return -GDB_EBADF;
+}
+
+__attribute__((weak)) int32_t Platform_FsPRead(int fileDescriptor, void* pBuffer, uint32_t count, uint32_t offset)
+{
+    return -GDB_EBADF;
+}
+
+__attribute__((weak)) int32_t Platform_FsPWrite(int fileDescriptor, const void* pBuffer, uint32_t count, uint32_t offset)
+{
+    return -GDB_EBADF;
+}
+
+__attribute__((weak)) int Platform_FsFStat(int fileDescriptor, PlatformFileStat* pStat)
+{
+    return -GDB_EBADF;
+}
+
+__attribute__((weak)) int Platform_FsUnlink(const char* pFilename)
+{
+    return -GDB_ENODEV;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Copyright 2024 Adam Green (https://github.com/adamgreen/)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Formats a binary log written by "monitor log start" using the format strings from the program's ELF file.
+
+Usage: mri_log_decode.py program.elf mri.log
+"""
+import re
+import struct
+import sys
+
+LOG_SECTION = b".mri_log"
+CONVERSION = re.compile(r"%(?:%|([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|l|z|t|j)?([diouxXcp]))")
+
+
+def read_log_section(elf):
+    """Returns the address and contents of the .mri_log section in a 32-bit little endian ELF file."""
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("not a 32-bit little endian ELF file")
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    sections = [struct.unpack_from("<IIIIII", elf, shoff + i * shentsize) for i in range(shnum)]
+    names_offset = sections[shstrndx][4]
+    for name, _, _, addr, offset, size in sections:
+        end = elf.index(b"\0", names_offset + name)
+        if elf[names_offset + name:end] == LOG_SECTION:
+            return addr, elf[offset:offset + size]
+    raise ValueError("no .mri_log section found")
+
+
+def format_record(template, args):
+    args = iter(args)
+
+    def convert(match):
+        if match.group(0) == "%%":
+            return "%"
+        flags, kind = match.group(1), match.group(2)
+        value = next(args, 0)
+        if kind in "di":
+            value -= (value & 0x80000000) << 1
+        elif kind == "u":
+            kind = "d"
+        elif kind == "p":
+            flags, kind = "#" + flags, "x"
+        return ("%" + flags + kind) % value
+
+    return CONVERSION.sub(convert, template)
+
+
+def decode(elf, log):
+    base, strings = read_log_section(elf)
+    offset = 0
+    while offset + 5 <= len(log):
+        address, count = struct.unpack_from("<IB", log, offset)
+        offset += 5
+        if offset + 4 * count > len(log):
+            break
+        args = struct.unpack_from("<%dI" % count, log, offset)
+        offset += 4 * count
+        start = address - base
+        if start < 0 or start >= len(strings):
+            yield "<unknown format 0x%08x>" % address + "".join(" 0x%08x" % arg for arg in args)
+            continue
+        template = strings[start:strings.index(b"\0", start)].decode("utf-8", "replace")
+        yield format_record(template, args)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 1
+    with open(argv[1], "rb") as elf_file, open(argv[2], "rb") as log_file:
+        for line in decode(elf_file.read(), log_file.read()):
+            print(line.rstrip("\r\n"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
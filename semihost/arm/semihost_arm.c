@@ -16,10 +16,17 @@
 #include <stdint.h>
 #include <core/libc.h>
 #include <core/core.h>
+#include <core/platforms.h>
 #include <core/semihost.h>
+#include <core/signal.h>
+#include <core/try_catch.h>
 #include <core/cmd_file.h>
 #include <core/fileio.h>
 #include <core/mbedsys.h>
+#include <core/write_behind.h>
+#include <core/read_ahead.h>
+#include <core/async_console.h>
+#include <core/cycle_clock.h>
 #include "semihost_arm.h"
 
 
@@ -37,17 +44,33 @@ static int      handleArmSemihostRemoveRequest(PlatformSemihostParameters* pSemi
 static int      handleArmSemihostRenameRequest(PlatformSemihostParameters* pSemihostParameters);
 static int      handleArmSemihostErrorNoRequest(PlatformSemihostParameters* pSemihostParameters);
 static int      handleMbedSemihostUidRequest(PlatformSemihostParameters* pParameters);
+static int      handleArmSemihostWriteCharRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      handleArmSemihostWriteStringRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      handleArmSemihostClockRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      handleArmSemihostTimeRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      handleArmSemihostElapsedRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      handleArmSemihostTickFrequencyRequest(PlatformSemihostParameters* pSemihostParameters);
+static int      isConsoleFlushNeeded(uint32_t opCode);
+static int      flushConsoleLine(void);
 int Semihost_HandleArmSemihostRequest(PlatformSemihostParameters* pParameters)
 {
     uint32_t opCode;
 
     opCode = pParameters->parameter1;
+    if (isConsoleFlushNeeded(opCode) && !flushConsoleLine())
+    {
+        return 0;
+    }
     switch (opCode)
     {
     case MRI_ARM_SEMIHOST_OPEN:
         return handleArmSemihostOpenRequest(pParameters);
     case MRI_ARM_SEMIHOST_CLOSE:
         return handleArmSemihostCloseRequest(pParameters);
+    case MRI_ARM_SEMIHOST_WRITEC:
+        return handleArmSemihostWriteCharRequest(pParameters);
+    case MRI_ARM_SEMIHOST_WRITE0:
+        return handleArmSemihostWriteStringRequest(pParameters);
     case MRI_ARM_SEMIHOST_WRITE:
         return handleArmSemihostWriteRequest(pParameters);
     case MRI_ARM_SEMIHOST_READ:
@@ -62,8 +85,16 @@ int Semihost_HandleArmSemihostRequest(PlatformSemihostParameters* pParameters)
         return handleArmSemihostRemoveRequest(pParameters);
     case MRI_ARM_SEMIHOST_RENAME:
         return handleArmSemihostRenameRequest(pParameters);
+    case MRI_ARM_SEMIHOST_CLOCK:
+        return handleArmSemihostClockRequest(pParameters);
+    case MRI_ARM_SEMIHOST_TIME:
+        return handleArmSemihostTimeRequest(pParameters);
     case MRI_ARM_SEMIHOST_ERR_NO:
         return handleArmSemihostErrorNoRequest(pParameters);
+    case MRI_ARM_SEMIHOST_ELAPSED:
+        return handleArmSemihostElapsedRequest(pParameters);
+    case MRI_ARM_SEMIHOST_TICKFREQ:
+        return handleArmSemihostTickFrequencyRequest(pParameters);
     case MRI_ARM_SEMIHOST_UUID:
          return handleMbedSemihostUidRequest(pParameters);
     default:
@@ -158,7 +189,12 @@ static int handleArmSemihostReadRequest(PlatformSemihostParameters* pSemihostPar
         return 0;
     }
 
-    int returnValue = IssueGdbFileReadRequest(&parameters);
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+    {
+        return 0;
+    }
+
+    int returnValue = ReadAhead_Read(parameters.fileDescriptor, parameters.bufferAddress, parameters.bufferSize);
     if (returnValue)
     {
         convertBytesTransferredToBytesNotTransferred(parameters.bufferSize);
@@ -187,7 +223,8 @@ static int handleArmSemihostCloseRequest(PlatformSemihostParameters* pSemihostPa
         return 0;
     }
 
-    return IssueGdbFileCloseRequest(parameters.fileDescriptor);
+    ReadAhead_Invalidate(parameters.fileDescriptor);
+    return WriteBehind_Close(parameters.fileDescriptor);
 }
 
 static int handleArmSemihostSeekRequest(PlatformSemihostParameters* pSemihostParameters)
@@ -207,7 +244,11 @@ static int handleArmSemihostSeekRequest(PlatformSemihostParameters* pSemihostPar
     parameters.fileDescriptor = armParameters.fileDescriptor;
     parameters.offset = armParameters.offsetFromStart;
     parameters.whence = GDB_SEEK_SET;
-    return IssueGdbFileSeekRequest(&parameters);
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+    {
+        return 0;
+    }
+    return ReadAhead_Seek(&parameters);
 }
 
 static int handleArmSemihostFileLengthRequest(PlatformSemihostParameters* pSemihostParameters)
@@ -222,6 +263,11 @@ static int handleArmSemihostFileLengthRequest(PlatformSemihostParameters* pSemih
         return 0;
     }
 
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+    {
+        return 0;
+    }
+
     GdbStats gdbFileStats;
     int returnValue = IssueGdbFileFStatRequest(parameters.fileDescriptor, (uint32_t)&gdbFileStats);
     if (returnValue && GetSemihostReturnCode() == 0)
@@ -299,4 +345,153 @@ static int handleMbedSemihostUidRequest(PlatformSemihostParameters* pParameters)
     Platform_SetSemihostCallReturnAndErrnoValues(0, 0);
 
     return 1;
- }
\ No newline at end of file
+ }
+
+/* Characters written with SYS_WRITEC and SYS_WRITE0 are collected into lines by the async console rather than each
+   being sent to gdb in its own packet. Any partial line is sent before other semihost operations are handled so that
+   output stays in order with reads from stdin and file I/O. */
+static int completeConsoleWrite(void);
+static int handleArmSemihostWriteCharRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    char character;
+
+    if (Platform_ReadMemory(&character, pSemihostParameters->parameter2, sizeof(character)) != sizeof(character))
+    {
+        return 0;
+    }
+    AsyncConsole_WriteBuffered(&character, sizeof(character));
+    return completeConsoleWrite();
+}
+
+static int handleArmSemihostWriteStringRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    uintmri_t address = pSemihostParameters->parameter2;
+    char      buffer[32];
+    uint32_t  bytesRead;
+    uint32_t  length;
+
+    do
+    {
+        bytesRead = Platform_ReadMemory(buffer, address, sizeof(buffer));
+        for (length = 0 ; length < bytesRead && buffer[length] != '\0' ; length++)
+        {
+        }
+        AsyncConsole_WriteBuffered(buffer, length);
+        address += bytesRead;
+    } while (length == sizeof(buffer) && !WasControlCEncountered());
+
+    return completeConsoleWrite();
+}
+
+static int completeConsoleWrite(void)
+{
+    Platform_AdvanceProgramCounterToNextInstruction();
+    Platform_SetSemihostCallReturnAndErrnoValues(0, 0);
+    if (WasControlCEncountered())
+    {
+        SetSignalValue(SIGINT);
+        return 0;
+    }
+    return 1;
+}
+
+static int isConsoleFlushNeeded(uint32_t opCode)
+{
+    /* Console output is only flushed ahead of calls which talk to gdb. The timing calls are answered locally and
+       flushing there would send a packet in the middle of the region being timed. */
+    switch (opCode)
+    {
+    case MRI_ARM_SEMIHOST_WRITEC:
+    case MRI_ARM_SEMIHOST_WRITE0:
+    case MRI_ARM_SEMIHOST_CLOCK:
+    case MRI_ARM_SEMIHOST_ELAPSED:
+    case MRI_ARM_SEMIHOST_TICKFREQ:
+        return 0;
+    case MRI_ARM_SEMIHOST_TIME:
+        return !CycleClock_IsSyncedWithGdb();
+    default:
+        return 1;
+    }
+}
+
+static int flushConsoleLine(void)
+{
+    AsyncConsole_FlushLine();
+    if (WasControlCEncountered())
+    {
+        SetSignalValue(SIGINT);
+        return 0;
+    }
+    return 1;
+}
+
+
+/* The timing calls are answered from the cycle counter without any communication with gdb, except for the first
+   SYS_TIME call which fetches the host's time of day. They return -1 on devices without a cycle counter. */
+static int completeLocalCall(uint32_t returnValue);
+static int handleArmSemihostClockRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    uint32_t centiseconds;
+
+    __try
+        centiseconds = CycleClock_GetCentiseconds();
+    __catch
+    {
+        clearExceptionCode();
+        centiseconds = (uint32_t)-1;
+    }
+    return completeLocalCall(centiseconds);
+}
+
+static int handleArmSemihostTimeRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    uint32_t seconds;
+
+    if (!CycleClock_GetEpochSeconds(&seconds))
+    {
+        return 0;
+    }
+    return completeLocalCall(seconds);
+}
+
+static int handleArmSemihostElapsedRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    uintmri_t address = pSemihostParameters->parameter2;
+    uint64_t  cycles;
+
+    __try
+        cycles = CycleClock_GetCycles();
+    __catch
+    {
+        clearExceptionCode();
+        return completeLocalCall((uint32_t)-1);
+    }
+
+    Platform_MemWrite32(address, (uint32_t)cycles);
+    Platform_MemWrite32(address + sizeof(uint32_t), (uint32_t)(cycles >> 32));
+    if (Platform_WasMemoryFaultEncountered())
+    {
+        return completeLocalCall((uint32_t)-1);
+    }
+    return completeLocalCall(0);
+}
+
+static int handleArmSemihostTickFrequencyRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    __try
+        CycleClock_GetCycles();
+    __catch
+    {
+        clearExceptionCode();
+        return completeLocalCall((uint32_t)-1);
+    }
+    return completeLocalCall(Platform_GetCpuClockFrequency());
+}
+
+static int completeLocalCall(uint32_t returnValue)
+{
+    Platform_AdvanceProgramCounterToNextInstruction();
+    Platform_SetSemihostCallReturnAndErrnoValues(returnValue, 0);
+
+    return 1;
+}
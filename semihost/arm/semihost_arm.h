@@ -21,6 +21,8 @@
 
 #define MRI_ARM_SEMIHOST_OPEN           1
 #define MRI_ARM_SEMIHOST_CLOSE          2
+#define MRI_ARM_SEMIHOST_WRITEC         3
+#define MRI_ARM_SEMIHOST_WRITE0         4
 #define MRI_ARM_SEMIHOST_WRITE          5
 #define MRI_ARM_SEMIHOST_READ           6
 #define MRI_ARM_SEMIHOST_IS_TTY         9
@@ -28,7 +30,11 @@
 #define MRI_ARM_SEMIHOST_FILE_LENGTH    12
 #define MRI_ARM_SEMIHOST_REMOVE         14
 #define MRI_ARM_SEMIHOST_RENAME         15
+#define MRI_ARM_SEMIHOST_CLOCK          16
+#define MRI_ARM_SEMIHOST_TIME           17
 #define MRI_ARM_SEMIHOST_ERR_NO         19
+#define MRI_ARM_SEMIHOST_ELAPSED        48
+#define MRI_ARM_SEMIHOST_TICKFREQ       49
 #define MRI_ARM_SEMIHOST_UUID           257
 
 #endif /* MRI_SEMIHOST_ARM_H_ */
@@ -17,8 +17,12 @@
 #ifndef MRI_NEWLIB_STUBS_H_
 #define MRI_NEWLIB_STUBS_H_
 
-#define MRI_NEWLIB_SEMIHOST_MIN         0xf5
+#define MRI_NEWLIB_SEMIHOST_MIN         0xf1
 
+#define MRI_NEWLIB_SEMIHOST_HOST_READ   0xf1
+#define MRI_NEWLIB_SEMIHOST_HOST_WRITE  0xf2
+#define MRI_NEWLIB_SEMIHOST_FSYNC       0xf3
+#define MRI_NEWLIB_SEMIHOST_LOG_FLUSH   0xf4
 #define MRI_NEWLIB_SEMIHOST_SET_HOOKS   0xf5
 #define MRI_NEWLIB_SEMIHOST_GET_ERRNO   0xf6
 #define MRI_NEWLIB_SEMIHOST_WRITE       0xf7
@@ -15,9 +15,13 @@
 /* Semihost functionality for redirecting stdin/stdout/stderr I/O to the GNU console. */
 #include <core/libc.h>
 #include <core/mri.h>
+#include <core/async_console.h>
 #include <core/semihost.h>
 #include <core/cmd_file.h>
 #include <core/core.h>
+#include <core/binlog.h>
+#include <core/write_behind.h>
+#include <core/read_ahead.h>
 #include "newlib_stubs.h"
 
 
@@ -30,8 +34,12 @@ static int handleNewlibSemihostCloseRequest(PlatformSemihostParameters* pSemihos
 static int handleNewlibSemihostFStatRequest(PlatformSemihostParameters* pSemihostParameters);
 static int handleNewlibSemihostStatRequest(PlatformSemihostParameters* pSemihostParameters);
 static int handleNewlibSemihostRenameRequest(PlatformSemihostParameters* pSemihostParameters);
+static int handleNewlibSemihostFSyncRequest(PlatformSemihostParameters* pSemihostParameters);
+static int handleNewlibSemihostHostWriteRequest(PlatformSemihostParameters* pSemihostParameters);
+static int handleNewlibSemihostHostReadRequest(PlatformSemihostParameters* pSemihostParameters);
 static int handleNewlibSemihostGetErrNoRequest(PlatformSemihostParameters* pSemihostParameters);
 static int handleNewlibSemihostSetHooksRequest(PlatformSemihostParameters* pSemihostParameters);
+static int handleNewlibSemihostLogFlushRequest(void);
 int Semihost_HandleNewlibSemihostRequest(PlatformSemihostParameters* pSemihostParameters)
 {
     uintmri_t semihostOperation = Platform_GetNewlibSemihostOperation();
@@ -56,10 +64,18 @@ int Semihost_HandleNewlibSemihostRequest(PlatformSemihostParameters* pSemihostPa
             return handleNewlibSemihostStatRequest(pSemihostParameters);
         case MRI_NEWLIB_SEMIHOST_RENAME:
             return handleNewlibSemihostRenameRequest(pSemihostParameters);
+        case MRI_NEWLIB_SEMIHOST_FSYNC:
+            return handleNewlibSemihostFSyncRequest(pSemihostParameters);
+        case MRI_NEWLIB_SEMIHOST_HOST_WRITE:
+            return handleNewlibSemihostHostWriteRequest(pSemihostParameters);
+        case MRI_NEWLIB_SEMIHOST_HOST_READ:
+            return handleNewlibSemihostHostReadRequest(pSemihostParameters);
         case MRI_NEWLIB_SEMIHOST_GET_ERRNO:
             return handleNewlibSemihostGetErrNoRequest(pSemihostParameters);
         case MRI_NEWLIB_SEMIHOST_SET_HOOKS:
             return handleNewlibSemihostSetHooksRequest(pSemihostParameters);
+        case MRI_NEWLIB_SEMIHOST_LOG_FLUSH:
+            return handleNewlibSemihostLogFlushRequest();
         default:
             return 0;
     }
@@ -84,7 +100,9 @@ static int handleNewlibSemihostReadRequest(PlatformSemihostParameters* pSemihost
     parameters.bufferAddress = pSemihostParameters->parameter2;
     parameters.bufferSize = pSemihostParameters->parameter3;
 
-    return IssueGdbFileReadRequest(&parameters);
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+        return 0;
+    return ReadAhead_Read(parameters.fileDescriptor, parameters.bufferAddress, parameters.bufferSize);
 }
 
 static int handleNewlibSemihostOpenRequest(PlatformSemihostParameters* pSemihostParameters)
@@ -117,16 +135,21 @@ static int handleNewlibSemihostLSeekRequest(PlatformSemihostParameters* pSemihos
     parameters.offset = pSemihostParameters->parameter2;
     parameters.whence = pSemihostParameters->parameter3;
 
-    return IssueGdbFileSeekRequest(&parameters);
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+        return 0;
+    return ReadAhead_Seek(&parameters);
 }
 
 static int handleNewlibSemihostCloseRequest(PlatformSemihostParameters* pSemihostParameters)
 {
-    return IssueGdbFileCloseRequest(pSemihostParameters->parameter1);
+    ReadAhead_Invalidate(pSemihostParameters->parameter1);
+    return WriteBehind_Close(pSemihostParameters->parameter1);
 }
 
 static int handleNewlibSemihostFStatRequest(PlatformSemihostParameters* pSemihostParameters)
 {
+    if (!WriteBehind_Flush(pSemihostParameters->parameter1))
+        return 0;
     return IssueGdbFileFStatRequest(pSemihostParameters->parameter1, pSemihostParameters->parameter2);
 }
 
@@ -151,6 +174,44 @@ static int handleNewlibSemihostRenameRequest(PlatformSemihostParameters* pSemiho
     return IssueGdbFileRenameRequest(&parameters);
 }
 
+static int handleNewlibSemihostFSyncRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    return WriteBehind_FSync(pSemihostParameters->parameter1);
+}
+
+/* mriHostWrite() and mriHostRead() skip MRI's buffering and issue a single gdb request for the whole buffer.
+   Anything already buffered for the file is dealt with first so that the data stays in program order. */
+static int handleNewlibSemihostHostWriteRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    const uint32_t     STDOUT_FILE_NO = 1;
+    TransferParameters parameters;
+
+    parameters.fileDescriptor = pSemihostParameters->parameter1;
+    parameters.bufferAddress = pSemihostParameters->parameter2;
+    parameters.bufferSize = pSemihostParameters->parameter3;
+
+    if (parameters.fileDescriptor == STDOUT_FILE_NO)
+        AsyncConsole_Flush();
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+        return 0;
+    if (!ReadAhead_Rewind(parameters.fileDescriptor))
+        return 0;
+    return IssueGdbFileWriteRequest(&parameters);
+}
+
+static int handleNewlibSemihostHostReadRequest(PlatformSemihostParameters* pSemihostParameters)
+{
+    TransferParameters parameters;
+
+    parameters.fileDescriptor = pSemihostParameters->parameter1;
+    parameters.bufferAddress = pSemihostParameters->parameter2;
+    parameters.bufferSize = pSemihostParameters->parameter3;
+
+    if (!WriteBehind_Flush(parameters.fileDescriptor))
+        return 0;
+    return ReadAhead_ReadAll(parameters.fileDescriptor, parameters.bufferAddress, parameters.bufferSize);
+}
+
 static int handleNewlibSemihostGetErrNoRequest(PlatformSemihostParameters* pSemihostParameters)
 {
     SetSemihostReturnValues(GetSemihostErrno(), 0);
@@ -170,3 +231,14 @@ static int handleNewlibSemihostSetHooksRequest(PlatformSemihostParameters* pSemi
     FlagSemihostCallAsHandled();
     return 1;
 }
+
+static int handleNewlibSemihostLogFlushRequest(void)
+{
+    /* Leave the PC on the breakpoint if CTRL+C interrupted the flush so that it is retried when execution resumes. */
+    if (!BinLog_Flush())
+        return 0;
+
+    SetSemihostReturnValues(0, 0);
+    FlagSemihostCallAsHandled();
+    return 1;
+}
@@ -13,11 +13,14 @@
    limitations under the License.
 */
 /* Semihost functionality for redirecting operations such as file I/O to the GNU debugger. */
+#include <core/async_console.h>
 #include <core/core.h>
 #include <core/gdb_console.h>
 #include <core/platforms.h>
+#include <core/read_ahead.h>
 #include <core/semihost.h>
 #include <core/signal.h>
+#include <core/write_behind.h>
 
 
 int Semihost_IsDebuggeeMakingSemihostCall(void)
@@ -50,7 +53,11 @@ int Semihost_WriteToFileOrConsole(const TransferParameters* pParameters)
     {
         return writeToGdbConsole(pParameters);
     }
-    return IssueGdbFileWriteRequest(pParameters);
+    if (!ReadAhead_Rewind(pParameters->fileDescriptor))
+    {
+        return 0;
+    }
+    return WriteBehind_Write(pParameters->fileDescriptor, pParameters->bufferAddress, pParameters->bufferSize);
 }
 
 static int writeToGdbConsole(const TransferParameters* pParameters)
@@ -58,6 +65,15 @@ static int writeToGdbConsole(const TransferParameters* pParameters)
     const char* pBuffer = (const char*)pParameters->bufferAddress;
     size_t length = pParameters->bufferSize;
 
+    if (AsyncConsole_Write(pBuffer, length))
+    {
+        SetSemihostReturnValues(length, 0);
+        FlagSemihostCallAsHandled();
+        return 1;
+    }
+    /* Fall back to sending the output before resuming if it doesn't fit in the console ring buffer. */
+    AsyncConsole_Flush();
+
     size_t charsWritten = WriteSizedStringToGdbConsole(pBuffer, length);
 
     SetSemihostReturnValues(charsWritten, 0);
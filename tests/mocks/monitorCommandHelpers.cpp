@@ -0,0 +1,87 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <monitorCommandHelpers.h>
+#include <platformMock.h>
+
+extern "C"
+{
+#include <core/core.h>
+}
+
+
+static char g_command[256];
+static char g_expectedTransmitData[2048];
+
+
+int stringToHex(char* pHexDest, const char* pSrc)
+{
+    char* pStart = pHexDest;
+    while (*pSrc)
+    {
+        snprintf(pHexDest, 3, "%02x", *pSrc++);
+        pHexDest += 2;
+    }
+    *pHexDest = '\0';
+    return pHexDest - pStart;
+}
+
+const char* monitorCommand(const char* pCommand)
+{
+    const char commandPrefix[] = "+$qRcmd,";
+    char*      pDest = g_command;
+
+    assert ( sizeof(commandPrefix) + 2 * strlen(pCommand) + 1 <= sizeof(g_command) );
+    memcpy(pDest, commandPrefix, sizeof(commandPrefix) - 1);
+    pDest += sizeof(commandPrefix) - 1;
+    pDest += stringToHex(pDest, pCommand);
+    strcpy(pDest, "#");
+
+    return g_command;
+}
+
+void sendMonitorCommand(const char* pCommand, const char* pNextPacket)
+{
+    PlatformTrapReason reason = { MRI_PLATFORM_TRAP_TYPE_UNKNOWN, 0 };
+
+    platformMock_SetTrapReason(&reason);
+    platformMock_CommInitTransmitDataBuffer(sizeof(g_expectedTransmitData));
+    platformMock_CommInitReceiveChecksummedData(monitorCommand(pCommand), pNextPacket);
+        mriDebugException(platformMock_GetContext());
+}
+
+const char* expectConsoleOutputAndResponse(const char* pOutputs[], size_t outputCount, const char* pResponse)
+{
+    char*  pDest = g_expectedTransmitData;
+    char*  pEnd = g_expectedTransmitData + sizeof(g_expectedTransmitData);
+
+    pDest += snprintf(pDest, pEnd - pDest, "$T05responseT#+");
+    for (size_t i = 0 ; i < outputCount ; i++)
+    {
+        assert ( pEnd - pDest > (ptrdiff_t)(2 * strlen(pOutputs[i]) + 4) );
+        pDest += snprintf(pDest, pEnd - pDest, "$O");
+        pDest += stringToHex(pDest, pOutputs[i]);
+        pDest += snprintf(pDest, pEnd - pDest, "#");
+    }
+    snprintf(pDest, pEnd - pDest, "$%s#+", pResponse);
+    return platformMock_CommChecksumData(g_expectedTransmitData);
+}
+
+const char* expectConsoleOutputAndResponse(const char* pOutput, const char* pResponse)
+{
+    return expectConsoleOutputAndResponse(&pOutput, 1, pResponse);
+}
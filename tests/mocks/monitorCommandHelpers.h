@@ -0,0 +1,36 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/* Helpers shared by the tests of commands which gdb sends to MRI with "monitor" (qRcmd packets). */
+#ifndef MONITOR_COMMAND_HELPERS_H_
+#define MONITOR_COMMAND_HELPERS_H_
+
+#include <stddef.h>
+
+/* Writes pSrc as 2 hex digits per character and returns the number of hex digits written. */
+int         stringToHex(char* pHexDest, const char* pSrc);
+
+/* Returns the acknowledged qRcmd packet for pCommand, ready to pass to platformMock_CommInitReceiveChecksummedData().
+   The packet is only valid until the next call. */
+const char* monitorCommand(const char* pCommand);
+
+/* Stops in the debugger for an unknown trap, runs the monitor command and then processes pNextPacket. */
+void        sendMonitorCommand(const char* pCommand, const char* pNextPacket = "++$c#");
+
+/* Returns the checksummed data expected to be transmitted when the monitor command writes each of the strings in
+   pOutputs to the gdb console in turn and then sends pResponse. */
+const char* expectConsoleOutputAndResponse(const char* pOutputs[], size_t outputCount, const char* pResponse);
+const char* expectConsoleOutputAndResponse(const char* pOutput, const char* pResponse);
+
+#endif /* MONITOR_COMMAND_HELPERS_H_ */
@@ -24,6 +24,9 @@ extern "C"
 #include <core/try_catch.h>
 #include <core/hex_convert.h>
 #include <core/memory.h>
+#include <core/mri.h>
+#include <core/binlog.h>
+#include <core/fileio.h>
 }
 #include "platformMock.h"
 
@@ -33,6 +36,7 @@ extern "C"
 
 
 // Forward Function Declarations.
+static void     freeReceiveAllocs(void);
 static char*    allocateAndCopyChecksummedData(const char* pData);
 static size_t   countPoundSigns(const char* p);
 static void     copyChecksummedData(char* pDest, const char* pSrc);
@@ -77,16 +81,17 @@ void Platform_Init(Token* pParameterTokens)
 
 // Platform_Comm* Instrumentation
 static const char  g_emptyPacket[] = "$#00";
-static Buffer      g_receiveBuffers[3];
+static Buffer      g_receiveBuffers[8];
 static size_t      g_receiveIndex;
-static char*       g_pAlloc1;
-static char*       g_pAlloc2;
-static char*       g_pAlloc3;
+static char*       g_pAllocs[8];
 static char*       g_pTransmitDataBufferStart;
 static char*       g_pTransmitDataBufferEnd;
 static char*       g_pTransmitDataBufferCurr;
 static char*       g_pChecksumData;
 static int         g_hasTransmitCompletedCount;
+static int         g_transmitReadyCount;
+static int         g_isTransmitInterruptEnabled;
+static int         g_setTransmitInterruptCount;
 
 void platformMock_CommInitReceiveData(const char* pDataToReceive1,
                                       const char* pDataToReceive2 /* = NULL */,
@@ -101,41 +106,47 @@ void platformMock_CommInitReceiveData(const char* pDataToReceive1,
         Buffer_Init(&g_receiveBuffers[2], (char*)pDataToReceive3, strlen(pDataToReceive3));
     else
         Buffer_Init(&g_receiveBuffers[2], (char*)g_emptyPacket, strlen(g_emptyPacket));
+    for (size_t i = 3 ; i < ARRAY_SIZE(g_receiveBuffers) ; i++)
+        Buffer_Init(&g_receiveBuffers[i], (char*)g_emptyPacket, 0);
     g_receiveIndex = 0;
 }
 
 void platformMock_CommInitReceiveChecksummedData(const char* pDataToReceive1,
                                                  const char* pDataToReceive2 /* = NULL */,
-                                                 const char* pDataToReceive3 /* = NULL */)
-{
-    free(g_pAlloc1);
-    free(g_pAlloc2);
-    free(g_pAlloc3);
-    g_pAlloc1 = NULL;
-    g_pAlloc2 = NULL;
-    g_pAlloc3 = NULL;
-
-    g_pAlloc1 = allocateAndCopyChecksummedData(pDataToReceive1);
-    Buffer_Init(&g_receiveBuffers[0], g_pAlloc1, strlen(g_pAlloc1));
-    if (pDataToReceive2)
-    {
-        g_pAlloc2 = allocateAndCopyChecksummedData(pDataToReceive2);
-        Buffer_Init(&g_receiveBuffers[1], g_pAlloc2, strlen(g_pAlloc2));
-    }
-    else
-    {
-        Buffer_Init(&g_receiveBuffers[1], (char*)g_emptyPacket, strlen(g_emptyPacket));
-    }
-    if (pDataToReceive3)
+                                                 const char* pDataToReceive3 /* = NULL */,
+                                                 const char* pDataToReceive4 /* = NULL */,
+                                                 const char* pDataToReceive5 /* = NULL */,
+                                                 const char* pDataToReceive6 /* = NULL */,
+                                                 const char* pDataToReceive7 /* = NULL */,
+                                                 const char* pDataToReceive8 /* = NULL */)
+{
+    const char* dataToReceive[8] = { pDataToReceive1, pDataToReceive2, pDataToReceive3, pDataToReceive4,
+                                     pDataToReceive5, pDataToReceive6, pDataToReceive7, pDataToReceive8 };
+
+    freeReceiveAllocs();
+    for (size_t i = 0 ; i < ARRAY_SIZE(g_receiveBuffers) ; i++)
     {
-        g_pAlloc3 = allocateAndCopyChecksummedData(pDataToReceive3);
-        Buffer_Init(&g_receiveBuffers[2], g_pAlloc3, strlen(g_pAlloc3));
+        if (dataToReceive[i])
+        {
+            g_pAllocs[i] = allocateAndCopyChecksummedData(dataToReceive[i]);
+            Buffer_Init(&g_receiveBuffers[i], g_pAllocs[i], strlen(g_pAllocs[i]));
+        }
+        else
+        {
+            size_t emptySize = i < 3 ? strlen(g_emptyPacket) : 0;
+            Buffer_Init(&g_receiveBuffers[i], (char*)g_emptyPacket, emptySize);
+        }
     }
-    else
+    g_receiveIndex = 0;
+}
+
+static void freeReceiveAllocs(void)
+{
+    for (size_t i = 0 ; i < ARRAY_SIZE(g_pAllocs) ; i++)
     {
-        Buffer_Init(&g_receiveBuffers[2], (char*)g_emptyPacket, strlen(g_emptyPacket));
+        free(g_pAllocs[i]);
+        g_pAllocs[i] = NULL;
     }
-    g_receiveIndex = 0;
 }
 
 static char* allocateAndCopyChecksummedData(const char* pData)
@@ -218,6 +229,21 @@ int platformMock_CommGetHasTransmitCompletedCallCount(void)
     return g_hasTransmitCompletedCount;
 }
 
+void platformMock_CommSetTransmitReadyCount(int readyCount)
+{
+    g_transmitReadyCount = readyCount;
+}
+
+int platformMock_CommGetTransmitInterruptEnabled(void)
+{
+    return g_isTransmitInterruptEnabled;
+}
+
+int platformMock_CommGetSetTransmitInterruptCallCount(void)
+{
+    return g_setTransmitInterruptCount;
+}
+
 // Platform_Comm* stubs called by MRI core.
 int Platform_CommHasReceiveData(void)
 {
@@ -266,6 +292,19 @@ void Platform_CommSendChar(int character)
 {
     if (g_pTransmitDataBufferCurr < g_pTransmitDataBufferEnd)
         *g_pTransmitDataBufferCurr++ = (char)character;
+    if (g_transmitReadyCount > 0)
+        g_transmitReadyCount--;
+}
+
+int Platform_CommIsTransmitReady(void)
+{
+    return g_transmitReadyCount != 0;
+}
+
+void Platform_CommSetTransmitInterrupt(int isEnabled)
+{
+    g_isTransmitInterruptEnabled = isEnabled;
+    g_setTransmitInterruptCount++;
 }
 
 
@@ -299,7 +338,9 @@ void Platform_LeavingDebugger(void)
 // Packet Buffer Instrumentation.
 // NOTE: Packet must be big enough for g/G packets to hold 16 general purpose registers + PSR with 2 hex digits per
 //       byte + 1 more byte for the g/G command character + 4 more bytes for packet header/checksum_trailer.
-static char     g_packetBuffer[1 + (16 + 1) * (sizeof(uint32_t) * 2) + 4];
+//       The array has room for tests to select a larger packet size with platformMock_SetPacketBufferSize().
+#define DEFAULT_PACKET_BUFFER_SIZE (1 + (16 + 1) * (sizeof(uint32_t) * 2) + 4)
+static char     g_packetBuffer[512];
 static size_t   g_packetBufferSize;
 
 void platformMock_SetPacketBufferSize(uint32_t setValue)
@@ -347,12 +388,30 @@ int Semihost_HandleSemihostRequest(void)
     return TRUE;
 }
 
+// Stands in for the newlib semihost stub which traps into MRI to flush the binary log.
+static int g_logFlushCalls;
+
+int platformMock_GetLogFlushCalls(void)
+{
+    return g_logFlushCalls;
+}
+
+void mriLogFlush(void)
+{
+    g_logFlushCalls++;
+    BinLog_Flush();
+}
+
 
 
 // Fault/Exception Related Instrumentation
 static uint8_t            g_causeOfException;
 static int                g_displayFaultCauseToGdbConsoleCount;
 static PlatformTrapReason g_trapReason;
+static uint32_t           g_faultStatusRegisters[8];
+static size_t             g_faultStatusRegisterCount;
+static uint32_t           g_unwindFrames[32];
+static size_t             g_unwindFrameCount;
 
 void platformMock_SetCauseOfException(uint8_t signal)
 {
@@ -369,6 +428,20 @@ void platformMock_SetTrapReason(const PlatformTrapReason* pReason)
     g_trapReason = *pReason;
 }
 
+void platformMock_SetFaultStatusRegisters(const uint32_t* pRegisters, size_t registerCount)
+{
+    assert ( registerCount <= ARRAY_SIZE(g_faultStatusRegisters) );
+    memcpy(g_faultStatusRegisters, pRegisters, registerCount * sizeof(*pRegisters));
+    g_faultStatusRegisterCount = registerCount;
+}
+
+void platformMock_SetUnwindFrames(const uint32_t* pFrames, size_t frameCount)
+{
+    assert ( frameCount <= ARRAY_SIZE(g_unwindFrames) );
+    memcpy(g_unwindFrames, pFrames, frameCount * sizeof(*pFrames));
+    g_unwindFrameCount = frameCount;
+}
+
 
 // Fault/Exception stubs called by MRI core.
 uint8_t Platform_DetermineCauseOfException(void)
@@ -386,19 +459,49 @@ void Platform_DisplayFaultCauseToGdbConsole(void)
     g_displayFaultCauseToGdbConsoleCount++;
 }
 
+size_t Platform_GetFaultStatusRegisters(uint32_t* pRegisters, size_t maxRegisters)
+{
+    size_t count = g_faultStatusRegisterCount < maxRegisters ? g_faultStatusRegisterCount : maxRegisters;
+
+    memcpy(pRegisters, g_faultStatusRegisters, count * sizeof(*pRegisters));
+    return count;
+}
+
+/* The first frame is taken from the context's first register so that tests can tell the threads apart. It is
+   followed by the frames set with platformMock_SetUnwindFrames(). */
+size_t Platform_UnwindStack(MriContext* pContext, uint32_t* pFrames, size_t maxFrames)
+{
+    size_t i;
+
+    if (maxFrames == 0)
+        return 0;
+    pFrames[0] = (uint32_t)Context_Get(pContext, 0);
+    for (i = 0 ; i < g_unwindFrameCount && i + 1 < maxFrames ; i++)
+        pFrames[i + 1] = g_unwindFrames[i];
+    return i + 1;
+}
+
 
 
 // Current Instruction Related Instrumentation
 PlatformInstructionType g_instructionType;
+PlatformMemoryWrite     g_memoryWrite;
 int                     g_advanceProgramCounterToNextInstruction;
 int                     g_setProgramCounterCalls;
 uint32_t                g_programCounter;
+uintmri_t               g_stackPointer;
 
 void platformMock_SetTypeOfCurrentInstruction(PlatformInstructionType setValue)
 {
     g_instructionType = setValue;
 }
 
+void platformMock_SetMemoryWriteOfCurrentInstruction(uintmri_t address, uint32_t size)
+{
+    g_memoryWrite.address = address;
+    g_memoryWrite.size = size;
+}
+
 int platformMock_AdvanceProgramCounterToNextInstructionCalls(void)
 {
     return g_advanceProgramCounterToNextInstruction;
@@ -414,12 +517,22 @@ uint32_t platformMock_GetProgramCounterValue(void)
     return g_programCounter;
 }
 
+void platformMock_SetStackPointer(uintmri_t stackPointer)
+{
+    g_stackPointer = stackPointer;
+}
+
 // Stubs called by MRI core.
 PlatformInstructionType Platform_TypeOfCurrentInstruction(void)
 {
     return g_instructionType;
 }
 
+PlatformMemoryWrite Platform_GetMemoryWriteOfCurrentInstruction(void)
+{
+    return g_memoryWrite;
+}
+
 void Platform_AdvanceProgramCounterToNextInstruction(void)
 {
     g_advanceProgramCounterToNextInstruction++;
@@ -442,6 +555,11 @@ uintmri_t  Platform_GetProgramCounter(void)
     return g_programCounter;
 }
 
+uintmri_t Platform_GetStackPointer(void)
+{
+    return g_stackPointer;
+}
+
 
 
 // Single Stepping stubs called by MRI core.
@@ -529,6 +647,8 @@ int                    g_setHardwareBreakpointCalls;
 uint32_t               g_setHardwareBreakpointAddressArg;
 uint32_t               g_setHardwareBreakpointKindArg;
 uint32_t               g_setHardwareBreakpointException;
+int                    g_hardwareBreakpointCapacity;
+int                    g_hardwareBreakpointsInUse;
 int                    g_clearHardwareBreakpointCalls;
 uint32_t               g_clearHardwareBreakpointAddressArg;
 uint32_t               g_clearHardwareBreakpointKindArg;
@@ -543,6 +663,10 @@ uint32_t               g_clearHardwareWatchpointAddressArg;
 uint32_t               g_clearHardwareWatchpointSizeArg;
 PlatformWatchpointType g_clearHardwareWatchpointTypeArg;
 uint32_t               g_clearHardwareWatchpointException;
+int                    g_setHardwareValueWatchpointCalls;
+uint32_t               g_setHardwareWatchpointValueArg;
+int                    g_clearHardwareValueWatchpointCalls;
+uint32_t               g_clearHardwareWatchpointValueArg;
 
 int platformMock_SetHardwareBreakpointCalls(void)
 {
@@ -564,6 +688,11 @@ void platformMock_SetHardwareBreakpointException(uint32_t exceptionToThrow)
     g_setHardwareBreakpointException = exceptionToThrow;
 }
 
+void platformMock_SetHardwareBreakpointCapacity(int capacity)
+{
+    g_hardwareBreakpointCapacity = capacity;
+}
+
 int platformMock_ClearHardwareBreakpointCalls(void)
 {
     return g_clearHardwareBreakpointCalls;
@@ -634,6 +763,26 @@ void platformMock_ClearHardwareWatchpointException(uint32_t exceptionToThrow)
     g_clearHardwareWatchpointException = exceptionToThrow;
 }
 
+int platformMock_SetHardwareValueWatchpointCalls(void)
+{
+    return g_setHardwareValueWatchpointCalls;
+}
+
+uint32_t platformMock_SetHardwareWatchpointValueArg(void)
+{
+    return g_setHardwareWatchpointValueArg;
+}
+
+int platformMock_ClearHardwareValueWatchpointCalls(void)
+{
+    return g_clearHardwareValueWatchpointCalls;
+}
+
+uint32_t platformMock_ClearHardwareWatchpointValueArg(void)
+{
+    return g_clearHardwareWatchpointValueArg;
+}
+
 // Stubs called from MRI core.
 __throws void  Platform_SetHardwareBreakpointOfGdbKind(uintmri_t address, uintmri_t kind)
 {
@@ -651,6 +800,9 @@ __throws void  Platform_SetHardwareBreakpoint(uintmri_t address)
     g_setHardwareBreakpointKindArg = 0xFFFFFFFF;
     if (g_setHardwareBreakpointException)
         __throw(g_setHardwareBreakpointException);
+    if (g_hardwareBreakpointCapacity && g_hardwareBreakpointsInUse >= g_hardwareBreakpointCapacity)
+        __throw(exceededHardwareResourcesException);
+    g_hardwareBreakpointsInUse++;
 }
 
 __throws void  Platform_ClearHardwareBreakpointOfGdbKind(uintmri_t address, uintmri_t kind)
@@ -669,6 +821,8 @@ __throws void  Platform_ClearHardwareBreakpoint(uintmri_t address)
     g_clearHardwareBreakpointKindArg = 0xFFFFFFFF;
     if (g_clearHardwareBreakpointException)
         __throw(g_clearHardwareBreakpointException);
+    if (g_hardwareBreakpointsInUse > 0)
+        g_hardwareBreakpointsInUse--;
 }
 
 __throws void  Platform_SetHardwareWatchpoint(uintmri_t address, uintmri_t size,  PlatformWatchpointType type)
@@ -691,21 +845,309 @@ __throws void  Platform_ClearHardwareWatchpoint(uintmri_t address, uintmri_t siz
         __throw(g_clearHardwareWatchpointException);
 }
 
+__throws void  Platform_SetHardwareValueWatchpoint(uintmri_t address, uintmri_t size, uintmri_t value,
+                                                   PlatformWatchpointType type)
+{
+    g_setHardwareValueWatchpointCalls++;
+    g_setHardwareWatchpointAddressArg = address;
+    g_setHardwareWatchpointSizeArg = size;
+    g_setHardwareWatchpointValueArg = value;
+    g_setHardwareWatchpointTypeArg = type;
+    if (g_setHardwareWatchpointException)
+        __throw(g_setHardwareWatchpointException);
+}
+
+__throws void  Platform_ClearHardwareValueWatchpoint(uintmri_t address, uintmri_t size, uintmri_t value,
+                                                     PlatformWatchpointType type)
+{
+    g_clearHardwareValueWatchpointCalls++;
+    g_clearHardwareWatchpointAddressArg = address;
+    g_clearHardwareWatchpointSizeArg = size;
+    g_clearHardwareWatchpointValueArg = value;
+    g_clearHardwareWatchpointTypeArg = type;
+    if (g_clearHardwareWatchpointException)
+        __throw(g_clearHardwareWatchpointException);
+}
+
+
+
+// Profiling Instrumentation.
+static int      g_startProfilingCalls;
+static uint32_t g_startProfilingIntervalArg;
+static uint32_t g_startProfilingException;
+static int      g_stopProfilingCalls;
+static uint32_t g_cpuClockFrequency;
+static int      g_enableCycleCounterCalls;
+static uint32_t g_enableCycleCounterException;
+static uint32_t g_cycleCounter;
+static uint32_t g_cycleCounterIncrement;
+static int      g_startPerfCountersCalls;
+static uint32_t g_startPerfCountersIntervalArg;
+static uint32_t g_startPerfCountersException;
+static int      g_stopPerfCountersCalls;
+static int      g_hookIrqCalls;
+static uint32_t g_hookIrqArg;
+static uint32_t g_hookIrqException;
+static int      g_unhookIrqCalls;
+static uint32_t g_unhookIrqArg;
+static uint32_t g_pendingIrqs;
+static int      g_startSamplingCalls;
+static uint32_t g_startSamplingIntervalArg;
+static uint32_t g_startSamplingException;
+static int      g_stopSamplingCalls;
+static int      g_startCpuLoadSamplingCalls;
+static uint32_t g_startCpuLoadSamplingIntervalArg;
+static uint32_t g_startCpuLoadSamplingException;
+static int      g_stopCpuLoadSamplingCalls;
+
+int platformMock_StartProfilingCalls(void)
+{
+    return g_startProfilingCalls;
+}
+
+uint32_t platformMock_StartProfilingIntervalArg(void)
+{
+    return g_startProfilingIntervalArg;
+}
+
+void platformMock_StartProfilingException(uint32_t exceptionToThrow)
+{
+    g_startProfilingException = exceptionToThrow;
+}
+
+int platformMock_StopProfilingCalls(void)
+{
+    return g_stopProfilingCalls;
+}
+
+void platformMock_SetCpuClockFrequency(uint32_t frequency)
+{
+    g_cpuClockFrequency = frequency;
+}
+
+int platformMock_EnableCycleCounterCalls(void)
+{
+    return g_enableCycleCounterCalls;
+}
+
+void platformMock_EnableCycleCounterException(uint32_t exceptionToThrow)
+{
+    g_enableCycleCounterException = exceptionToThrow;
+}
+
+void platformMock_SetCycleCounter(uint32_t cycles)
+{
+    g_cycleCounter = cycles;
+}
+
+void platformMock_SetCycleCounterIncrement(uint32_t cycles)
+{
+    g_cycleCounterIncrement = cycles;
+}
+
+int platformMock_StartPerfCountersCalls(void)
+{
+    return g_startPerfCountersCalls;
+}
+
+uint32_t platformMock_StartPerfCountersIntervalArg(void)
+{
+    return g_startPerfCountersIntervalArg;
+}
+
+void platformMock_StartPerfCountersException(uint32_t exceptionToThrow)
+{
+    g_startPerfCountersException = exceptionToThrow;
+}
+
+int platformMock_StopPerfCountersCalls(void)
+{
+    return g_stopPerfCountersCalls;
+}
+
+int platformMock_HookIrqCalls(void)
+{
+    return g_hookIrqCalls;
+}
+
+uint32_t platformMock_HookIrqArg(void)
+{
+    return g_hookIrqArg;
+}
+
+void platformMock_HookIrqException(uint32_t exceptionToThrow)
+{
+    g_hookIrqException = exceptionToThrow;
+}
+
+int platformMock_UnhookIrqCalls(void)
+{
+    return g_unhookIrqCalls;
+}
+
+uint32_t platformMock_UnhookIrqArg(void)
+{
+    return g_unhookIrqArg;
+}
+
+void platformMock_SetPendingIrqs(uint32_t pendingMask)
+{
+    g_pendingIrqs = pendingMask;
+}
+
+int platformMock_StartSamplingCalls(void)
+{
+    return g_startSamplingCalls;
+}
+
+uint32_t platformMock_StartSamplingIntervalArg(void)
+{
+    return g_startSamplingIntervalArg;
+}
+
+void platformMock_StartSamplingException(uint32_t exceptionToThrow)
+{
+    g_startSamplingException = exceptionToThrow;
+}
+
+int platformMock_StopSamplingCalls(void)
+{
+    return g_stopSamplingCalls;
+}
+
+int platformMock_StartCpuLoadSamplingCalls(void)
+{
+    return g_startCpuLoadSamplingCalls;
+}
+
+uint32_t platformMock_StartCpuLoadSamplingIntervalArg(void)
+{
+    return g_startCpuLoadSamplingIntervalArg;
+}
+
+void platformMock_StartCpuLoadSamplingException(uint32_t exceptionToThrow)
+{
+    g_startCpuLoadSamplingException = exceptionToThrow;
+}
+
+int platformMock_StopCpuLoadSamplingCalls(void)
+{
+    return g_stopCpuLoadSamplingCalls;
+}
+
+// Stubs called from MRI core.
+__throws void Platform_StartProfiling(uint32_t sampleInterval)
+{
+    g_startProfilingCalls++;
+    g_startProfilingIntervalArg = sampleInterval;
+    if (g_startProfilingException)
+        __throw(g_startProfilingException);
+}
+
+void Platform_StopProfiling(void)
+{
+    g_stopProfilingCalls++;
+}
+
+uint32_t Platform_GetCpuClockFrequency(void)
+{
+    return g_cpuClockFrequency;
+}
+
+__throws void Platform_EnableCycleCounter(void)
+{
+    g_enableCycleCounterCalls++;
+    if (g_enableCycleCounterException)
+        __throw(g_enableCycleCounterException);
+}
+
+uint32_t Platform_GetCycleCounter(void)
+{
+    uint32_t cycles = g_cycleCounter;
+
+    g_cycleCounter += g_cycleCounterIncrement;
+    return cycles;
+}
+
+__throws void Platform_StartPerfCounters(uint32_t sampleInterval)
+{
+    g_startPerfCountersCalls++;
+    g_startPerfCountersIntervalArg = sampleInterval;
+    if (g_startPerfCountersException)
+        __throw(g_startPerfCountersException);
+}
+
+void Platform_StopPerfCounters(void)
+{
+    g_stopPerfCountersCalls++;
+}
+
+__throws void Platform_HookIrq(uint32_t irq)
+{
+    g_hookIrqCalls++;
+    g_hookIrqArg = irq;
+    if (g_hookIrqException)
+        __throw(g_hookIrqException);
+}
+
+void Platform_UnhookIrq(uint32_t irq)
+{
+    g_unhookIrqCalls++;
+    g_unhookIrqArg = irq;
+}
+
+int Platform_IsIrqPending(uint32_t irq)
+{
+    return irq < 32 && (g_pendingIrqs & (1 << irq));
+}
+
+__throws void Platform_StartSampling(uint32_t sampleInterval)
+{
+    g_startSamplingCalls++;
+    g_startSamplingIntervalArg = sampleInterval;
+    if (g_startSamplingException)
+        __throw(g_startSamplingException);
+}
+
+void Platform_StopSampling(void)
+{
+    g_stopSamplingCalls++;
+}
+
+__throws void Platform_StartCpuLoadSampling(uint32_t sampleInterval)
+{
+    g_startCpuLoadSamplingCalls++;
+    g_startCpuLoadSamplingIntervalArg = sampleInterval;
+    if (g_startCpuLoadSamplingException)
+        __throw(g_startCpuLoadSamplingException);
+}
+
+void Platform_StopCpuLoadSampling(void)
+{
+    g_stopCpuLoadSamplingCalls++;
+}
+
 
 
 // Query memory map and feature XML test instrumentation.
-static char g_deviceMemoryMapXml[] = "TEST";
-static char g_targetXml[] = "test!";
+static const char  g_defaultDeviceMemoryMapXml[] = "TEST";
+static const char* g_pDeviceMemoryMapXml = g_defaultDeviceMemoryMapXml;
+static char        g_targetXml[] = "test!";
+
+void platformMock_SetDeviceMemoryMapXml(const char* pXml)
+{
+    g_pDeviceMemoryMapXml = pXml;
+}
 
 // Stubs called by MRI core.
 size_t Platform_GetDeviceMemoryMapXmlSize(void)
 {
-    return sizeof(g_deviceMemoryMapXml) - 1;
+    return strlen(g_pDeviceMemoryMapXml);
 }
 
 const char*  Platform_GetDeviceMemoryMapXml(void)
 {
-    return g_deviceMemoryMapXml;
+    return g_pDeviceMemoryMapXml;
 }
 
 size_t Platform_GetTargetXmlSize(void)
@@ -899,6 +1341,141 @@ void Platform_RtosRestorePrevThreadState(void)
 
 
 
+// Filesystem instrumentation. A single file is simulated and it is always opened as file descriptor 3.
+#define FS_MOCK_FILE_DESCRIPTOR 3
+static char     g_fsFilename[64];
+static uint8_t  g_fsData[1024];
+static uint32_t g_fsSize;
+static uint32_t g_fsLastModifiedTime;
+static uint32_t g_fsOpenFlags;
+static uint32_t g_fsOpenMode;
+static int      g_fsExists;
+static int      g_fsIsOpen;
+static int      g_fsError;
+
+void platformMock_FsSetFile(const char* pFilename, const void* pData, uint32_t size, uint32_t lastModifiedTime)
+{
+    assert ( strlen(pFilename) < sizeof(g_fsFilename) && size <= sizeof(g_fsData) );
+    strcpy(g_fsFilename, pFilename);
+    memcpy(g_fsData, pData, size);
+    g_fsSize = size;
+    g_fsLastModifiedTime = lastModifiedTime;
+    g_fsExists = 1;
+}
+
+void platformMock_FsSetError(int negatedErrno)
+{
+    g_fsError = negatedErrno;
+}
+
+const uint8_t* platformMock_FsGetFileData(void)
+{
+    return g_fsData;
+}
+
+uint32_t platformMock_FsGetFileSize(void)
+{
+    return g_fsSize;
+}
+
+int platformMock_FsExists(void)
+{
+    return g_fsExists;
+}
+
+int platformMock_FsIsOpen(void)
+{
+    return g_fsIsOpen;
+}
+
+uint32_t platformMock_FsGetOpenFlags(void)
+{
+    return g_fsOpenFlags;
+}
+
+uint32_t platformMock_FsGetOpenMode(void)
+{
+    return g_fsOpenMode;
+}
+
+// Stubs called by MRI core.
+int Platform_FsOpen(const char* pFilename, uint32_t flags, uint32_t mode)
+{
+    int matches = g_fsExists && strcmp(pFilename, g_fsFilename) == 0;
+
+    if (g_fsError)
+        return g_fsError;
+    if (!matches && (flags & GDB_O_CREAT) == 0)
+        return -GDB_ENOENT;
+    if (!matches)
+    {
+        assert ( strlen(pFilename) < sizeof(g_fsFilename) );
+        strcpy(g_fsFilename, pFilename);
+        g_fsSize = 0;
+        g_fsExists = 1;
+    }
+    if (flags & GDB_O_TRUNC)
+        g_fsSize = 0;
+    g_fsOpenFlags = flags;
+    g_fsOpenMode = mode;
+    g_fsIsOpen = 1;
+    return FS_MOCK_FILE_DESCRIPTOR;
+}
+
+int Platform_FsClose(int fileDescriptor)
+{
+    if (fileDescriptor != FS_MOCK_FILE_DESCRIPTOR || !g_fsIsOpen)
+        return -GDB_EBADF;
+    g_fsIsOpen = 0;
+    return 0;
+}
+
+int32_t Platform_FsPRead(int fileDescriptor, void* pBuffer, uint32_t count, uint32_t offset)
+{
+    if (g_fsError)
+        return g_fsError;
+    if (fileDescriptor != FS_MOCK_FILE_DESCRIPTOR || !g_fsIsOpen)
+        return -GDB_EBADF;
+    if (offset >= g_fsSize)
+        return 0;
+    if (count > g_fsSize - offset)
+        count = g_fsSize - offset;
+    memcpy(pBuffer, g_fsData + offset, count);
+    return count;
+}
+
+int32_t Platform_FsPWrite(int fileDescriptor, const void* pBuffer, uint32_t count, uint32_t offset)
+{
+    if (fileDescriptor != FS_MOCK_FILE_DESCRIPTOR || !g_fsIsOpen)
+        return -GDB_EBADF;
+    if (offset + count > sizeof(g_fsData))
+        return -GDB_EFBIG;
+    memcpy(g_fsData + offset, pBuffer, count);
+    if (offset + count > g_fsSize)
+        g_fsSize = offset + count;
+    return count;
+}
+
+int Platform_FsFStat(int fileDescriptor, PlatformFileStat* pStat)
+{
+    if (fileDescriptor != FS_MOCK_FILE_DESCRIPTOR || !g_fsIsOpen)
+        return -GDB_EBADF;
+    pStat->mode = GDB_S_IFREG | GDB_S_IRUSR | GDB_S_IWUSR;
+    pStat->size = g_fsSize;
+    pStat->lastModifiedTime = g_fsLastModifiedTime;
+    return 0;
+}
+
+int Platform_FsUnlink(const char* pFilename)
+{
+    if (!g_fsExists || strcmp(pFilename, g_fsFilename) != 0)
+        return -GDB_ENOENT;
+    g_fsExists = 0;
+    return 0;
+}
+
+
+
 // Memory Cache instrumentation.
 static int g_invalidateICacheCount;
 int platformMock_GetSyncICacheToDCacheCalls(void)
@@ -924,29 +1501,40 @@ void platformMock_Init(void)
     memset(&g_initTokenCopy, 0, sizeof(g_initTokenCopy));
     memset(&g_trapReason, 0, sizeof(g_trapReason));
     g_hasTransmitCompletedCount = 0;
+    g_transmitReadyCount = -1;
+    g_isTransmitInterruptEnabled = 0;
+    g_setTransmitInterruptCount = 0;
     g_pChecksumData = NULL;
     g_initCount = 0;
     g_enteringDebuggerCount = 0;
     g_leavingDebuggerCount = 0;
     g_isDebuggeeMakingSemihostCall = FALSE;
     g_getHandleSemihostRequestCount = 0;
+    g_logFlushCalls = 0;
     g_causeOfException = SIGTRAP;
     g_displayFaultCauseToGdbConsoleCount = 0;
-    g_packetBufferSize = sizeof(g_packetBuffer);
+    g_packetBufferSize = DEFAULT_PACKET_BUFFER_SIZE;
     g_instructionType = MRI_PLATFORM_INSTRUCTION_OTHER;
+    memset(&g_memoryWrite, 0, sizeof(g_memoryWrite));
     g_advanceProgramCounterToNextInstruction = 0;
     g_setProgramCounterCalls = 0;
     g_programCounter = INITIAL_PC;
+    g_stackPointer = 0;
+    g_faultStatusRegisterCount = 0;
+    g_unwindFrameCount = 0;
     g_singleSteppingForced = false;
     g_singleSteppingShouldAdvancePC = false;
     g_singleStepping = FALSE;
     g_callToFail = 0;
     memset(g_contextEntries, 0xff, sizeof(g_contextEntries));
     Context_Init(&g_context, &g_contextSection, 1);
+    g_pDeviceMemoryMapXml = g_defaultDeviceMemoryMapXml;
     g_setHardwareBreakpointCalls = 0;
     g_setHardwareBreakpointAddressArg = 0;
     g_setHardwareBreakpointKindArg = 0;
     g_setHardwareBreakpointException = noException;
+    g_hardwareBreakpointCapacity = 0;
+    g_hardwareBreakpointsInUse = 0;
     g_clearHardwareBreakpointCalls = 0;
     g_clearHardwareBreakpointAddressArg = 0;
     g_clearHardwareBreakpointKindArg = 0;
@@ -961,6 +1549,37 @@ void platformMock_Init(void)
     g_clearHardwareWatchpointSizeArg = 0;
     g_clearHardwareWatchpointTypeArg = MRI_PLATFORM_WRITE_WATCHPOINT;
     g_clearHardwareWatchpointException = noException;
+    g_setHardwareValueWatchpointCalls = 0;
+    g_setHardwareWatchpointValueArg = 0;
+    g_clearHardwareValueWatchpointCalls = 0;
+    g_clearHardwareWatchpointValueArg = 0;
+    g_startProfilingCalls = 0;
+    g_startProfilingIntervalArg = 0;
+    g_startProfilingException = noException;
+    g_stopProfilingCalls = 0;
+    g_enableCycleCounterCalls = 0;
+    g_enableCycleCounterException = noException;
+    g_cycleCounter = 0;
+    g_cycleCounterIncrement = 0;
+    g_startPerfCountersCalls = 0;
+    g_startPerfCountersIntervalArg = 0;
+    g_startPerfCountersException = noException;
+    g_stopPerfCountersCalls = 0;
+    g_hookIrqCalls = 0;
+    g_hookIrqArg = 0;
+    g_hookIrqException = noException;
+    g_unhookIrqCalls = 0;
+    g_unhookIrqArg = 0;
+    g_pendingIrqs = 0;
+    g_startSamplingCalls = 0;
+    g_startSamplingIntervalArg = 0;
+    g_startSamplingException = noException;
+    g_stopSamplingCalls = 0;
+    g_startCpuLoadSamplingCalls = 0;
+    g_startCpuLoadSamplingIntervalArg = 0;
+    g_startCpuLoadSamplingException = noException;
+    g_stopCpuLoadSamplingCalls = 0;
+    g_cpuClockFrequency = 0;
     g_semihostCallReturnValue = 0;
     g_resetCount = 0;
     g_rtosThreadId = 0;
@@ -976,18 +1595,21 @@ void platformMock_Init(void)
     g_rtosThreadStateCount = 0;
     g_rtosInvalidThreadAttempts = 0;
     g_rtosRestorePrevThreadStateCallCount = 0;
+    g_fsFilename[0] = '\0';
+    g_fsSize = 0;
+    g_fsLastModifiedTime = 0;
+    g_fsOpenFlags = 0;
+    g_fsOpenMode = 0;
+    g_fsExists = 0;
+    g_fsIsOpen = 0;
+    g_fsError = 0;
     g_invalidateICacheCount = 0;
 }
 
 void platformMock_Uninit(void)
 {
-    free(g_pAlloc1);
-    free(g_pAlloc2);
-    free(g_pAlloc3);
+    freeReceiveAllocs();
     free(g_pChecksumData);
-    g_pAlloc1 = NULL;
-    g_pAlloc2 = NULL;
-    g_pAlloc3 = NULL;
     g_pChecksumData = NULL;
     commUninitTransmitDataBuffer();
 }
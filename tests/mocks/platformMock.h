@@ -32,11 +32,19 @@ void        platformMock_CommInitReceiveData(const char* pDataToReceive1,
                                              const char* pDataToReceive3 = NULL);
 void        platformMock_CommInitReceiveChecksummedData(const char* pDataToReceive1,
                                                         const char* pDataToReceive2 = NULL,
-                                                        const char* pDataToReceive3 = NULL);
+                                                        const char* pDataToReceive3 = NULL,
+                                                        const char* pDataToReceive4 = NULL,
+                                                        const char* pDataToReceive5 = NULL,
+                                                        const char* pDataToReceive6 = NULL,
+                                                        const char* pDataToReceive7 = NULL,
+                                                        const char* pDataToReceive8 = NULL);
 void        platformMock_CommInitTransmitDataBuffer(size_t Size);
 const char* platformMock_CommChecksumData(const char* pData);
 const char* platformMock_CommGetTransmittedData(void);
 int         platformMock_CommGetHasTransmitCompletedCallCount(void);
+void        platformMock_CommSetTransmitReadyCount(int readyCount);
+int         platformMock_CommGetTransmitInterruptEnabled(void);
+int         platformMock_CommGetSetTransmitInterruptCallCount(void);
 
 void        platformMock_SetInitException(int exceptionToThrow);
 int         platformMock_GetInitCount(void);
@@ -47,17 +55,24 @@ int         platformMock_GetLeavingDebuggerCalls(void);
 
 void        platformMock_SetIsDebuggeeMakingSemihostCall(int setValue);
 int         platformMock_GetHandleSemihostRequestCalls(void);
+int         platformMock_GetLogFlushCalls(void);
 
 void        platformMock_SetCauseOfException(uint8_t signal);
 void        platformMock_SetTrapReason(const PlatformTrapReason* reason);
 int         platformMock_DisplayFaultCauseToGdbConsoleCalls(void);
+void        platformMock_SetFaultStatusRegisters(const uint32_t* pRegisters, size_t registerCount);
+void        platformMock_SetUnwindFrames(const uint32_t* pFrames, size_t frameCount);
 
 void        platformMock_SetPacketBufferSize(uint32_t setValue);
 
+void        platformMock_SetDeviceMemoryMapXml(const char* pXml);
+
 void        platformMock_SetTypeOfCurrentInstruction(PlatformInstructionType setValue);
+void        platformMock_SetMemoryWriteOfCurrentInstruction(uintmri_t address, uint32_t size);
 int         platformMock_AdvanceProgramCounterToNextInstructionCalls(void);
 int         platformMock_SetProgramCounterCalls(void);
 uint32_t    platformMock_GetProgramCounterValue(void);
+void        platformMock_SetStackPointer(uintmri_t stackPointer);
 
 void        platformMock_FaultOnSpecificMemoryCall(int callToFail);
 
@@ -68,6 +83,7 @@ int         platformMock_SetHardwareBreakpointCalls(void);
 uint32_t    platformMock_SetHardwareBreakpointAddressArg(void);
 uint32_t    platformMock_SetHardwareBreakpointKindArg(void);
 void        platformMock_SetHardwareBreakpointException(uint32_t exceptionToThrow);
+void        platformMock_SetHardwareBreakpointCapacity(int capacity);
 
 int         platformMock_ClearHardwareBreakpointCalls(void);
 uint32_t    platformMock_ClearHardwareBreakpointAddressArg(void);
@@ -86,6 +102,40 @@ uint32_t               platformMock_ClearHardwareWatchpointSizeArg(void);
 PlatformWatchpointType platformMock_ClearHardwareWatchpointTypeArg(void);
 void                   platformMock_ClearHardwareWatchpointException(uint32_t exceptionToThrow);
 
+/* Value watchpoints record their address, size, type and exception in the same places as regular watchpoints. */
+int                    platformMock_SetHardwareValueWatchpointCalls(void);
+uint32_t               platformMock_SetHardwareWatchpointValueArg(void);
+int                    platformMock_ClearHardwareValueWatchpointCalls(void);
+uint32_t               platformMock_ClearHardwareWatchpointValueArg(void);
+
+int         platformMock_StartProfilingCalls(void);
+uint32_t    platformMock_StartProfilingIntervalArg(void);
+void        platformMock_StartProfilingException(uint32_t exceptionToThrow);
+int         platformMock_StopProfilingCalls(void);
+void        platformMock_SetCpuClockFrequency(uint32_t frequency);
+int         platformMock_EnableCycleCounterCalls(void);
+void        platformMock_EnableCycleCounterException(uint32_t exceptionToThrow);
+void        platformMock_SetCycleCounter(uint32_t cycles);
+void        platformMock_SetCycleCounterIncrement(uint32_t cycles);
+int         platformMock_StartPerfCountersCalls(void);
+uint32_t    platformMock_StartPerfCountersIntervalArg(void);
+void        platformMock_StartPerfCountersException(uint32_t exceptionToThrow);
+int         platformMock_StopPerfCountersCalls(void);
+int         platformMock_HookIrqCalls(void);
+uint32_t    platformMock_HookIrqArg(void);
+void        platformMock_HookIrqException(uint32_t exceptionToThrow);
+int         platformMock_UnhookIrqCalls(void);
+uint32_t    platformMock_UnhookIrqArg(void);
+void        platformMock_SetPendingIrqs(uint32_t pendingMask);
+int         platformMock_StartSamplingCalls(void);
+uint32_t    platformMock_StartSamplingIntervalArg(void);
+void        platformMock_StartSamplingException(uint32_t exceptionToThrow);
+int         platformMock_StopSamplingCalls(void);
+int         platformMock_StartCpuLoadSamplingCalls(void);
+uint32_t    platformMock_StartCpuLoadSamplingIntervalArg(void);
+void        platformMock_StartCpuLoadSamplingException(uint32_t exceptionToThrow);
+int         platformMock_StopCpuLoadSamplingCalls(void);
+
 int platformMock_GetSemihostCallReturnValue(void);
 int platformMock_GetSemihostCallErrno(void);
 
@@ -110,6 +160,15 @@ void     platformMock_RtosSetThreadList(PlatformMockThread* pThreads, size_t thr
 uint32_t platformMock_RtosGetThreadStateInvalidAttempts(void);
 uint32_t platformMock_RtosGetRestorePrevThreadStateCallCount(void);
 
+void           platformMock_FsSetFile(const char* pFilename, const void* pData, uint32_t size, uint32_t lastModifiedTime);
+void           platformMock_FsSetError(int negatedErrno);
+const uint8_t* platformMock_FsGetFileData(void);
+uint32_t       platformMock_FsGetFileSize(void);
+int            platformMock_FsExists(void);
+int            platformMock_FsIsOpen(void);
+uint32_t       platformMock_FsGetOpenFlags(void);
+uint32_t       platformMock_FsGetOpenMode(void);
+
 int platformMock_GetSyncICacheToDCacheCalls(void);
 
 #endif /* PLATFORM_MOCK_H_ */
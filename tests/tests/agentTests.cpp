@@ -0,0 +1,403 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/agent.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(agent)
+{
+    int     m_expectedException;
+    uint8_t m_bytecode[256];
+    size_t  m_length;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        m_length = 0;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        SetContext(platformMock_GetContext());
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    void emit(uint8_t byte)
+    {
+        m_bytecode[m_length++] = byte;
+    }
+
+    void emitConst8(uint8_t value)
+    {
+        emit(0x22);
+        emit(value);
+    }
+
+    void emitConst64(uint64_t value)
+    {
+        emit(0x25);
+        for (int shift = 56 ; shift >= 0 ; shift -= 8)
+            emit((uint8_t)(value >> shift));
+    }
+
+    void emitPrintf(const char* pFormat, uint8_t argCount)
+    {
+        size_t length = strlen(pFormat) + 1;
+
+        // Function and channel.
+        emitConst8(0);
+        emitConst8(0);
+        emit(0x34);
+        emit(argCount);
+        emit((uint8_t)(length >> 8));
+        emit((uint8_t)length);
+        memcpy(&m_bytecode[m_length], pFormat, length);
+        m_length += length;
+    }
+
+    void emitEnd()
+    {
+        emit(0x27);
+    }
+
+    void run()
+    {
+        Agent_RunExpression(m_bytecode, m_length);
+    }
+};
+
+TEST(agent, EmptyExpression_ShouldDoNothing)
+{
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfWithNoArguments_ShouldSendOPacket)
+{
+    emitPrintf("Hi\n", 0);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O48690a#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfWithTwoArguments_ShouldFormatInOrder)
+{
+    emitConst8(2);
+    emitConst8(1);
+    emitPrintf("%d,%d", 2);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O312c32#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfIntegerConversions)
+{
+    emitConst64(0xFFFFFFFFFFFFFFFF);
+    emitConst8(0x7F);
+    emitConst8(0xAB);
+    emitConst8(0xAB);
+    emitConst8(8);
+    emitConst8(42);
+    emitConst8(42);
+    emitConst64(0xFFFFFFFFFFFFFFFE);
+    emitPrintf("%d|%+d|% 5d|%o|%#x|%#X|%u|%hhd", 8);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O2d327c2b34327c20202034327c31307c3078" "61627c305841427c3132377c2d31#"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfWidthAndPrecision)
+{
+    emitConst8(7);
+    emitConst8(7);
+    emitConst8(7);
+    emitConst8(7);
+    emitPrintf("[%3d][%-3d][%03d][%.3d]", 4);
+    emitEnd();
+    run();
+    // "[  7][7  ][007][007]"
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O5b2020375d5b372020" "5d5b3030375d5b3030375d#"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfCharAndPercent)
+{
+    emitConst8('A');
+    emitPrintf("%c%%", 1);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O4125#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfStringFromMemory)
+{
+    static const char string[] = "Hello";
+    emitConst64((size_t)string);
+    emitConst64((size_t)string);
+    emitConst64((size_t)string);
+    emitPrintf("%s|%.2s|%6s", 3);
+    emitEnd();
+    run();
+    // "Hello|He| Hello"
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O48656c6c6f7c48657c2048656c6c6f#"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfNullString)
+{
+    emitConst8(0);
+    emitPrintf("%s", 1);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O286e756c6c29#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, PrintfFloatConversion_ShouldThrow)
+{
+    emitConst8(1);
+    emitPrintf("%f", 1);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, PrintfWithTooFewArguments_ShouldThrow)
+{
+    emitConst8(1);
+    emitPrintf("%d %d", 2);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, PrintfOutputLargerThanPacket_ShouldSplitIntoMultiplePackets)
+{
+    platformMock_SetPacketBufferSize(1+2*4+4);
+    platformMock_CommInitReceiveData("+", "+");
+    emitPrintf("abcdef", 0);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O61626364#$O6566#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, Arithmetic_ShouldComputeResult)
+{
+    // ((3 + 4) * 6 - 2) / 5 % 3 = 8 % 3 = 2
+    emitConst8(3);
+    emitConst8(4);
+    emit(0x02);
+    emitConst8(6);
+    emit(0x04);
+    emitConst8(2);
+    emit(0x03);
+    emitConst8(5);
+    emit(0x06);
+    emitConst8(3);
+    emit(0x08);
+    emitPrintf("%d", 1);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O32#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, SignedOperations)
+{
+    // -8 / 2 = -4, -4 >> 1 = -2, -2 < 1 = 1
+    emitConst8(0xF8);
+    emit(0x16);
+    emit(8);
+    emitConst8(2);
+    emit(0x05);
+    emit(0x28);
+    emitConst8(1);
+    emit(0x0a);
+    emit(0x28);
+    emitConst8(1);
+    emit(0x14);
+    emitPrintf("%d %d %d", 3);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O31202d32202d34#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, DivideByZero_ShouldThrow)
+{
+    emitConst8(1);
+    emitConst8(0);
+    emit(0x06);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidValueException);
+}
+
+TEST(agent, StackUnderflow_ShouldThrow)
+{
+    emitConst8(1);
+    emit(0x02);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, StackOverflow_ShouldThrow)
+{
+    for (int i = 0 ; i < 17 ; i++)
+        emitConst8(i);
+    emitEnd();
+    run();
+    validateExceptionCode(bufferOverrunException);
+}
+
+TEST(agent, UnsupportedOpcode_ShouldThrow)
+{
+    emit(0x01);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, TruncatedImmediate_ShouldThrow)
+{
+    emit(0x24);
+    emit(0x00);
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, MemoryReferences_ShouldReadTargetMemory)
+{
+    static const uint32_t value = 0x12345678;
+    emitConst64((size_t)&value);
+    emit(0x19);
+    emitConst64((size_t)&value);
+    emit(0x17);
+    emitPrintf("%x %x", 2);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O3738203132333435363738#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, MemoryReferenceFault_ShouldThrow)
+{
+    static const uint32_t value = 0x12345678;
+    platformMock_FaultOnSpecificMemoryCall(1);
+    emitConst64((size_t)&value);
+    emit(0x19);
+    emitEnd();
+    run();
+    validateExceptionCode(memFaultException);
+}
+
+TEST(agent, Register_ShouldPushContextValue)
+{
+    platformMock_GetContextEntries()[2] = 0x1234;
+    emit(0x26);
+    emit(0x00);
+    emit(0x02);
+    emitPrintf("%x", 1);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O31323334#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, InvalidRegister_ShouldThrow)
+{
+    emit(0x26);
+    emit(0x00);
+    emit(0x20);
+    emitEnd();
+    run();
+    validateExceptionCode(bufferOverrunException);
+}
+
+TEST(agent, IfGoto_ShouldBranchOnlyWhenConditionIsTrue)
+{
+    // 0: const8 0; 2: if_goto 12; 5: const8 1; 7: if_goto 12; 10: end; 11: end; 12: printf...
+    emitConst8(0);
+    emit(0x20);
+    emit(0x00);
+    emit(12);
+    emitConst8(1);
+    emit(0x20);
+    emit(0x00);
+    emit(12);
+    emitEnd();
+    emitEnd();
+    emitPrintf("!", 0);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O21#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, GotoOutsideExpression_ShouldThrow)
+{
+    emit(0x21);
+    emit(0x01);
+    emit(0x00);
+    emitEnd();
+    run();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(agent, StackManipulation)
+{
+    // 1 2 3 rot => 3 1 2, swap => 3 2 1, pick 2 => 3 2 1 3, pop => 3 2 1
+    emitConst8(1);
+    emitConst8(2);
+    emitConst8(3);
+    emit(0x33);
+    emit(0x2b);
+    emit(0x32);
+    emit(2);
+    emit(0x29);
+    emitPrintf("%d%d%d", 3);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O313233#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(agent, ZeroExtend_ShouldTruncateValue)
+{
+    emitConst64(0x123456789ABCDEF0);
+    emit(0x2a);
+    emit(16);
+    emitPrintf("%llx", 1);
+    emitEnd();
+    run();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O64656630#"), platformMock_CommGetTransmittedData() );
+}
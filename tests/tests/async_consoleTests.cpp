@@ -0,0 +1,354 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/async_console.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(asyncConsole)
+{
+    char m_buffer[8];
+    char m_largeBuffer[MRI_ASYNC_CONSOLE_PACKET_SIZE + 1];
+
+    void setup()
+    {
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        mriSetConsoleBuffer(m_buffer, sizeof(m_buffer));
+        platformMock_CommInitReceiveData("", "", "");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( noException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetConsoleBuffer(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    void write(const char* pString)
+    {
+        CHECK_TRUE ( AsyncConsole_Write(pString, strlen(pString)) );
+    }
+
+    void receive(const char* pData)
+    {
+        platformMock_CommInitReceiveData(pData, "", "");
+    }
+
+    void resetTransmittedData()
+    {
+        platformMock_CommInitTransmitDataBuffer(256);
+    }
+};
+
+
+TEST(asyncConsole, Write_NoBuffer_ShouldReturnZeroSoCallerSendsItBeforeResuming)
+{
+    mriSetConsoleBuffer(NULL, 0);
+    LONGS_EQUAL ( 0, AsyncConsole_Write("Test", 4) );
+}
+
+TEST(asyncConsole, Write_TooLargeForFreeSpace_ShouldReturnZeroAndQueueNothing)
+{
+    write("Test");
+    LONGS_EQUAL ( 0, AsyncConsole_Write("Hello", 5) );
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54657374#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, Write_ShouldNotTransmitAnythingUntilInterrupt)
+{
+    write("Test\n");
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_NothingQueued_ShouldSendNothingAndDisableTransmitInterrupt)
+{
+    LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_CommGetTransmitInterruptEnabled() );
+    LONGS_EQUAL ( 1, platformMock_CommGetSetTransmitInterruptCallCount() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_TransmitterAlwaysReady_ShouldSendWholePacketAndDisableTransmitInterrupt)
+{
+    write("Test\n");
+    LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O546573740a#"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_CommGetTransmitInterruptEnabled() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_TransmitterOnlyReadyForTwoChars_ShouldSendPacketAcrossMultipleInterrupts)
+{
+    write("T");
+    platformMock_CommSetTransmitReadyCount(2);
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "$O", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_CommGetTransmitInterruptEnabled() );
+
+    platformMock_CommSetTransmitReadyCount(2);
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "$O54", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_CommGetTransmitInterruptEnabled() );
+
+    platformMock_CommSetTransmitReadyCount(3);
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54#"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_CommGetTransmitInterruptEnabled() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_WaitingForAck_ShouldNotSendNextPacket)
+{
+    write("T");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    write("e");
+    resetTransmittedData();
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_AckReceived_ShouldSendNextPacketWithOnlyNewData)
+{
+    write("T");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    write("e");
+    resetTransmittedData();
+    receive("+");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O65#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_AckFreesSpace_ShouldAllowLargerWrite)
+{
+    write("Test");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    LONGS_EQUAL ( 0, AsyncConsole_Write("Hello", 5) );
+    receive("+");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    write("Hello");
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_NakReceived_ShouldResendSamePacket)
+{
+    write("Te");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    resetTransmittedData();
+    receive("-");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O5465#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_ControlCWhileWaitingForAck_ShouldReturnNonZeroToEnterDebugger)
+{
+    write("T");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    receive("\x03");
+        LONGS_EQUAL ( 1, AsyncConsole_ProcessCommInterrupt() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_DataReceivedWhileIdle_ShouldReturnNonZeroAndLeaveItForDebugger)
+{
+    receive("$");
+        LONGS_EQUAL ( 1, AsyncConsole_ProcessCommInterrupt() );
+    LONGS_EQUAL ( '$', Platform_CommReceiveChar() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_MoreThanPacketSizeQueued_ShouldSplitAcrossPackets)
+{
+    char expected[2 + 2 * MRI_ASYNC_CONSOLE_PACKET_SIZE + 2];
+
+    memset(m_largeBuffer, 'a', sizeof(m_largeBuffer));
+    mriSetConsoleBuffer(m_largeBuffer, sizeof(m_largeBuffer));
+    CHECK_TRUE ( AsyncConsole_Write(m_largeBuffer, sizeof(m_largeBuffer)) );
+    strcpy(expected, "$O");
+    for (int i = 0 ; i < MRI_ASYNC_CONSOLE_PACKET_SIZE ; i++)
+        strcat(expected, "61");
+    strcat(expected, "#");
+
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData(expected), platformMock_CommGetTransmittedData() );
+    resetTransmittedData();
+    receive("+");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O61#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, ProcessCommInterrupt_DataWrapsAroundEndOfRingBuffer_ShouldSendItInOrder)
+{
+    write("ABCDEF");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    receive("+");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    write("GHIJ");
+    resetTransmittedData();
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O4748494a#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, FinishPacket_PartiallySentPacket_ShouldCompleteItAndWaitForAck)
+{
+    write("T");
+    platformMock_CommSetTransmitReadyCount(3);
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    receive("+");
+        AsyncConsole_FinishPacket();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54#"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_CommGetTransmitInterruptEnabled() );
+    LONGS_EQUAL ( 0, Platform_CommHasReceiveData() );
+
+    resetTransmittedData();
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, FinishPacket_NakReceived_ShouldResendPacketUntilAcked)
+{
+    write("T");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    resetTransmittedData();
+    receive("-+");
+        AsyncConsole_FinishPacket();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, FinishPacket_Idle_ShouldSendNothing)
+{
+    write("T");
+        AsyncConsole_FinishPacket();
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, Flush_ShouldSendQueuedDataAsConsolePackets)
+{
+    write("Test");
+    receive("+");
+        AsyncConsole_Flush();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54657374#"), platformMock_CommGetTransmittedData() );
+
+    resetTransmittedData();
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, Flush_PacketInFlight_ShouldFinishItBeforeSendingRest)
+{
+    write("T");
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    write("e");
+    resetTransmittedData();
+    platformMock_CommInitReceiveData("+", "+", "");
+        AsyncConsole_Flush();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O65#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, Resume_NothingQueued_ShouldLeaveTransmitInterruptDisabled)
+{
+        AsyncConsole_Resume();
+    LONGS_EQUAL ( 0, platformMock_CommGetTransmitInterruptEnabled() );
+    LONGS_EQUAL ( 0, platformMock_CommGetSetTransmitInterruptCallCount() );
+}
+
+TEST(asyncConsole, Resume_DataQueued_ShouldEnableTransmitInterrupt)
+{
+    write("T");
+        AsyncConsole_Resume();
+    LONGS_EQUAL ( 1, platformMock_CommGetTransmitInterruptEnabled() );
+}
+
+TEST(asyncConsole, WriteBuffered_NoRingBuffer_ShouldHoldPartialLine)
+{
+    mriSetConsoleBuffer(NULL, 0);
+        AsyncConsole_WriteBuffered("T", 1);
+        AsyncConsole_WriteBuffered("e", 1);
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, WriteBuffered_NoRingBuffer_ShouldSendLineOnNewline)
+{
+    mriSetConsoleBuffer(NULL, 0);
+    receive("+");
+        AsyncConsole_WriteBuffered("T", 1);
+        AsyncConsole_WriteBuffered("e\nx", 3);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54650a#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, WriteBuffered_NoRingBuffer_ShouldSendLineOnceFull)
+{
+    char expected[2 + 2 * MRI_ASYNC_CONSOLE_PACKET_SIZE + 2];
+
+    mriSetConsoleBuffer(NULL, 0);
+    memset(m_largeBuffer, 'a', sizeof(m_largeBuffer));
+    strcpy(expected, "$O");
+    for (int i = 0 ; i < MRI_ASYNC_CONSOLE_PACKET_SIZE ; i++)
+        strcat(expected, "61");
+    strcat(expected, "#");
+    receive("+");
+        AsyncConsole_WriteBuffered(m_largeBuffer, sizeof(m_largeBuffer));
+    STRCMP_EQUAL ( platformMock_CommChecksumData(expected), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, FlushLine_ShouldSendPartialLine)
+{
+    mriSetConsoleBuffer(NULL, 0);
+        AsyncConsole_WriteBuffered("Te", 2);
+    receive("+");
+        AsyncConsole_FlushLine();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O5465#"), platformMock_CommGetTransmittedData() );
+
+    resetTransmittedData();
+        AsyncConsole_FlushLine();
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, Flush_ShouldAlsoSendPartialLine)
+{
+    mriSetConsoleBuffer(NULL, 0);
+        AsyncConsole_WriteBuffered("Te", 2);
+    receive("+");
+        AsyncConsole_Flush();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O5465#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, WriteBuffered_WithRingBuffer_ShouldQueueInRing)
+{
+        AsyncConsole_WriteBuffered("T", 1);
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(asyncConsole, WriteBuffered_RingBufferFull_ShouldFlushRingAndThenQueue)
+{
+    write("Testing");
+    receive("+");
+        AsyncConsole_WriteBuffered("12", 2);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O54657374696e67#"), platformMock_CommGetTransmittedData() );
+
+    resetTransmittedData();
+        LONGS_EQUAL ( 0, AsyncConsole_ProcessCommInterrupt() );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O3132#"), platformMock_CommGetTransmittedData() );
+}
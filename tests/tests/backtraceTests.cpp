@@ -0,0 +1,180 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/context.h>
+#include <core/backtrace.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* Frame and thread values are chosen to be printable in little endian order so that the binary qXfer data can be
+   compared as strings. Reads also skip over the frameCount fields since their upper bytes are always 0. */
+TEST_GROUP(backtrace)
+{
+    uintmri_t      m_otherEntries[4];
+    ContextSection m_otherSection;
+    MriContext     m_otherContext;
+
+    void setup()
+    {
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_GetContextEntries()[0] = 0x34333231;
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( noException, getExceptionCode() );
+        clearExceptionCode();
+        platformMock_Uninit();
+    }
+
+    void setOtherThread()
+    {
+        static const uint32_t threads[] = { 0x41414141, 0x42424242 };
+
+        memset(m_otherEntries, 0, sizeof(m_otherEntries));
+        m_otherEntries[0] = 0x38373635;
+        m_otherSection.pValues = m_otherEntries;
+        m_otherSection.count = sizeof(m_otherEntries) / sizeof(m_otherEntries[0]);
+        Context_Init(&m_otherContext, &m_otherSection, 1);
+        platformMock_RtosSetHaltedThreadId(0x41414141);
+        platformMock_RtosSetThreads(threads, 2);
+        platformMock_RtosSetThreadContext(0x42424242, &m_otherContext);
+    }
+};
+
+TEST(backtrace, QueryXfer_NonNullAnnex_ShouldReturnErrorResponse)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read:target.xml:0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_NoRtosOrUnwindFrames_ShouldOnlyReturnHaltedProgramCounter)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::4,1#",
+                                                "+$qXfer:mri-backtrace:read::8,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$m\x01#+$l1234#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_ReadPastEnd_ShouldReturnEmptyLastPacket)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::c,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_WithUnwindFrames_ShouldReturnCallersAfterProgramCounter)
+{
+    static const uint32_t frames[] = { 0x64636261, 0x68676665 };
+
+    platformMock_SetUnwindFrames(frames, 2);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::4,1#",
+                                                "+$qXfer:mri-backtrace:read::8,8#",
+                                                "+$qXfer:mri-backtrace:read::10,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$m\x03#+$m1234abcd#+$lefgh#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_TooManyUnwindFrames_ShouldTruncateToMaximum)
+{
+    uint32_t frames[MRI_BACKTRACE_MAX_FRAMES + 4];
+
+    for (size_t i = 0 ; i < sizeof(frames)/sizeof(frames[0]) ; i++)
+        frames[i] = 0x61616161 + i;
+    platformMock_SetUnwindFrames(frames, sizeof(frames)/sizeof(frames[0]));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::4,1#",
+                                                "+$qXfer:mri-backtrace:read::44,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    // The last frame that fits is frames[MRI_BACKTRACE_MAX_FRAMES - 2] since the program counter comes first.
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$m\x10#+$loaaa#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_WithRtos_ShouldReturnHaltedThreadFirstThenOtherThreads)
+{
+    static const uint32_t frames[] = { 0x64636261 };
+
+    setOtherThread();
+    platformMock_SetUnwindFrames(frames, 1);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::0,4#",
+                                                "+$qXfer:mri-backtrace:read::8,8#",
+                                                "+$qXfer:mri-backtrace:read::10,4#",
+                                                "+$qXfer:mri-backtrace:read::14,1#",
+                                                "+$qXfer:mri-backtrace:read::18,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05thread:41414141;responseT#"
+                                                 "+$mAAAA#+$m1234abcd#+$mBBBB#+$m\x02#+$l5678abcd#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_ReadAcrossThreadRecords_ShouldReturnBothInOnePacket)
+{
+    setOtherThread();
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::8,8#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05thread:41414141;responseT#+$m1234BBBB#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_ThreadWithoutContext_ShouldBeSkipped)
+{
+    static const uint32_t threads[] = { 0x41414141, 0x43434343 };
+
+    platformMock_RtosSetHaltedThreadId(0x41414141);
+    platformMock_RtosSetThreads(threads, 2);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::8,20#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05thread:41414141;responseT#+$l1234#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, QueryXfer_FramesWithSpecialCharacters_ShouldBeEscaped)
+{
+    platformMock_GetContextEntries()[0] = 0x2A7D2324;
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-backtrace:read::8,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l}\x04}\x03}]}\x0a#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(backtrace, GetRecordSize_ShouldOnlyCountUsedFrames)
+{
+    static const uint32_t frames[] = { 0x64636261, 0x68676665 };
+
+    platformMock_SetUnwindFrames(frames, 2);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    const BacktraceRecord* pRecord = Backtrace_GetFirstRecord();
+    LONGS_EQUAL ( 3, pRecord->frameCount );
+    LONGS_EQUAL ( 8 + 3 * 4, Backtrace_GetRecordSize(pRecord) );
+    POINTERS_EQUAL ( NULL, Backtrace_GetNextRecord() );
+}
@@ -0,0 +1,288 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/binlog.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+static const char g_format[] = "Motor %d speed %u";
+
+TEST_GROUP(binlog)
+{
+    int       m_expectedException;
+    uint8_t   m_buffer[24];
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        memset(m_buffer, 0xFF, sizeof(m_buffer));
+        mriSetLogBuffer(m_buffer, sizeof(m_buffer));
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetLogBuffer(NULL, 0);
+        BinLog_Reset();
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    void validateRecord(const uint8_t* pRecord, const char* pFormat, uint32_t argCount, const uint32_t* pArgs)
+    {
+        uint32_t address;
+
+        memcpy(&address, pRecord, sizeof(address));
+        UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)pFormat, address );
+        LONGS_EQUAL ( argCount, pRecord[4] );
+        for (uint32_t i = 0 ; i < argCount ; i++)
+        {
+            uint32_t arg;
+            memcpy(&arg, &pRecord[MRI_BINLOG_HEADER_SIZE + i * sizeof(arg)], sizeof(arg));
+            UNSIGNED_LONGS_EQUAL ( pArgs[i], arg );
+        }
+    }
+
+    void validateWriteRequest(const char* pTransmitted, uint32_t expectedSize)
+    {
+        const char* pWrite = strstr(pTransmitted, "$Fwrite,05,");
+        char*       pEnd = NULL;
+
+        CHECK_TRUE ( pWrite != NULL );
+        UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)m_buffer, strtoul(pWrite + 11, &pEnd, 16) );
+        UNSIGNED_LONGS_EQUAL ( expectedSize, strtoul(pEnd + 1, NULL, 16) );
+    }
+};
+
+TEST(binlog, Start_WithoutBuffer_ShouldThrow)
+{
+    mriSetLogBuffer(NULL, 0);
+    BinLog_Start("mri.log");
+    validateExceptionCode(notFoundException);
+    CHECK_FALSE ( BinLog_IsRunning() );
+}
+
+TEST(binlog, Start_BufferTooSmallForLargestRecord_ShouldThrow)
+{
+    mriSetLogBuffer(m_buffer, MRI_BINLOG_HEADER_SIZE + MRI_LOG_MAX_ARGUMENTS * sizeof(uint32_t) - 1);
+    BinLog_Start("mri.log");
+    validateExceptionCode(bufferOverrunException);
+}
+
+TEST(binlog, Start_EmptyFilename_ShouldThrow)
+{
+    BinLog_Start("");
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(binlog, Write_NotRunning_ShouldBeIgnored)
+{
+    mriLogWrite(g_format, 1, 0x12345678);
+    LONGS_EQUAL ( 0xFF, m_buffer[0] );
+    LONGS_EQUAL ( 0, platformMock_GetLogFlushCalls() );
+}
+
+TEST(binlog, Write_ShouldPackFormatAddressCountAndArguments)
+{
+    static const uint32_t args1[] = { 0x12345678, 0xFFFFFFFF };
+    static const uint32_t args2[] = { 0xDEADBEEF };
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 2, args1[0], args1[1]);
+    mriLogWrite(g_format, 1, args2[0]);
+    validateRecord(m_buffer, g_format, 2, args1);
+    validateRecord(m_buffer + MRI_BINLOG_HEADER_SIZE + 2 * sizeof(uint32_t), g_format, 1, args2);
+    LONGS_EQUAL ( 0xFF, m_buffer[2 * MRI_BINLOG_HEADER_SIZE + 3 * sizeof(uint32_t)] );
+}
+
+TEST(binlog, Write_MacroWithNoArguments_ShouldRecordZeroCount)
+{
+    BinLog_Start("mri.log");
+    mriLog0("Hello");
+    LONGS_EQUAL ( 0, m_buffer[4] );
+    LONGS_EQUAL ( 0xFF, m_buffer[MRI_BINLOG_HEADER_SIZE] );
+}
+
+TEST(binlog, Write_TooManyArguments_ShouldBeIgnored)
+{
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, MRI_LOG_MAX_ARGUMENTS + 1, 1, 2, 3, 4, 5);
+    LONGS_EQUAL ( 0xFF, m_buffer[0] );
+}
+
+TEST(binlog, Write_BufferFull_ShouldFlushToHostAndStartOver)
+{
+    static const uint32_t args[] = { 1, 2 };
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 2, args[0], args[1]);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$Fd#");
+        mriLogWrite(g_format, 2, args[1], args[0]);
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    static const uint32_t expectedArgs[] = { 2, 1 };
+    LONGS_EQUAL ( 1, platformMock_GetLogFlushCalls() );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fopen,") != NULL );
+    CHECK_TRUE ( strstr(pTransmitted, "/08,0601,01a4#") != NULL );
+    validateWriteRequest(pTransmitted, 13);
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    validateRecord(m_buffer, g_format, 2, expectedArgs);
+}
+
+TEST(binlog, Write_BufferFullTwice_ShouldOnlyOpenFileOnce)
+{
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 2, 1, 2);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$Fd#");
+        mriLogWrite(g_format, 2, 3, 4);
+    platformMock_CommInitTransmitDataBuffer(1024);
+    platformMock_CommInitReceiveChecksummedData("+$Fd#");
+        mriLogWrite(g_format, 2, 5, 6);
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    LONGS_EQUAL ( 2, platformMock_GetLogFlushCalls() );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fopen,") == NULL );
+    validateWriteRequest(pTransmitted, 13);
+}
+
+TEST(binlog, Write_FailToOpenFile_ShouldStopLogging)
+{
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 2, 1, 2);
+    platformMock_CommInitReceiveChecksummedData("+$F-1,2#", "+");
+        mriLogWrite(g_format, 2, 3, 4);
+
+    char expected[128];
+    stringToHex(expected, "Failed to open log output file.\r\n");
+    CHECK_TRUE ( strstr(platformMock_CommGetTransmittedData(), expected) != NULL );
+    CHECK_FALSE ( BinLog_IsRunning() );
+    CHECK_TRUE ( BinLog_Flush() );
+}
+
+TEST(binlog, Flush_NothingLogged_ShouldDoNothing)
+{
+    BinLog_Start("mri.log");
+    CHECK_TRUE ( BinLog_Flush() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(binlog, DebugException_ShouldFlushRecordsBeforeStopResponse)
+{
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 1, 1);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F9#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    const char* pStop = strstr(pTransmitted, "$T05responseT#");
+    CHECK_TRUE ( pStop != NULL );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fopen,") < pStop );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fwrite,") < pStop );
+    validateWriteRequest(pTransmitted, 9);
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(binlog, MonitorLogStart_WithoutBuffer_ShouldFail)
+{
+    mriSetLogBuffer(NULL, 0);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("log start"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetLogBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_LOG_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(binlog, MonitorLogStart_InvalidSubcommand_ShouldShowUsage)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("log begin"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor log start [FILENAME]|stop\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( BinLog_IsRunning() );
+}
+
+TEST(binlog, MonitorLogStart_WithFilename_ShouldStartLoggingToThatFile)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("log start out.bin"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Logging started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_TRUE ( BinLog_IsRunning() );
+
+    mriLogWrite(g_format, 2, 1, 2);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$Fd#");
+        mriLogWrite(g_format, 2, 3, 4);
+    CHECK_TRUE ( strstr(platformMock_CommGetTransmittedData(), "/08,0601,01a4#") != NULL );
+}
+
+TEST(binlog, MonitorLogStop_ShouldWriteRemainingRecordsAndCloseFileOnContinue)
+{
+    BinLog_Start("mri.log");
+    mriLogWrite(g_format, 2, 1, 2);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$Fd#");
+        mriLogWrite(g_format, 2, 3, 4);
+    platformMock_CommInitTransmitDataBuffer(1024);
+    platformMock_CommInitReceiveChecksummedData("+$Fd#", monitorCommand("log stop"), "++$c#", "+$F0#");
+        mriDebugException(platformMock_GetContext());
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    char        expected[128];
+    stringToHex(expected, "Logging stopped.\r\n");
+    CHECK_TRUE ( strstr(pTransmitted, expected) != NULL );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fclose,05#") != NULL );
+    CHECK_FALSE ( BinLog_IsRunning() );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 1, platformMock_GetLeavingDebuggerCalls() );
+}
+
+TEST(binlog, MonitorLogStop_WhenNeverOpened_ShouldNotIssueFileIO)
+{
+    BinLog_Start("mri.log");
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("log stop"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Logging stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( BinLog_IsRunning() );
+}
+
+TEST(binlog, Detach_ShouldDropLogWithoutFileIO)
+{
+    BinLog_Start("mri.log");
+    platformMock_CommInitReceiveChecksummedData("+$D#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#"), platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( BinLog_IsRunning() );
+}
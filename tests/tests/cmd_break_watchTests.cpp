@@ -12,6 +12,7 @@
    See the License for the specific language governing permissions and
    limitations under the License.
 */
+#include <string.h>
 
 extern "C"
 {
@@ -48,6 +49,22 @@ TEST_GROUP(cmdBreakWatch)
         m_expectedException = expectedExceptionCode;
         LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
     }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void hitBreakpoint(const char* pExpectedTransmit)
+    {
+        Platform_SetProgramCounter(INITIAL_PC);
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( pExpectedTransmit, platformMock_CommGetTransmittedData() );
+    }
 };
 
 TEST(cmdBreakWatch, SetHardwareBreakpoint)
@@ -249,4 +266,108 @@ TEST(cmdBreakWatch, InvalidClearHardwareBreakWatchpoint_ShouldReturnEmptyRespons
     STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$#+"), platformMock_CommGetTransmittedData() );
     CHECK_EQUAL( 0, platformMock_ClearHardwareBreakpointCalls() );
     CHECK_EQUAL( 0, platformMock_ClearHardwareWatchpointCalls() );
-}
\ No newline at end of file
+}
+/* const8 5; const8 0; const8 0; printf 1 arg "x=%d\n"; end */
+#define DPRINTF_BYTECODE "22052200220034010006783d25640a0027"
+
+TEST(cmdBreakWatch, SetHardwareBreakpointWithCommands_ShouldReturnOK)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X11," DPRINTF_BYTECODE "#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+"), platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL( 1, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_EQUAL( 0x10000000, platformMock_SetHardwareBreakpointAddressArg() );
+}
+
+TEST(cmdBreakWatch, HitBreakpointWithCommands_ShouldSendConsoleOutputAndResumeWithoutStopping)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X11," DPRINTF_BYTECODE "#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    hitBreakpoint(platformMock_CommChecksumData("$O783d350a#"));
+    CHECK_TRUE ( Platform_IsSingleStepping() );
+    CHECK_EQUAL( 1, platformMock_ClearHardwareBreakpointCalls() );
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O783d350a#"), platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+    CHECK_EQUAL( 2, platformMock_SetHardwareBreakpointCalls() );
+}
+
+TEST(cmdBreakWatch, HitBreakpointWithTwoExpressions_ShouldRunBoth)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X11," DPRINTF_BYTECODE "X11," DPRINTF_BYTECODE "#",
+                                                "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    platformMock_CommInitReceiveChecksummedData("+", "+");
+    Platform_SetProgramCounter(INITIAL_PC);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    platformMock_CommInitTransmitDataBuffer(512);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O783d350a#$O783d350a#"), platformMock_CommGetTransmittedData() );
+    CHECK_TRUE ( Platform_IsSingleStepping() );
+}
+
+TEST(cmdBreakWatch, HitBreakpointAfterCommandsRemoved_ShouldStopNormally)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X11," DPRINTF_BYTECODE "#",
+                                                "+$z1,10000000,2#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+
+    hitBreakpoint(platformMock_CommChecksumData("$T05responseT#+"));
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+}
+
+TEST(cmdBreakWatch, HitBreakpointWithUnsupportedOpcode_ShouldStopNormally)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X2,0127#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    hitBreakpoint(platformMock_CommChecksumData("$T05responseT#+"));
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+}
+
+TEST(cmdBreakWatch, HitDifferentBreakpoint_ShouldStopNormally)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000010,2;cmds:1,X11," DPRINTF_BYTECODE "#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    hitBreakpoint(platformMock_CommChecksumData("$T05responseT#+"));
+}
+
+TEST(cmdBreakWatch, SetHardwareBreakpointWithCommandsOverflowingStorage_ShouldReturnOverrunErrorResponse)
+{
+    char packet[512];
+
+    /* The first expression plus its length prefix exactly fills the 128 byte storage so the second must fail. */
+    strcpy(packet, "+$Z1,10000000,2;cmds:1,X7e,");
+    for (int i = 0 ; i < 0x7e ; i++)
+        strcat(packet, "27");
+    strcat(packet, "X1,27#");
+    platformMock_SetPacketBufferSize(sizeof(packet));
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_BUFFER_OVERRUN "#+"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL( 0, platformMock_SetHardwareBreakpointCalls() );
+}
+
+TEST(cmdBreakWatch, SetHardwareBreakpointWithUnknownOption_ShouldReturnErrorResponse)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;X2,0127#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL( 0, platformMock_SetHardwareBreakpointCalls() );
+}
+
+TEST(cmdBreakWatch, SetHardwareBreakpointWithTruncatedCommands_ShouldReturnErrorResponse)
+{
+    platformMock_CommInitReceiveChecksummedData("+$Z1,10000000,2;cmds:1,X11,2205#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL( 0, platformMock_SetHardwareBreakpointCalls() );
+}
@@ -228,3 +228,17 @@ TEST(cmdFile, IssueGdbFileRenameRequest_ReturnSuccess)
     CHECK_EQUAL ( 0, GetSemihostErrno() );
     CHECK_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
 }
+
+TEST(cmdFile, IssueGdbGetTimeOfDayRequest_ReturnSuccess)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        IssueGdbGetTimeOfDayRequest(0x11111111);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Fgettimeofday,11111111,00#+"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+    CHECK_FALSE ( WasControlCFlagSentFromGdb() );
+    CHECK_FALSE ( WasSemihostCallCancelledByGdb() );
+    CHECK_EQUAL ( 0, GetSemihostReturnCode() );
+    CHECK_EQUAL ( 0, GetSemihostErrno() );
+    CHECK_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
@@ -199,6 +199,102 @@ TEST(cmdMemory, MemoryRead8_FaultOnLastOfThreeBytes)
     STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$1234#+"), platformMock_CommGetTransmittedData() );
 }
 
+TEST(cmdMemory, BinaryMemoryRead32Aligned)
+{
+    uint32_t value = 0x41424344;
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,4#", (size_t)&value);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$bDCBA#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead16Aligned)
+{
+    uint16_t value = 0x4142;
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,2#", (size_t)&value);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$bBA#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead32Unaligned)
+{
+    char     values[] = "ABCDEFGH";
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,4#", ((size_t)values) + 1);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$bBCDE#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead8_ShouldEscapeSpecialBytes)
+{
+    uint8_t  values[] = { 'a', '$', '#', '}', '*', 'z' };
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,6#", (size_t)values);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$ba}\x04}\x03}]}\x0az#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead_PacketBufferTooSmall_ShouldReturnAsManyBytesAsFit)
+{
+    char     values[] = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAA$BC";
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,20#", (size_t)values);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+    platformMock_SetPacketBufferSize(4+1+30);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$bAAAAAAAAAAAAAAAAAAAAAAAAAAAAA#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead_ZeroLength_ShouldReturnEmptyData)
+{
+    uint8_t  value = 0x41;
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,0#", (size_t)&value);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$b#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead_InvalidParameterSeparator_ErrorResponse)
+{
+    uint8_t  value = 0x41;
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx:1#", (size_t)&value);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead32_FaultAndReturnNoBytes)
+{
+    uint32_t value = 0x41424344;
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,4#", (size_t)&value);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+    platformMock_FaultOnSpecificMemoryCall(1);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$E03#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdMemory, BinaryMemoryRead8_FaultOnLastOfThreeBytes)
+{
+    uint8_t  values[3] = {0x41, 0x42, 0x43};
+    char     packet[64];
+    snprintf(packet, sizeof(packet), "+$x%016lx,3#", (size_t)values);
+    platformMock_CommInitReceiveChecksummedData(packet, "+$c#");
+    platformMock_FaultOnSpecificMemoryCall(3);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$bAB#+"), platformMock_CommGetTransmittedData() );
+}
+
 
 
 TEST(cmdMemory, MemoryWrite64Aligned)
@@ -88,7 +88,7 @@ TEST(cmdQuery, QuerySupported)
     platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
         mriDebugException(platformMock_GetContext());
     STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
-                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;PacketSize=89#+"),
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;PacketSize=89#+"),
                                                  platformMock_CommGetTransmittedData() );
 }
 
@@ -270,19 +270,44 @@ TEST(cmdQuery, QueryRcmd_ShowFault_ShouldDumpException)
 TEST(cmdQuery, QueryRcmd_Help_ShouldDisplaySupportedCommands)
 {
     const char* pCommand = monitorCommand("help");
-    platformMock_CommInitReceiveChecksummedData(pCommand, "++++$c#");
+    platformMock_CommInitTransmitDataBuffer(2048);
+    platformMock_CommInitReceiveChecksummedData(pCommand, "++++++++++++++++$c#");
     LONGS_EQUAL( 0, platformMock_GetResetDeviceCalls() );
         mriDebugException(platformMock_GetContext());
-    char expectedConsoleOutput[3][64];
-    char expectedTransmitData[512];
+    char expectedConsoleOutput[15][128];
+    char expectedTransmitData[4096];
     stringToHex(expectedConsoleOutput[0], "Supported monitor commands:\r\n");
     stringToHex(expectedConsoleOutput[1], "reset\r\n");
     stringToHex(expectedConsoleOutput[2], "showfault\r\n");
+    stringToHex(expectedConsoleOutput[3], "watchvalue ADDRESS [VALUE]\r\n");
+    stringToHex(expectedConsoleOutput[4], "profile start [CYCLES]|stop|dump [FILENAME]\r\n");
+    stringToHex(expectedConsoleOutput[5], "time [START END|stop]\r\n");
+    stringToHex(expectedConsoleOutput[6], "perf start [CYCLES]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[7], "irqstats start IRQ [IRQ...]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[8], "sample start CYCLES ADDR SIZE [...]|stop\r\n");
+    stringToHex(expectedConsoleOutput[9], "log start [FILENAME]|stop\r\n");
+    stringToHex(expectedConsoleOutput[10], "record start|stop\r\n");
+    stringToHex(expectedConsoleOutput[11], "coverage [start ADDRESS COUNT|stop]\r\n");
+    stringToHex(expectedConsoleOutput[12], "cpuload start [CYCLES]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[13], "coredump [FILENAME]\r\n");
+    stringToHex(expectedConsoleOutput[14], "snapshot save|restore FILENAME\r\n");
     snprintf(expectedTransmitData, sizeof(expectedTransmitData),
-             "$T05responseT#+$O%s#$O%s#$O%s#$OK#+",
+             "$T05responseT#+$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$OK#+",
              expectedConsoleOutput[0],
              expectedConsoleOutput[1],
-             expectedConsoleOutput[2]);
+             expectedConsoleOutput[2],
+             expectedConsoleOutput[3],
+             expectedConsoleOutput[4],
+             expectedConsoleOutput[5],
+             expectedConsoleOutput[6],
+             expectedConsoleOutput[7],
+             expectedConsoleOutput[8],
+             expectedConsoleOutput[9],
+             expectedConsoleOutput[10],
+             expectedConsoleOutput[11],
+             expectedConsoleOutput[12],
+             expectedConsoleOutput[13],
+             expectedConsoleOutput[14]);
     STRCMP_EQUAL ( platformMock_CommChecksumData(expectedTransmitData),
                    platformMock_CommGetTransmittedData() );
 }
@@ -290,25 +315,153 @@ TEST(cmdQuery, QueryRcmd_Help_ShouldDisplaySupportedCommands)
 TEST(cmdQuery, QueryRcmd_UnknownMonitorCommand_ShouldDisplayErrorAndHelp)
 {
     const char* pCommand = monitorCommand("unknown");
-    platformMock_CommInitReceiveChecksummedData(pCommand, "+++++$c#");
+    platformMock_CommInitTransmitDataBuffer(2048);
+    platformMock_CommInitReceiveChecksummedData(pCommand, "+++++++++++++++++$c#");
     LONGS_EQUAL( 0, platformMock_GetResetDeviceCalls() );
         mriDebugException(platformMock_GetContext());
-    char expectedConsoleOutput[4][64];
-    char expectedTransmitData[512];
+    char expectedConsoleOutput[16][128];
+    char expectedTransmitData[4096];
     stringToHex(expectedConsoleOutput[0], "Unrecognized monitor command!\r\n");
     stringToHex(expectedConsoleOutput[1], "Supported monitor commands:\r\n");
     stringToHex(expectedConsoleOutput[2], "reset\r\n");
     stringToHex(expectedConsoleOutput[3], "showfault\r\n");
+    stringToHex(expectedConsoleOutput[4], "watchvalue ADDRESS [VALUE]\r\n");
+    stringToHex(expectedConsoleOutput[5], "profile start [CYCLES]|stop|dump [FILENAME]\r\n");
+    stringToHex(expectedConsoleOutput[6], "time [START END|stop]\r\n");
+    stringToHex(expectedConsoleOutput[7], "perf start [CYCLES]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[8], "irqstats start IRQ [IRQ...]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[9], "sample start CYCLES ADDR SIZE [...]|stop\r\n");
+    stringToHex(expectedConsoleOutput[10], "log start [FILENAME]|stop\r\n");
+    stringToHex(expectedConsoleOutput[11], "record start|stop\r\n");
+    stringToHex(expectedConsoleOutput[12], "coverage [start ADDRESS COUNT|stop]\r\n");
+    stringToHex(expectedConsoleOutput[13], "cpuload start [CYCLES]|stop|show\r\n");
+    stringToHex(expectedConsoleOutput[14], "coredump [FILENAME]\r\n");
+    stringToHex(expectedConsoleOutput[15], "snapshot save|restore FILENAME\r\n");
     snprintf(expectedTransmitData, sizeof(expectedTransmitData),
-             "$T05responseT#+$O%s#$O%s#$O%s#$O%s#$OK#+",
+             "$T05responseT#+$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$O%s#$OK#+",
              expectedConsoleOutput[0],
              expectedConsoleOutput[1],
              expectedConsoleOutput[2],
-             expectedConsoleOutput[3]);
+             expectedConsoleOutput[3],
+             expectedConsoleOutput[4],
+             expectedConsoleOutput[5],
+             expectedConsoleOutput[6],
+             expectedConsoleOutput[7],
+             expectedConsoleOutput[8],
+             expectedConsoleOutput[9],
+             expectedConsoleOutput[10],
+             expectedConsoleOutput[11],
+             expectedConsoleOutput[12],
+             expectedConsoleOutput[13],
+             expectedConsoleOutput[14],
+             expectedConsoleOutput[15]);
     STRCMP_EQUAL ( platformMock_CommChecksumData(expectedTransmitData),
                    platformMock_CommGetTransmittedData() );
 }
 
+TEST(cmdQuery, QueryRcmd_WatchValue_ShouldMakeSubsequentWatchpointsMatchValue)
+{
+    const char* pCommand = monitorCommand("watchvalue 0x20000000 42");
+    platformMock_CommInitReceiveChecksummedData(pCommand, "+$Z2,20000000,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL( 0, platformMock_SetHardwareWatchpointCalls() );
+    LONGS_EQUAL( 1, platformMock_SetHardwareValueWatchpointCalls() );
+    LONGS_EQUAL( 0x20000000, platformMock_SetHardwareWatchpointAddressArg() );
+    LONGS_EQUAL( 4, platformMock_SetHardwareWatchpointSizeArg() );
+    LONGS_EQUAL( 42, platformMock_SetHardwareWatchpointValueArg() );
+    LONGS_EQUAL( MRI_PLATFORM_WRITE_WATCHPOINT, platformMock_SetHardwareWatchpointTypeArg() );
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_WatchpointAtOtherAddressShouldBeUnaffected)
+{
+    const char* pCommand = monitorCommand("watchvalue 0x20000000 42");
+    platformMock_CommInitReceiveChecksummedData(pCommand, "+$Z3,20000004,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL( 1, platformMock_SetHardwareWatchpointCalls() );
+    LONGS_EQUAL( 0, platformMock_SetHardwareValueWatchpointCalls() );
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_DecimalAddressAndNegativeValue)
+{
+    const char* pCommand = monitorCommand("watchvalue  536870912  -1 ");
+    platformMock_CommInitReceiveChecksummedData(pCommand, "+$Z4,20000000,2#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL( 1, platformMock_SetHardwareValueWatchpointCalls() );
+    LONGS_EQUAL( 0xFFFFFFFF, platformMock_SetHardwareWatchpointValueArg() );
+    LONGS_EQUAL( MRI_PLATFORM_READWRITE_WATCHPOINT, platformMock_SetHardwareWatchpointTypeArg() );
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_RemoveWatchpointShouldUseValueItWasSetWith)
+{
+    const char* pCommand1 = monitorCommand("watchvalue 0x20000000 42");
+    platformMock_CommInitReceiveChecksummedData(pCommand1, "+$Z2,20000000,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    const char* pCommand2 = monitorCommand("watchvalue 0x20000000 0x43");
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData(pCommand2, "+$z2,20000000,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL( 0, platformMock_ClearHardwareWatchpointCalls() );
+    LONGS_EQUAL( 1, platformMock_ClearHardwareValueWatchpointCalls() );
+    LONGS_EQUAL( 42, platformMock_ClearHardwareWatchpointValueArg() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$Z2,20000000,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    LONGS_EQUAL( 2, platformMock_SetHardwareValueWatchpointCalls() );
+    LONGS_EQUAL( 0x43, platformMock_SetHardwareWatchpointValueArg() );
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_WithoutValueShouldRemoveCondition)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("watchvalue 0x20000000 42"), "+$c#");
+        mriDebugException(platformMock_GetContext());
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("watchvalue 0x20000000"), "+$Z2,20000000,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL( 1, platformMock_SetHardwareWatchpointCalls() );
+    LONGS_EQUAL( 0, platformMock_SetHardwareValueWatchpointCalls() );
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_InvalidArgumentsShouldDisplayUsage)
+{
+    static const char* invalidCommands[] = { "watchvalue", "watchvalue 0x", "watchvalue 12a", "watchvalue 0x10 1 2" };
+    char expectedConsoleOutput[128];
+    char expectedTransmitData[512];
+
+    stringToHex(expectedConsoleOutput, "Usage: monitor watchvalue ADDRESS [VALUE]\r\n");
+    snprintf(expectedTransmitData, sizeof(expectedTransmitData),
+             "$T05responseT#+$O%s#$" MRI_ERROR_INVALID_ARGUMENT "#+", expectedConsoleOutput);
+    for (size_t i = 0 ; i < sizeof(invalidCommands)/sizeof(invalidCommands[0]) ; i++)
+    {
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData(monitorCommand(invalidCommands[i]), "++$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( platformMock_CommChecksumData(expectedTransmitData), platformMock_CommGetTransmittedData() );
+    }
+}
+
+TEST(cmdQuery, QueryRcmd_WatchValue_TooManyValuesShouldFail)
+{
+    char expectedConsoleOutput[128];
+    char expectedTransmitData[512];
+
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("watchvalue 0x10 1"), "+$c#");
+        mriDebugException(platformMock_GetContext());
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("watchvalue 0x20 1"), "+$c#");
+        mriDebugException(platformMock_GetContext());
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("watchvalue 0x30 1"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    stringToHex(expectedConsoleOutput, "Too many watchpoint values.\r\n");
+    snprintf(expectedTransmitData, sizeof(expectedTransmitData),
+             "$T05responseT#+$O%s#$" MRI_ERROR_NO_FREE_BREAKPOINT "#+", expectedConsoleOutput);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(expectedTransmitData), platformMock_CommGetTransmittedData() );
+}
 
 
 
@@ -0,0 +1,385 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+}
+#include <platformMock.h>
+#include <stdio.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(cmdTrace)
+{
+    int      m_expectedException;
+    uint8_t  m_traceBuffer[256];
+    uint32_t m_value;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        m_value = 0x12345678;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        mriSetTraceBuffer(m_traceBuffer, sizeof(m_traceBuffer));
+        sendPackets("+$QTinit#", "+$QTBuffer:circular:0#");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetTraceBuffer(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    void sendPackets(const char* pPacket1, const char* pPacket2 = NULL)
+    {
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+        platformMock_CommInitTransmitDataBuffer(512);
+        if (pPacket2)
+            platformMock_CommInitReceiveChecksummedData(pPacket1, pPacket2, "+$c#");
+        else
+            platformMock_CommInitReceiveChecksummedData(pPacket1, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void startTraceCollectingRegistersAndValue(uint32_t passCount)
+    {
+        char definition[64];
+        char actions[64];
+        snprintf(definition, sizeof(definition), "+$QTDP:1:%x:E:0:%x#", INITIAL_PC, passCount);
+        snprintf(actions, sizeof(actions), "+$QTDP:-1:%x:R3M-1,%lx,4#", INITIAL_PC, (size_t)&m_value);
+        sendPackets(definition, actions);
+        sendPackets("+$QTStart#");
+        STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+"), platformMock_CommGetTransmittedData() );
+    }
+
+    void hitTracepoint()
+    {
+        Platform_SetProgramCounter(INITIAL_PC);
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_TRUE ( Platform_IsSingleStepping() );
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_FALSE ( Platform_IsSingleStepping() );
+    }
+};
+
+TEST(cmdTrace, QTinit_ShouldReturnOK)
+{
+    sendPackets("+$QTinit#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTStart_WithNoTraceBuffer_ShouldReturnNoTraceBufferError)
+{
+    mriSetTraceBuffer(NULL, 0);
+    sendPackets("+$QTStart#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_NO_TRACE_BUFFER "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_DefineTwoTracepoints_ShouldBeUploadedWithQTfPAndQTsP)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0-#", "+$QTDP:2:10000010:D:0:5#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    sendPackets("+$qTfP#", "+$qTsP#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$T01:10000000:E:0:00#+$T02:10000010:D:0:05#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$qTsP#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_RedefineExistingTracepoint_ShouldReplaceIt)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0#", "+$QTDP:1:10000020:D:0:3#");
+    sendPackets("+$qTfP#", "+$qTsP#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$T01:10000020:D:0:03#+$l#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_WithWhileSteppingCount_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTDP:1:10000000:E:1:0#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_WithCondition_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0:X3,220100#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_AgentExpressionAction_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0-#", "+$QTDP:-1:10000000:X3,220100#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_ActionForUndefinedTracepoint_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTDP:-1:10000000:R3#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_ZeroLengthMemoryRange_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0-#", "+$QTDP:-1:10000000:M-1,20000000,0#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTDP_TooManyTracepoints_ShouldReturnNoFreeBreakpointError)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0#", "+$QTDP:2:10000000:E:0:0#");
+    sendPackets("+$QTDP:3:10000000:E:0:0#", "+$QTDP:4:10000000:E:0:0#");
+    sendPackets("+$QTDP:5:10000000:E:0:0#", "+$QTDP:6:10000000:E:0:0#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    sendPackets("+$QTDP:7:10000000:E:0:0#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_NO_FREE_BREAKPOINT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTStart_ShouldArmEnabledTracepointsWithHardwareBreakpoints)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0#", "+$QTDP:2:10000010:D:0:0#");
+    sendPackets("+$QTStart#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+"), platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL ( 1, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_EQUAL ( 0x10000000, platformMock_SetHardwareBreakpointAddressArg() );
+}
+
+TEST(cmdTrace, QTStart_FailToArmHardwareBreakpoint_ShouldReturnNoFreeBreakpointError)
+{
+    sendPackets("+$QTDP:1:10000000:E:0:0#");
+    platformMock_SetHardwareBreakpointException(exceededHardwareResourcesException);
+    sendPackets("+$QTStart#", "+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_NO_FREE_BREAKPOINT "#+"
+                                                 "$T0;tnotrun:00;tframes:00;tcreated:00;tfree:0100;tsize:0100;"
+                                                 "circular:0;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTStop_ShouldDisarmTracepointsAndReportStopReason)
+{
+    startTraceCollectingRegistersAndValue(0);
+    sendPackets("+$QTStop#", "+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+"
+                                                 "$T0;tstop::00;tframes:00;tcreated:00;tfree:0100;tsize:0100;"
+                                                 "circular:0;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_EQUAL ( 1, platformMock_ClearHardwareBreakpointCalls() );
+    CHECK_EQUAL ( 0x10000000, platformMock_ClearHardwareBreakpointAddressArg() );
+}
+
+TEST(cmdTrace, QTBuffer_SetCircularAndSize_ShouldBeReportedInStatus)
+{
+    sendPackets("+$QTBuffer:circular:1#", "+$QTBuffer:size:400#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$OK#+"), platformMock_CommGetTransmittedData() );
+    sendPackets("+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"
+                                                 "$T0;tnotrun:00;tframes:00;tcreated:00;tfree:0100;tsize:0100;"
+                                                 "circular:1;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTBuffer_UnknownOption_ShouldReturnInvalidArgument)
+{
+    sendPackets("+$QTBuffer:foo:1#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, TracepointHit_ShouldCollectFrameAndResumeWithoutNotifyingGdb)
+{
+    startTraceCollectingRegistersAndValue(0);
+    hitTracepoint();
+    CHECK_EQUAL ( 1, platformMock_ClearHardwareBreakpointCalls() );
+    CHECK_EQUAL ( 2, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_EQUAL ( 0x10000000, platformMock_SetHardwareBreakpointAddressArg() );
+
+    sendPackets("+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"
+                                                 "$T1;tnotrun:00;tframes:01;tcreated:01;tfree:ca;tsize:0100;"
+                                                 "circular:0;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, NonTracepointHardwareBreakpoint_ShouldStopAndNotifyGdb)
+{
+    startTraceCollectingRegistersAndValue(0);
+    Platform_SetProgramCounter(INITIAL_PC + 0x10);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, TracepointHit_PassCountReached_ShouldStopTraceAndLeaveBreakpointDisarmed)
+{
+    startTraceCollectingRegistersAndValue(1);
+    Platform_SetProgramCounter(INITIAL_PC);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+    CHECK_EQUAL ( 1, platformMock_ClearHardwareBreakpointCalls() );
+    CHECK_EQUAL ( 1, platformMock_SetHardwareBreakpointCalls() );
+
+    sendPackets("+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"
+                                                 "$T0;tpasscount:01;tframes:01;tcreated:01;tfree:ca;tsize:0100;"
+                                                 "circular:0;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, TracepointHit_BufferFull_ShouldStopTrace)
+{
+    startTraceCollectingRegistersAndValue(0);
+    for (int i = 0 ; i < 4 ; i++)
+        hitTracepoint();
+    Platform_SetProgramCounter(INITIAL_PC);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+
+    sendPackets("+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"
+                                                 "$T0;tfull:00;tframes:04;tcreated:04;tfree:28;tsize:0100;"
+                                                 "circular:0;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, TracepointHit_CircularBufferFull_ShouldDiscardOldestFrames)
+{
+    sendPackets("+$QTBuffer:circular:1#");
+    startTraceCollectingRegistersAndValue(0);
+    for (int i = 0 ; i < 6 ; i++)
+        hitTracepoint();
+
+    sendPackets("+$qTStatus#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"
+                                                 "$T1;tnotrun:00;tframes:04;tcreated:06;tfree:28;tsize:0100;"
+                                                 "circular:1;disconn:0#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$QTFrame:3#", "+$QTFrame:4#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F03T01#+$F-1#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTFrame_SelectCollectedFrame_ShouldReadRegistersAndMemoryFromFrame)
+{
+    uintmri_t* pContext = platformMock_GetContextEntries();
+    pContext[0] = 0x1111111111111111;
+    pContext[1] = 0x2222222222222222;
+    pContext[2] = 0x3333333333333333;
+    pContext[3] = 0x4444444444444444;
+    startTraceCollectingRegistersAndValue(0);
+    hitTracepoint();
+    m_value = 0xBAADF00D;
+    pContext[0] = 0;
+
+    sendPackets("+$QTFrame:0#", "+$g#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F00T01#+"
+                                                 "$1111111111111111222222222222222233333333333333334444444444444444#+"),
+                   platformMock_CommGetTransmittedData() );
+
+    char read1[64];
+    char read2[64];
+    snprintf(read1, sizeof(read1), "+$m%lx,8#", (size_t)&m_value);
+    snprintf(read2, sizeof(read2), "+$m%lx,2#", (size_t)&m_value + 2);
+    sendPackets(read1, read2);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$78563412#+$3412#+"),
+                   platformMock_CommGetTransmittedData() );
+
+    snprintf(read1, sizeof(read1), "+$m%lx,4#", (size_t)&m_value);
+    sendPackets("+$QTFrame:ffffffff#", read1);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F-1#+$0df0adba#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, QTFrame_ReadMemoryNotInFrame_ShouldReturnMemoryAccessError)
+{
+    startTraceCollectingRegistersAndValue(0);
+    hitTracepoint();
+
+    char read[64];
+    snprintf(read, sizeof(read), "+$m%lx,4#", (size_t)&m_value + 4);
+    sendPackets("+$QTFrame:0#", read);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F00T01#+$" MRI_ERROR_MEMORY_ACCESS_FAILURE "#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$QTFrame:ffffffff#");
+}
+
+TEST(cmdTrace, QTFrame_SearchByPcAndTracepoint_ShouldFindSuccessiveFrames)
+{
+    startTraceCollectingRegistersAndValue(0);
+    hitTracepoint();
+    hitTracepoint();
+
+    sendPackets("+$QTFrame:pc:10000000#", "+$QTFrame:pc:10000000#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F00T01#+$F01T01#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$QTFrame:pc:10000000#", "+$QTFrame:tdp:1#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F-1#+$F00T01#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$QTFrame:tdp:2#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$F-1#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(cmdTrace, qTBuffer_ShouldReturnRawFrameDataAndEndMarker)
+{
+    startTraceCollectingRegistersAndValue(0);
+    hitTracepoint();
+
+    sendPackets("+$qTBuffer:0,7#", "+$qTBuffer:32,4#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$01003000000052#+$78563412#+"),
+                   platformMock_CommGetTransmittedData() );
+    sendPackets("+$qTBuffer:36,10#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l#+"), platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,264 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/fileio.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* "log.txt" hex encoded. */
+#define LOG_FILENAME_HEX "6c6f672e747874"
+
+TEST_GROUP(cmdVFile)
+{
+    void setup()
+    {
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        platformMock_Uninit();
+    }
+
+    void sendCommand(const char* pCommand)
+    {
+        platformMock_CommInitReceiveChecksummedData(pCommand, "+$c#");
+            mriDebugException(platformMock_GetContext());
+    }
+
+    void validateResponse(const char* pExpectedResponse)
+    {
+        char expected[256];
+
+        snprintf(expected, sizeof(expected), "$T05responseT#+$%s#+", pExpectedResponse);
+        STRCMP_EQUAL ( platformMock_CommChecksumData(expected), platformMock_CommGetTransmittedData() );
+    }
+
+    void openLogFile(const char* pContents)
+    {
+        platformMock_FsSetFile("log.txt", pContents, strlen(pContents), 0);
+        sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0,0#");
+        validateResponse("F03");
+        platformMock_CommInitTransmitDataBuffer(512);
+    }
+
+    uint32_t extractBigEndianWord(const char* pBytes)
+    {
+        const uint8_t* p = (const uint8_t*)pBytes;
+
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+};
+
+TEST(cmdVFile, Open_ExistingFile_ShouldReturnFileDescriptor)
+{
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0);
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0,0#");
+    validateResponse("F03");
+    CHECK_TRUE ( platformMock_FsIsOpen() );
+    LONGS_EQUAL ( GDB_O_RDONLY, platformMock_FsGetOpenFlags() );
+}
+
+TEST(cmdVFile, Open_MissingFile_ShouldReturnErrno)
+{
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0,0#");
+    validateResponse("F-1,02");
+    CHECK_FALSE ( platformMock_FsIsOpen() );
+}
+
+TEST(cmdVFile, Open_CreateAndTruncate_ShouldPassFlagsAndModeThrough)
+{
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0);
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",601,1c0#");
+    validateResponse("F03");
+    LONGS_EQUAL ( GDB_O_WRONLY | GDB_O_CREAT | GDB_O_TRUNC, platformMock_FsGetOpenFlags() );
+    LONGS_EQUAL ( 0700, platformMock_FsGetOpenMode() );
+    LONGS_EQUAL ( 0, platformMock_FsGetFileSize() );
+}
+
+TEST(cmdVFile, Open_MissingMode_ShouldReturnEInval)
+{
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0);
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0#");
+    validateResponse("F-1,16");
+    CHECK_FALSE ( platformMock_FsIsOpen() );
+}
+
+TEST(cmdVFile, Open_InvalidHexInFilename_ShouldReturnEInval)
+{
+    sendCommand("+$vFile:open:6c6g,0,0#");
+    validateResponse("F-1,16");
+}
+
+TEST(cmdVFile, Open_HookFails_ShouldReturnHookErrno)
+{
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0);
+    platformMock_FsSetError(-GDB_EACCES);
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0,0#");
+    validateResponse("F-1,0d");
+}
+
+TEST(cmdVFile, Close_OpenFile_ShouldReturnZero)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:close:3#");
+    validateResponse("F00");
+    CHECK_FALSE ( platformMock_FsIsOpen() );
+}
+
+TEST(cmdVFile, Close_BadFileDescriptor_ShouldReturnEBadF)
+{
+    sendCommand("+$vFile:close:3#");
+    validateResponse("F-1,09");
+}
+
+TEST(cmdVFile, PRead_WholeFile_ShouldReturnDataInBinary)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pread:3,40,0#");
+    validateResponse("F05;Hello");
+}
+
+TEST(cmdVFile, PRead_FromOffset_ShouldReturnRemainingData)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pread:3,40,3#");
+    validateResponse("F02;lo");
+}
+
+TEST(cmdVFile, PRead_PastEndOfFile_ShouldReturnZeroBytes)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pread:3,40,5#");
+    validateResponse("F00;");
+}
+
+TEST(cmdVFile, PRead_SpecialCharacters_ShouldBeEscaped)
+{
+    openLogFile("a$#}*z");
+    sendCommand("+$vFile:pread:3,40,0#");
+    validateResponse("F06;a}\x04}\x03}]}\x0az");
+}
+
+TEST(cmdVFile, PRead_LargerThanPacket_ShouldReturnShortRead)
+{
+    openLogFile("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+    platformMock_SetPacketBufferSize(4 + 10 + 17);
+    sendCommand("+$vFile:pread:3,40,0#");
+    validateResponse("F0f;0123456789ABCDE");
+}
+
+TEST(cmdVFile, PRead_EscapesCatchUpWithUnreadData_ShouldCutReadShort)
+{
+    openLogFile("$$$$$$$$$$$$$$$$$$$$");
+    platformMock_SetPacketBufferSize(4 + 10 + 17);
+    sendCommand("+$vFile:pread:3,40,0#");
+    validateResponse("F02;}\x04}\x04");
+}
+
+TEST(cmdVFile, PRead_BadFileDescriptor_ShouldReturnEBadF)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pread:4,40,0#");
+    validateResponse("F-1,09");
+}
+
+TEST(cmdVFile, PRead_MissingOffset_ShouldReturnEInval)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pread:3,40#");
+    validateResponse("F-1,16");
+}
+
+TEST(cmdVFile, PWrite_ShouldWriteUnescapedDataAtOffset)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pwrite:3,3,p}\x04!#");
+    validateResponse("F03");
+    LONGS_EQUAL ( 6, platformMock_FsGetFileSize() );
+    MEMCMP_EQUAL ( "Help$!", platformMock_FsGetFileData(), 6 );
+}
+
+TEST(cmdVFile, PWrite_HookFails_ShouldReturnErrno)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pwrite:3,400,Hi#");
+    validateResponse("F-1,1b");
+}
+
+TEST(cmdVFile, PWrite_MissingData_ShouldReturnEInval)
+{
+    openLogFile("Hello");
+    sendCommand("+$vFile:pwrite:3,0#");
+    validateResponse("F-1,16");
+}
+
+TEST(cmdVFile, FStat_ShouldReturnBigEndianStatStructure)
+{
+    static const char expectedPrefix[] = "$T05responseT#7c+$F40;";
+    const char*       pTransmitted;
+
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0x12345678);
+    sendCommand("+$vFile:open:" LOG_FILENAME_HEX ",0,0#");
+    platformMock_CommInitTransmitDataBuffer(512);
+    sendCommand("+$vFile:fstat:3#");
+
+    pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( 0 == strncmp(expectedPrefix, pTransmitted, sizeof(expectedPrefix) - 1) );
+    pTransmitted += sizeof(expectedPrefix) - 1;
+    LONGS_EQUAL ( GDB_S_IFREG | GDB_S_IRUSR | GDB_S_IWUSR, extractBigEndianWord(pTransmitted + 8) );
+    LONGS_EQUAL ( 1, extractBigEndianWord(pTransmitted + 12) );
+    LONGS_EQUAL ( 0, extractBigEndianWord(pTransmitted + 28) );
+    LONGS_EQUAL ( 5, extractBigEndianWord(pTransmitted + 32) );
+    LONGS_EQUAL ( 0x12345678, extractBigEndianWord(pTransmitted + 56) );
+    LONGS_EQUAL ( '#', pTransmitted[64] );
+}
+
+TEST(cmdVFile, FStat_BadFileDescriptor_ShouldReturnEBadF)
+{
+    sendCommand("+$vFile:fstat:3#");
+    validateResponse("F-1,09");
+}
+
+TEST(cmdVFile, Unlink_ExistingFile_ShouldDeleteIt)
+{
+    platformMock_FsSetFile("log.txt", "Hello", 5, 0);
+    sendCommand("+$vFile:unlink:" LOG_FILENAME_HEX "#");
+    validateResponse("F00");
+    CHECK_FALSE ( platformMock_FsExists() );
+}
+
+TEST(cmdVFile, Unlink_MissingFile_ShouldReturnENoEnt)
+{
+    sendCommand("+$vFile:unlink:" LOG_FILENAME_HEX "#");
+    validateResponse("F-1,02");
+}
+
+TEST(cmdVFile, UnsupportedOperation_ShouldReturnEmptyResponse)
+{
+    sendCommand("+$vFile:setfs:0#");
+    validateResponse("");
+}
@@ -0,0 +1,358 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/cmd_common.h>
+#include <core/signal.h>
+#include <core/coredump.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* gdb is only sent the lower 32-bits of the staging buffer's address so the upper bits are taken from this. */
+static uint8_t g_staticInSameImage;
+
+static const char g_memoryMapXml[] = "<?xml version=\"1.0\"?>"
+                                     "<!DOCTYPE memory-map PUBLIC \"+//IDN gnu.org//DTD GDB Memory Map V1.0//EN\" "
+                                     "\"http://sourceware.org/gdb/gdb-memory-map.dtd\">"
+                                     "<memory-map>"
+                                     "<memory type=\"flash\" start=\"0x0\" length=\"0x80000\"> "
+                                     "<property name=\"blocksize\">0x1000</property></memory>"
+                                     "<memory type=\"ram\" start=\"0x10000000\" length=\"0x8000\"> </memory>"
+                                     "<memory type=\"rom\" start=\"0x1FFF0000\" length=\"0x2000\"> </memory>"
+                                     "<memory type=\"ram\" start=\"0x2007C000\" length=\"0x8000\"> </memory>"
+                                     "</memory-map>";
+
+// ELF header + PT_NOTE + 2 PT_LOAD program headers.
+static const uint32_t g_headersSize = 52 + 3 * 32;
+static const uint32_t g_noteSize = 12 + 8 + 148;
+
+TEST_GROUP(coredump)
+{
+    int         m_expectedException;
+    char        m_expectedTransmitData[1024];
+    char        m_responses[3][32];
+    const char* m_pTransmitted;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        platformMock_SetDeviceMemoryMapXml(g_memoryMapXml);
+        platformMock_CommInitTransmitDataBuffer(2048);
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        Coredump_Cancel();
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    void enterDebuggerToSetHaltedContext()
+    {
+        uintmri_t* pEntries = platformMock_GetContextEntries();
+
+        pEntries[0] = 0x11111111;
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        platformMock_CommInitTransmitDataBuffer(2048);
+    }
+
+    const char* writeResponse(int index, uint32_t bytesWritten)
+    {
+        snprintf(m_responses[index], sizeof(m_responses[index]), "+$F%x#", bytesWritten);
+        return m_responses[index];
+    }
+
+    uint32_t findWrite(int index, uint32_t* pAddress)
+    {
+        const char* pWrite = m_pTransmitted;
+        char*       pEnd = NULL;
+
+        for (int i = 0 ; i <= index ; i++)
+        {
+            pWrite = strstr(pWrite, "$Fwrite,05,");
+            CHECK_TRUE ( pWrite != NULL );
+            pWrite += 11;
+        }
+        *pAddress = strtoul(pWrite, &pEnd, 16);
+        return strtoul(pEnd + 1, NULL, 16);
+    }
+
+    const uint8_t* stagingPointer(uint32_t address)
+    {
+        uintptr_t upperAddress = (uintptr_t)&g_staticInSameImage & ~(uintptr_t)0xFFFFFFFF;
+
+        return (const uint8_t*)(upperAddress | address);
+    }
+
+    uint32_t readLE32(const uint8_t* pSrc)
+    {
+        return pSrc[0] | (pSrc[1] << 8) | (pSrc[2] << 16) | ((uint32_t)pSrc[3] << 24);
+    }
+
+    uint16_t readLE16(const uint8_t* pSrc)
+    {
+        return pSrc[0] | (pSrc[1] << 8);
+    }
+
+    void validateConsoleOutput(const char* pOutput)
+    {
+        char expected[128];
+
+        stringToHex(expected, pOutput);
+        CHECK_TRUE ( strstr(m_pTransmitted, expected) != NULL );
+    }
+};
+
+TEST(coredump, MonitorCoredump_ShouldOpenDefaultFileOnNextContinue)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("coredump"), "++$c#", "+$F-1,2#", "+");
+        mriDebugException(platformMock_GetContext());
+
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    char output[128];
+    stringToHex(output, "Will write core dump on next continue.\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$T05responseT#+$O%s#", output);
+    const char* pExpected = platformMock_CommChecksumData(m_expectedTransmitData);
+    CHECK_TRUE ( strncmp(m_pTransmitted, pExpected, strlen(pExpected)) == 0 );
+    // The length of "core" plus its NULL terminator.
+    CHECK_TRUE ( strstr(m_pTransmitted, "/05,0601,01a4#") != NULL );
+    validateConsoleOutput("Failed to open core dump file.\r\n");
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fwrite") == NULL );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+    LONGS_EQUAL ( 1, platformMock_GetLeavingDebuggerCalls() );
+}
+
+TEST(coredump, MonitorCoredump_WithFilename_ShouldOpenThatFile)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("coredump crash.core"), "++$c#", "+$F-1,2#", "+");
+        mriDebugException(platformMock_GetContext());
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "/0b,0601,01a4#") != NULL );
+}
+
+TEST(coredump, MonitorCoredump_TooManyArguments_ShouldDisplayUsage)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("coredump a b"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor coredump [FILENAME]\r\n", MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coredump, MonitorCoredump_FilenameTooLong_ShouldDisplayUsage)
+{
+    platformMock_SetPacketBufferSize(256);
+    platformMock_CommInitReceiveChecksummedData(
+        monitorCommand("coredump 0123456789012345678901234567890123456789012345678901234567890123456789"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor coredump [FILENAME]\r\n", MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coredump, Request_EmptyFilename_ShouldThrow)
+{
+    Coredump_Request("");
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(coredump, WriteRequested_WithoutRequest_ShouldDoNothing)
+{
+    CHECK_TRUE ( Coredump_WriteRequested() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(coredump, WriteRequested_HeaderWriteFails_ShouldSkipRestOfFileAndReportFailure)
+{
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F-1,1c#", "+$F0#", "+");
+        CHECK_TRUE ( Coredump_WriteRequested() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Failed to write core dump file.\r\n");
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+
+    // The headers are still in the staging buffer since the notes weren't written over them.
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( g_headersSize, findWrite(0, &address) );
+    CHECK_TRUE ( strstr(strstr(m_pTransmitted, "$Fwrite,05,") + 1, "$Fwrite") == NULL );
+    const uint8_t* pHeaders = stagingPointer(address);
+    const uint8_t  ident[] = { 0x7F, 'E', 'L', 'F', 1, 1, 1, 0 };
+    MEMCMP_EQUAL ( ident, pHeaders, sizeof(ident) );
+    LONGS_EQUAL ( 4, readLE16(&pHeaders[16]) );
+    LONGS_EQUAL ( 40, readLE16(&pHeaders[18]) );
+    LONGS_EQUAL ( 1, readLE32(&pHeaders[20]) );
+    LONGS_EQUAL ( 52, readLE32(&pHeaders[28]) );
+    UNSIGNED_LONGS_EQUAL ( 0x05000000, readLE32(&pHeaders[36]) );
+    LONGS_EQUAL ( 52, readLE16(&pHeaders[40]) );
+    LONGS_EQUAL ( 32, readLE16(&pHeaders[42]) );
+    LONGS_EQUAL ( 3, readLE16(&pHeaders[44]) );
+
+    const uint8_t* pNote = &pHeaders[52];
+    LONGS_EQUAL ( 4, readLE32(&pNote[0]) );
+    LONGS_EQUAL ( g_headersSize, readLE32(&pNote[4]) );
+    LONGS_EQUAL ( g_noteSize, readLE32(&pNote[16]) );
+
+    const uint8_t* pLoad = &pHeaders[52 + 32];
+    LONGS_EQUAL ( 1, readLE32(&pLoad[0]) );
+    LONGS_EQUAL ( g_headersSize + g_noteSize, readLE32(&pLoad[4]) );
+    UNSIGNED_LONGS_EQUAL ( 0x10000000, readLE32(&pLoad[8]) );
+    UNSIGNED_LONGS_EQUAL ( 0x10000000, readLE32(&pLoad[12]) );
+    LONGS_EQUAL ( 0x8000, readLE32(&pLoad[16]) );
+    LONGS_EQUAL ( 0x8000, readLE32(&pLoad[20]) );
+    LONGS_EQUAL ( 6, readLE32(&pLoad[24]) );
+
+    pLoad += 32;
+    LONGS_EQUAL ( 1, readLE32(&pLoad[0]) );
+    LONGS_EQUAL ( g_headersSize + g_noteSize + 0x8000, readLE32(&pLoad[4]) );
+    UNSIGNED_LONGS_EQUAL ( 0x2007C000, readLE32(&pLoad[8]) );
+    LONGS_EQUAL ( 0x8000, readLE32(&pLoad[16]) );
+}
+
+TEST(coredump, WriteRequested_ShouldWriteHeadersNoteAndRamRegionsToHost)
+{
+    enterDebuggerToSetHaltedContext();
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", writeResponse(0, g_headersSize), writeResponse(1, g_noteSize),
+                                                "+$F8000#", "+$F8000#", "+$F0#", "+");
+        CHECK_TRUE ( Coredump_WriteRequested() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "/09,0601,01a4#") != NULL );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Core dump written.\r\n");
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( g_headersSize, findWrite(0, &address) );
+    UNSIGNED_LONGS_EQUAL ( g_noteSize, findWrite(1, &address) );
+    const uint8_t* pNote = stagingPointer(address);
+    UNSIGNED_LONGS_EQUAL ( 0x8000, findWrite(2, &address) );
+    UNSIGNED_LONGS_EQUAL ( 0x10000000, address );
+    UNSIGNED_LONGS_EQUAL ( 0x8000, findWrite(3, &address) );
+    UNSIGNED_LONGS_EQUAL ( 0x2007C000, address );
+
+    LONGS_EQUAL ( 5, readLE32(&pNote[0]) );
+    LONGS_EQUAL ( 148, readLE32(&pNote[4]) );
+    LONGS_EQUAL ( 1, readLE32(&pNote[8]) );
+    STRCMP_EQUAL ( "CORE", (const char*)&pNote[12] );
+    const uint8_t* pStatus = &pNote[20];
+    LONGS_EQUAL ( SIGTRAP, readLE16(&pStatus[12]) );
+    LONGS_EQUAL ( 1, readLE32(&pStatus[24]) );
+    // The mock's context only has r0-r3 in it.
+    UNSIGNED_LONGS_EQUAL ( 0x11111111, readLE32(&pStatus[72]) );
+    UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, readLE32(&pStatus[76]) );
+    UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, readLE32(&pStatus[84]) );
+    LONGS_EQUAL ( 0, readLE32(&pStatus[88]) );
+}
+
+TEST(coredump, WriteRequested_WithRtos_ShouldWriteNoteForHaltedThreadFirstThenOtherThreads)
+{
+    static const uint32_t threads[] = { 0x100, 0x200 };
+    uintmri_t             otherEntries[17];
+    ContextSection        otherSection = { otherEntries, 17 };
+    MriContext            otherContext;
+
+    for (size_t i = 0 ; i < 17 ; i++)
+        otherEntries[i] = 0xA0000000 + i;
+    Context_Init(&otherContext, &otherSection, 1);
+    platformMock_RtosSetHaltedThreadId(0x100);
+    platformMock_RtosSetThreads(threads, 2);
+    platformMock_RtosSetThreadContext(0x200, &otherContext);
+    enterDebuggerToSetHaltedContext();
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", writeResponse(0, g_headersSize),
+                                                writeResponse(1, g_noteSize), writeResponse(2, g_noteSize),
+                                                "+$F8000#", "+$F8000#", "+$F0#", "+");
+    // The thread being switched to in gdb shouldn't change which thread gets the first note.
+    SetContext(&otherContext);
+        CHECK_TRUE ( Coredump_WriteRequested() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    validateConsoleOutput("Core dump written.\r\n");
+
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( g_headersSize, findWrite(0, &address) );
+    UNSIGNED_LONGS_EQUAL ( g_noteSize, findWrite(1, &address) );
+    UNSIGNED_LONGS_EQUAL ( g_noteSize, findWrite(2, &address) );
+    UNSIGNED_LONGS_EQUAL ( 0x8000, findWrite(3, &address) );
+    UNSIGNED_LONGS_EQUAL ( 0x10000000, address );
+
+    // Only the last note is left in the staging buffer.
+    findWrite(2, &address);
+    const uint8_t* pStatus = stagingPointer(address) + 20;
+    LONGS_EQUAL ( 0, readLE16(&pStatus[12]) );
+    LONGS_EQUAL ( 0x200, readLE32(&pStatus[24]) );
+    for (int i = 0 ; i < 17 ; i++)
+        UNSIGNED_LONGS_EQUAL ( 0xA0000000 + i, readLE32(&pStatus[72 + 4 * i]) );
+    LONGS_EQUAL ( 0, readLE32(&pStatus[72 + 4 * 17]) );
+}
+
+TEST(coredump, WriteRequested_ControlCDuringWrite_ShouldCloseFileAndReturnZero)
+{
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F-1,4,C#", "+$F0#");
+        CHECK_FALSE ( Coredump_WriteRequested() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+
+    // The request has been consumed.
+    platformMock_CommInitTransmitDataBuffer(2048);
+    CHECK_TRUE ( Coredump_WriteRequested() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(coredump, WriteRequested_NoRamInMemoryMap_ShouldOnlyWriteHeadersAndNote)
+{
+    platformMock_SetDeviceMemoryMapXml("TEST");
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", writeResponse(0, 52 + 32), writeResponse(1, g_noteSize),
+                                                "+$F0#", "+");
+        CHECK_TRUE ( Coredump_WriteRequested() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    validateConsoleOutput("Core dump written.\r\n");
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( 52 + 32, findWrite(0, &address) );
+    UNSIGNED_LONGS_EQUAL ( g_noteSize, findWrite(1, &address) );
+}
+
+TEST(coredump, Detach_ShouldCancelPendingCoredump)
+{
+    Coredump_Request("out.core");
+    platformMock_CommInitReceiveChecksummedData("+$D#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#"), platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,365 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/coverage.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+#define BLOCK0  (INITIAL_PC + 0x10)
+#define BLOCK1  (INITIAL_PC + 0x20)
+#define BLOCK2  (INITIAL_PC + 0x30)
+#define BLOCK3  (INITIAL_PC + 0x40)
+
+TEST_GROUP(coverage)
+{
+    int       m_expectedException;
+    uint32_t  m_blocks[4];
+    uint8_t   m_bitmap[1];
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        m_blocks[0] = BLOCK0;
+        m_blocks[1] = BLOCK1;
+        m_blocks[2] = BLOCK2;
+        m_blocks[3] = BLOCK3;
+        m_bitmap[0] = 0xFF;
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetCoverageBuffer(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    void sendCoverageStart(uint32_t blockCount)
+    {
+        char command[64];
+
+        snprintf(command, sizeof(command), "coverage start 0x%lx %u",
+                 (unsigned long)(size_t)m_blocks, (unsigned int)blockCount);
+        sendMonitorCommand(command);
+    }
+
+    void startCoverage(uint32_t blockCount)
+    {
+        mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+        sendCoverageStart(blockCount);
+        STRCMP_EQUAL ( expectConsoleOutputAndResponse("Coverage started.\r\n", "OK"),
+                       platformMock_CommGetTransmittedData() );
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void hitBreakpointAndResume(uint32_t address)
+    {
+        Platform_SetProgramCounter(address);
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_FALSE ( Platform_IsSingleStepping() );
+    }
+
+    void hitBreakpointAndStop(uint32_t address, PlatformTrapType type)
+    {
+        Platform_SetProgramCounter(address);
+        setTrapReason(type);
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+    }
+};
+
+TEST(coverage, MonitorCoverageStart_NoBuffer_ShouldFail)
+{
+    sendCoverageStart(4);
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetCoverageBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_COVERAGE_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+}
+
+TEST(coverage, MonitorCoverageStart_BitmapDoesNotFitInBuffer_ShouldFail)
+{
+    uint32_t blocks[9] = { BLOCK0, BLOCK1, BLOCK2, BLOCK3, BLOCK0, BLOCK1, BLOCK2, BLOCK3, BLOCK0 };
+    char     command[64];
+
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    snprintf(command, sizeof(command), "coverage start 0x%lx 9", (unsigned long)(size_t)blocks);
+    sendMonitorCommand(command);
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Coverage buffer is too small.\r\n", MRI_ERROR_BUFFER_OVERRUN),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+}
+
+TEST(coverage, MonitorCoverageStart_ZeroBlocks_ShouldFail)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    sendCoverageStart(0);
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor coverage [start ADDRESS COUNT|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+}
+
+TEST(coverage, MonitorCoverageStart_MissingCount_ShouldFail)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    sendMonitorCommand("coverage start 0x10000000");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor coverage [start ADDRESS COUNT|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+}
+
+TEST(coverage, MonitorCoverageStart_FaultReadingBlockList_ShouldFail)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    platformMock_FaultOnSpecificMemoryCall(3);
+    sendCoverageStart(4);
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Failed to read block address list.\r\n",
+                                                  MRI_ERROR_MEMORY_ACCESS_FAILURE),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+}
+
+TEST(coverage, MonitorCoverageStart_NoFreeComparators_ShouldFail)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    platformMock_SetHardwareBreakpointException(exceededHardwareResourcesException);
+    sendCoverageStart(4);
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for coverage.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+    LONGS_EQUAL ( 0, Coverage_GetArmedCount() );
+}
+
+TEST(coverage, MonitorCoverageStart_ShouldClearBitmapAndArmEveryBlock)
+{
+    startCoverage(4);
+    CHECK_TRUE ( Coverage_IsRunning() );
+    LONGS_EQUAL ( 0x00, m_bitmap[0] );
+    LONGS_EQUAL ( 4, platformMock_SetHardwareBreakpointCalls() );
+    LONGS_EQUAL ( BLOCK3, platformMock_SetHardwareBreakpointAddressArg() );
+    LONGS_EQUAL ( 4, Coverage_GetArmedCount() );
+    LONGS_EQUAL ( 0, Coverage_GetHitCount() );
+}
+
+TEST(coverage, MonitorCoverageStart_WithThumbBitSetOnAddresses_ShouldClearIt)
+{
+    m_blocks[0] |= 1;
+    startCoverage(1);
+    LONGS_EQUAL ( BLOCK0, platformMock_SetHardwareBreakpointAddressArg() );
+}
+
+TEST(coverage, MonitorCoverageStart_OnlyTwoComparatorsFree_ShouldArmFirstTwoBlocks)
+{
+    platformMock_SetHardwareBreakpointCapacity(2);
+    startCoverage(4);
+    LONGS_EQUAL ( 3, platformMock_SetHardwareBreakpointCalls() );
+    LONGS_EQUAL ( 2, Coverage_GetArmedCount() );
+}
+
+TEST(coverage, MonitorCoverageStart_DuplicateAddresses_ShouldOnlyArmOnce)
+{
+    m_blocks[1] = BLOCK0;
+    startCoverage(2);
+    LONGS_EQUAL ( 1, platformMock_SetHardwareBreakpointCalls() );
+    LONGS_EQUAL ( 2, Coverage_GetArmedCount() );
+}
+
+TEST(coverage, BlockHit_ShouldSetBitRetireBreakpointAndArmNextBlock)
+{
+    platformMock_SetHardwareBreakpointCapacity(2);
+    startCoverage(4);
+    hitBreakpointAndResume(BLOCK1);
+    LONGS_EQUAL ( 0x02, m_bitmap[0] );
+    LONGS_EQUAL ( 1, Coverage_GetHitCount() );
+    LONGS_EQUAL ( 1, platformMock_ClearHardwareBreakpointCalls() );
+    LONGS_EQUAL ( BLOCK1, platformMock_ClearHardwareBreakpointAddressArg() );
+    LONGS_EQUAL ( 5, platformMock_SetHardwareBreakpointCalls() );
+    LONGS_EQUAL ( 2, Coverage_GetArmedCount() );
+    hitBreakpointAndResume(BLOCK2);
+    LONGS_EQUAL ( 0x06, m_bitmap[0] );
+}
+
+TEST(coverage, BlockHit_EveryBlock_ShouldSetAllBitsAndLeaveNothingArmed)
+{
+    platformMock_SetHardwareBreakpointCapacity(2);
+    startCoverage(4);
+    hitBreakpointAndResume(BLOCK0);
+    hitBreakpointAndResume(BLOCK2);
+    hitBreakpointAndResume(BLOCK1);
+    hitBreakpointAndResume(BLOCK3);
+    LONGS_EQUAL ( 0x0F, m_bitmap[0] );
+    LONGS_EQUAL ( 4, Coverage_GetHitCount() );
+    LONGS_EQUAL ( 0, Coverage_GetArmedCount() );
+    LONGS_EQUAL ( 4, platformMock_ClearHardwareBreakpointCalls() );
+}
+
+TEST(coverage, BlockHit_DuplicateAddresses_ShouldSetBothBitsAndClearOnce)
+{
+    m_blocks[1] = BLOCK0;
+    startCoverage(2);
+    hitBreakpointAndResume(BLOCK0 | 1);
+    LONGS_EQUAL ( 0x03, m_bitmap[0] );
+    LONGS_EQUAL ( 2, Coverage_GetHitCount() );
+    LONGS_EQUAL ( 1, platformMock_ClearHardwareBreakpointCalls() );
+}
+
+TEST(coverage, BreakpointHit_NotOnArmedBlock_ShouldStopInDebugger)
+{
+    platformMock_SetHardwareBreakpointCapacity(2);
+    startCoverage(4);
+    hitBreakpointAndStop(BLOCK2, MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    LONGS_EQUAL ( 0x00, m_bitmap[0] );
+}
+
+TEST(coverage, SingleStepOntoArmedBlock_ShouldStopInDebugger)
+{
+    startCoverage(4);
+    hitBreakpointAndStop(BLOCK0, MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+    LONGS_EQUAL ( 0, Coverage_GetHitCount() );
+}
+
+TEST(coverage, MonitorCoverageStop_ShouldClearArmedBreakpointsButKeepBitmap)
+{
+    startCoverage(4);
+    hitBreakpointAndResume(BLOCK0);
+    sendMonitorCommand("coverage stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Coverage stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Coverage_IsRunning() );
+    LONGS_EQUAL ( 4, platformMock_ClearHardwareBreakpointCalls() );
+    LONGS_EQUAL ( 0x01, m_bitmap[0] );
+    LONGS_EQUAL ( 1, Coverage_GetBitmapSize() );
+    hitBreakpointAndStop(BLOCK1, MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+}
+
+TEST(coverage, MonitorCoverage_NotStarted_ShouldSaySo)
+{
+    sendMonitorCommand("coverage");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Coverage hasn't been started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, MonitorCoverage_ShouldReportBlockHitAndArmedCounts)
+{
+    static const char* outputs[] =
+    {
+        "Blocks: ", "4", "\r\n",
+        "Hit: ", "3", "\r\n",
+        "Armed: ", "1", "\r\n"
+    };
+    platformMock_SetHardwareBreakpointCapacity(2);
+    startCoverage(4);
+    hitBreakpointAndResume(BLOCK0);
+    hitBreakpointAndResume(BLOCK1);
+    hitBreakpointAndResume(BLOCK2);
+    sendMonitorCommand("coverage", "++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, MonitorCoverage_WithExtraArguments_ShouldFail)
+{
+    sendMonitorCommand("coverage stop now");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor coverage [start ADDRESS COUNT|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, QuerySupported_WithBuffer_ShouldAdvertiseCoverageObject)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-coverage:read+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, QueryXfer_NoBuffer_ShouldReturnEmptyResponse)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-coverage:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, QueryXfer_NonNullAnnex_ShouldReturnErrorResponse)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-coverage:read:target.xml:0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, QueryXfer_ReadBitmap)
+{
+    startCoverage(4);
+    hitBreakpointAndResume(BLOCK0);
+    hitBreakpointAndResume(BLOCK2);
+    platformMock_CommInitTransmitDataBuffer(512);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-coverage:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l\x05#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, QueryXfer_BeforeStart_ShouldReturnEmptyBitmap)
+{
+    mriSetCoverageBuffer(m_bitmap, sizeof(m_bitmap));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-coverage:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(coverage, MriInit_ShouldStopCoverage)
+{
+    startCoverage(4);
+    mriInit("MRI_UART_MBED_USB");
+    CHECK_FALSE ( Coverage_IsRunning() );
+    LONGS_EQUAL ( 0, Coverage_GetArmedCount() );
+}
@@ -0,0 +1,207 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/cpuload.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(cpuLoad)
+{
+    int       m_expectedException;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        CpuLoad_Reset();
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void sample(uint32_t threadId, int wasInterruptActive = 0)
+    {
+        platformMock_RtosSetHaltedThreadId(threadId);
+        CpuLoad_RecordSample(wasInterruptActive);
+        platformMock_RtosSetHaltedThreadId(0);
+    }
+
+    void startCpuLoad()
+    {
+        CpuLoad_Start(MRI_CPULOAD_DEFAULT_INTERVAL);
+        LONGS_EQUAL ( noException, getExceptionCode() );
+    }
+};
+
+TEST(cpuLoad, MonitorCpuLoadStart_ShouldUseDefaultInterval)
+{
+    sendMonitorCommand("cpuload start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("CPU load sampling started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StartCpuLoadSamplingCalls() );
+    LONGS_EQUAL ( MRI_CPULOAD_DEFAULT_INTERVAL, platformMock_StartCpuLoadSamplingIntervalArg() );
+    CHECK_TRUE ( CpuLoad_IsRunning() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadStart_WithInterval_ShouldPassItToPlatform)
+{
+    sendMonitorCommand("cpuload start 0x1000");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("CPU load sampling started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0x1000, platformMock_StartCpuLoadSamplingIntervalArg() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadStart_WithZeroInterval_ShouldFail)
+{
+    sendMonitorCommand("cpuload start 0");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor cpuload start [CYCLES]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartCpuLoadSamplingCalls() );
+}
+
+TEST(cpuLoad, MonitorCpuLoad_WithNoSubcommand_ShouldFail)
+{
+    sendMonitorCommand("cpuload");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor cpuload start [CYCLES]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadStart_WithNoFreeHardware_ShouldFail)
+{
+    platformMock_StartCpuLoadSamplingException(exceededHardwareResourcesException);
+    sendMonitorCommand("cpuload start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for CPU load sampling.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( CpuLoad_IsRunning() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadStop_ShouldStopSamplingAndKeepTicks)
+{
+    startCpuLoad();
+    sample(0x100);
+    sendMonitorCommand("cpuload stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("CPU load sampling stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StopCpuLoadSamplingCalls() );
+    CHECK_FALSE ( CpuLoad_IsRunning() );
+    LONGS_EQUAL ( 1, CpuLoad_GetTotalTicks() );
+}
+
+TEST(cpuLoad, RecordSample_WhenNotRunning_ShouldBeIgnored)
+{
+    sample(0x100);
+    LONGS_EQUAL ( 0, CpuLoad_GetTotalTicks() );
+    LONGS_EQUAL ( 0, CpuLoad_GetThreadCount() );
+}
+
+TEST(cpuLoad, RecordSample_ShouldCountTicksForEachThread)
+{
+    startCpuLoad();
+    sample(0x100);
+    sample(0x200);
+    sample(0x100);
+    LONGS_EQUAL ( 3, CpuLoad_GetTotalTicks() );
+    LONGS_EQUAL ( 2, CpuLoad_GetThreadCount() );
+    LONGS_EQUAL ( 0x100, CpuLoad_GetThread(0)->threadId );
+    LONGS_EQUAL ( 2, CpuLoad_GetThread(0)->ticks );
+    LONGS_EQUAL ( 0x200, CpuLoad_GetThread(1)->threadId );
+    LONGS_EQUAL ( 1, CpuLoad_GetThread(1)->ticks );
+    POINTERS_EQUAL ( NULL, CpuLoad_GetThread(2) );
+}
+
+TEST(cpuLoad, RecordSample_InInterruptHandler_ShouldOnlyCountInterruptTicks)
+{
+    startCpuLoad();
+    sample(0x100, 1);
+    LONGS_EQUAL ( 1, CpuLoad_GetTotalTicks() );
+    LONGS_EQUAL ( 1, CpuLoad_GetInterruptTicks() );
+    LONGS_EQUAL ( 0, CpuLoad_GetThreadCount() );
+}
+
+TEST(cpuLoad, RecordSample_MoreThreadsThanTable_ShouldLumpExtrasTogether)
+{
+    startCpuLoad();
+    for (uint32_t i = 1 ; i <= MRI_CPULOAD_MAX_THREADS + 2 ; i++)
+        sample(i);
+    LONGS_EQUAL ( MRI_CPULOAD_MAX_THREADS, CpuLoad_GetThreadCount() );
+    LONGS_EQUAL ( 2, CpuLoad_GetOtherThreadTicks() );
+    LONGS_EQUAL ( MRI_CPULOAD_MAX_THREADS + 2, CpuLoad_GetTotalTicks() );
+}
+
+TEST(cpuLoad, Start_ShouldClearPreviousTicks)
+{
+    startCpuLoad();
+    sample(0x100);
+    sample(0x100, 1);
+    startCpuLoad();
+    LONGS_EQUAL ( 0, CpuLoad_GetTotalTicks() );
+    LONGS_EQUAL ( 0, CpuLoad_GetInterruptTicks() );
+    LONGS_EQUAL ( 0, CpuLoad_GetThreadCount() );
+    LONGS_EQUAL ( 1, platformMock_StopCpuLoadSamplingCalls() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadShow_NoSamples_ShouldSaySo)
+{
+    sendMonitorCommand("cpuload show");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No CPU load samples have been taken.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(cpuLoad, MonitorCpuLoadShow_ShouldReportInterruptAndThreadPercentages)
+{
+    static const char* outputs[] =
+    {
+        "Samples: ", "4", "\r\n",
+        "Interrupts: ", "1", " (", "25", "%)\r\n",
+        "Thread ", "0x0100", " ", "idle", ": ", "2", " (", "50", "%)\r\n",
+        "Thread ", "0x0200", ": ", "1", " (", "25", "%)\r\n"
+    };
+    platformMock_RtosSetExtraThreadInfo(0x100, "idle");
+    startCpuLoad();
+    sample(0x100);
+    sample(0x200);
+    sample(0x100);
+    sample(0x200, 1);
+    sendMonitorCommand("cpuload show", "+++++++++++++++++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,210 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/cycle_clock.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* gdb is only sent the lower 32-bits of the time of day buffer's address so the upper bits are taken from this. */
+static uint8_t g_staticInSameImage;
+
+
+TEST_GROUP(cycleClock)
+{
+    int m_expectedException;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        platformMock_SetCpuClockFrequency(100000000);
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    uintptr_t getTimeValAddressFromRequest(const char* pTransmitted)
+    {
+        static const char prefix[] = "$Fgettimeofday,";
+        const char*       pRequest = strstr(pTransmitted, prefix);
+        uintptr_t         upperAddress = (uintptr_t)&g_staticInSameImage & ~(uintptr_t)0xFFFFFFFF;
+
+        CHECK_TRUE ( pRequest != NULL );
+        return upperAddress | strtoul(pRequest + sizeof(prefix) - 1, NULL, 16);
+    }
+
+    uintptr_t failFirstTimeOfDayRequest()
+    {
+        uint32_t seconds = 0;
+
+        platformMock_CommInitReceiveChecksummedData("+$F-1,5#");
+            LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+        UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, seconds );
+        uintptr_t address = getTimeValAddressFromRequest(platformMock_CommGetTransmittedData());
+        platformMock_CommInitTransmitDataBuffer(512);
+        return address;
+    }
+};
+
+TEST(cycleClock, GetCycles_FirstCall_ShouldEnableCycleCounterAndStartAtZero)
+{
+    platformMock_SetCycleCounter(1000);
+    UNSIGNED_LONGS_EQUAL ( 0, CycleClock_GetCycles() );
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+}
+
+TEST(cycleClock, GetCycles_LaterCalls_ShouldNotEnableCycleCounterAgain)
+{
+    CycleClock_GetCycles();
+    platformMock_SetCycleCounter(1234);
+    UNSIGNED_LONGS_EQUAL ( 1234, CycleClock_GetCycles() );
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+}
+
+TEST(cycleClock, GetCycles_CounterWraps_ShouldExtendTo64Bits)
+{
+    platformMock_SetCycleCounter(0xFFFFFF00);
+    CycleClock_GetCycles();
+    platformMock_SetCycleCounter(0x100);
+    CHECK_TRUE ( 0x200 == CycleClock_GetCycles() );
+    platformMock_SetCycleCounter(0x80000000);
+    CycleClock_GetCycles();
+    platformMock_SetCycleCounter(0x100);
+    CHECK_TRUE ( 0x100000200ULL == CycleClock_GetCycles() );
+}
+
+TEST(cycleClock, GetCycles_NoCycleCounter_ShouldThrow)
+{
+    platformMock_EnableCycleCounterException(invalidArgumentException);
+    CycleClock_GetCycles();
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(cycleClock, Update_BeforeFirstTimingCall_ShouldNotEnableCycleCounter)
+{
+    CycleClock_Update();
+    LONGS_EQUAL ( 0, platformMock_EnableCycleCounterCalls() );
+}
+
+TEST(cycleClock, Update_ShouldCatchWrapsBetweenTimingCalls)
+{
+    CycleClock_GetCycles();
+    platformMock_SetCycleCounter(0xC0000000);
+    CycleClock_Update();
+    platformMock_SetCycleCounter(0x80000000);
+    CycleClock_Update();
+    platformMock_SetCycleCounter(0x40000000);
+    CHECK_TRUE ( 0x240000000ULL == CycleClock_GetCycles() );
+}
+
+TEST(cycleClock, GetCentiseconds_ShouldConvertCyclesUsingCpuClockFrequency)
+{
+    CycleClock_GetCycles();
+    platformMock_SetCycleCounter(2500000);
+    UNSIGNED_LONGS_EQUAL ( 2, CycleClock_GetCentiseconds() );
+    platformMock_SetCycleCounter(3000000);
+    UNSIGNED_LONGS_EQUAL ( 3, CycleClock_GetCentiseconds() );
+}
+
+TEST(cycleClock, GetCentiseconds_UnknownCpuClockFrequency_ShouldThrow)
+{
+    platformMock_SetCpuClockFrequency(0);
+    CycleClock_GetCentiseconds();
+    validateExceptionCode(invalidValueException);
+}
+
+TEST(cycleClock, GetEpochSeconds_NoCycleCounter_ShouldCompleteWithAllOnesWithoutAskingGdb)
+{
+    uint32_t seconds = 0;
+
+    platformMock_EnableCycleCounterException(invalidArgumentException);
+        LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+    UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, seconds );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(cycleClock, GetEpochSeconds_UnknownCpuClockFrequency_ShouldCompleteWithAllOnes)
+{
+    uint32_t seconds = 0;
+
+    platformMock_SetCpuClockFrequency(0);
+        LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+    UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, seconds );
+}
+
+TEST(cycleClock, GetEpochSeconds_GdbFails_ShouldReturnAllOnesAndTryAgainNextTime)
+{
+    failFirstTimeOfDayRequest();
+    uint32_t seconds = 0;
+    platformMock_CommInitReceiveChecksummedData("+$F-1,5#");
+        LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+    CHECK_TRUE ( strstr(platformMock_CommGetTransmittedData(), "$Fgettimeofday,") != NULL );
+    UNSIGNED_LONGS_EQUAL ( 0xFFFFFFFF, seconds );
+    CHECK_FALSE ( CycleClock_IsSyncedWithGdb() );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(cycleClock, GetEpochSeconds_ControlC_ShouldReturnZeroToRetry)
+{
+    uint32_t seconds = 0;
+
+    platformMock_CommInitReceiveChecksummedData("+$F-1,4,C#");
+        LONGS_EQUAL ( 0, CycleClock_GetEpochSeconds(&seconds) );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+}
+
+TEST(cycleClock, GetEpochSeconds_ShouldOnlyAskGdbOnceAndThenCountLocally)
+{
+    char     writePacket[64];
+    uint32_t seconds = 0;
+
+    uintptr_t address = failFirstTimeOfDayRequest();
+    snprintf(writePacket, sizeof(writePacket), "+$M%lx,4:6553f100#", (unsigned long)address);
+    platformMock_CommInitReceiveChecksummedData(writePacket, "+$F0#");
+    CHECK_FALSE ( CycleClock_IsSyncedWithGdb() );
+        LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+    UNSIGNED_LONGS_EQUAL ( 0x6553f100, seconds );
+    CHECK_TRUE ( CycleClock_IsSyncedWithGdb() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_SetCycleCounter(250000000);
+        LONGS_EQUAL ( 1, CycleClock_GetEpochSeconds(&seconds) );
+    UNSIGNED_LONGS_EQUAL ( 0x6553f102, seconds );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,358 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+#include <signal.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/platforms.h>
+#include <core/fault_capture.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(faultCapture)
+{
+    static const size_t registerCount = 4;
+    static const size_t faultStatusCount = 5;
+    static const size_t stackSize = 16;
+
+    int       m_expectedException;
+    uint32_t  m_buffer[(sizeof(FaultCaptureHeader) + (registerCount + faultStatusCount) * sizeof(uint32_t) + stackSize) /
+                       sizeof(uint32_t)];
+    uint8_t   m_stack[stackSize];
+
+    void setup()
+    {
+        static const uint32_t faultStatusRegisters[faultStatusCount] = { 0x82, 0x40000000, 0x00, 0x20000000, 0x10 };
+
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        memset(m_buffer, 0xFF, sizeof(m_buffer));
+        for (size_t i = 0 ; i < sizeof(m_stack) ; i++)
+            m_stack[i] = i;
+        for (size_t i = 0 ; i < registerCount ; i++)
+            platformMock_GetContextEntries()[i] = 0x11111111 * (i + 1);
+        platformMock_SetFaultStatusRegisters(faultStatusRegisters, faultStatusCount);
+        platformMock_SetStackPointer((uintmri_t)(uintptr_t)m_stack);
+        platformMock_SetCpuClockFrequency(1000000);
+        platformMock_SetCycleCounterIncrement(500);
+        platformMock_SetCauseOfException(SIGSEGV);
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetFaultCaptureBuffer(NULL, 0, 0);
+        platformMock_Uninit();
+    }
+
+    FaultCaptureHeader* header()
+    {
+        return (FaultCaptureHeader*)m_buffer;
+    }
+
+    uint32_t* words()
+    {
+        return (uint32_t*)(header() + 1);
+    }
+
+    void faultWithNoGdbAttached()
+    {
+        platformMock_CommInitReceiveData("", "", "");
+            mriDebugException(platformMock_GetContext());
+    }
+};
+
+TEST(faultCapture, NoBuffer_FaultShouldWaitForGdbAsUsual)
+{
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T0bresponseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetResetDeviceCalls() );
+    POINTERS_EQUAL ( NULL, FaultCapture_GetData() );
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+}
+
+TEST(faultCapture, BufferTooSmallForHeader_ShouldBeIgnored)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(FaultCaptureHeader) - 1, 100);
+    POINTERS_EQUAL ( NULL, FaultCapture_GetData() );
+    LONGS_EQUAL ( 0xFFFFFFFF, header()->magic );
+}
+
+TEST(faultCapture, SetBuffer_ShouldInitializeHeaderAndEnableCycleCounter)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    POINTERS_EQUAL ( m_buffer, FaultCapture_GetData() );
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+    LONGS_EQUAL ( MRI_FAULT_CAPTURE_MAGIC, header()->magic );
+    LONGS_EQUAL ( sizeof(m_buffer), header()->bufferSize );
+    LONGS_EQUAL ( 0, header()->captureSize );
+    LONGS_EQUAL ( 0, header()->captureCount );
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+}
+
+TEST(faultCapture, DebugTrap_ShouldNotProbeGdb)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetResetDeviceCalls() );
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+}
+
+TEST(faultCapture, Fault_GdbAcknowledgesProbe_ShouldStopAsUsual)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_CommInitReceiveChecksummedData("+", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O#$T0bresponseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetResetDeviceCalls() );
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+}
+
+TEST(faultCapture, Fault_CycleCounterNotAvailable_ShouldWaitForGdbAsUsual)
+{
+    platformMock_EnableCycleCounterException(invalidArgumentException);
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T0bresponseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetResetDeviceCalls() );
+}
+
+TEST(faultCapture, Fault_CpuClockFrequencyUnknown_ShouldWaitForGdbAsUsual)
+{
+    platformMock_SetCpuClockFrequency(0);
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T0bresponseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetResetDeviceCalls() );
+}
+
+TEST(faultCapture, Fault_NoGdbResponse_ShouldCaptureStateAndResetDevice)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O#"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_GetResetDeviceCalls() );
+    LONGS_EQUAL ( sizeof(m_buffer), FaultCapture_GetSize() );
+    LONGS_EQUAL ( sizeof(m_buffer), header()->captureSize );
+    LONGS_EQUAL ( 1, header()->captureCount );
+    LONGS_EQUAL ( SIGSEGV, header()->signal );
+    LONGS_EQUAL ( registerCount, header()->registerCount );
+    LONGS_EQUAL ( faultStatusCount, header()->faultStatusCount );
+    LONGS_EQUAL ( (uint32_t)(uintptr_t)m_stack, header()->stackAddress );
+    LONGS_EQUAL ( stackSize, header()->stackSize );
+    LONGS_EQUAL ( 0x11111111, words()[0] );
+    LONGS_EQUAL ( 0x44444444, words()[3] );
+    LONGS_EQUAL ( 0x82, words()[4] );
+    LONGS_EQUAL ( 0x40000000, words()[5] );
+    LONGS_EQUAL ( 0x10, words()[8] );
+    MEMCMP_EQUAL ( m_stack, &words()[9], stackSize );
+}
+
+TEST(faultCapture, Fault_NoGdbResponse_ShouldWaitForFullTimeout)
+{
+    // 1000 cycles per millisecond and the cycle counter advances 500 cycles on each read.
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 10);
+        faultWithNoGdbAttached();
+    LONGS_EQUAL ( 1, platformMock_GetResetDeviceCalls() );
+    LONGS_EQUAL ( 21 * 500, Platform_GetCycleCounter() );
+}
+
+TEST(faultCapture, Fault_NoGdbResponse_CycleCounterWraps_ShouldStillTimeoutCorrectly)
+{
+    platformMock_SetCycleCounter(0xFFFFFFFF - 1000);
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 10);
+        faultWithNoGdbAttached();
+    LONGS_EQUAL ( 1, platformMock_GetResetDeviceCalls() );
+    LONGS_EQUAL ( (uint32_t)(0xFFFFFFFF - 1000 + 21 * 500), Platform_GetCycleCounter() );
+}
+
+TEST(faultCapture, Fault_SmallBuffer_ShouldTruncateStackWindow)
+{
+    size_t bufferSize = sizeof(m_buffer) - 8;
+
+    mriSetFaultCaptureBuffer(m_buffer, bufferSize, 100);
+        faultWithNoGdbAttached();
+    LONGS_EQUAL ( bufferSize, FaultCapture_GetSize() );
+    LONGS_EQUAL ( stackSize - 8, header()->stackSize );
+    MEMCMP_EQUAL ( m_stack, &words()[9], stackSize - 8 );
+    LONGS_EQUAL ( 0xFFFFFFFF, m_buffer[sizeof(m_buffer)/sizeof(m_buffer[0]) - 1] );
+}
+
+TEST(faultCapture, Fault_BufferOnlyHoldsSomeRegisters_ShouldTruncateRegistersAndSkipTheRest)
+{
+    size_t bufferSize = sizeof(FaultCaptureHeader) + 2 * sizeof(uint32_t);
+
+    mriSetFaultCaptureBuffer(m_buffer, bufferSize, 100);
+        faultWithNoGdbAttached();
+    LONGS_EQUAL ( bufferSize, FaultCapture_GetSize() );
+    LONGS_EQUAL ( 2, header()->registerCount );
+    LONGS_EQUAL ( 0, header()->faultStatusCount );
+    LONGS_EQUAL ( 0, header()->stackSize );
+    LONGS_EQUAL ( 0x22222222, words()[1] );
+}
+
+TEST(faultCapture, SetBufferAgain_SameSize_ShouldPreserveCaptureFromBeforeReset)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    LONGS_EQUAL ( sizeof(m_buffer), FaultCapture_GetSize() );
+    LONGS_EQUAL ( 1, header()->captureCount );
+}
+
+TEST(faultCapture, SetBufferAgain_DifferentSize_ShouldDiscardCapture)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer) - 4, 100);
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+    LONGS_EQUAL ( 0, header()->captureCount );
+}
+
+TEST(faultCapture, SetBuffer_CorruptMagic_ShouldDiscardCapture)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    header()->magic ^= 1;
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    LONGS_EQUAL ( MRI_FAULT_CAPTURE_MAGIC, header()->magic );
+    LONGS_EQUAL ( 0, FaultCapture_GetSize() );
+}
+
+TEST(faultCapture, SecondFault_ShouldReplaceCaptureAndIncrementCount)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    platformMock_SetCauseOfException(SIGBUS);
+        faultWithNoGdbAttached();
+    LONGS_EQUAL ( 2, header()->captureCount );
+    LONGS_EQUAL ( SIGBUS, header()->signal );
+    LONGS_EQUAL ( 2, platformMock_GetResetDeviceCalls() );
+}
+
+TEST(faultCapture, QuerySupported_NoCapture_ShouldNotAdvertiseFaultObject)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "PacketSize=89#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QuerySupported_WithCapture_ShouldAdvertiseFaultObject)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-fault:read+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QuerySupported_WithEveryOptionalFeature_ShouldFitMinimumPacketBuffer)
+{
+    uint32_t  flightRecorder[64];
+    uint8_t   coverage[1];
+    uintmri_t record[64];
+
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    mriSetFlightRecorderBuffer(flightRecorder, sizeof(flightRecorder));
+    mriSetCoverageBuffer(coverage, sizeof(coverage));
+    mriSetRecordBuffer(record, sizeof(record));
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    mriSetFlightRecorderBuffer(NULL, 0);
+    mriSetCoverageBuffer(NULL, 0);
+    mriSetRecordBuffer(NULL, 0);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-trace:read+;qXfer:mri-fault:read+;qXfer:mri-coverage:read+;"
+                                                 "ReverseStep+;ReverseContinue+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QueryXfer_NoCapture_ShouldReturnEmptyResponse)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-fault:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QueryXfer_NonNullAnnex_ShouldReturnErrorResponse)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-fault:read:target.xml:0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QueryXfer_ReadMagic)
+{
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+        faultWithNoGdbAttached();
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-fault:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$mMRFC#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(faultCapture, QueryXfer_ReadThroughEndOfStackWindow)
+{
+    char expectedData[64];
+
+    mriSetFaultCaptureBuffer(m_buffer, sizeof(m_buffer), 100);
+    for (size_t i = 0 ; i < sizeof(m_stack) ; i++)
+        m_stack[i] = 'A' + i;
+    faultWithNoGdbAttached();
+    platformMock_SetCauseOfException(SIGTRAP);
+    platformMock_CommInitTransmitDataBuffer(512);
+    snprintf(expectedData, sizeof(expectedData), "+$qXfer:mri-fault:read::%zx,20#", sizeof(m_buffer) - 4);
+    platformMock_CommInitReceiveChecksummedData(expectedData, "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$lMNOP#+"), platformMock_CommGetTransmittedData() );
+}
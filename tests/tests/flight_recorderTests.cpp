@@ -0,0 +1,249 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/flight_recorder.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(flightRecorder)
+{
+    int       m_expectedException;
+    uint32_t  m_buffer[(sizeof(FlightRecorderHeader) + 4 * sizeof(FlightRecorderRecord)) / sizeof(uint32_t)];
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        memset(m_buffer, 0xFF, sizeof(m_buffer));
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetFlightRecorderBuffer(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    FlightRecorderHeader* header()
+    {
+        return (FlightRecorderHeader*)m_buffer;
+    }
+
+    FlightRecorderRecord* record(uint32_t index)
+    {
+        return (FlightRecorderRecord*)(header() + 1) + index;
+    }
+
+    void validateRecord(uint32_t index, uint32_t expectedTimestamp, uint16_t expectedId, uint32_t expectedValue)
+    {
+        LONGS_EQUAL ( expectedTimestamp, record(index)->timestamp );
+        LONGS_EQUAL ( expectedId, record(index)->id );
+        LONGS_EQUAL ( 0, record(index)->reserved );
+        LONGS_EQUAL ( expectedValue, record(index)->value );
+    }
+};
+
+TEST(flightRecorder, NoBuffer_TraceShouldBeIgnored)
+{
+    mriTrace(1, 2);
+    POINTERS_EQUAL ( NULL, FlightRecorder_GetData() );
+    LONGS_EQUAL ( 0, FlightRecorder_GetSize() );
+}
+
+TEST(flightRecorder, BufferTooSmallForOneRecord_ShouldBeIgnored)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(FlightRecorderHeader) + sizeof(FlightRecorderRecord) - 1);
+    mriTrace(1, 2);
+    POINTERS_EQUAL ( NULL, FlightRecorder_GetData() );
+    LONGS_EQUAL ( 0, FlightRecorder_GetSize() );
+    LONGS_EQUAL ( 0xFFFFFFFF, header()->magic );
+}
+
+TEST(flightRecorder, SetBuffer_ShouldInitializeHeaderAndEnableCycleCounter)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    LONGS_EQUAL ( MRI_FLIGHT_RECORDER_MAGIC, header()->magic );
+    LONGS_EQUAL ( 4, header()->recordCapacity );
+    LONGS_EQUAL ( 0, header()->writeCount );
+    LONGS_EQUAL ( sizeof(FlightRecorderRecord), header()->recordSize );
+    POINTERS_EQUAL ( m_buffer, FlightRecorder_GetData() );
+    LONGS_EQUAL ( sizeof(m_buffer), FlightRecorder_GetSize() );
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+}
+
+TEST(flightRecorder, SetBuffer_CycleCounterFailsToEnable_ShouldStillRecord)
+{
+    platformMock_EnableCycleCounterException(exceededHardwareResourcesException);
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    mriTrace(1, 2);
+    LONGS_EQUAL ( 1, header()->writeCount );
+}
+
+TEST(flightRecorder, SetBuffer_ShouldRoundCapacityDownToPowerOf2)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer) - 1);
+    LONGS_EQUAL ( 2, header()->recordCapacity );
+    LONGS_EQUAL ( sizeof(FlightRecorderHeader) + 2 * sizeof(FlightRecorderRecord), FlightRecorder_GetSize() );
+}
+
+TEST(flightRecorder, Trace_ShouldRecordTimestampIdAndValue)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    platformMock_SetCycleCounter(0x12345678);
+    mriTrace(0xABCD, 0xDEADBEEF);
+    platformMock_SetCycleCounter(0x12345700);
+    mriTrace(0x0001, 0x00000002);
+    LONGS_EQUAL ( 2, header()->writeCount );
+    validateRecord(0, 0x12345678, 0xABCD, 0xDEADBEEF);
+    validateRecord(1, 0x12345700, 0x0001, 0x00000002);
+}
+
+TEST(flightRecorder, Trace_FullBuffer_ShouldOverwriteOldestRecords)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    for (uint32_t i = 0 ; i < 6 ; i++)
+    {
+        platformMock_SetCycleCounter(i * 10);
+        mriTrace(i, i * 100);
+    }
+    LONGS_EQUAL ( 6, header()->writeCount );
+    validateRecord(0, 40, 4, 400);
+    validateRecord(1, 50, 5, 500);
+    validateRecord(2, 20, 2, 200);
+    validateRecord(3, 30, 3, 300);
+}
+
+TEST(flightRecorder, Trace_WriteCountWraps_ShouldContinueAtStartOfBuffer)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    header()->writeCount = 0xFFFFFFFF;
+    mriTrace(1, 1);
+    mriTrace(2, 2);
+    LONGS_EQUAL ( 1, header()->writeCount );
+    validateRecord(3, 0, 1, 1);
+    validateRecord(0, 0, 2, 2);
+}
+
+TEST(flightRecorder, SetBufferAgain_SameSize_ShouldPreserveRecordsFromBeforeReset)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    mriTrace(1, 0x11111111);
+    mriTrace(2, 0x22222222);
+    mriSetFlightRecorderBuffer(NULL, 0);
+
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    LONGS_EQUAL ( 2, header()->writeCount );
+    mriTrace(3, 0x33333333);
+    validateRecord(0, 0, 1, 0x11111111);
+    validateRecord(1, 0, 2, 0x22222222);
+    validateRecord(2, 0, 3, 0x33333333);
+}
+
+TEST(flightRecorder, SetBufferAgain_DifferentSize_ShouldDiscardRecords)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    mriTrace(1, 0x11111111);
+
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer) - 1);
+    LONGS_EQUAL ( 2, header()->recordCapacity );
+    LONGS_EQUAL ( 0, header()->writeCount );
+}
+
+TEST(flightRecorder, SetBuffer_CorruptMagic_ShouldDiscardRecords)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    mriTrace(1, 0x11111111);
+    header()->magic = 0;
+
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    LONGS_EQUAL ( MRI_FLIGHT_RECORDER_MAGIC, header()->magic );
+    LONGS_EQUAL ( 0, header()->writeCount );
+}
+
+TEST(flightRecorder, QuerySupported_WithBuffer_ShouldAdvertiseFlightRecorderObject)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-trace:read+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_NoBuffer_ShouldReturnEmptyResponse)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_NonNullAnnex_ShouldReturnErrorResponse)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read:target.xml:0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$" MRI_ERROR_INVALID_ARGUMENT "#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_ReadMagic)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read::0,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$mMRIF#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_ReadValueWithSpecialCharacters_ShouldEscapeThem)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    mriTrace(1, 0x2A7D2324);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read::18,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$m}\x04}\x03}]}\x0a#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_ReadThroughEnd)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    for (int i = 0 ; i < 4 ; i++)
+        mriTrace(0, 0x44434241);
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read::3C,8#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$lABCD#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(flightRecorder, QueryXfer_StartReadPastEnd)
+{
+    mriSetFlightRecorderBuffer(m_buffer, sizeof(m_buffer));
+    platformMock_CommInitReceiveChecksummedData("+$qXfer:mri-trace:read::40,4#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$l#+"), platformMock_CommGetTransmittedData() );
+}
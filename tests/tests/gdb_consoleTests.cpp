@@ -76,3 +76,15 @@ TEST(gdbConsole, WriteHexValueToGdbConsole_SendMaximumValue)
     WriteHexValueToGdbConsole(~0U);
     STRCMP_EQUAL ( platformMock_CommChecksumData("$O30786666666666666666#"), platformMock_CommGetTransmittedData() );
 }
+
+TEST(gdbConsole, WriteDecimalValueToGdbConsole_SendMinimumValue)
+{
+    WriteDecimalValueToGdbConsole(0);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O30#"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(gdbConsole, WriteDecimalValueToGdbConsole_SendMaximumValue)
+{
+    WriteDecimalValueToGdbConsole(~0U);
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$O34323934393637323935#"), platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,266 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/irqstats.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(irqstats)
+{
+    int       m_expectedException;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        IrqStats_Reset();
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void startIrqStats(uint32_t irq1, uint32_t irq2)
+    {
+        uint32_t irqs[] = { irq1, irq2 };
+        IrqStats_Start(irqs, sizeof(irqs)/sizeof(irqs[0]));
+        LONGS_EQUAL ( noException, getExceptionCode() );
+    }
+
+    void enterAt(uint32_t irq, uint32_t cycles)
+    {
+        platformMock_SetCycleCounter(cycles);
+        IrqStats_Enter(irq);
+    }
+
+    void exitAt(uint32_t irq, uint32_t cycles)
+    {
+        platformMock_SetCycleCounter(cycles);
+        IrqStats_Exit(irq);
+    }
+};
+
+TEST(irqstats, MonitorIrqStatsStart_ShouldEnableCycleCounterAndHookEachIrq)
+{
+    sendMonitorCommand("irqstats start 5 0x10");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("IRQ statistics started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+    LONGS_EQUAL ( 2, platformMock_HookIrqCalls() );
+    LONGS_EQUAL ( 0x10, platformMock_HookIrqArg() );
+    CHECK_TRUE ( IrqStats_IsRunning() );
+    LONGS_EQUAL ( 2, IrqStats_GetCount() );
+    LONGS_EQUAL ( 5, IrqStats_Get(0)->irq );
+    LONGS_EQUAL ( 0x10, IrqStats_Get(1)->irq );
+    POINTERS_EQUAL ( NULL, IrqStats_Get(2) );
+}
+
+TEST(irqstats, MonitorIrqStatsStart_WithNoIrqs_ShouldFail)
+{
+    sendMonitorCommand("irqstats start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor irqstats start IRQ [IRQ...]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_HookIrqCalls() );
+}
+
+TEST(irqstats, MonitorIrqStatsStart_WithTooManyIrqs_ShouldFail)
+{
+    sendMonitorCommand("irqstats start 0 1 2 3 4 5 6 7 8");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor irqstats start IRQ [IRQ...]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_HookIrqCalls() );
+}
+
+TEST(irqstats, MonitorIrqStats_WithNoSubcommand_ShouldFail)
+{
+    sendMonitorCommand("irqstats");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor irqstats start IRQ [IRQ...]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(irqstats, MonitorIrqStatsStart_WithDuplicateIrqs_ShouldFail)
+{
+    sendMonitorCommand("irqstats start 3 3");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("IRQ list is invalid or doesn't fit in the vector table.\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_HookIrqCalls() );
+    CHECK_FALSE ( IrqStats_IsRunning() );
+}
+
+TEST(irqstats, MonitorIrqStatsStart_WithNoVectorTable_ShouldFail)
+{
+    platformMock_HookIrqException(notFoundException);
+    sendMonitorCommand("irqstats start 3");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetIrqVectorTable() first.\r\n",
+                                                  MRI_ERROR_NO_VECTOR_TABLE),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( IrqStats_IsRunning() );
+    LONGS_EQUAL ( 0, IrqStats_GetCount() );
+    LONGS_EQUAL ( 0, platformMock_UnhookIrqCalls() );
+}
+
+TEST(irqstats, MonitorIrqStatsStart_WithNoCycleCounter_ShouldFail)
+{
+    platformMock_EnableCycleCounterException(exceededHardwareResourcesException);
+    sendMonitorCommand("irqstats start 3");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for IRQ statistics.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_HookIrqCalls() );
+    CHECK_FALSE ( IrqStats_IsRunning() );
+}
+
+TEST(irqstats, MonitorIrqStatsStop_ShouldUnhookIrqsAndKeepStats)
+{
+    startIrqStats(1, 2);
+    enterAt(2, 100);
+    exitAt(2, 150);
+    sendMonitorCommand("irqstats stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("IRQ statistics stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2, platformMock_UnhookIrqCalls() );
+    LONGS_EQUAL ( 2, platformMock_UnhookIrqArg() );
+    CHECK_FALSE ( IrqStats_IsRunning() );
+    LONGS_EQUAL ( 1, IrqStats_Get(1)->count );
+    LONGS_EQUAL ( 50, IrqStats_Get(1)->maxDuration );
+}
+
+TEST(irqstats, Start_ShouldUnhookPreviousIrqsAndClearStats)
+{
+    startIrqStats(1, 2);
+    enterAt(1, 100);
+    exitAt(1, 150);
+    startIrqStats(3, 4);
+    LONGS_EQUAL ( 2, platformMock_UnhookIrqCalls() );
+    LONGS_EQUAL ( 3, IrqStats_Get(0)->irq );
+    LONGS_EQUAL ( 0, IrqStats_Get(0)->count );
+    LONGS_EQUAL ( 0, IrqStats_Get(0)->maxDuration );
+}
+
+TEST(irqstats, EnterAndExit_ShouldCountCallsAndTrackWorstCaseDuration)
+{
+    startIrqStats(1, 2);
+    enterAt(1, 1000);
+    exitAt(1, 1100);
+    enterAt(1, 2000);
+    exitAt(1, 2300);
+    enterAt(1, 3000);
+    exitAt(1, 3200);
+    LONGS_EQUAL ( 3, IrqStats_Get(0)->count );
+    LONGS_EQUAL ( 300, IrqStats_Get(0)->maxDuration );
+    LONGS_EQUAL ( 0, IrqStats_Get(0)->maxLatency );
+    LONGS_EQUAL ( 0, IrqStats_Get(1)->count );
+}
+
+TEST(irqstats, EnterAndExit_WhenCycleCounterWraps_ShouldStillCalculateDuration)
+{
+    startIrqStats(1, 2);
+    enterAt(1, 0xFFFFFFF0);
+    exitAt(1, 0x10);
+    LONGS_EQUAL ( 0x20, IrqStats_Get(0)->maxDuration );
+}
+
+TEST(irqstats, Enter_IrqSeenPendingByAnotherHandler_ShouldRecordLatency)
+{
+    startIrqStats(1, 2);
+    platformMock_SetPendingIrqs(1 << 2);
+    enterAt(1, 1000);
+    enterAt(1, 1010);
+    exitAt(1, 1500);
+    platformMock_SetPendingIrqs(0);
+    enterAt(2, 1600);
+    LONGS_EQUAL ( 600, IrqStats_Get(1)->maxLatency );
+    LONGS_EQUAL ( 1, IrqStats_Get(1)->count );
+}
+
+TEST(irqstats, Enter_IrqSeenPendingOnExitOfAnotherHandler_ShouldRecordLatencyFromExit)
+{
+    startIrqStats(1, 2);
+    enterAt(1, 1000);
+    platformMock_SetPendingIrqs(1 << 2);
+    exitAt(1, 1500);
+    platformMock_SetPendingIrqs(0);
+    enterAt(2, 1520);
+    exitAt(2, 1600);
+    enterAt(2, 2000);
+    LONGS_EQUAL ( 20, IrqStats_Get(1)->maxLatency );
+    LONGS_EQUAL ( 2, IrqStats_Get(1)->count );
+}
+
+TEST(irqstats, EnterAndExit_ForIrqNotBeingMonitored_ShouldBeIgnored)
+{
+    startIrqStats(1, 2);
+    enterAt(7, 1000);
+    exitAt(7, 2000);
+    LONGS_EQUAL ( 0, IrqStats_Get(0)->count );
+    LONGS_EQUAL ( 0, IrqStats_Get(1)->count );
+}
+
+TEST(irqstats, MonitorIrqStatsShow_WithNoIrqs_ShouldSaySo)
+{
+    sendMonitorCommand("irqstats show");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No IRQs are being monitored.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(irqstats, MonitorIrqStatsShow_ShouldReportEachIrq)
+{
+    static const char* outputs[] =
+    {
+        "IRQ ", "1", ": ", "Count: ", "2", ", ",
+        "Max latency: ", "0", " cycles, ", "Max duration: ", "256", " cycles\r\n",
+        "IRQ ", "26", ": ", "Count: ", "1", ", ",
+        "Max latency: ", "16", " cycles, ", "Max duration: ", "32", " cycles\r\n"
+    };
+    startIrqStats(1, 26);
+    enterAt(1, 1000);
+    exitAt(1, 1010);
+    enterAt(1, 2000);
+    platformMock_SetPendingIrqs(1 << 26);
+    exitAt(1, 2256);
+    platformMock_SetPendingIrqs(0);
+    enterAt(26, 2272);
+    exitAt(26, 2304);
+    sendMonitorCommand("irqstats show", "+++++++++++++++++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
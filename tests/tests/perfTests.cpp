@@ -0,0 +1,228 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/perf.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(perf)
+{
+    int       m_expectedException;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        Perf_Reset();
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void accumulate(uint32_t cycles, uint32_t cpi, uint32_t exception, uint32_t sleep, uint32_t lsu, uint32_t fold)
+    {
+        PerfCounters sample = { cycles, cpi, exception, sleep, lsu, fold };
+        Perf_Accumulate(&sample);
+    }
+
+    void startPerf()
+    {
+        Perf_Start(MRI_PERF_DEFAULT_INTERVAL);
+        LONGS_EQUAL ( noException, getExceptionCode() );
+    }
+};
+
+TEST(perf, MonitorPerfStart_ShouldUseDefaultInterval)
+{
+    sendMonitorCommand("perf start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Performance counters started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StartPerfCountersCalls() );
+    LONGS_EQUAL ( MRI_PERF_DEFAULT_INTERVAL, platformMock_StartPerfCountersIntervalArg() );
+    CHECK_TRUE ( Perf_IsRunning() );
+}
+
+TEST(perf, MonitorPerfStart_WithInterval_ShouldPassItToPlatform)
+{
+    sendMonitorCommand("perf start 0x80");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Performance counters started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0x80, platformMock_StartPerfCountersIntervalArg() );
+}
+
+TEST(perf, MonitorPerfStart_WithZeroInterval_ShouldFail)
+{
+    sendMonitorCommand("perf start 0");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor perf start [CYCLES]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartPerfCountersCalls() );
+}
+
+TEST(perf, MonitorPerf_WithNoSubcommand_ShouldFail)
+{
+    sendMonitorCommand("perf");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor perf start [CYCLES]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(perf, MonitorPerfShow_WithExtraArguments_ShouldFail)
+{
+    sendMonitorCommand("perf show all");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor perf start [CYCLES]|stop|show\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(perf, MonitorPerfStart_WithNoFreeHardware_ShouldFail)
+{
+    platformMock_StartPerfCountersException(exceededHardwareResourcesException);
+    sendMonitorCommand("perf start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for performance counters.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Perf_IsRunning() );
+}
+
+TEST(perf, MonitorPerfStop_ShouldStopCountersAndKeepTotals)
+{
+    startPerf();
+    accumulate(100, 1, 2, 3, 4, 5);
+    sendMonitorCommand("perf stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Performance counters stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StopPerfCountersCalls() );
+    CHECK_FALSE ( Perf_IsRunning() );
+    LONGS_EQUAL ( 100, Perf_GetTotals()->cycles );
+}
+
+TEST(perf, Accumulate_WhenNotRunning_ShouldBeIgnored)
+{
+    accumulate(100, 1, 2, 3, 4, 5);
+    LONGS_EQUAL ( 0, Perf_GetTotals()->cycles );
+}
+
+TEST(perf, Accumulate_ShouldSumEachCounter)
+{
+    startPerf();
+    accumulate(100, 1, 2, 3, 4, 5);
+    accumulate(200, 10, 20, 30, 40, 50);
+
+    const PerfCounters* pTotals = Perf_GetTotals();
+    LONGS_EQUAL ( 300, pTotals->cycles );
+    LONGS_EQUAL ( 11, pTotals->cpi );
+    LONGS_EQUAL ( 22, pTotals->exception );
+    LONGS_EQUAL ( 33, pTotals->sleep );
+    LONGS_EQUAL ( 44, pTotals->lsu );
+    LONGS_EQUAL ( 55, pTotals->fold );
+    LONGS_EQUAL ( 0, Perf_GetPossibleWrapCount() );
+}
+
+TEST(perf, Accumulate_SampleLongerThanCounterRange_ShouldCountPossibleWrap)
+{
+    startPerf();
+    accumulate(MRI_PERF_COUNTER_MAX, 0, 0, 0, 0, 0);
+    LONGS_EQUAL ( 0, Perf_GetPossibleWrapCount() );
+    accumulate(MRI_PERF_COUNTER_MAX + 1, 0, 0, 0, 0, 0);
+    LONGS_EQUAL ( 1, Perf_GetPossibleWrapCount() );
+}
+
+TEST(perf, Accumulate_CycleTotalOverflow_ShouldSaturate)
+{
+    startPerf();
+    accumulate(0xFFFFFF00, 1, 0, 0, 0, 0);
+    accumulate(0x100, 1, 0, 0, 0, 0);
+    accumulate(0x10, 1, 0, 0, 0, 0);
+    CHECK_TRUE ( Perf_HasSaturated() );
+    LONGS_EQUAL ( 0xFFFFFF00, Perf_GetTotals()->cycles );
+    LONGS_EQUAL ( 1, Perf_GetTotals()->cpi );
+}
+
+TEST(perf, Start_ShouldClearPreviousTotals)
+{
+    startPerf();
+    accumulate(0x1000, 1, 0, 0, 0, 0);
+    startPerf();
+    LONGS_EQUAL ( 0, Perf_GetTotals()->cycles );
+    LONGS_EQUAL ( 0, Perf_GetPossibleWrapCount() );
+    LONGS_EQUAL ( 1, platformMock_StopPerfCountersCalls() );
+}
+
+TEST(perf, MonitorPerfShow_ShouldReportTotalsRatiosAndCyclesPerInstruction)
+{
+    static const char* outputs[] =
+    {
+        "Cycles: ", "1000", "\r\n",
+        "CPI stall cycles: ", "100", " (", "10", "%)\r\n",
+        "Exception overhead cycles: ", "50", " (", "5", "%)\r\n",
+        "Sleep cycles: ", "0", " (", "0", "%)\r\n",
+        "LSU stall cycles: ", "200", " (", "20", "%)\r\n",
+        "Folded instructions: ", "30", " (", "3", "%)\r\n",
+        "Instructions: ", "680", "\r\n",
+        "Cycles per instruction: ", "1", ".", "47", "\r\n"
+    };
+    startPerf();
+    accumulate(250, 25, 25, 0, 50, 5);
+    accumulate(250, 25, 25, 0, 50, 5);
+    accumulate(250, 25, 0, 0, 50, 10);
+    accumulate(250, 25, 0, 0, 50, 10);
+    sendMonitorCommand("perf show", "+++++++++++++++++++++++++++++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(perf, MonitorPerfShow_WithPossibleWrapsAndNoInstructions_ShouldWarn)
+{
+    static const char* outputs[] =
+    {
+        "Cycles: ", "256", "\r\n",
+        "CPI stall cycles: ", "256", " (", "100", "%)\r\n",
+        "Exception overhead cycles: ", "0", " (", "0", "%)\r\n",
+        "Sleep cycles: ", "0", " (", "0", "%)\r\n",
+        "LSU stall cycles: ", "0", " (", "0", "%)\r\n",
+        "Folded instructions: ", "0", " (", "0", "%)\r\n",
+        "Warning: Counters may have wrapped during ", "1", " long samples.\r\n"
+    };
+    startPerf();
+    accumulate(0x100, 0x100, 0, 0, 0, 0);
+    sendMonitorCommand("perf show", "++++++++++++++++++++++++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
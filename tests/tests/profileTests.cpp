@@ -0,0 +1,310 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/profile.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+// The bins start on the first word boundary after the gmon headers.
+static const size_t g_gmonHeaderSize = 20 + 1 + 2 * sizeof(uintmri_t) + 4 + 4 + 15 + 1;
+static const size_t g_binsOffset = (g_gmonHeaderSize + 3) & ~3;
+
+TEST_GROUP(profile)
+{
+    int       m_expectedException;
+    char      m_expectedTransmitData[1024];
+    uint32_t  m_buffer[(g_binsOffset + 8 * sizeof(uint16_t)) / sizeof(uint32_t)];
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriSetProfileBuffer(NULL, 0, 0, 0);
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetProfileBuffer(NULL, 0, 0, 0);
+        platformMock_Uninit();
+    }
+
+    void setProfileBufferFor8Bins()
+    {
+        // 16 bytes of code in 8 bins of 2 bytes each.
+        mriSetProfileBuffer(m_buffer, sizeof(m_buffer), 0x1000, 0x1010);
+    }
+
+    uint16_t* bins()
+    {
+        return (uint16_t*)((uint8_t*)m_buffer + g_binsOffset);
+    }
+
+    uint8_t* gmonFile()
+    {
+        return (uint8_t*)m_buffer + g_binsOffset - g_gmonHeaderSize;
+    }
+};
+
+TEST(profile, MonitorProfileStart_WithoutBuffer_ShouldFail)
+{
+    sendMonitorCommand("profile start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetProfileBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_PROFILE_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartProfilingCalls() );
+    CHECK_FALSE ( Profile_IsRunning() );
+}
+
+TEST(profile, MonitorProfileStart_BufferTooSmallForHeaders_ShouldFail)
+{
+    mriSetProfileBuffer(m_buffer, g_gmonHeaderSize, 0x1000, 0x1010);
+    sendMonitorCommand("profile start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetProfileBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_PROFILE_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(profile, MonitorProfileStart_WithDefaultInterval)
+{
+    setProfileBufferFor8Bins();
+    sendMonitorCommand("profile start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Profiling started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StartProfilingCalls() );
+    LONGS_EQUAL ( MRI_PROFILE_DEFAULT_INTERVAL, platformMock_StartProfilingIntervalArg() );
+    CHECK_TRUE ( Profile_IsRunning() );
+}
+
+TEST(profile, MonitorProfileStart_WithHexInterval)
+{
+    setProfileBufferFor8Bins();
+    sendMonitorCommand("profile start 0x1000");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Profiling started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0x1000, platformMock_StartProfilingIntervalArg() );
+}
+
+TEST(profile, MonitorProfileStart_NoFreeHardware_ShouldFail)
+{
+    setProfileBufferFor8Bins();
+    platformMock_StartProfilingException(exceededHardwareResourcesException);
+    sendMonitorCommand("profile start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for profiling.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Profile_IsRunning() );
+}
+
+TEST(profile, MonitorProfile_InvalidArguments_ShouldDisplayUsage)
+{
+    static const char* invalidCommands[] = { "profile", "profile bogus", "profile start 0", "profile start 12a",
+                                             "profile stop 1", "profile dump a b", "profile starts" };
+
+    setProfileBufferFor8Bins();
+    for (size_t i = 0 ; i < sizeof(invalidCommands)/sizeof(invalidCommands[0]) ; i++)
+    {
+        sendMonitorCommand(invalidCommands[i]);
+        STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor profile start [CYCLES]|stop|dump [FILENAME]\r\n",
+                                                      MRI_ERROR_INVALID_ARGUMENT),
+                       platformMock_CommGetTransmittedData() );
+    }
+    LONGS_EQUAL ( 0, platformMock_StartProfilingCalls() );
+}
+
+TEST(profile, RecordSample_ShouldBinByAddressAndCountOutOfRangeSamples)
+{
+    setProfileBufferFor8Bins();
+    Profile_Start(100);
+    Profile_RecordSample(0x1000);
+    Profile_RecordSample(0x1001);
+    Profile_RecordSample(0x1002);
+    Profile_RecordSample(0x100E);
+    Profile_RecordSample(0x0FFE);
+    Profile_RecordSample(0x1010);
+    LONGS_EQUAL ( 2, bins()[0] );
+    LONGS_EQUAL ( 1, bins()[1] );
+    LONGS_EQUAL ( 0, bins()[2] );
+    LONGS_EQUAL ( 1, bins()[7] );
+    LONGS_EQUAL ( 6, Profile_GetSampleCount() );
+    LONGS_EQUAL ( 2, Profile_GetOutOfRangeSampleCount() );
+}
+
+TEST(profile, RecordSample_SmallBufferShouldUseLargerBins)
+{
+    // 4 bins can only cover 16 bytes of code with 4 bytes per bin.
+    mriSetProfileBuffer(m_buffer, g_binsOffset + 4 * sizeof(uint16_t), 0x1000, 0x1010);
+    Profile_Start(100);
+    Profile_RecordSample(0x1003);
+    Profile_RecordSample(0x1004);
+    Profile_RecordSample(0x100F);
+    LONGS_EQUAL ( 1, bins()[0] );
+    LONGS_EQUAL ( 1, bins()[1] );
+    LONGS_EQUAL ( 1, bins()[3] );
+    LONGS_EQUAL ( 0, Profile_GetOutOfRangeSampleCount() );
+}
+
+TEST(profile, RecordSample_BinsShouldSaturate)
+{
+    setProfileBufferFor8Bins();
+    Profile_Start(100);
+    for (int i = 0 ; i < 0x10001 ; i++)
+        Profile_RecordSample(0x1000);
+    LONGS_EQUAL ( 0xFFFF, bins()[0] );
+}
+
+TEST(profile, StartShouldClearPreviousSamples)
+{
+    setProfileBufferFor8Bins();
+    Profile_Start(100);
+    Profile_RecordSample(0x1000);
+    Profile_Start(100);
+    LONGS_EQUAL ( 0, bins()[0] );
+    LONGS_EQUAL ( 0, Profile_GetSampleCount() );
+    LONGS_EQUAL ( 1, platformMock_StopProfilingCalls() );
+    LONGS_EQUAL ( 2, platformMock_StartProfilingCalls() );
+}
+
+TEST(profile, MonitorProfileStop_ShouldStopSamplingAndReportCounts)
+{
+    setProfileBufferFor8Bins();
+    Profile_Start(100);
+    Profile_RecordSample(0x1000);
+    Profile_RecordSample(0x2000);
+    sendMonitorCommand("profile stop", "++++++$c#");
+    char output[5][64];
+    stringToHex(output[0], "Profiling stopped with ");
+    stringToHex(output[1], "2");
+    stringToHex(output[2], " samples (");
+    stringToHex(output[3], "1");
+    stringToHex(output[4], " out of range).\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData),
+             "$T05responseT#+$O%s#$O%s#$O%s#$O%s#$O%s#$OK#+", output[0], output[1], output[2], output[3], output[4]);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(m_expectedTransmitData), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StopProfilingCalls() );
+    CHECK_FALSE ( Profile_IsRunning() );
+}
+
+TEST(profile, MonitorProfileDump_WithoutBuffer_ShouldFail)
+{
+    sendMonitorCommand("profile dump");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetProfileBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_PROFILE_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(profile, MonitorProfileDump_ShouldOpenDefaultFileOnNextContinue)
+{
+    setProfileBufferFor8Bins();
+    platformMock_CommInitTransmitDataBuffer(1024);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("profile dump"), "++$c#", "+$F-1,2#", "+");
+        mriDebugException(platformMock_GetContext());
+
+    // The address of the filename isn't known to the test so just check the rest of the open request.
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    char        output[128];
+    stringToHex(output, "Will write profile on next continue.\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$T05responseT#+$O%s#", output);
+    const char* pExpected = platformMock_CommChecksumData(m_expectedTransmitData);
+    CHECK_TRUE ( strncmp(pTransmitted, pExpected, strlen(pExpected)) == 0 );
+    CHECK_TRUE ( strstr(pTransmitted, "+$Fopen,") != NULL );
+    CHECK_TRUE ( strstr(pTransmitted, "/09,0601,01a4#") != NULL );
+    stringToHex(output, "Failed to open profile output file.\r\n");
+    CHECK_TRUE ( strstr(pTransmitted, output) != NULL );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+    LONGS_EQUAL ( 1, platformMock_GetLeavingDebuggerCalls() );
+}
+
+TEST(profile, WriteRequestedDump_ShouldWriteGmonFileToHost)
+{
+    platformMock_SetCpuClockFrequency(1000000);
+    setProfileBufferFor8Bins();
+    Profile_Start(100);
+    Profile_RecordSample(0x1002);
+    Profile_RequestDump("out.gmon");
+    size_t fileSize = g_gmonHeaderSize + 8 * sizeof(uint16_t);
+    char   writeResponse[32];
+    snprintf(writeResponse, sizeof(writeResponse), "+$F%x#", (unsigned int)fileSize);
+    platformMock_CommInitReceiveChecksummedData("+$F5#", writeResponse, "+$F0#", "+");
+        CHECK_TRUE ( Profile_WriteRequestedDump() );
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    const char* pWrite = strstr(pTransmitted, "$Fwrite,05,");
+    char*       pEnd = NULL;
+    char        expected[128];
+    CHECK_TRUE ( strstr(pTransmitted, "/09,0601,01a4#") != NULL );
+    CHECK_TRUE ( pWrite != NULL );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)gmonFile(), strtoul(pWrite + 11, &pEnd, 16) );
+    UNSIGNED_LONGS_EQUAL ( fileSize, strtoul(pEnd + 1, NULL, 16) );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fclose,05#") != NULL );
+    stringToHex(expected, "Profile written.\r\n");
+    CHECK_TRUE ( strstr(pTransmitted, expected) != NULL );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+
+    uint8_t*  pFile = gmonFile();
+    uint32_t  version;
+    uintmri_t lowPc;
+    uintmri_t highPc;
+    uint32_t  binCount;
+    uint32_t  rate;
+    memcpy(&version, &pFile[4], sizeof(version));
+    memcpy(&lowPc, &pFile[21], sizeof(lowPc));
+    memcpy(&highPc, &pFile[21 + sizeof(lowPc)], sizeof(highPc));
+    memcpy(&binCount, &pFile[21 + 2 * sizeof(lowPc)], sizeof(binCount));
+    memcpy(&rate, &pFile[25 + 2 * sizeof(lowPc)], sizeof(rate));
+    CHECK_TRUE ( memcmp(pFile, "gmon", 4) == 0 );
+    LONGS_EQUAL ( 1, version );
+    LONGS_EQUAL ( 0, pFile[20] );
+    LONGS_EQUAL ( 0x1000, lowPc );
+    LONGS_EQUAL ( 0x1010, highPc );
+    LONGS_EQUAL ( 8, binCount );
+    LONGS_EQUAL ( 10000, rate );
+    STRCMP_EQUAL ( "seconds", (char*)&pFile[29 + 2 * sizeof(lowPc)] );
+    LONGS_EQUAL ( 's', pFile[g_gmonHeaderSize - 1] );
+    LONGS_EQUAL ( 1, bins()[1] );
+}
+
+TEST(profile, WriteRequestedDump_WithoutRequest_ShouldDoNothing)
+{
+    setProfileBufferFor8Bins();
+    CHECK_TRUE ( Profile_WriteRequestedDump() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(profile, Detach_ShouldCancelPendingDump)
+{
+    setProfileBufferFor8Bins();
+    Profile_RequestDump("out.gmon");
+    platformMock_CommInitReceiveChecksummedData("+$D#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#"), platformMock_CommGetTransmittedData() );
+}
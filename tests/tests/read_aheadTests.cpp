@@ -0,0 +1,394 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/fileio.h>
+#include <core/read_ahead.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* gdb is only sent the lower 32-bits of buffer addresses so the program's buffer is a static like the caches. */
+static uint8_t g_data[MRI_READ_AHEAD_BUFFER_SIZE];
+
+
+TEST_GROUP(readAhead)
+{
+    void setup()
+    {
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        memset(g_data, 0xff, sizeof(g_data));
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( noException, getExceptionCode() );
+        clearExceptionCode();
+        ReadAhead_Reset();
+        platformMock_Uninit();
+    }
+
+    int read(uint32_t fileDescriptor, int32_t size)
+    {
+        return ReadAhead_Read(fileDescriptor, (uintmri_t)g_data, size);
+    }
+
+    int readAll(uint32_t fileDescriptor, int32_t size)
+    {
+        return ReadAhead_ReadAll(fileDescriptor, (uintmri_t)g_data, size);
+    }
+
+    int seek(uint32_t fileDescriptor, int32_t offset, int32_t whence)
+    {
+        SeekParameters parameters;
+
+        parameters.fileDescriptor = fileDescriptor;
+        parameters.offset = offset;
+        parameters.whence = whence;
+        return ReadAhead_Seek(&parameters);
+    }
+
+    void validateReadRequest(const char* pTransmitted, uint32_t expectedFileDescriptor, uint32_t expectedSize)
+    {
+        const char* pRead = findReadRequest(pTransmitted, expectedFileDescriptor);
+        char*       pEnd = NULL;
+
+        strtoul(pRead, &pEnd, 16);
+        UNSIGNED_LONGS_EQUAL ( expectedSize, strtoul(pEnd + 1, NULL, 16) );
+    }
+
+    uint8_t* getAddressFromReadRequest(const char* pTransmitted, uint32_t fileDescriptor)
+    {
+        uintptr_t lowerAddress = strtoul(findReadRequest(pTransmitted, fileDescriptor), NULL, 16);
+        uintptr_t upperAddress = (uintptr_t)g_data & ~(uintptr_t)0xFFFFFFFF;
+
+        return (uint8_t*)(upperAddress | lowerAddress);
+    }
+
+    const char* findReadRequest(const char* pTransmitted, uint32_t fileDescriptor)
+    {
+        char        prefix[32];
+        const char* pRead;
+
+        snprintf(prefix, sizeof(prefix), "$Fread,%02x,", fileDescriptor);
+        pRead = strstr(pTransmitted, prefix);
+        CHECK_TRUE ( pRead != NULL );
+        return pRead + strlen(prefix);
+    }
+
+    void fillCache(uint32_t fileDescriptor, const char* pContents)
+    {
+        char response[32];
+
+        /* The first byte is read from the cache before the test can fill it in so it is left as a 0. */
+        snprintf(response, sizeof(response), "+$F%x#", (unsigned int)strlen(pContents) + 1);
+        platformMock_CommInitReceiveChecksummedData(response);
+            LONGS_EQUAL ( 1, read(fileDescriptor, 1) );
+        LONGS_EQUAL ( 1, platformMock_GetSemihostCallReturnValue() );
+        LONGS_EQUAL ( 0, g_data[0] );
+        memcpy(getAddressFromReadRequest(platformMock_CommGetTransmittedData(), fileDescriptor) + 1,
+               pContents, strlen(pContents));
+        platformMock_CommInitTransmitDataBuffer(512);
+    }
+};
+
+TEST(readAhead, Read_SmallRead_ShouldRequestWholeCacheFromGdb)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F5#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(readAhead, Read_FromStdin_ShouldAlsoBeCached)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F6#");
+        LONGS_EQUAL ( 1, read(0, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 0, MRI_READ_AHEAD_BUFFER_SIZE);
+
+    platformMock_CommInitTransmitDataBuffer(512);
+        LONGS_EQUAL ( 1, read(0, 1) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(readAhead, Read_CachedData_ShouldCopyWithoutContactingGdb)
+{
+    fillCache(3, "Hello");
+        LONGS_EQUAL ( 1, read(3, 3) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 3, platformMock_GetSemihostCallReturnValue() );
+    MEMCMP_EQUAL ( "Hel", g_data, 3 );
+    LONGS_EQUAL ( 0xff, g_data[3] );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(readAhead, Read_MoreThanCached_ShouldReturnJustTheCachedBytes)
+{
+    fillCache(3, "Hello");
+        LONGS_EQUAL ( 1, read(3, 3) );
+        LONGS_EQUAL ( 1, read(3, 10) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+    MEMCMP_EQUAL ( "lo", g_data, 2 );
+}
+
+TEST(readAhead, Read_CacheEmptied_ShouldRefillFromGdb)
+{
+    fillCache(3, "Hi");
+        LONGS_EQUAL ( 1, read(3, 2) );
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+}
+
+TEST(readAhead, Read_EndOfFile_ShouldReturnZeroWithoutCaching)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+}
+
+TEST(readAhead, Read_GdbError_ShouldReturnErrorToProgram)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F-1,9#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    LONGS_EQUAL ( -1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( EBADF, platformMock_GetSemihostCallErrno() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(readAhead, Read_ControlCWhileFilling_ShouldLeaveCallToBeRetried)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F-1,4,C#");
+        LONGS_EQUAL ( 0, read(3, 1) );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(readAhead, Read_AsLargeAsCache_ShouldGoStraightToGdb)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F80#");
+        LONGS_EQUAL ( 1, read(3, MRI_READ_AHEAD_BUFFER_SIZE) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+    POINTERS_EQUAL ( g_data, getAddressFromReadRequest(platformMock_CommGetTransmittedData(), 3) );
+    LONGS_EQUAL ( MRI_READ_AHEAD_BUFFER_SIZE, platformMock_GetSemihostCallReturnValue() );
+}
+
+TEST(readAhead, Read_LargeReadWithCachedData_ShouldReturnCachedDataFirst)
+{
+    fillCache(3, "Hi");
+        LONGS_EQUAL ( 1, read(3, MRI_READ_AHEAD_BUFFER_SIZE) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+    MEMCMP_EQUAL ( "Hi", g_data, 2 );
+}
+
+TEST(readAhead, Read_MoreFilesThanCaches_ShouldSendExtraFilesStraightToGdb)
+{
+    uint32_t fileDescriptor;
+
+    for (fileDescriptor = 3 ; fileDescriptor < 3 + MRI_READ_AHEAD_FILE_COUNT ; fileDescriptor++)
+        fillCache(fileDescriptor, "Hi");
+
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, read(fileDescriptor, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), fileDescriptor, 1);
+    POINTERS_EQUAL ( g_data, getAddressFromReadRequest(platformMock_CommGetTransmittedData(), fileDescriptor) );
+}
+
+TEST(readAhead, Read_FilesShouldHaveSeparateCaches)
+{
+    fillCache(3, "abc");
+    fillCache(4, "xyz");
+        LONGS_EQUAL ( 1, read(3, 3) );
+    MEMCMP_EQUAL ( "abc", g_data, 3 );
+        LONGS_EQUAL ( 1, read(4, 3) );
+    MEMCMP_EQUAL ( "xyz", g_data, 3 );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(readAhead, Seek_RelativeWithCachedData_ShouldAdjustForReadAheadAndDropCache)
+{
+    fillCache(3, "Hello");
+    platformMock_CommInitReceiveChecksummedData("+$F2#");
+        LONGS_EQUAL ( 1, seek(3, 1, GDB_SEEK_CUR) );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Flseek,03,-04,01#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+}
+
+TEST(readAhead, Seek_Absolute_ShouldPassOffsetThroughAndDropCache)
+{
+    fillCache(3, "Hello");
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        LONGS_EQUAL ( 1, seek(3, 0, GDB_SEEK_SET) );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Flseek,03,00,00#+"), platformMock_CommGetTransmittedData() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+}
+
+TEST(readAhead, Seek_Fails_ShouldKeepCachedData)
+{
+    fillCache(0, "Hi");
+    platformMock_CommInitReceiveChecksummedData("+$F-1,1d#");
+        LONGS_EQUAL ( 1, seek(0, 0, GDB_SEEK_CUR) );
+    LONGS_EQUAL ( -1, platformMock_GetSemihostCallReturnValue() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+        LONGS_EQUAL ( 1, read(0, 2) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    MEMCMP_EQUAL ( "Hi", g_data, 2 );
+}
+
+TEST(readAhead, Rewind_NothingCached_ShouldDoNothing)
+{
+    LONGS_EQUAL ( 1, ReadAhead_Rewind(3) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(readAhead, Rewind_CachedData_ShouldSeekBackForDebuggerAndDropCache)
+{
+    fillCache(3, "Hello");
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, ReadAhead_Rewind(3) );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Flseek,03,-05,01#+"), platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+        LONGS_EQUAL ( 1, ReadAhead_Rewind(3) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(readAhead, Rewind_ControlC_ShouldKeepCacheForRetry)
+{
+    fillCache(3, "Hello");
+    platformMock_CommInitReceiveChecksummedData("+$F-1,4,C#");
+        LONGS_EQUAL ( 0, ReadAhead_Rewind(3) );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, ReadAhead_Rewind(3) );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Flseek,03,-05,01#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(readAhead, Invalidate_ShouldDropCacheWithoutContactingGdb)
+{
+    fillCache(3, "Hello");
+        ReadAhead_Invalidate(3);
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, read(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, MRI_READ_AHEAD_BUFFER_SIZE);
+}
+
+TEST(readAhead, ReadAll_NothingCached_ShouldGoStraightToGdb)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, readAll(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, 1);
+    POINTERS_EQUAL ( g_data, getAddressFromReadRequest(platformMock_CommGetTransmittedData(), 3) );
+    LONGS_EQUAL ( 1, platformMock_GetSemihostCallReturnValue() );
+}
+
+TEST(readAhead, ReadAll_CachedDataCoversRequest_ShouldCopyWithoutContactingGdb)
+{
+    fillCache(3, "Hello");
+        LONGS_EQUAL ( 1, readAll(3, 5) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 5, platformMock_GetSemihostCallReturnValue() );
+    MEMCMP_EQUAL ( "Hello", g_data, 5 );
+}
+
+TEST(readAhead, ReadAll_MoreThanCached_ShouldReadRestOfBufferFromGdbAndDropCache)
+{
+    fillCache(3, "Hi");
+    platformMock_CommInitReceiveChecksummedData("+$F3#");
+        LONGS_EQUAL ( 1, readAll(3, 5) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, 3);
+    POINTERS_EQUAL ( g_data + 2, getAddressFromReadRequest(platformMock_CommGetTransmittedData(), 3) );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    MEMCMP_EQUAL ( "Hi", g_data, 2 );
+    LONGS_EQUAL ( 5, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, readAll(3, 1) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, 1);
+}
+
+TEST(readAhead, ReadAll_EndOfFileAfterCachedData_ShouldReturnJustTheCachedBytes)
+{
+    fillCache(3, "Hi");
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        LONGS_EQUAL ( 1, readAll(3, 5) );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+}
+
+TEST(readAhead, ReadAll_GdbErrorAfterCachedData_ShouldReturnJustTheCachedBytes)
+{
+    fillCache(3, "Hi");
+    platformMock_CommInitReceiveChecksummedData("+$F-1,5#");
+        LONGS_EQUAL ( 1, readAll(3, 5) );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+}
+
+TEST(readAhead, ReadAll_ControlC_ShouldKeepCacheForRetry)
+{
+    fillCache(3, "Hi");
+    platformMock_CommInitReceiveChecksummedData("+$F-1,4,C#");
+        LONGS_EQUAL ( 0, readAll(3, 5) );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F3#");
+        LONGS_EQUAL ( 1, readAll(3, 5) );
+    validateReadRequest(platformMock_CommGetTransmittedData(), 3, 3);
+    LONGS_EQUAL ( 5, platformMock_GetSemihostCallReturnValue() );
+}
@@ -0,0 +1,345 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/record.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* Smallest buffer which can hold an entry with every register and the largest store modified. */
+#define MIN_RECORD_SLOTS    (7 + MRI_RECORD_MAX_REGISTERS + MRI_RECORD_MAX_STORE_SIZE / sizeof(uintmri_t))
+
+TEST_GROUP(record)
+{
+    int       m_expectedException;
+    uintmri_t m_slots[MIN_RECORD_SLOTS * 2];
+    uint32_t  m_memory[2];
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        memset(m_slots, 0xFF, sizeof(m_slots));
+        m_memory[0] = 0x11111111;
+        m_memory[1] = 0x22222222;
+        mriSetRecordBuffer(m_slots, sizeof(m_slots));
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetRecordBuffer(NULL, 0);
+        mriSetFlightRecorderBuffer(NULL, 0);
+        Record_Reset();
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void startRecording(const char* pNextPacket = "++$c#")
+    {
+        sendMonitorCommand("record start", pNextPacket);
+        STRCMP_EQUAL ( expectConsoleOutputAndResponse("Recording started.\r\n", "OK"),
+                       platformMock_CommGetTransmittedData() );
+    }
+
+    void executeInstruction(uintmri_t newR0)
+    {
+        platformMock_GetContextEntries()[0] = newR0;
+        Platform_SetProgramCounter(Platform_GetProgramCounter() + 2);
+        stepWhileContinuing();
+    }
+
+    void stepWhileContinuing()
+    {
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+        platformMock_CommInitTransmitDataBuffer(1024);
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_TRUE ( Platform_IsSingleStepping() );
+    }
+
+    void hitBreakpoint(const char* pPacket1, const char* pPacket2 = "+$c#", const char* pPacket3 = NULL)
+    {
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+        platformMock_CommInitTransmitDataBuffer(1024);
+        platformMock_CommInitReceiveChecksummedData(pPacket1, pPacket2, pPacket3);
+            mriDebugException(platformMock_GetContext());
+    }
+};
+
+
+TEST(record, MonitorRecordStart_WithoutBuffer_ShouldFail)
+{
+    mriSetRecordBuffer(NULL, 0);
+    sendMonitorCommand("record start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetRecordBuffer() first.\r\n", "E0B"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Record_IsRunning() );
+}
+
+TEST(record, MonitorRecordStart_WithTooSmallBuffer_ShouldFail)
+{
+    mriSetRecordBuffer(m_slots, (MIN_RECORD_SLOTS - 1) * sizeof(uintmri_t));
+    sendMonitorCommand("record start");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Record buffer is too small.\r\n", "E04"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Record_IsRunning() );
+}
+
+TEST(record, MonitorRecord_WithNoArguments_ShouldShowUsage)
+{
+    sendMonitorCommand("record");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor record start|stop\r\n", "E01"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, MonitorRecord_WithExtraArguments_ShouldShowUsage)
+{
+    sendMonitorCommand("record start now");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor record start|stop\r\n", "E01"),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Record_IsRunning() );
+}
+
+TEST(record, MonitorRecordStart_ThenContinue_ShouldSingleStepInstead)
+{
+    startRecording();
+    CHECK_TRUE ( Record_IsRunning() );
+    CHECK_TRUE ( Record_IsContinuing() );
+    CHECK_TRUE ( Platform_IsSingleStepping() );
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+}
+
+TEST(record, MonitorRecordStop_ShouldDiscardLogAndStopStepping)
+{
+    startRecording();
+    executeInstruction(0x12345678);
+    LONGS_EQUAL ( 1, Record_GetEntryCount() );
+    hitBreakpoint(monitorCommand("record stop"), "++$c#");
+    CHECK_FALSE ( Record_IsRunning() );
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+}
+
+TEST(record, ContinueWhileRecording_ShouldLogEachInstructionWithoutHalting)
+{
+    startRecording();
+    executeInstruction(0x12345678);
+    executeInstruction(0x12345679);
+    LONGS_EQUAL ( 2, Record_GetEntryCount() );
+}
+
+TEST(record, StepWhichChangesNothing_ShouldNotBeLogged)
+{
+    startRecording();
+    stepWhileContinuing();
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+}
+
+TEST(record, BreakpointWhileRecording_ShouldHaltWithNormalStopResponse)
+{
+    startRecording();
+    executeInstruction(0x12345678);
+    hitBreakpoint("+$c#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, Record_GetEntryCount() );
+    CHECK_TRUE ( Platform_IsSingleStepping() );
+}
+
+TEST(record, GdbSingleStepWhileRecording_ShouldLogInstructionAndHalt)
+{
+    startRecording("++$s#");
+    CHECK_FALSE ( Record_IsContinuing() );
+    platformMock_GetContextEntries()[1] = 0xBAADF00D;
+    Platform_SetProgramCounter(INITIAL_PC + 2);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+    platformMock_CommInitTransmitDataBuffer(1024);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, Record_GetEntryCount() );
+}
+
+TEST(record, ReverseStep_ShouldRestoreRegistersAndProgramCounter)
+{
+    startRecording();
+    executeInstruction(0x12345678);
+    executeInstruction(0x87654321);
+    hitBreakpoint("+$bs#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$T05responseT#+"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0x12345678, platformMock_GetContextEntries()[0] );
+    LONGS_EQUAL ( INITIAL_PC + 2, Platform_GetProgramCounter() );
+    LONGS_EQUAL ( 1, Record_GetEntryCount() );
+}
+
+TEST(record, ReverseStep_ShouldRestoreMemoryModifiedByStore)
+{
+    platformMock_SetMemoryWriteOfCurrentInstruction((uintmri_t)m_memory, sizeof(m_memory));
+    startRecording();
+    m_memory[0] = 0xAAAAAAAA;
+    m_memory[1] = 0xBBBBBBBB;
+    executeInstruction(0x12345678);
+    platformMock_SetMemoryWriteOfCurrentInstruction(0, 0);
+    hitBreakpoint("+$bs#");
+    LONGS_EQUAL ( 0x11111111, m_memory[0] );
+    LONGS_EQUAL ( 0x22222222, m_memory[1] );
+    LONGS_EQUAL ( INITIAL_PC, Platform_GetProgramCounter() );
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+}
+
+TEST(record, ReverseStep_WithEmptyLog_ShouldReportStartOfReplayLog)
+{
+    hitBreakpoint("+$bs#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$T05replaylog:begin;responseT#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, ReverseContinue_WithoutBreakpoints_ShouldUndoWholeLog)
+{
+    startRecording();
+    executeInstruction(0x1);
+    executeInstruction(0x2);
+    executeInstruction(0x3);
+    hitBreakpoint("+$bc#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$T05replaylog:begin;responseT#+"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+    LONGS_EQUAL ( INITIAL_PC, Platform_GetProgramCounter() );
+    LONGS_EQUAL ( (uintmri_t)~0ULL, platformMock_GetContextEntries()[0] );
+}
+
+TEST(record, ReverseContinue_ShouldStopAtGdbBreakpoint)
+{
+    startRecording();
+    executeInstruction(0x1);
+    executeInstruction(0x2);
+    executeInstruction(0x3);
+    hitBreakpoint("+$Z1,10000002,2#", "+$bc#", "+$c#");
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+$OK#+$T05responseT#+"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, Record_GetEntryCount() );
+    LONGS_EQUAL ( INITIAL_PC + 2, Platform_GetProgramCounter() );
+    LONGS_EQUAL ( 0x1, platformMock_GetContextEntries()[0] );
+}
+
+TEST(record, RemovedBreakpoint_ShouldNotStopReverseContinue)
+{
+    Record_SetBreakpoint(INITIAL_PC + 2);
+    CHECK_TRUE ( Record_IsBreakpointAt(INITIAL_PC + 3) );
+    hitBreakpoint("+$z1,10000002,2#");
+    CHECK_FALSE ( Record_IsBreakpointAt(INITIAL_PC + 2) );
+}
+
+TEST(record, BreakpointWithCommands_ShouldNotStopReverseContinue)
+{
+    hitBreakpoint("+$Z1,10000002,2#", "+$Z1,10000002,2;cmds:1,X11,22052200220034010006783d25640a0027#", "+$c#");
+    CHECK_FALSE ( Record_IsBreakpointAt(INITIAL_PC + 2) );
+}
+
+TEST(record, FullLog_ShouldDropOldestEntries)
+{
+    size_t entrySlots = 7 + 1;
+    size_t expectedEntries = MIN_RECORD_SLOTS / entrySlots;
+
+    mriSetRecordBuffer(m_slots, MIN_RECORD_SLOTS * sizeof(uintmri_t));
+    startRecording();
+    for (size_t i = 0 ; i < expectedEntries + 2 ; i++)
+        executeInstruction(i);
+    LONGS_EQUAL ( expectedEntries, Record_GetEntryCount() );
+
+    hitBreakpoint("+$bc#");
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+    LONGS_EQUAL ( INITIAL_PC + 2 * 2, Platform_GetProgramCounter() );
+    LONGS_EQUAL ( 1, platformMock_GetContextEntries()[0] );
+}
+
+TEST(record, QuerySupported_WithRecordBuffer_ShouldAdvertiseReverseExecution)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "ReverseStep+;ReverseContinue+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, QuerySupported_WithFlightRecorderAndRecordBuffers_ShouldAdvertiseBoth)
+{
+    uint32_t flightRecorder[64];
+
+    mriSetFlightRecorderBuffer(flightRecorder, sizeof(flightRecorder));
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(MRI_QUERY_SUPPORTED_PACKET_BUFFER_SIZE);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-trace:read+;ReverseStep+;ReverseContinue+;PacketSize=e2#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, QuerySupported_PacketBufferOnlyFitsFlightRecorder_ShouldOmitReverseExecution)
+{
+    uint32_t flightRecorder[64];
+
+    mriSetFlightRecorderBuffer(flightRecorder, sizeof(flightRecorder));
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+    platformMock_SetPacketBufferSize(4 + 108 + 22 + 19);
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "qXfer:mri-trace:read+;PacketSize=95#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, QuerySupported_PacketBufferTooSmall_ShouldOmitReverseExecution)
+{
+    platformMock_CommInitReceiveChecksummedData("+$qSupported#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#"
+                                                 "+$qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;Tracepoints+;BreakpointCommands+;binary-upload+;"
+                                                 "PacketSize=89#+"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(record, Detach_ShouldStopRecording)
+{
+    startRecording();
+    executeInstruction(0x1);
+    hitBreakpoint("+$D#");
+    CHECK_FALSE ( Record_IsRunning() );
+    LONGS_EQUAL ( 0, Record_GetEntryCount() );
+    CHECK_FALSE ( Platform_IsSingleStepping() );
+}
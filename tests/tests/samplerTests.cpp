@@ -0,0 +1,284 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/sampler.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(sampler)
+{
+    int       m_expectedException;
+    char      m_expectedTransmitData[2048];
+    uint8_t   m_sampleBuffer[64];
+    uint32_t  m_var32;
+    uint16_t  m_var16;
+    uint8_t   m_var8;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        mriSetSampleBuffer(m_sampleBuffer, sizeof(m_sampleBuffer));
+        m_var32 = 0x12345678;
+        m_var16 = 0xABCD;
+        m_var8 = 0x5A;
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        mriSetSampleBuffer(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    const char* startCommand(const char* pFormat, ...)
+    {
+        static char command[128];
+        va_list     args;
+
+        va_start(args, pFormat);
+        vsnprintf(command, sizeof(command), pFormat, args);
+        va_end(args);
+        return command;
+    }
+
+    void startSampling(uintptr_t address, uint32_t size)
+    {
+        SamplerVariable variable = { address, size };
+        Sampler_Start(100, &variable, 1);
+        LONGS_EQUAL ( noException, getExceptionCode() );
+    }
+
+    void tickAt(uint32_t cycles)
+    {
+        platformMock_SetCycleCounter(cycles);
+        Sampler_ProcessTick();
+    }
+};
+
+TEST(sampler, MonitorSampleStart_ShouldStartPlatformSampling)
+{
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 4", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Sampling started.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StartSamplingCalls() );
+    LONGS_EQUAL ( 1000, platformMock_StartSamplingIntervalArg() );
+    CHECK_TRUE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, MonitorSampleStart_WithNoVariables_ShouldFail)
+{
+    sendMonitorCommand("sample start 1000");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(
+                    "Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n",
+                    MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartSamplingCalls() );
+}
+
+TEST(sampler, MonitorSampleStart_WithMissingSize_ShouldFail)
+{
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(
+                    "Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n",
+                    MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, MonitorSampleStart_WithTooManyVariables_ShouldFail)
+{
+    sendMonitorCommand("sample start 1000 0x100 1 0x100 1 0x100 1 0x100 1 0x100 1");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(
+                    "Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n",
+                    MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, MonitorSampleStart_WithInvalidSize_ShouldFail)
+{
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 3", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(
+                    "Usage: monitor sample start CYCLES ADDR SIZE [...]|stop\r\n",
+                    MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartSamplingCalls() );
+}
+
+TEST(sampler, MonitorSampleStart_WithNoBuffer_ShouldFail)
+{
+    mriSetSampleBuffer(NULL, 0);
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 4", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetSampleBuffer() first.\r\n",
+                                                  MRI_ERROR_NO_SAMPLE_BUFFER),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, MonitorSampleStart_WithBufferTooSmallForTwoSamples_ShouldFail)
+{
+    mriSetSampleBuffer(m_sampleBuffer, 15);
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 4", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Sample buffer is too small.\r\n", MRI_ERROR_BUFFER_OVERRUN),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, MonitorSampleStart_WithUnreadableVariable_ShouldFail)
+{
+    platformMock_FaultOnSpecificMemoryCall(1);
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 4", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Can't read sampled variable.\r\n",
+                                                  MRI_ERROR_MEMORY_ACCESS_FAILURE),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_StartSamplingCalls() );
+}
+
+TEST(sampler, MonitorSampleStart_WithNoFreeHardware_ShouldFail)
+{
+    platformMock_StartSamplingException(exceededHardwareResourcesException);
+    sendMonitorCommand(startCommand("sample start 1000 0x%lx 4", (unsigned long)(uintptr_t)&m_var32));
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for sampling.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, ProcessTick_WhenNotRunning_ShouldDoNothing)
+{
+    platformMock_CommInitTransmitDataBuffer(256);
+    tickAt(100);
+    Sampler_Drain();
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, ProcessTick_ShouldBatchSamplesUntilBufferIsHalfFull)
+{
+    // 8-byte records in a 64-byte buffer so the 4th sample should cause them all to be sent.
+    startSampling((uintptr_t)&m_var32, sizeof(m_var32));
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveData("++++");
+    tickAt(0x100);
+    m_var32 = 0x1;
+    tickAt(0x200);
+    m_var32 = 0x2;
+    tickAt(0x300);
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+
+    m_var32 = 0xFFFFFFFF;
+    tickAt(0x400);
+    char expectedOutput[4][64];
+    stringToHex(expectedOutput[0], "00000100 12345678\r\n");
+    stringToHex(expectedOutput[1], "00000200 00000001\r\n");
+    stringToHex(expectedOutput[2], "00000300 00000002\r\n");
+    stringToHex(expectedOutput[3], "00000400 ffffffff\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$O%s#$O%s#$O%s#$O%s#",
+             expectedOutput[0], expectedOutput[1], expectedOutput[2], expectedOutput[3]);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(m_expectedTransmitData), platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, ProcessTick_ShouldFormatEachVariableUsingItsSize)
+{
+    SamplerVariable variables[] =
+    {
+        { (uintptr_t)&m_var8, sizeof(m_var8) },
+        { (uintptr_t)&m_var16, sizeof(m_var16) },
+        { (uintptr_t)&m_var32, sizeof(m_var32) }
+    };
+    Sampler_Start(100, variables, sizeof(variables)/sizeof(variables[0]));
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveData("+");
+    tickAt(0xFEDCBA98);
+    Sampler_Drain();
+
+    char expectedOutput[64];
+    stringToHex(expectedOutput, "fedcba98 5a abcd 12345678\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$O%s#", expectedOutput);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(m_expectedTransmitData), platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, ProcessTick_WithMemoryFault_ShouldRecordZero)
+{
+    startSampling((uintptr_t)&m_var32, sizeof(m_var32));
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveData("+");
+    platformMock_FaultOnSpecificMemoryCall(1);
+    tickAt(0x10);
+    Sampler_Drain();
+
+    char expectedOutput[64];
+    stringToHex(expectedOutput, "00000010 00000000\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$O%s#", expectedOutput);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(m_expectedTransmitData), platformMock_CommGetTransmittedData() );
+}
+
+TEST(sampler, MonitorSampleStop_ShouldStopSampling)
+{
+    startSampling((uintptr_t)&m_var16, sizeof(m_var16));
+    sendMonitorCommand("sample stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Sampling stopped.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 1, platformMock_StopSamplingCalls() );
+    CHECK_FALSE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, DebugException_ShouldSendRemainingSamplesBeforeStopResponse)
+{
+    startSampling((uintptr_t)&m_var16, sizeof(m_var16));
+    tickAt(0x20);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("++$c#");
+        mriDebugException(platformMock_GetContext());
+
+    char expectedOutput[64];
+    stringToHex(expectedOutput, "00000020 abcd\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$O%s#$T05responseT#+", expectedOutput);
+    STRCMP_EQUAL ( platformMock_CommChecksumData(m_expectedTransmitData), platformMock_CommGetTransmittedData() );
+    CHECK_TRUE ( Sampler_IsRunning() );
+}
+
+TEST(sampler, Start_ShouldDiscardSamplesFromPreviousRun)
+{
+    startSampling((uintptr_t)&m_var16, sizeof(m_var16));
+    tickAt(0x20);
+    startSampling((uintptr_t)&m_var16, sizeof(m_var16));
+    LONGS_EQUAL ( 1, platformMock_StopSamplingCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(256);
+    Sampler_Drain();
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
@@ -0,0 +1,411 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/cmd_common.h>
+#include <core/snapshot.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+/* gdb is only sent the lower 32-bits of buffer addresses so the upper bits are taken from these statics. */
+static uint8_t           g_region1[16];
+static uint8_t           g_region2[8];
+static MriSnapshotRegion g_regions[2];
+
+// Header + 2 regions + 4 registers in the mock context.
+static const uint32_t g_headerSize = (4 + 2 * 2 + 4) * sizeof(uint32_t);
+
+TEST_GROUP(snapshot)
+{
+    int         m_expectedException;
+    char        m_expectedTransmitData[1024];
+    char        m_responses[4][32];
+    const char* m_pTransmitted;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        platformMock_CommInitTransmitDataBuffer(2048);
+        g_regions[0].address = (uintptr_t)g_region1;
+        g_regions[0].size = sizeof(g_region1);
+        g_regions[1].address = (uintptr_t)g_region2;
+        g_regions[1].size = sizeof(g_region2);
+        memset(g_region1, 0, sizeof(g_region1));
+        memset(g_region2, 0, sizeof(g_region2));
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        Snapshot_Cancel();
+        mriSetSnapshotRegions(NULL, 0);
+        platformMock_Uninit();
+    }
+
+    void validateExceptionCode(int expectedExceptionCode)
+    {
+        m_expectedException = expectedExceptionCode;
+        LONGS_EQUAL ( expectedExceptionCode, getExceptionCode() );
+    }
+
+    void enterDebuggerToSetHaltedContext()
+    {
+        uintmri_t* pEntries = platformMock_GetContextEntries();
+
+        for (int i = 0 ; i < 4 ; i++)
+            pEntries[i] = 0x11111111 * (i + 1);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+        platformMock_CommInitTransmitDataBuffer(2048);
+    }
+
+    const char* transferResponse(int index, uint32_t bytesTransferred)
+    {
+        snprintf(m_responses[index], sizeof(m_responses[index]), "+$F%x#", bytesTransferred);
+        return m_responses[index];
+    }
+
+    uint32_t findTransfer(const char* pPrefix, int index, uint32_t* pAddress)
+    {
+        const char* pTransfer = m_pTransmitted;
+        char*       pEnd = NULL;
+
+        for (int i = 0 ; i <= index ; i++)
+        {
+            pTransfer = strstr(pTransfer, pPrefix);
+            CHECK_TRUE ( pTransfer != NULL );
+            pTransfer += strlen(pPrefix);
+        }
+        *pAddress = strtoul(pTransfer, &pEnd, 16);
+        return strtoul(pEnd + 1, NULL, 16);
+    }
+
+    const uint32_t* stagingPointer(uint32_t address)
+    {
+        uintptr_t upperAddress = (uintptr_t)g_region1 & ~(uintptr_t)0xFFFFFFFF;
+
+        return (const uint32_t*)(upperAddress | address);
+    }
+
+    void validateConsoleOutput(const char* pOutput)
+    {
+        char expected[128];
+
+        stringToHex(expected, pOutput);
+        CHECK_TRUE ( strstr(m_pTransmitted, expected) != NULL );
+    }
+
+    const uint32_t* saveSnapshot()
+    {
+        uint32_t address;
+
+        Snapshot_RequestSave("state.snap");
+        platformMock_CommInitReceiveChecksummedData("+$F5#", transferResponse(0, g_headerSize),
+                                                    transferResponse(1, sizeof(g_region1)),
+                                                    transferResponse(2, sizeof(g_region2)), "+$F0#", "+");
+            CHECK_TRUE ( Snapshot_HandleRequest() );
+        m_pTransmitted = platformMock_CommGetTransmittedData();
+        UNSIGNED_LONGS_EQUAL ( g_headerSize, findTransfer("$Fwrite,05,", 0, &address) );
+        return stagingPointer(address);
+    }
+};
+
+TEST(snapshot, MonitorSnapshot_WithoutRegions_ShouldReportErrorAndNotRequestTransfer)
+{
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot save state.snap"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Program must call mriSetSnapshotRegions() first.\r\n",
+                                                  MRI_ERROR_NO_SNAPSHOT_REGIONS),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_TRUE ( Snapshot_HandleRequest() );
+}
+
+TEST(snapshot, MonitorSnapshot_WithoutArguments_ShouldDisplayUsage)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor snapshot save|restore FILENAME\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(snapshot, MonitorSnapshot_UnknownSubcommand_ShouldDisplayUsage)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot load state.snap"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor snapshot save|restore FILENAME\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(snapshot, MonitorSnapshot_MissingFilename_ShouldDisplayUsage)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot save"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor snapshot save|restore FILENAME\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(snapshot, MonitorSnapshot_TooManyArguments_ShouldDisplayUsage)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot save a b"), "++$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor snapshot save|restore FILENAME\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(snapshot, MonitorSnapshotSave_ShouldOpenFileForWritingOnNextContinue)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot save state.snap"), "++$c#", "+$F-1,2#", "+");
+        mriDebugException(platformMock_GetContext());
+
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    char output[128];
+    stringToHex(output, "Will save snapshot on next continue.\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$T05responseT#+$O%s#", output);
+    const char* pExpected = platformMock_CommChecksumData(m_expectedTransmitData);
+    CHECK_TRUE ( strncmp(m_pTransmitted, pExpected, strlen(pExpected)) == 0 );
+    // The length of "state.snap" plus its NULL terminator.
+    CHECK_TRUE ( strstr(m_pTransmitted, "/0b,0601,01a4#") != NULL );
+    validateConsoleOutput("Failed to open snapshot file.\r\n");
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fwrite") == NULL );
+    LONGS_EQUAL ( 1, platformMock_GetLeavingDebuggerCalls() );
+}
+
+TEST(snapshot, MonitorSnapshotRestore_ShouldOpenFileForReadingOnNextContinue)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    platformMock_CommInitReceiveChecksummedData(monitorCommand("snapshot restore state.snap"), "++$c#",
+                                                "+$F-1,2#", "+");
+        mriDebugException(platformMock_GetContext());
+
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    char output[128];
+    stringToHex(output, "Will restore snapshot on next continue.\r\n");
+    snprintf(m_expectedTransmitData, sizeof(m_expectedTransmitData), "$T05responseT#+$O%s#", output);
+    const char* pExpected = platformMock_CommChecksumData(m_expectedTransmitData);
+    CHECK_TRUE ( strncmp(m_pTransmitted, pExpected, strlen(pExpected)) == 0 );
+    CHECK_TRUE ( strstr(m_pTransmitted, "/0b,00,01a4#") != NULL );
+    validateConsoleOutput("Failed to open snapshot file.\r\n");
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fread") == NULL );
+}
+
+TEST(snapshot, Detach_ShouldCancelPendingSnapshot)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestSave("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$D#");
+        mriDebugException(platformMock_GetContext());
+    CHECK_TRUE ( strstr(platformMock_CommGetTransmittedData(), "$Fopen") == NULL );
+}
+
+TEST(snapshot, Request_WithoutRegions_ShouldThrow)
+{
+    Snapshot_RequestRestore("state.snap");
+    validateExceptionCode(notFoundException);
+}
+
+TEST(snapshot, Request_EmptyFilename_ShouldThrow)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestSave("");
+    validateExceptionCode(invalidArgumentException);
+}
+
+TEST(snapshot, Request_FilenameTooLong_ShouldThrow)
+{
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestSave("0123456789012345678901234567890123456789012345678901234567890123456789");
+    validateExceptionCode(bufferOverrunException);
+}
+
+TEST(snapshot, SetSnapshotRegions_NullRegions_ShouldActLikeNoRegions)
+{
+    mriSetSnapshotRegions(NULL, 2);
+    Snapshot_RequestSave("state.snap");
+    validateExceptionCode(notFoundException);
+}
+
+TEST(snapshot, HandleRequest_WithoutRequest_ShouldDoNothing)
+{
+    CHECK_TRUE ( Snapshot_HandleRequest() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(snapshot, HandleRequest_Save_ShouldWriteHeaderRegisterAndRegionsToHost)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    const uint32_t* pHeader = saveSnapshot();
+
+    CHECK_TRUE ( strstr(m_pTransmitted, "/0b,0601,01a4#") != NULL );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Snapshot saved.\r\n");
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    UNSIGNED_LONGS_EQUAL ( MRI_SNAPSHOT_MAGIC, pHeader[0] );
+    LONGS_EQUAL ( MRI_SNAPSHOT_VERSION, pHeader[1] );
+    LONGS_EQUAL ( 4, pHeader[2] );
+    LONGS_EQUAL ( 2, pHeader[3] );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region1, pHeader[4] );
+    LONGS_EQUAL ( sizeof(g_region1), pHeader[5] );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region2, pHeader[6] );
+    LONGS_EQUAL ( sizeof(g_region2), pHeader[7] );
+    UNSIGNED_LONGS_EQUAL ( 0x11111111, pHeader[8] );
+    UNSIGNED_LONGS_EQUAL ( 0x22222222, pHeader[9] );
+    UNSIGNED_LONGS_EQUAL ( 0x33333333, pHeader[10] );
+    UNSIGNED_LONGS_EQUAL ( 0x44444444, pHeader[11] );
+
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( sizeof(g_region1), findTransfer("$Fwrite,05,", 1, &address) );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region1, address );
+    UNSIGNED_LONGS_EQUAL ( sizeof(g_region2), findTransfer("$Fwrite,05,", 2, &address) );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region2, address );
+}
+
+TEST(snapshot, HandleRequest_SaveWithShortHeaderWrite_ShouldSkipRegionsAndReportFailure)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestSave("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F4#", "+$F0#", "+");
+        CHECK_TRUE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(strstr(m_pTransmitted, "$Fwrite,05,") + 1, "$Fwrite") == NULL );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Failed to write snapshot file.\r\n");
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+}
+
+TEST(snapshot, HandleRequest_SaveInterruptedByCtrlC_ShouldCloseFileAndReturnZero)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestSave("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F-1,4,C#", "+$F0#");
+        CHECK_FALSE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    CHECK_TRUE ( Snapshot_HandleRequest() );
+}
+
+TEST(snapshot, HandleRequest_RestoreWithShortHeaderRead_ShouldReportFailureAndLeaveRegistersAlone)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    Snapshot_RequestRestore("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F4#", "+$F0#", "+");
+        CHECK_TRUE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( g_headerSize, findTransfer("$Fread,05,", 0, &address) );
+    CHECK_TRUE ( strstr(strstr(m_pTransmitted, "$Fread,05,") + 1, "$Fread") == NULL );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Failed to read snapshot file.\r\n");
+    UNSIGNED_LONGS_EQUAL ( 0x11111111, platformMock_GetContextEntries()[0] );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+}
+
+TEST(snapshot, HandleRequest_RestoreWithDifferentRegions_ShouldReportMismatch)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    saveSnapshot();
+
+    // The staging buffer still holds the header that was just saved, which gdb's read is assumed to return.
+    g_regions[1].size = 4;
+    platformMock_CommInitTransmitDataBuffer(2048);
+    Snapshot_RequestRestore("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", transferResponse(0, g_headerSize), "+$F0#", "+");
+        CHECK_TRUE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(strstr(m_pTransmitted, "$Fread,05,") + 1, "$Fread") == NULL );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Snapshot file doesn't match this program.\r\n");
+}
+
+TEST(snapshot, HandleRequest_Restore_ShouldReadRegionsInPlaceAndRestoreRegisters)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    saveSnapshot();
+
+    // The staging buffer still holds the header that was just saved, which gdb's read is assumed to return.
+    uintmri_t* pEntries = platformMock_GetContextEntries();
+    for (int i = 0 ; i < 4 ; i++)
+        pEntries[i] = 0;
+    platformMock_CommInitTransmitDataBuffer(2048);
+    Snapshot_RequestRestore("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", transferResponse(0, g_headerSize),
+                                                transferResponse(1, sizeof(g_region1)),
+                                                transferResponse(2, sizeof(g_region2)), "+$F0#", "+");
+        CHECK_TRUE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    uint32_t address;
+    UNSIGNED_LONGS_EQUAL ( sizeof(g_region1), findTransfer("$Fread,05,", 1, &address) );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region1, address );
+    UNSIGNED_LONGS_EQUAL ( sizeof(g_region2), findTransfer("$Fread,05,", 2, &address) );
+    UNSIGNED_LONGS_EQUAL ( (uint32_t)(uintptr_t)g_region2, address );
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fclose,05#") != NULL );
+    validateConsoleOutput("Snapshot restored.\r\n");
+    UNSIGNED_LONGS_EQUAL ( 0x11111111, pEntries[0] );
+    UNSIGNED_LONGS_EQUAL ( 0x22222222, pEntries[1] );
+    UNSIGNED_LONGS_EQUAL ( 0x33333333, pEntries[2] );
+    UNSIGNED_LONGS_EQUAL ( 0x44444444, pEntries[3] );
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+}
+
+TEST(snapshot, HandleRequest_RestoreWithShortRegionRead_ShouldLeaveRegistersAlone)
+{
+    enterDebuggerToSetHaltedContext();
+    mriSetSnapshotRegions(g_regions, 2);
+    saveSnapshot();
+
+    uintmri_t* pEntries = platformMock_GetContextEntries();
+    pEntries[0] = 0;
+    platformMock_CommInitTransmitDataBuffer(2048);
+    Snapshot_RequestRestore("state.snap");
+    platformMock_CommInitReceiveChecksummedData("+$F5#", transferResponse(0, g_headerSize), "+$F1#", "+$F0#", "+");
+        CHECK_TRUE ( Snapshot_HandleRequest() );
+    m_pTransmitted = platformMock_CommGetTransmittedData();
+    CHECK_TRUE ( strstr(m_pTransmitted, "$Fread,05,") != NULL );
+    validateConsoleOutput("Failed to read snapshot file.\r\n");
+    UNSIGNED_LONGS_EQUAL ( 0, pEntries[0] );
+}
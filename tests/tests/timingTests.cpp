@@ -0,0 +1,246 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/timing.h>
+}
+#include <platformMock.h>
+#include <monitorCommandHelpers.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+#define START_ADDRESS   (INITIAL_PC + 0x10)
+#define END_ADDRESS     (INITIAL_PC + 0x20)
+
+TEST_GROUP(timing)
+{
+    int       m_expectedException;
+
+    void setup()
+    {
+        m_expectedException = noException;
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( m_expectedException, getExceptionCode() );
+        clearExceptionCode();
+        Timing_Reset();
+        platformMock_Uninit();
+    }
+
+    void setTrapReason(PlatformTrapType type)
+    {
+        PlatformTrapReason reason = { type, 0 };
+        platformMock_SetTrapReason(&reason);
+    }
+
+    void startTiming()
+    {
+        sendMonitorCommand("time 0x10000010 0x10000020");
+        STRCMP_EQUAL ( expectConsoleOutputAndResponse("Timing started.\r\n", "OK"),
+                       platformMock_CommGetTransmittedData() );
+    }
+
+    void hitBreakpointAndResume(uint32_t address, uint32_t cycles)
+    {
+        Platform_SetProgramCounter(address);
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+        platformMock_SetCycleCounter(cycles);
+        platformMock_CommInitTransmitDataBuffer(512);
+        platformMock_CommInitReceiveChecksummedData("+$c#");
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_TRUE ( Platform_IsSingleStepping() );
+        setTrapReason(MRI_PLATFORM_TRAP_TYPE_UNKNOWN);
+            mriDebugException(platformMock_GetContext());
+        STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+        CHECK_FALSE ( Platform_IsSingleStepping() );
+    }
+
+    void timeRegion(uint32_t startCycles, uint32_t endCycles)
+    {
+        hitBreakpointAndResume(START_ADDRESS, startCycles);
+        hitBreakpointAndResume(END_ADDRESS, endCycles);
+    }
+};
+
+TEST(timing, MonitorTime_WithStartAndEnd_ShouldEnableCycleCounterAndSetBothBreakpoints)
+{
+    startTiming();
+    LONGS_EQUAL ( 1, platformMock_EnableCycleCounterCalls() );
+    LONGS_EQUAL ( 2, platformMock_SetHardwareBreakpointCalls() );
+    LONGS_EQUAL ( END_ADDRESS, platformMock_SetHardwareBreakpointAddressArg() );
+    CHECK_TRUE ( Timing_IsRunning() );
+}
+
+TEST(timing, MonitorTime_WithThumbBitSetOnAddresses_ShouldClearIt)
+{
+    sendMonitorCommand("time 0x10000011 0x10000021");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Timing started.\r\n", "OK"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( END_ADDRESS, platformMock_SetHardwareBreakpointAddressArg() );
+}
+
+TEST(timing, MonitorTime_WithSameStartAndEnd_ShouldFail)
+{
+    sendMonitorCommand("time 0x10000010 0x10000011");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor time [START END|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_FALSE ( Timing_IsRunning() );
+}
+
+TEST(timing, MonitorTime_WithOnlyStart_ShouldFail)
+{
+    sendMonitorCommand("time 0x10000010");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor time [START END|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Timing_IsRunning() );
+}
+
+TEST(timing, MonitorTime_WithExtraArguments_ShouldFail)
+{
+    sendMonitorCommand("time stop now");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Usage: monitor time [START END|stop]\r\n",
+                                                  MRI_ERROR_INVALID_ARGUMENT),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(timing, MonitorTime_WithNoCycleCounter_ShouldFail)
+{
+    platformMock_EnableCycleCounterException(exceededHardwareResourcesException);
+    sendMonitorCommand("time 0x10000010 0x10000020");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for timing.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_SetHardwareBreakpointCalls() );
+    CHECK_FALSE ( Timing_IsRunning() );
+}
+
+TEST(timing, MonitorTime_WithNoFreeBreakpoints_ShouldFail)
+{
+    platformMock_SetHardwareBreakpointException(exceededHardwareResourcesException);
+    sendMonitorCommand("time 0x10000010 0x10000020");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No free hardware resources for timing.\r\n",
+                                                  MRI_ERROR_NO_FREE_BREAKPOINT),
+                   platformMock_CommGetTransmittedData() );
+    CHECK_FALSE ( Timing_IsRunning() );
+}
+
+TEST(timing, MonitorTimeStop_ShouldClearBothBreakpointsAndKeepStats)
+{
+    startTiming();
+    timeRegion(100, 150);
+    sendMonitorCommand("time stop");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("Timing stopped.\r\n", "OK"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2 + 2, platformMock_ClearHardwareBreakpointCalls() );
+    LONGS_EQUAL ( END_ADDRESS, platformMock_ClearHardwareBreakpointAddressArg() );
+    CHECK_FALSE ( Timing_IsRunning() );
+    LONGS_EQUAL ( 1, Timing_GetStats()->count );
+}
+
+TEST(timing, RegionHits_ShouldResumeAndRecordCycleStats)
+{
+    startTiming();
+    timeRegion(100, 150);
+    timeRegion(1000, 1200);
+    timeRegion(0xFFFFFFF0, 0x00000030);
+
+    const TimingStats* pStats = Timing_GetStats();
+    LONGS_EQUAL ( 3, pStats->count );
+    LONGS_EQUAL ( 50, pStats->minimum );
+    LONGS_EQUAL ( 200, pStats->maximum );
+    LONGS_EQUAL ( 50 + 200 + 0x40, pStats->total );
+    LONGS_EQUAL ( (50 + 200 + 0x40) / 3, Timing_GetMeanCycles() );
+    LONGS_EQUAL ( 1, pStats->buckets[5] );
+    LONGS_EQUAL ( 1, pStats->buckets[6] );
+    LONGS_EQUAL ( 1, pStats->buckets[7] );
+    LONGS_EQUAL ( 0, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(timing, VeryLongRegion_ShouldLandInLastBucket)
+{
+    startTiming();
+    timeRegion(0, 0x80000000);
+    LONGS_EQUAL ( 1, Timing_GetStats()->buckets[MRI_TIMING_BUCKET_COUNT - 1] );
+}
+
+TEST(timing, EndHitWithoutStart_ShouldResumeWithoutRecording)
+{
+    startTiming();
+    hitBreakpointAndResume(END_ADDRESS, 100);
+    LONGS_EQUAL ( 0, Timing_GetStats()->count );
+}
+
+TEST(timing, OtherHardwareBreakpoint_ShouldStopAndNotifyGdb)
+{
+    startTiming();
+    Platform_SetProgramCounter(INITIAL_PC);
+    setTrapReason(MRI_PLATFORM_TRAP_TYPE_HWBREAK);
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$c#");
+        mriDebugException(platformMock_GetContext());
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$T05responseT#+"), platformMock_CommGetTransmittedData() );
+}
+
+TEST(timing, MonitorTime_WithNoCompletedRegions_ShouldSaySo)
+{
+    startTiming();
+    sendMonitorCommand("time");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse("No timed regions have completed.\r\n", "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(timing, MonitorTime_ShouldReportStatsAndHistogram)
+{
+    static const char* outputs[] =
+    {
+        "Regions: ", "2", "\r\n",
+        "Min: ", "50", " cycles\r\n",
+        "Max: ", "200", " cycles\r\n",
+        "Mean: ", "125", " cycles\r\n",
+        ">= ", "32", " cycles: ", "1", "\r\n",
+        ">= ", "128", " cycles: ", "1", "\r\n"
+    };
+    startTiming();
+    timeRegion(100, 150);
+    timeRegion(1000, 1200);
+    sendMonitorCommand("time", "+++++++++++++++++++++++$c#");
+    STRCMP_EQUAL ( expectConsoleOutputAndResponse(outputs, sizeof(outputs)/sizeof(outputs[0]), "OK"),
+                   platformMock_CommGetTransmittedData() );
+}
+
+TEST(timing, StartAgain_ShouldClearPreviousStats)
+{
+    startTiming();
+    timeRegion(100, 150);
+    startTiming();
+    LONGS_EQUAL ( 0, Timing_GetStats()->count );
+    LONGS_EQUAL ( 2 + 2, platformMock_ClearHardwareBreakpointCalls() );
+    LONGS_EQUAL ( 2 + 2 + 2, platformMock_SetHardwareBreakpointCalls() );
+}
@@ -0,0 +1,291 @@
+/* Copyright 2024 Adam Green (https://github.com/adamgreen/)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include <core/try_catch.h>
+#include <core/mri.h>
+#include <core/core.h>
+#include <core/write_behind.h>
+}
+#include <platformMock.h>
+
+// Include C++ headers for test harness.
+#include "CppUTest/TestHarness.h"
+
+
+TEST_GROUP(writeBehind)
+{
+    uint8_t m_data[MRI_WRITE_BEHIND_BUFFER_SIZE + 1];
+
+    void setup()
+    {
+        platformMock_Init();
+        mriInit("MRI_UART_MBED_USB");
+        for (size_t i = 0 ; i < sizeof(m_data) ; i++)
+            m_data[i] = (uint8_t)i;
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL ( noException, getExceptionCode() );
+        clearExceptionCode();
+        WriteBehind_Reset();
+        platformMock_Uninit();
+    }
+
+    int write(uint32_t fileDescriptor, int32_t size)
+    {
+        return WriteBehind_Write(fileDescriptor, (uintmri_t)m_data, size);
+    }
+
+    void validateWriteRequest(const char* pTransmitted, uint32_t expectedFileDescriptor, uint32_t expectedSize)
+    {
+        char        prefix[32];
+        const char* pWrite;
+        char*       pEnd = NULL;
+
+        snprintf(prefix, sizeof(prefix), "$Fwrite,%02x,", expectedFileDescriptor);
+        pWrite = strstr(pTransmitted, prefix);
+        CHECK_TRUE ( pWrite != NULL );
+        strtoul(pWrite + strlen(prefix), &pEnd, 16);
+        UNSIGNED_LONGS_EQUAL ( expectedSize, strtoul(pEnd + 1, NULL, 16) );
+    }
+
+    int countWriteRequests(const char* pTransmitted)
+    {
+        int count = 0;
+
+        while ((pTransmitted = strstr(pTransmitted, "$Fwrite,")) != NULL)
+        {
+            count++;
+            pTransmitted++;
+        }
+        return count;
+    }
+};
+
+TEST(writeBehind, Write_SmallWrite_ShouldCompleteWithoutContactingGdb)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 5, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, Write_ToStderr_ShouldGoStraightToGdb)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F5#");
+        LONGS_EQUAL ( 1, write(2, 5) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 2, 5);
+    LONGS_EQUAL ( 5, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, Write_LargerThanBuffer_ShouldGoStraightToGdb)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F81#");
+        LONGS_EQUAL ( 1, write(3, MRI_WRITE_BEHIND_BUFFER_SIZE + 1) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, MRI_WRITE_BEHIND_BUFFER_SIZE + 1);
+    LONGS_EQUAL ( 1, countWriteRequests(platformMock_CommGetTransmittedData()) );
+    LONGS_EQUAL ( MRI_WRITE_BEHIND_BUFFER_SIZE + 1, platformMock_GetSemihostCallReturnValue() );
+}
+
+TEST(writeBehind, Write_ExactlyFillBuffer_ShouldStillNotContactGdb)
+{
+    LONGS_EQUAL ( 1, write(3, MRI_WRITE_BEHIND_BUFFER_SIZE - 1) );
+    LONGS_EQUAL ( 1, write(3, 1) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, Write_OverflowBuffer_ShouldFlushEarlierWritesThenBufferNewOne)
+{
+    LONGS_EQUAL ( 1, write(3, MRI_WRITE_BEHIND_BUFFER_SIZE - 1) );
+    platformMock_CommInitReceiveChecksummedData("+$F7f#");
+        LONGS_EQUAL ( 1, write(3, 2) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, MRI_WRITE_BEHIND_BUFFER_SIZE - 1);
+    CHECK_FALSE ( IsIssuingFileIOForDebugger() );
+    LONGS_EQUAL ( 2, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F2#");
+        LONGS_EQUAL ( 1, WriteBehind_Flush(3) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, 2);
+}
+
+TEST(writeBehind, Write_ControlCWhileFlushing_ShouldLeaveCallToBeRetried)
+{
+    LONGS_EQUAL ( 1, write(3, MRI_WRITE_BEHIND_BUFFER_SIZE) );
+    platformMock_CommInitReceiveChecksummedData("+$F-1,4,C#");
+        LONGS_EQUAL ( 0, write(3, 1) );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+    platformMock_CommInitReceiveChecksummedData("+$F80#");
+        LONGS_EQUAL ( 1, WriteBehind_Flush(3) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, MRI_WRITE_BEHIND_BUFFER_SIZE);
+}
+
+TEST(writeBehind, Write_MoreFilesThanBuffers_ShouldSendExtraFilesStraightToGdb)
+{
+    uint32_t fileDescriptor;
+
+    for (fileDescriptor = 3 ; fileDescriptor < 3 + MRI_WRITE_BEHIND_FILE_COUNT ; fileDescriptor++)
+        LONGS_EQUAL ( 1, write(fileDescriptor, 1) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, write(fileDescriptor, 1) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), fileDescriptor, 1);
+}
+
+TEST(writeBehind, Write_AfterFlushFreesBuffer_ShouldBufferAnotherFile)
+{
+    uint32_t fileDescriptor;
+
+    for (fileDescriptor = 3 ; fileDescriptor < 3 + MRI_WRITE_BEHIND_FILE_COUNT ; fileDescriptor++)
+        LONGS_EQUAL ( 1, write(fileDescriptor, 1) );
+    platformMock_CommInitReceiveChecksummedData("+$F1#");
+        LONGS_EQUAL ( 1, WriteBehind_Flush(3) );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+        LONGS_EQUAL ( 1, write(fileDescriptor, 1) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(writeBehind, Flush_NothingBuffered_ShouldDoNothing)
+{
+    LONGS_EQUAL ( 1, WriteBehind_Flush(3) );
+    LONGS_EQUAL ( 1, WriteBehind_FlushAll() );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+}
+
+TEST(writeBehind, Flush_ShouldOnlyFlushRequestedFile)
+{
+    LONGS_EQUAL ( 1, write(3, 1) );
+    LONGS_EQUAL ( 1, write(4, 2) );
+    platformMock_CommInitReceiveChecksummedData("+$F2#");
+        LONGS_EQUAL ( 1, WriteBehind_Flush(4) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 4, 2);
+    LONGS_EQUAL ( 1, countWriteRequests(platformMock_CommGetTransmittedData()) );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, FlushAll_ShouldFlushEveryFile)
+{
+    LONGS_EQUAL ( 1, write(3, 1) );
+    LONGS_EQUAL ( 1, write(4, 2) );
+    platformMock_CommInitReceiveChecksummedData("+$F1#", "+$F2#");
+        LONGS_EQUAL ( 1, WriteBehind_FlushAll() );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, 1);
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 4, 2);
+}
+
+TEST(writeBehind, Flush_ShortWrite_ShouldReportEIOOnNextWrite)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F2#");
+        LONGS_EQUAL ( 1, WriteBehind_Flush(3) );
+
+    platformMock_CommInitTransmitDataBuffer(512);
+        LONGS_EQUAL ( 1, write(3, 1) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( -1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( EIO, platformMock_GetSemihostCallErrno() );
+
+        LONGS_EQUAL ( 1, write(3, 1) );
+    LONGS_EQUAL ( 1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallErrno() );
+}
+
+TEST(writeBehind, FSync_WithBufferedData_ShouldFlushAndReturnZero)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F5#");
+        LONGS_EQUAL ( 1, WriteBehind_FSync(3) );
+    validateWriteRequest(platformMock_CommGetTransmittedData(), 3, 5);
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, FSync_NothingBuffered_ShouldReturnZeroWithoutContactingGdb)
+{
+    LONGS_EQUAL ( 1, WriteBehind_FSync(3) );
+    STRCMP_EQUAL ( "", platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, FSync_FailedFlush_ShouldReturnGdbErrno)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F-1,1c#");
+        LONGS_EQUAL ( 1, WriteBehind_FSync(3) );
+    LONGS_EQUAL ( -1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0x1c, platformMock_GetSemihostCallErrno() );
+}
+
+TEST(writeBehind, Close_WithBufferedData_ShouldFlushBeforeClosing)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$F0#");
+        LONGS_EQUAL ( 1, WriteBehind_Close(3) );
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    validateWriteRequest(pTransmitted, 3, 5);
+    CHECK_TRUE ( strstr(pTransmitted, "$Fwrite,") < strstr(pTransmitted, "$Fclose,03#") );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 2, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}
+
+TEST(writeBehind, Close_NothingBuffered_ShouldJustClose)
+{
+    platformMock_CommInitReceiveChecksummedData("+$F0#");
+        LONGS_EQUAL ( 1, WriteBehind_Close(3) );
+    STRCMP_EQUAL ( platformMock_CommChecksumData("$Fclose,03#+"), platformMock_CommGetTransmittedData() );
+    LONGS_EQUAL ( 0, platformMock_GetSemihostCallReturnValue() );
+}
+
+TEST(writeBehind, Close_FailedFlush_ShouldReportWriteErrorAfterClosing)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F-1,1c#", "+$F0#");
+        LONGS_EQUAL ( 1, WriteBehind_Close(3) );
+    CHECK_TRUE ( strstr(platformMock_CommGetTransmittedData(), "$Fclose,03#") != NULL );
+    LONGS_EQUAL ( -1, platformMock_GetSemihostCallReturnValue() );
+    LONGS_EQUAL ( 0x1c, platformMock_GetSemihostCallErrno() );
+    LONGS_EQUAL ( -1, GetSemihostReturnCode() );
+    LONGS_EQUAL ( 0x1c, GetSemihostErrno() );
+}
+
+TEST(writeBehind, DebugException_ShouldFlushBufferedWritesBeforeStopResponse)
+{
+    LONGS_EQUAL ( 1, write(3, 5) );
+    platformMock_CommInitReceiveChecksummedData("+$F5#", "+$c#");
+        mriDebugException(platformMock_GetContext());
+
+    const char* pTransmitted = platformMock_CommGetTransmittedData();
+    const char* pStop = strstr(pTransmitted, "$T05responseT#");
+    CHECK_TRUE ( pStop != NULL );
+    CHECK_TRUE ( strstr(pTransmitted, "$Fwrite,") < pStop );
+    validateWriteRequest(pTransmitted, 3, 5);
+    LONGS_EQUAL ( 1, platformMock_AdvanceProgramCounterToNextInstructionCalls() );
+}